@@ -190,11 +190,56 @@ int foil_page_set_row_col(pcmcth_page *page, int cols, int rows)
     return 0;
 }
 
+void foil_page_set_clip_rect(pcmcth_page *page, const foil_rect *rc)
+{
+    if (rc) {
+        page->clip_rect = *rc;
+        page->clipped = true;
+    }
+    else {
+        page->clipped = false;
+    }
+}
+
+/* Gets the bounds of the drawable area; returns false if nothing can be
+   drawn in the row `y`. */
+static bool get_drawable_bounds(pcmcth_page *page, int y,
+        int *left, int *right)
+{
+    if (y < 0 || y >= page->rows)
+        return false;
+
+    *left = 0;
+    *right = page->cols;
+    if (page->clipped) {
+        if (y < page->clip_rect.top || y >= page->clip_rect.bottom)
+            return false;
+
+        if (page->clip_rect.left > *left)
+            *left = page->clip_rect.left;
+        if (page->clip_rect.right < *right)
+            *right = page->clip_rect.right;
+    }
+
+    return *left < *right;
+}
+
 /* use the foreground color of the page but reserve the background color */
 int foil_page_draw_uchar(pcmcth_page *page, int x, int y,
         uint32_t uc, size_t count)
 {
-    if (x < 0 || y < 0 || x >= page->cols || y >= page->rows || count == 0)
+    int left, right;
+    if (count == 0 || !get_drawable_bounds(page, y, &left, &right))
+        return 0;
+
+    /* skip characters beyond the left bound */
+    int w = g_unichar_iswide(uc) ? 2 : 1;
+    while (x < left && count > 0) {
+        x += w;
+        count--;
+    }
+
+    if (x >= right || count == 0)
         return 0;
 
     struct foil_tty_cell *dst_cell = page->cells[y];
@@ -217,7 +262,7 @@ int foil_page_draw_uchar(pcmcth_page *page, int x, int y,
 
     size_t my_count = 0;
     if (g_unichar_iswide(uc)) {
-        while (x < page->cols - 1 && my_count < count) {
+        while (x < right - 1 && my_count < count) {
             dst_cell->uc = uc;
             dst_cell->attrs = page->attrs;
             dst_cell->fgc = page->fgc;
@@ -233,7 +278,7 @@ int foil_page_draw_uchar(pcmcth_page *page, int x, int y,
         }
     }
     else {
-        while (x < page->cols && my_count < count) {
+        while (x < right && my_count < count) {
             dst_cell->uc = uc;
             dst_cell->latter_half = 0;
             dst_cell->attrs = page->attrs;
@@ -263,11 +308,12 @@ int foil_page_draw_uchar(pcmcth_page *page, int x, int y,
 int foil_page_draw_ustring(pcmcth_page *page, int x, int y,
         uint32_t *ucs, size_t nr_ucs)
 {
-    if (y < 0 || x >= page->cols || y >= page->rows || nr_ucs == 0)
+    int left, right;
+    if (nr_ucs == 0 || !get_drawable_bounds(page, y, &left, &right))
         return 0;
 
     /* skip characters beyond the left bound */
-    while (x < 0 && nr_ucs > 0) {
+    while (x < left && nr_ucs > 0) {
         if (g_unichar_iswide(*ucs))
             x += 2;
         else
@@ -276,7 +322,7 @@ int foil_page_draw_ustring(pcmcth_page *page, int x, int y,
         nr_ucs--;
     }
 
-    if (nr_ucs == 0)
+    if (nr_ucs == 0 || x >= right)
         return 0;
 
     assert(x >= 0);
@@ -300,11 +346,11 @@ int foil_page_draw_ustring(pcmcth_page *page, int x, int y,
     }
 
     size_t my_count = 0;
-    while (x < page->cols && my_count < nr_ucs) {
+    while (x < right && my_count < nr_ucs) {
         uint32_t uc = ucs[my_count];
 
         if (g_unichar_iswide(uc)) {
-            if (x == page->cols - 1)
+            if (x == right - 1)
                 break;
 
             dst_cell->uc = uc;
@@ -350,7 +396,7 @@ int foil_page_draw_ustring(pcmcth_page *page, int x, int y,
 
 bool foil_page_fill_rect(pcmcth_page *page, const foil_rect *rc, uint32_t uc)
 {
-    if (rc == NULL) {
+    if (rc == NULL && !page->clipped) {
         struct foil_tty_cell cell;
         cell.uc = uc;
         cell.attrs = page->attrs;
@@ -384,9 +430,10 @@ bool foil_page_fill_rect(pcmcth_page *page, const foil_rect *rc, uint32_t uc)
         foil_rect_set(&page->dirty_rect, 0, 0, page->cols, page->rows);
     }
     else {
+        /* foil_page_draw_uchar() clips the cells further */
         foil_rect my_rc;
         foil_rect_set(&my_rc, 0, 0, page->cols, page->rows);
-        if (!foil_rect_intersect(&my_rc, &my_rc, rc))
+        if (rc && !foil_rect_intersect(&my_rc, &my_rc, rc))
             goto done;
 
         size_t count = my_rc.right - my_rc.left;
@@ -420,6 +467,10 @@ bool foil_page_erase_rect(pcmcth_page *page, const foil_rect *rc)
             goto done;
     }
 
+    if (page->clipped &&
+            !foil_rect_intersect(&my_rc, &my_rc, &page->clip_rect))
+        goto done;
+
     foil_rect dirty = my_rc;
     for (int y = my_rc.top; y < my_rc.bottom; y++) {
         struct foil_tty_cell *line = page->cells[y];
@@ -78,6 +78,11 @@ struct pcmcth_page {
        TODO: use region in the future. */
     foil_rect dirty_rect;
 
+    /* the clipping rectangle used when repainting a part of the page;
+       only valid if `clipped` is true. */
+    foil_rect clip_rect;
+    bool clipped;
+
     /* Since PURCMC-120 */
     purc_page_ostack_t ostack;
 
@@ -121,6 +126,9 @@ bool foil_page_fill_rect(pcmcth_page *page, const foil_rect *rc, uint32_t uc);
 bool foil_page_erase_rect(pcmcth_page *page, const foil_rect *rc);
 bool foil_page_expose(pcmcth_page *page);
 
+/* Sets the clipping rectangle for the drawing functions; NULL to reset. */
+void foil_page_set_clip_rect(pcmcth_page *page, const foil_rect *rc);
+
 #ifdef __cplusplus
 }
 #endif
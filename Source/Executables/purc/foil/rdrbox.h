@@ -405,6 +405,10 @@ struct foil_rdrbox {
     uint32_t is_height_resolved:1;
     // Indicates that the computed z-index value is `auto`.
     uint32_t is_zidx_auto:1;
+    // Indicates that the box needs to be laid out again in the next frame.
+    uint32_t needs_relayout:1;
+    // Indicates that a descendant of the box needs to be laid out again.
+    uint32_t has_dirty_descendant:1;
 
     /* Used values of non-inherited properties */
     uint32_t type:4;
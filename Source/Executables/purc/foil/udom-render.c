@@ -461,10 +461,26 @@ render_box_border(struct foil_render_ctxt *ctxt, struct foil_rdrbox *box,
     }
 }
 
+/* Returns false if the block-level box is out of the rectangle to repaint */
+static bool
+is_rdrbox_invalid(struct foil_render_ctxt *ctxt, struct foil_rdrbox *box)
+{
+    if (ctxt->invrc == NULL || box->is_root || !box->is_block_level)
+        return true;
+
+    foil_rect border_rc, page_rc;
+    foil_rdrbox_border_box(box, &border_rc);
+    foil_rdrbox_map_rect_to_page(&border_rc, &page_rc);
+    return foil_rect_intersect(&page_rc, &page_rc, ctxt->invrc);
+}
+
 static void
 render_rdrbox_part(struct foil_render_ctxt *ctxt,
         struct foil_rdrbox *box, foil_box_part_k part)
 {
+    if (!is_rdrbox_invalid(ctxt, box))
+        return;
+
     switch (part) {
     case FOIL_BOX_PART_BACKGROUND:
         if (box->tailor_ops && box->tailor_ops->bgnd_painter) {
@@ -814,26 +830,37 @@ void foil_udom_render_to_page(pcmcth_udom *udom)
     render_rdrbox_with_stacking_ctxt(&rdr_ctxt, root->stacking_ctxt, root);
 }
 
+/* The box will be repainted in the next frame, along with other boxes
+   invalidated in the same frame. */
 void foil_udom_invalidate_rdrbox(pcmcth_udom *udom, foil_rdrbox *box)
 {
-    struct foil_stacking_context *stacking_ctxt = NULL;
-    foil_rdrbox *parent = box;
+    foil_rect border_rc, page_rc;
+    foil_rdrbox_border_box(box, &border_rc);
+    foil_rdrbox_map_rect_to_page(&border_rc, &page_rc);
+
+    if (!foil_rect_is_empty(&page_rc)) {
+        foil_rect_get_bound(&udom->invalid_rc, &udom->invalid_rc, &page_rc);
+        foil_udom_schedule_update(udom);
+    }
+}
 
-    do {
-        if (parent->stacking_ctxt)
-            stacking_ctxt = parent->stacking_ctxt;
+void foil_udom_repaint(pcmcth_udom *udom)
+{
+    foil_rect invrc = udom->invalid_rc;
+    foil_rect_empty(&udom->invalid_rc);
 
-        parent = parent->parent;
-    } while (parent);
+    if (foil_rect_is_empty(&invrc) || udom->initial_cblock->first == NULL)
+        return;
 
-    foil_rect invrc;
-    foil_rdrbox_border_box(box, &invrc);
+    foil_rdrbox *root = udom->initial_cblock->first;
+    assert(root->is_root && root->stacking_ctxt);
 
-    if (!foil_rect_is_empty(&invrc)) {
-        foil_render_ctxt rdr_ctxt = { .udom = udom, .invrc = &invrc };
+    /* repaint all boxes overlapping the rectangle, but only the cells
+       in the rectangle are changed. */
+    foil_render_ctxt rdr_ctxt = { .udom = udom, .invrc = &invrc };
+    foil_page_set_clip_rect(udom->page, &invrc);
+    render_rdrbox_with_stacking_ctxt(&rdr_ctxt, root->stacking_ctxt, root);
+    foil_page_set_clip_rect(udom->page, NULL);
 
-        render_rdrbox_with_stacking_ctxt(&rdr_ctxt, stacking_ctxt, box);
-        foil_page_expose(udom->page);
-    }
+    foil_page_expose(udom->page);
 }
-
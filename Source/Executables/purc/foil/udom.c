@@ -30,6 +30,8 @@
 #include "widget.h"
 #include "rdrbox.h"
 #include "rdrbox-internal.h"
+#include "timer.h"
+#include "foil.h"
 #include "util/sorted-array.h"
 #include "util/list.h"
 #include "unicode/unicode.h"
@@ -345,8 +347,11 @@ failed:
     return NULL;
 }
 
+static void cancel_frame_timer(pcmcth_udom *udom);
+
 void foil_udom_delete(pcmcth_udom *udom)
 {
+    cancel_frame_timer(udom);
     udom_cleanup(udom);
     free(udom);
 }
@@ -1415,6 +1420,8 @@ static void reset_rdrbox_layout_info(pcmcth_udom *udom, foil_rdrbox *box)
     box->nr_abspos_children = 0;
     box->ml = box->mt = box->mr = box->mb = 0;
     box->pl = box->pt = box->pr = box->pb = 0;
+    box->needs_relayout = 0;
+    box->has_dirty_descendant = 0;
     foil_rect_set(&box->ctnt_rect, 0, 0, 0, 0);
 }
 
@@ -1789,6 +1796,114 @@ again:
     return rdrbox;
 }
 
+/*
+ * The updates are not laid out and painted at once. A box whose size may
+ * change is marked to be laid out again, and its ancestors are marked to
+ * have a dirty descendant; the areas to repaint are accumulated in
+ * `udom->invalid_rc`. All updates received in a frame are then flushed
+ * together by the frame timer: only the dirty boxes are laid out again
+ * (relayout_rdrtree() goes up to the container if the size changed),
+ * and only the union of the affected rectangles is repainted.
+ */
+#define TIMER_FRAME_NAME            "frame"
+#define TIMER_FRAME_INTERVAL        20  // 50 fps
+
+static void mark_rdrbox_dirty(pcmcth_udom *udom, foil_rdrbox *box)
+{
+    /* the old area of the box must be repainted as well */
+    foil_udom_invalidate_rdrbox(udom, box);
+
+    box->needs_relayout = 1;
+
+    foil_rdrbox *parent = box->parent;
+    while (parent && !parent->has_dirty_descendant) {
+        parent->has_dirty_descendant = 1;
+        parent = parent->parent;
+    }
+}
+
+static void relayout_dirty_boxes(struct foil_layout_ctxt *ctxt,
+        struct foil_rdrbox *box)
+{
+    if (box->needs_relayout) {
+        /* the dirty bits of the subtree are cleared by the relayout */
+        box = relayout_rdrtree(ctxt, box, box->ctnt_rect);
+        if (box->is_root) {
+            /* the page may be enlarged; repaint the whole page */
+            pcmcth_page *page = ctxt->udom->page;
+            foil_rect_set(&ctxt->udom->invalid_rc, 0, 0,
+                    page->cols, page->rows);
+        }
+        else {
+            foil_udom_invalidate_rdrbox(ctxt->udom, box);
+        }
+        return;
+    }
+
+    if (!box->has_dirty_descendant)
+        return;
+
+    box->has_dirty_descendant = 0;
+    foil_rdrbox *child = box->first;
+    while (child) {
+        relayout_dirty_boxes(ctxt, child);
+        child = child->next;
+    }
+}
+
+static int on_frame_expired(const char *name, void *ctxt)
+{
+    (void)name;
+    pcmcth_udom *udom = ctxt;
+
+    udom->update_pending = false;
+    foil_udom_flush_updates(udom);
+    return -1;
+}
+
+void foil_udom_schedule_update(pcmcth_udom *udom)
+{
+    if (udom->update_pending)
+        return;
+
+    pcmcth_renderer *rdr = foil_get_renderer();
+    if (pcmcth_timer_new(rdr, TIMER_FRAME_NAME, on_frame_expired,
+                TIMER_FRAME_INTERVAL, udom)) {
+        udom->update_pending = true;
+    }
+    else {
+        /* fall back to update at once */
+        foil_udom_flush_updates(udom);
+    }
+}
+
+static void cancel_frame_timer(pcmcth_udom *udom)
+{
+    if (udom->update_pending) {
+        pcmcth_renderer *rdr = foil_get_renderer();
+        pcmcth_timer_t timer = pcmcth_timer_find(rdr,
+                TIMER_FRAME_NAME, on_frame_expired, udom);
+        if (timer)
+            pcmcth_timer_delete(rdr, timer);
+        udom->update_pending = false;
+    }
+}
+
+void foil_udom_flush_updates(pcmcth_udom *udom)
+{
+    cancel_frame_timer(udom);
+
+    /* the boxes invalidated during the relayout are repainted below,
+       so do not arm the timer again */
+    udom->update_pending = true;
+
+    foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
+    relayout_dirty_boxes(&layout_ctxt, udom->initial_cblock);
+    foil_udom_repaint(udom);
+
+    udom->update_pending = false;
+}
+
 
 static int on_update_style(pcmcth_udom *udom, foil_rdrbox *rdrbox,
     pcdoc_element_t ref_elem, int op)
@@ -1796,7 +1911,6 @@ static int on_update_style(pcmcth_udom *udom, foil_rdrbox *rdrbox,
     (void)ref_elem;
     (void)op;
     int r = PCRDR_SC_NOT_IMPLEMENTED;
-    foil_rdrbox *render_box = rdrbox;
     pcdoc_element *ancestor = rdrbox->owner;
     css_select_results *result = NULL;
     foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
@@ -1839,15 +1953,12 @@ static int on_update_style(pcmcth_udom *udom, foil_rdrbox *rdrbox,
     if (!crux_changed) {
         /* sizing, border property */
         pre_layout_rdrtree(&layout_ctxt, rdrbox);
-        goto render;
+        foil_udom_invalidate_rdrbox(udom, rdrbox);
+    }
+    else {
+        mark_rdrbox_dirty(udom, get_rdrbox_container(udom, rdrbox));
     }
 
-    render_box = get_rdrbox_container(udom, rdrbox);
-
-    render_box = relayout_rdrtree(&layout_ctxt, render_box, render_box->ctnt_rect);
-
-render:
-    foil_udom_invalidate_rdrbox(udom, render_box);
     r = PCRDR_SC_OK;
 
 done:
@@ -1866,14 +1977,8 @@ failed:
 
 static int on_rebuild_subtree(pcmcth_udom *udom, foil_rdrbox *rdrbox)
 {
-    foil_rect orc = rdrbox->ctnt_rect;
-
     rebuild_subtree(udom, rdrbox);
-
-    foil_layout_ctxt layout_ctxt = { udom, udom->initial_cblock };
-    rdrbox = relayout_rdrtree(&layout_ctxt, rdrbox, orc);
-
-    foil_udom_invalidate_rdrbox(udom, rdrbox);
+    mark_rdrbox_dirty(udom, rdrbox);
     return PCRDR_SC_OK;
 }
 
@@ -83,6 +83,12 @@ struct pcmcth_udom {
 
     /* the pointer to the stacking context created by the root element */
     struct foil_stacking_context *root_stk_ctxt;
+
+    /* the rectangle (in page cells) to repaint in the next frame */
+    foil_rect invalid_rc;
+
+    /* whether the updates are pending to be flushed */
+    bool update_pending;
 };
 
 typedef struct foil_stacking_context {
@@ -146,6 +152,14 @@ void foil_udom_render_to_file(pcmcth_udom *udom, FILE *fp);
 void foil_udom_render_to_page(pcmcth_udom *udom);
 
 void foil_udom_invalidate_rdrbox(pcmcth_udom *udom, foil_rdrbox *box);
+void foil_udom_repaint(pcmcth_udom *udom);
+
+/* Arms the timer to relayout the dirty boxes and repaint the invalid
+   rectangle in the next frame. */
+void foil_udom_schedule_update(pcmcth_udom *udom);
+
+/* Relayouts the dirty boxes and repaints the invalid rectangle at once. */
+void foil_udom_flush_updates(pcmcth_udom *udom);
 
 #ifdef __cplusplus
 }
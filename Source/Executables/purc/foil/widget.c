@@ -27,6 +27,7 @@
 
 #include "widget.h"
 #include "page.h"
+#include "udom.h"
 #include "workspace.h"
 #include "timer.h"
 
@@ -265,6 +266,10 @@ purc_variant_t foil_widget_call_method(foil_widget *widget,
     if (strcmp(method, "dumpContents") == 0) {
         const char *fname = purc_variant_get_string_const(arg);
 
+        /* make the contents up to date */
+        if (widget->page.udom)
+            foil_udom_flush_updates(widget->page.udom);
+
         int retv = -1;
         if (fname && widget->ops->dump) {
             retv = widget->ops->dump(widget, fname);
@@ -720,6 +720,8 @@ stream_open_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
+    // Do not map the file here: a stream may live long and the file may
+    // grow (e.g. a log) or be truncated (SIGBUS) while it is mapped.
     rwstream = purc_rwstream_new_from_file (filename,
             purc_variant_get_string_const (argv[1]));
 
@@ -3308,6 +3308,26 @@ file_contents_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
+    if (!opt_binary) {
+        // make the string from the mapped file directly to avoid a copy
+        purc_rwstream_t rws = purc_rwstream_new_from_mmap(filename);
+        if (rws) {
+            size_t sz_mapped = 0;
+            const char *mapped = purc_rwstream_get_mem_buffer(rws, &sz_mapped);
+            if (mapped && (size_t)offset + sz_contents <= sz_mapped) {
+                ret_var = purc_variant_make_string_ex(mapped + offset,
+                        sz_contents, opt_check_encoding);
+                purc_rwstream_destroy(rws);
+                return ret_var;
+            }
+            purc_rwstream_destroy(rws);
+        }
+        else {
+            // not mappable; read the file with stdio below
+            purc_clr_error();
+        }
+    }
+
     if (opt_binary) {
         contents = malloc(sz_contents);
     }
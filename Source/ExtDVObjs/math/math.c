@@ -26,8 +26,10 @@
 #include "purc-variant.h"
 #include "purc-version.h"
 #include "purc-dvobjs.h"
+#include "purc-ports.h"
 
 #include "private/map.h"
+#include "private/list.h"
 #include "mathlib.h"
 
 #include <strings.h>
@@ -40,6 +42,7 @@
 #endif
 #include <math.h>
 #include <fenv.h>
+#include <pthread.h>
 
 #define UNUSED_PARAM (void)
 #define MATH_DVOBJ_VERSION  0
@@ -67,6 +70,38 @@ struct const_struct {
     struct const_value value;
 };
 
+/* the maximal number of compiled expressions kept by eval and eval_array */
+#define EVAL_CACHE_SIZE     64
+
+struct eval_cache_entry {
+    struct list_head    ln;
+    char               *expr;
+    void               *prog;
+    unsigned int        refc;
+    bool                is_long_double;
+    /* evicted while in use; freed by the last release */
+    bool                detached;
+};
+
+// the compiled expressions in LRU order, shared by all instances
+static struct {
+    purc_mutex          lock;
+    struct list_head    lru;
+    size_t              nr_entries;
+    bool                inited;
+} eval_cache;
+
+static pthread_once_t eval_cache_once = PTHREAD_ONCE_INIT;
+
+// called once for all runners, which may create $MATH concurrently
+static void eval_cache_init_once(void)
+{
+    purc_mutex_init(&eval_cache.lock);
+    list_head_init(&eval_cache.lru);
+    eval_cache.nr_entries = 0;
+    eval_cache.inited = true;
+}
+
 #define GET_EXCEPTION_OR_CREATE_VARIANT(x, y) \
     if (isnan (x)) { \
         purc_set_error (PURC_ERROR_INVALID_FLOAT); \
@@ -1458,6 +1493,111 @@ ceil_l_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     return ret_var;
 }
 
+static void
+eval_cache_delete_entry(struct eval_cache_entry *entry)
+{
+    if (entry->is_long_double)
+        math_program_delete_l((struct math_program_l *)entry->prog);
+    else
+        math_program_delete((struct math_program *)entry->prog);
+    free(entry->expr);
+    free(entry);
+}
+
+static struct eval_cache_entry *
+eval_cache_acquire(bool is_long_double, const char *expr)
+{
+    struct eval_cache_entry *entry, *tmp, *n;
+
+    purc_mutex_lock(&eval_cache.lock);
+    list_for_each_entry(entry, &eval_cache.lru, ln) {
+        if (entry->is_long_double == is_long_double &&
+                strcmp(entry->expr, expr) == 0) {
+            list_move(&entry->ln, &eval_cache.lru);
+            entry->refc++;
+            purc_mutex_unlock(&eval_cache.lock);
+            return entry;
+        }
+    }
+    purc_mutex_unlock(&eval_cache.lock);
+
+    // compile the expression out of the lock
+    entry = (struct eval_cache_entry *)calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    entry->expr = strdup(expr);
+    if (entry->expr == NULL) {
+        free(entry);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    int r;
+    entry->is_long_double = is_long_double;
+    if (is_long_double)
+        r = math_compile_l(expr, (struct math_program_l **)&entry->prog);
+    else
+        r = math_compile(expr, (struct math_program **)&entry->prog);
+    if (r) {
+        free(entry->expr);
+        free(entry);
+        return NULL;
+    }
+
+    entry->refc = 1;
+
+    purc_mutex_lock(&eval_cache.lock);
+    list_add(&entry->ln, &eval_cache.lru);
+    eval_cache.nr_entries++;
+
+    list_for_each_entry_reverse_safe(tmp, n, &eval_cache.lru, ln) {
+        if (eval_cache.nr_entries <= EVAL_CACHE_SIZE)
+            break;
+
+        list_del(&tmp->ln);
+        eval_cache.nr_entries--;
+        if (tmp->refc == 0)
+            eval_cache_delete_entry(tmp);
+        else
+            tmp->detached = true;
+    }
+    purc_mutex_unlock(&eval_cache.lock);
+
+    return entry;
+}
+
+static void
+eval_cache_release(struct eval_cache_entry *entry)
+{
+    bool to_delete;
+
+    purc_mutex_lock(&eval_cache.lock);
+    entry->refc--;
+    to_delete = entry->detached && entry->refc == 0;
+    purc_mutex_unlock(&eval_cache.lock);
+
+    if (to_delete)
+        eval_cache_delete_entry(entry);
+}
+
+static void
+eval_cache_clear(void)
+{
+    struct eval_cache_entry *entry, *tmp;
+
+    list_for_each_entry_safe(entry, tmp, &eval_cache.lru, ln) {
+        list_del(&entry->ln);
+        if (entry->refc == 0)
+            eval_cache_delete_entry(entry);
+        else
+            entry->detached = true;
+    }
+    eval_cache.nr_entries = 0;
+}
+
 static purc_variant_t
 internal_eval_getter (int is_long_double, purc_variant_t root,
     size_t nr_args, purc_variant_t *argv, bool silently)
@@ -1483,21 +1623,29 @@ internal_eval_getter (int is_long_double, purc_variant_t root,
     }
 
     purc_variant_t param = nr_args >=2 ? argv[1] : PURC_VARIANT_INVALID;
+    purc_variant_t ret_var = PURC_VARIANT_INVALID;
+
+    struct eval_cache_entry *entry = eval_cache_acquire(is_long_double, input);
+    if (entry == NULL)
+        return PURC_VARIANT_INVALID;
 
     if (!is_long_double) {
         double v = 0;
-        int r = math_eval(input, &v, param);
-        if (r)
-            return PURC_VARIANT_INVALID;
-        return purc_variant_make_number(v);
+        int r = math_program_eval((struct math_program *)entry->prog,
+                &v, param);
+        if (r == 0)
+            ret_var = purc_variant_make_number(v);
     }
     else {
         long double v = 0;
-        int r = math_eval_l(input, &v, param);
-        if (r)
-            return PURC_VARIANT_INVALID;
-        return purc_variant_make_longdouble(v);
+        int r = math_program_eval_l((struct math_program_l *)entry->prog,
+                &v, param);
+        if (r == 0)
+            ret_var = purc_variant_make_longdouble(v);
     }
+
+    eval_cache_release(entry);
+    return ret_var;
 }
 
 static purc_variant_t
@@ -1517,6 +1665,73 @@ eval_l_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
             (call_flags & PCVRT_CALL_FLAG_SILENTLY));
 }
 
+/*
+ * $MATH.eval_array(<string $expression>, <array | object $data>)
+ *
+ * Evaluates the expression once for every row of the data:
+ *  - an array of objects, each of which gives the variables of a row;
+ *  - an object of columns, each of which is an array giving the values
+ *    of a variable for all rows; a number applies to all rows.
+ *
+ * Returns an array of the results.
+ */
+static purc_variant_t
+internal_eval_array_getter (int is_long_double, purc_variant_t root,
+    size_t nr_args, purc_variant_t *argv, bool silently)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(silently);
+
+    if (nr_args < 2) {
+        purc_set_error (PURC_ERROR_ARGUMENT_MISSED);
+        return PURC_VARIANT_INVALID;
+    }
+
+    const char *input = purc_variant_get_string_const(argv[0]);
+    if (!input) {
+        purc_set_error (PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (argv[1] == PURC_VARIANT_INVALID ||
+            !(purc_variant_is_array(argv[1]) ||
+                purc_variant_is_object(argv[1]))) {
+        purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t ret_var;
+    struct eval_cache_entry *entry = eval_cache_acquire(is_long_double, input);
+    if (entry == NULL)
+        return PURC_VARIANT_INVALID;
+
+    if (!is_long_double)
+        ret_var = math_program_eval_array(
+                (struct math_program *)entry->prog, argv[1]);
+    else
+        ret_var = math_program_eval_array_l(
+                (struct math_program_l *)entry->prog, argv[1]);
+
+    eval_cache_release(entry);
+    return ret_var;
+}
+
+static purc_variant_t
+eval_array_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
+        unsigned call_flags)
+{
+    return internal_eval_array_getter(0, root, nr_args, argv,
+            (call_flags & PCVRT_CALL_FLAG_SILENTLY));
+}
+
+static purc_variant_t
+eval_array_l_getter (purc_variant_t root, size_t nr_args,
+        purc_variant_t *argv, unsigned call_flags)
+{
+    return internal_eval_array_getter(1, root, nr_args, argv,
+            (call_flags & PCVRT_CALL_FLAG_SILENTLY));
+}
+
 static void * map_copy_key(const void *key)
 {
     return (void*)key;
@@ -1549,6 +1764,12 @@ void __attribute__ ((destructor)) math_fini(void)
         pcutils_map_destroy (const_map);
         const_map = NULL;
     }
+
+    if (eval_cache.inited) {
+        eval_cache_clear();
+        purc_mutex_clear(&eval_cache.lock);
+        eval_cache.inited = false;
+    }
 }
 
 // todo: release const_map
@@ -1611,6 +1832,8 @@ static purc_variant_t pcdvobjs_create_math (void)
         }
     }
 
+    pthread_once(&eval_cache_once, eval_cache_init_once);
+
     // set dynamic
     static struct purc_dvobj_method method [] = {
         {"pi",      pi_getter, NULL},
@@ -1621,6 +1844,8 @@ static purc_variant_t pcdvobjs_create_math (void)
         {"const_l", const_l_getter, NULL},
         {"eval",    eval_getter, NULL},
         {"eval_l",  eval_l_getter, NULL},
+        {"eval_array",   eval_array_getter, NULL},
+        {"eval_array_l", eval_array_l_getter, NULL},
         {"sin",     sin_getter, NULL},
         {"sin_l",   sin_l_getter, NULL},
         {"cos",     cos_getter, NULL},
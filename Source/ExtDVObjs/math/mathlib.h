@@ -54,6 +54,63 @@ int
 math_eval_l(const char *input, long double *d, purc_variant_t param)
 __attribute__((visibility("hidden")));
 
+/* compiled expressions; see parsers/math.y */
+struct math_program;
+struct math_program_l;
+
+int
+math_compile(const char *input, struct math_program **prog)
+__attribute__((visibility("hidden")));
+
+int
+math_compile_l(const char *input, struct math_program_l **prog)
+__attribute__((visibility("hidden")));
+
+void
+math_program_delete(struct math_program *prog)
+__attribute__((visibility("hidden")));
+
+void
+math_program_delete_l(struct math_program_l *prog)
+__attribute__((visibility("hidden")));
+
+size_t
+math_program_nr_vars(const struct math_program *prog)
+__attribute__((visibility("hidden")));
+
+size_t
+math_program_nr_vars_l(const struct math_program_l *prog)
+__attribute__((visibility("hidden")));
+
+int
+math_program_exec(const struct math_program *prog,
+        const double * const *vars, size_t nr_rows, double *results)
+__attribute__((visibility("hidden")));
+
+int
+math_program_exec_l(const struct math_program_l *prog,
+        const long double * const *vars, size_t nr_rows, long double *results)
+__attribute__((visibility("hidden")));
+
+int
+math_program_eval(const struct math_program *prog, double *d,
+        purc_variant_t param)
+__attribute__((visibility("hidden")));
+
+int
+math_program_eval_l(const struct math_program_l *prog, long double *d,
+        purc_variant_t param)
+__attribute__((visibility("hidden")));
+
+purc_variant_t
+math_program_eval_array(const struct math_program *prog, purc_variant_t data)
+__attribute__((visibility("hidden")));
+
+purc_variant_t
+math_program_eval_array_l(const struct math_program_l *prog,
+        purc_variant_t data)
+__attribute__((visibility("hidden")));
+
 int
 math_voi(double *r, double (*f)(void))
 __attribute__((visibility("hidden")));
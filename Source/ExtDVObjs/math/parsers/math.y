@@ -38,6 +38,13 @@
 
         #define VALUE_TYPE     double
         #define FUNC_NAME      math_eval
+        #define PROGRAM        math_program
+        #define COMPILE_FUNC   math_compile
+        #define DELETE_FUNC    math_program_delete
+        #define NR_VARS_FUNC   math_program_nr_vars
+        #define EXEC_FUNC      math_program_exec
+        #define EVAL_FUNC      math_program_eval
+        #define ARRAY_FUNC     math_program_eval_array
 
         #define STRTOD         strtod
         #define CAST_TO_NUMBER purc_variant_cast_to_number
@@ -89,6 +96,13 @@
 
         #define VALUE_TYPE     long double
         #define FUNC_NAME      math_eval_l
+        #define PROGRAM        math_program_l
+        #define COMPILE_FUNC   math_compile_l
+        #define DELETE_FUNC    math_program_delete_l
+        #define NR_VARS_FUNC   math_program_nr_vars_l
+        #define EXEC_FUNC      math_program_exec_l
+        #define EVAL_FUNC      math_program_eval_l
+        #define ARRAY_FUNC     math_program_eval_array_l
 
         #define STRTOD         strtold
         #define CAST_TO_NUMBER purc_variant_cast_to_longdouble
@@ -136,15 +150,55 @@
 
     #endif
 
-    struct internal_value {
-        VALUE_TYPE      d;
+    /* the opcodes of a compiled expression, in postfix (RPN) order */
+    enum math_opcode {
+        MATH_OP_NUM,
+        MATH_OP_VAR,
+        MATH_OP_NEG,
+        MATH_OP_ADD,
+        MATH_OP_SUB,
+        MATH_OP_MUL,
+        MATH_OP_DIV,
+        MATH_OP_VOI,
+        MATH_OP_UNI,
+        MATH_OP_BIN,
+    };
+
+    struct math_insn {
+        enum math_opcode    op;
+        union {
+            VALUE_TYPE      d;
+            size_t          var;
+            VALUE_TYPE    (*voi_func)(void);
+            VALUE_TYPE    (*uni_func)(VALUE_TYPE a);
+            VALUE_TYPE    (*bin_func)(VALUE_TYPE a, VALUE_TYPE b);
+        };
+    };
+
+    struct math_var {
+        char           *name;
+        /* the value used when the variable is not given by the caller */
+        VALUE_TYPE      def;
+        unsigned int    has_def:1;
+    };
+
+    struct PROGRAM {
+        struct math_insn   *insns;
+        size_t              nr_insns;
+        size_t              sz_insns;
+
+        struct math_var    *vars;
+        size_t              nr_vars;
+        size_t              sz_vars;
+
+        /* the depth of the evaluation stack */
+        size_t              depth;
+        size_t              max_depth;
     };
 
     struct internal_param {
-        purc_variant_t param;
-        purc_variant_t variables;
-        VALUE_TYPE     d;
-        unsigned int   divide_by_zero:1;
+        struct PROGRAM *prog;
+        unsigned int   oom:1;
     };
 
     struct math_token {
@@ -166,117 +220,134 @@
     // introduce yylex decl for later use
     #include <math.h>
 
-    #define SET(_r, _a) do {                           \
-            _r->d = _a.d;                              \
-    } while (0)
+    #include <stdlib.h>
+
+    static struct math_insn *
+    emit_insn(struct internal_param *param, enum math_opcode op, int delta)
+    {
+        struct PROGRAM *prog = param->prog;
+
+        if (prog->nr_insns == prog->sz_insns) {
+            size_t sz = prog->sz_insns ? prog->sz_insns * 2 : 16;
+            struct math_insn *insns;
+            insns = realloc(prog->insns, sizeof(*insns) * sz);
+            if (!insns) {
+                param->oom = 1;
+                return NULL;
+            }
+            prog->insns = insns;
+            prog->sz_insns = sz;
+        }
 
-    #define NEG(_r, _a) do {                           \
-            _r.d = -_a.d;                              \
-    } while (0)
+        prog->depth += delta;
+        if (prog->depth > prog->max_depth)
+            prog->max_depth = prog->depth;
 
-    #define ADD(_r, _a, _b) do {                       \
-            _r.d = _a.d + _b.d;                        \
-    } while (0)
+        struct math_insn *insn = prog->insns + prog->nr_insns++;
+        insn->op = op;
+        return insn;
+    }
 
-    #define SUB(_r, _a, _b) do {                       \
-            _r.d = _a.d - _b.d;                        \
-    } while (0)
+    /* returns the slot of the variable, registering it if it is new */
+    static ssize_t
+    find_or_add_var(struct internal_param *param,
+            const char *name, size_t len)
+    {
+        struct PROGRAM *prog = param->prog;
+
+        for (size_t i = 0; i < prog->nr_vars; i++) {
+            if (strncmp(prog->vars[i].name, name, len) == 0 &&
+                    prog->vars[i].name[len] == '\0')
+                return i;
+        }
 
-    #define MUL(_r, _a, _b) do {                       \
-            _r.d = _a.d * _b.d;                        \
-    } while (0)
+        if (prog->nr_vars == prog->sz_vars) {
+            size_t sz = prog->sz_vars ? prog->sz_vars * 2 : 4;
+            struct math_var *vars;
+            vars = realloc(prog->vars, sizeof(*vars) * sz);
+            if (!vars)
+                goto oom;
+            prog->vars = vars;
+            prog->sz_vars = sz;
+        }
 
-    #define DIV(_r, _a, _b, _loc) do {                        \
-            int f = fpclassify(_b.d);                         \
-            if (f & FP_ZERO) {                                \
-                param->divide_by_zero = 1;                    \
-                yyerror(_loc,arg,param,"Divide by zero");     \
-                YYERROR;                                      \
-            }                                                 \
-            _r.d = _a.d / _b.d;                               \
-    } while (0)
+        struct math_var *var = prog->vars + prog->nr_vars;
+        var->name = strndup(name, len);
+        if (!var->name)
+            goto oom;
+        var->def = 0;
+        var->has_def = 0;
+        return prog->nr_vars++;
+
+    oom:
+        param->oom = 1;
+        return -1;
+    }
 
-    #define SET_BY_NUM(_r, _a) do {                                 \
-            /* TODO: strtod sort of func */                         \
-            char *_s = (char*)_a.text;                              \
-            const char _c = _s[_a.leng];                            \
-            char *endptr = NULL;                                    \
-            _s[_a.leng] = '\0';                                     \
-            _r.d = STRTOD(_s, &endptr);                             \
-            _s[_a.leng] = _c;                                       \
-            if (endptr && *endptr)                                  \
-                YYABORT;                                            \
+    #define EMIT(_op, _delta) do {                                       \
+        if (!emit_insn(param, _op, _delta))                              \
+            YYABORT;                                                     \
     } while (0)
 
-    #define SET_BY_VAR(_r, _a) do {                                      \
-        purc_variant_t _v;                                               \
+    #define EMIT_NUM(_a) do {                                            \
+        /* TODO: strtod sort of func */                                  \
         char *_s = (char*)_a.text;                                       \
         const char _c = _s[_a.leng];                                     \
-        if (param->variables) {                                          \
-            _s[_a.leng] = '\0';                                          \
-            _v = purc_variant_object_get_by_ckey_ex(param->variables,       \
-                    _s, false);                                          \
-            _s[_a.leng] = _c;                                            \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        if (param->param && purc_variant_is_object(param->param)) {      \
-            _s[_a.leng] = '\0';                                          \
-            _v = purc_variant_object_get_by_ckey_ex(param->param,           \
-                    _s, false);                                          \
-            _s[_a.leng] = _c;                                            \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        YYABORT;                                                         \
+        char *endptr = NULL;                                             \
+        VALUE_TYPE _d;                                                   \
+        _s[_a.leng] = '\0';                                              \
+        _d = STRTOD(_s, &endptr);                                        \
+        _s[_a.leng] = _c;                                                \
+        if (endptr && *endptr)                                           \
+            YYABORT;                                                     \
+        struct math_insn *_insn = emit_insn(param, MATH_OP_NUM, 1);      \
+        if (!_insn)                                                      \
+            YYABORT;                                                     \
+        _insn->d = _d;                                                   \
     } while (0)
 
-    #define SET_BY_PRE_DEFINED(_r, _a, _s) do {                          \
-        purc_variant_t _v;                                               \
-        if (param->variables) {                                          \
-            _v = purc_variant_object_get_by_ckey_ex(param->variables,       \
-                    _s, false);                                          \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        if (param->param && purc_variant_is_object(param->param)) {      \
-            _v = purc_variant_object_get_by_ckey_ex(param->param, _s, false);  \
-            if (_v) {                                                    \
-                bool ok = CAST_TO_NUMBER(_v, &_r.d, false);              \
-                fprintf(stderr, "_s: %s; ok: %d\n", _s, ok); \
-                if (ok)                                                  \
-                    break;                                               \
-            }                                                            \
-        }                                                                \
-        _r.d = PRE_DEFINED(_a);                                          \
-        purc_clr_error();                                                \
+    #define EMIT_VAR(_a) do {                                            \
+        ssize_t _var = find_or_add_var(param, _a.text, _a.leng);         \
+        if (_var < 0)                                                    \
+            YYABORT;                                                     \
+        struct math_insn *_insn = emit_insn(param, MATH_OP_VAR, 1);      \
+        if (!_insn)                                                      \
+            YYABORT;                                                     \
+        _insn->var = _var;                                               \
     } while (0)
 
-    #define EVAL_BY_VOI_FUNC(_r, _f) do {                                \
-        int r = VOI_FUNC(&_r.d, _f);                                     \
-        if (r)                                                           \
+    /* a pre-defined constant is a variable which the caller can override */
+    #define EMIT_PRE_DEFINED(_a, _s) do {                                \
+        ssize_t _var = find_or_add_var(param, _s, sizeof(_s) - 1);       \
+        if (_var < 0)                                                    \
+            YYABORT;                                                     \
+        param->prog->vars[_var].def = PRE_DEFINED(_a);                   \
+        param->prog->vars[_var].has_def = 1;                             \
+        struct math_insn *_insn = emit_insn(param, MATH_OP_VAR, 1);      \
+        if (!_insn)                                                      \
             YYABORT;                                                     \
+        _insn->var = _var;                                               \
     } while (0)
 
-    #define EVAL_BY_UNI_FUNC(_r, _f, _a) do {                            \
-        int r = UNI_FUNC(&_r.d, _f, _a.d);                               \
-        if (r)                                                           \
+    #define EMIT_VOI_FUNC(_f) do {                                       \
+        struct math_insn *_insn = emit_insn(param, MATH_OP_VOI, 1);      \
+        if (!_insn)                                                      \
             YYABORT;                                                     \
+        _insn->voi_func = _f;                                            \
     } while (0)
 
-    #define EVAL_BY_BIN_FUNC(_r, _f, _a, _b) do {                        \
-        int r = BIN_FUNC(&_r.d, _f, _a.d, _b.d);                         \
-        if (r)                                                           \
+    #define EMIT_UNI_FUNC(_f) do {                                       \
+        struct math_insn *_insn = emit_insn(param, MATH_OP_UNI, 0);      \
+        if (!_insn)                                                      \
             YYABORT;                                                     \
+        _insn->uni_func = _f;                                            \
+    } while (0)
+
+    #define EMIT_BIN_FUNC(_f) do {                                       \
+        struct math_insn *_insn = emit_insn(param, MATH_OP_BIN, -1);     \
+        if (!_insn)                                                      \
+            YYABORT;                                                     \
+        _insn->bin_func = _f;                                            \
     } while (0)
 
     static void yyerror(
@@ -302,7 +373,6 @@
 %parse-param { struct internal_param *param }
 
 %union { struct math_token token; }
-%union { struct internal_value v; }
 %union { VALUE_TYPE (*voi_func)(void); }
 %union { VALUE_TYPE (*uni_func)(VALUE_TYPE a); }
 %union { VALUE_TYPE (*bin_func)(VALUE_TYPE a, VALUE_TYPE b); }
@@ -323,7 +393,6 @@
 %token PI E LN2 LN10 LOG2E LOG10E SQRT1_2 SQRT2
 
 %token <token> NUMBER VAR
-%nterm <v> exp term pre_defined
 %nterm <voi_func> voi_func
 %nterm <uni_func> uni_func
 %nterm <bin_func> bin_func
@@ -337,38 +406,38 @@ input:
 ;
 
 statement:
-  exp         { SET(param, $1); }
+  exp
 ;
 
 exp:
   term
-| exp '+' exp   { ADD($$, $1, $3); }
-| exp '-' exp   { SUB($$, $1, $3); }
-| exp '*' exp   { MUL($$, $1, $3); }
-| exp '/' exp   { DIV($$, $1, $3, &(@3)); }
-| exp '^' exp   { EVAL_BY_BIN_FUNC($$, POW, $1, $3); }
-| '-' exp %prec NEG { NEG($$, $2); }
+| exp '+' exp   { EMIT(MATH_OP_ADD, -1); }
+| exp '-' exp   { EMIT(MATH_OP_SUB, -1); }
+| exp '*' exp   { EMIT(MATH_OP_MUL, -1); }
+| exp '/' exp   { EMIT(MATH_OP_DIV, -1); }
+| exp '^' exp   { EMIT_BIN_FUNC(POW); }
+| '-' exp %prec NEG { EMIT(MATH_OP_NEG, 0); }
 ;
 
 term:
-  NUMBER      { SET_BY_NUM($$, $1); }
-| VAR         { SET_BY_VAR($$, $1); }
-| pre_defined { $$ = $1; }
-| voi_func '(' ')' { EVAL_BY_VOI_FUNC($$, $1); }
-| uni_func '(' exp ')' { EVAL_BY_UNI_FUNC($$, $1, $3); }
-| bin_func '(' exp ',' exp ')' { EVAL_BY_BIN_FUNC($$, $1, $3, $5); }
-| '(' exp ')' { $$ = $2; }
+  NUMBER      { EMIT_NUM($1); }
+| VAR         { EMIT_VAR($1); }
+| pre_defined
+| voi_func '(' ')' { EMIT_VOI_FUNC($1); }
+| uni_func '(' exp ')' { EMIT_UNI_FUNC($1); }
+| bin_func '(' exp ',' exp ')' { EMIT_BIN_FUNC($1); }
+| '(' exp ')'
 ;
 
 pre_defined:
-  PI          { SET_BY_PRE_DEFINED($$, MATH_PI,      "PI"); }
-| E           { SET_BY_PRE_DEFINED($$, MATH_E,       "E"); }
-| LN2         { SET_BY_PRE_DEFINED($$, MATH_LN2,     "LN2"); }
-| LN10        { SET_BY_PRE_DEFINED($$, MATH_LN10,    "LN10"); }
-| LOG2E       { SET_BY_PRE_DEFINED($$, MATH_LOG2E,   "LOG2E"); }
-| LOG10E      { SET_BY_PRE_DEFINED($$, MATH_LOG10E,  "LOG10E"); }
-| SQRT1_2     { SET_BY_PRE_DEFINED($$, MATH_SQRT1_2, "SQRT1_2"); }
-| SQRT2       { SET_BY_PRE_DEFINED($$, MATH_SQRT2,   "SQRT2"); }
+  PI          { EMIT_PRE_DEFINED(MATH_PI,      "PI"); }
+| E           { EMIT_PRE_DEFINED(MATH_E,       "E"); }
+| LN2         { EMIT_PRE_DEFINED(MATH_LN2,     "LN2"); }
+| LN10        { EMIT_PRE_DEFINED(MATH_LN10,    "LN10"); }
+| LOG2E       { EMIT_PRE_DEFINED(MATH_LOG2E,   "LOG2E"); }
+| LOG10E      { EMIT_PRE_DEFINED(MATH_LOG10E,  "LOG10E"); }
+| SQRT1_2     { EMIT_PRE_DEFINED(MATH_SQRT1_2, "SQRT1_2"); }
+| SQRT2       { EMIT_PRE_DEFINED(MATH_SQRT2,   "SQRT2"); }
 
 
 voi_func:
@@ -431,35 +500,379 @@ yyerror(
         errsg);
 }
 
-int FUNC_NAME(const char *input, VALUE_TYPE *d, purc_variant_t param)
+void DELETE_FUNC(struct PROGRAM *prog)
+{
+    for (size_t i = 0; i < prog->nr_vars; i++)
+        free(prog->vars[i].name);
+    free(prog->vars);
+    free(prog->insns);
+    free(prog);
+}
+
+int COMPILE_FUNC(const char *input, struct PROGRAM **prog)
 {
     struct internal_param ud = {0};
-    ud.param = param;
-    ud.variables = PURC_VARIANT_INVALID;
+    ud.prog = (struct PROGRAM *)calloc(1, sizeof(*ud.prog));
+    if (ud.prog == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return 1;
+    }
 
     yyscan_t arg = {0};
     yylex_init(&arg);
     // yyset_in(in, arg);
     // yyset_debug(debug, arg);
-    yyset_extra(param, arg);
     yy_scan_string(input, arg);
-    int ret =yyparse(arg, &ud);
-    if (ud.variables) {
-        purc_variant_unref(ud.variables);
-        ud.variables = PURC_VARIANT_INVALID;
-    }
+    int ret = yyparse(arg, &ud);
     yylex_destroy(arg);
-    if (ret==0 && d) {
-        *d = ud.d;
+    if (ret) {
+        DELETE_FUNC(ud.prog);
+        if (ud.oom) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        }
+        else {
+            purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+        }
+        return 1;
+    }
+
+    *prog = ud.prog;
+    return 0;
+}
+
+size_t NR_VARS_FUNC(const struct PROGRAM *prog)
+{
+    return prog->nr_vars;
+}
+
+/* the number of rows evaluated in one pass of the program */
+#define EXEC_BLOCK_ROWS     64
+
+int EXEC_FUNC(const struct PROGRAM *prog, const VALUE_TYPE * const *vars,
+        size_t nr_rows, VALUE_TYPE *results)
+{
+    VALUE_TYPE local_stack[EXEC_BLOCK_ROWS * 8];
+    VALUE_TYPE *stack = local_stack;
+    int ret = 1;
+
+    if (prog->nr_insns == 0) {
+        for (size_t r = 0; r < nr_rows; r++)
+            results[r] = 0;
+        return 0;
+    }
+
+    if (prog->max_depth * EXEC_BLOCK_ROWS >
+            sizeof(local_stack) / sizeof(local_stack[0])) {
+        stack = (VALUE_TYPE *)malloc(sizeof(VALUE_TYPE) *
+                prog->max_depth * EXEC_BLOCK_ROWS);
+        if (stack == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return 1;
+        }
+    }
+
+    /* every slot of the stack holds the operands of a block of rows,
+       so that each instruction runs as a tight loop over the block */
+    for (size_t base = 0; base < nr_rows; base += EXEC_BLOCK_ROWS) {
+        size_t n = nr_rows - base;
+        if (n > EXEC_BLOCK_ROWS)
+            n = EXEC_BLOCK_ROWS;
+
+        VALUE_TYPE *sp = stack;
+        for (size_t k = 0; k < prog->nr_insns; k++) {
+            const struct math_insn *insn = prog->insns + k;
+            VALUE_TYPE *a, *b;
+
+            switch (insn->op) {
+            case MATH_OP_NUM:
+                for (size_t i = 0; i < n; i++)
+                    sp[i] = insn->d;
+                sp += EXEC_BLOCK_ROWS;
+                break;
+
+            case MATH_OP_VAR:
+                memcpy(sp, vars[insn->var] + base, sizeof(VALUE_TYPE) * n);
+                sp += EXEC_BLOCK_ROWS;
+                break;
+
+            case MATH_OP_NEG:
+                a = sp - EXEC_BLOCK_ROWS;
+                for (size_t i = 0; i < n; i++)
+                    a[i] = -a[i];
+                break;
+
+            case MATH_OP_ADD:
+                b = sp - EXEC_BLOCK_ROWS;
+                a = b - EXEC_BLOCK_ROWS;
+                for (size_t i = 0; i < n; i++)
+                    a[i] += b[i];
+                sp = b;
+                break;
+
+            case MATH_OP_SUB:
+                b = sp - EXEC_BLOCK_ROWS;
+                a = b - EXEC_BLOCK_ROWS;
+                for (size_t i = 0; i < n; i++)
+                    a[i] -= b[i];
+                sp = b;
+                break;
+
+            case MATH_OP_MUL:
+                b = sp - EXEC_BLOCK_ROWS;
+                a = b - EXEC_BLOCK_ROWS;
+                for (size_t i = 0; i < n; i++)
+                    a[i] *= b[i];
+                sp = b;
+                break;
+
+            case MATH_OP_DIV:
+                b = sp - EXEC_BLOCK_ROWS;
+                a = b - EXEC_BLOCK_ROWS;
+                for (size_t i = 0; i < n; i++) {
+                    if (fpclassify(b[i]) == FP_ZERO) {
+                        purc_set_error(PURC_ERROR_OVERFLOW);
+                        goto out;
+                    }
+                }
+                for (size_t i = 0; i < n; i++)
+                    a[i] /= b[i];
+                sp = b;
+                break;
+
+            case MATH_OP_VOI:
+                for (size_t i = 0; i < n; i++) {
+                    if (VOI_FUNC(sp + i, insn->voi_func))
+                        goto out;
+                }
+                sp += EXEC_BLOCK_ROWS;
+                break;
+
+            case MATH_OP_UNI:
+                a = sp - EXEC_BLOCK_ROWS;
+                for (size_t i = 0; i < n; i++) {
+                    if (UNI_FUNC(a + i, insn->uni_func, a[i]))
+                        goto out;
+                }
+                break;
+
+            case MATH_OP_BIN:
+                b = sp - EXEC_BLOCK_ROWS;
+                a = b - EXEC_BLOCK_ROWS;
+                for (size_t i = 0; i < n; i++) {
+                    if (BIN_FUNC(a + i, insn->bin_func, a[i], b[i]))
+                        goto out;
+                }
+                sp = b;
+                break;
+            }
+        }
+
+        memcpy(results + base, stack, sizeof(VALUE_TYPE) * n);
+    }
+
+    ret = 0;
+
+out:
+    if (stack != local_stack)
+        free(stack);
+    return ret;
+}
+
+/* resolves the value of the variable from the object given by the caller */
+static int
+resolve_var(const struct PROGRAM *prog, size_t idx, purc_variant_t obj,
+        VALUE_TYPE *d)
+{
+    const struct math_var *var = prog->vars + idx;
+
+    if (obj && purc_variant_is_object(obj)) {
+        purc_variant_t v;
+        v = purc_variant_object_get_by_ckey_ex(obj, var->name, true);
+        if (v && CAST_TO_NUMBER(v, d, false))
+            return 0;
+    }
+
+    if (var->has_def) {
+        *d = var->def;
+        return 0;
+    }
+
+    return -1;
+}
+
+#define NR_LOCAL_VARS   8
+
+int EVAL_FUNC(const struct PROGRAM *prog, VALUE_TYPE *d,
+        purc_variant_t param)
+{
+    VALUE_TYPE local_values[NR_LOCAL_VARS];
+    const VALUE_TYPE *local_vars[NR_LOCAL_VARS];
+    VALUE_TYPE *values = local_values;
+    const VALUE_TYPE **vars = local_vars;
+    int ret = 1;
+
+    if (prog->nr_vars > NR_LOCAL_VARS) {
+        values = (VALUE_TYPE *)malloc(sizeof(*values) * prog->nr_vars);
+        vars = (const VALUE_TYPE **)malloc(sizeof(*vars) * prog->nr_vars);
+        if (values == NULL || vars == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto out;
+        }
+    }
+
+    for (size_t i = 0; i < prog->nr_vars; i++) {
+        if (resolve_var(prog, i, param, values + i)) {
+            purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+            goto out;
+        }
+        vars[i] = values + i;
+    }
+
+    ret = EXEC_FUNC(prog, vars, 1, d);
+
+out:
+    if (values != local_values)
+        free(values);
+    if (vars != local_vars)
+        free(vars);
+    return ret;
+}
+
+/* evaluates the program for every row of the data, which is either
+   an array of objects or an object of columns (arrays) */
+purc_variant_t ARRAY_FUNC(const struct PROGRAM *prog, purc_variant_t data)
+{
+    purc_variant_t result = PURC_VARIANT_INVALID;
+    VALUE_TYPE *values = NULL;
+    const VALUE_TYPE **vars = NULL;
+    VALUE_TYPE *results = NULL;
+    bool by_rows;
+    ssize_t nr_rows = -1;
+
+    if (purc_variant_is_array(data)) {
+        by_rows = true;
+        nr_rows = purc_variant_array_get_size(data);
+    }
+    else if (purc_variant_is_object(data)) {
+        by_rows = false;
+        for (size_t i = 0; i < prog->nr_vars; i++) {
+            purc_variant_t col = purc_variant_object_get_by_ckey_ex(data,
+                    prog->vars[i].name, true);
+            if (col == PURC_VARIANT_INVALID || !purc_variant_is_array(col))
+                continue;
+
+            ssize_t sz = purc_variant_array_get_size(col);
+            if (nr_rows >= 0 && sz != nr_rows) {
+                purc_set_error(PURC_ERROR_INVALID_VALUE);
+                return PURC_VARIANT_INVALID;
+            }
+            nr_rows = sz;
+        }
+
+        /* all variables are scalars */
+        if (nr_rows < 0)
+            nr_rows = 1;
     }
     else {
-        if (ud.divide_by_zero) {
-            purc_set_error(PURC_ERROR_OVERFLOW);
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    result = purc_variant_make_array_0();
+    if (result == PURC_VARIANT_INVALID || nr_rows == 0)
+        return result;
+
+    values = (VALUE_TYPE *)malloc(sizeof(*values) *
+            (prog->nr_vars * nr_rows + 1));
+    vars = (const VALUE_TYPE **)malloc(sizeof(*vars) * (prog->nr_vars + 1));
+    results = (VALUE_TYPE *)malloc(sizeof(*results) * nr_rows);
+    if (values == NULL || vars == NULL || results == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    /* lay out the variables column by column */
+    for (size_t i = 0; i < prog->nr_vars; i++) {
+        VALUE_TYPE *column = values + i * nr_rows;
+        vars[i] = column;
+
+        if (by_rows) {
+            for (ssize_t r = 0; r < nr_rows; r++) {
+                purc_variant_t row = purc_variant_array_get(data, r);
+                if (!purc_variant_is_object(row)) {
+                    purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+                    goto failed;
+                }
+                if (resolve_var(prog, i, row, column + r)) {
+                    purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+                    goto failed;
+                }
+            }
+            continue;
+        }
+
+        purc_variant_t col = purc_variant_object_get_by_ckey_ex(data,
+                prog->vars[i].name, true);
+        if (col && purc_variant_is_array(col)) {
+            for (ssize_t r = 0; r < nr_rows; r++) {
+                purc_variant_t v = purc_variant_array_get(col, r);
+                if (!CAST_TO_NUMBER(v, column + r, false)) {
+                    purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+                    goto failed;
+                }
+            }
         }
         else {
-            purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+            /* a scalar applies to all rows */
+            if (resolve_var(prog, i, data, column)) {
+                purc_set_error(PURC_ERROR_INTERNAL_FAILURE);
+                goto failed;
+            }
+            for (ssize_t r = 1; r < nr_rows; r++)
+                column[r] = column[0];
         }
     }
+
+    if (EXEC_FUNC(prog, vars, nr_rows, results))
+        goto failed;
+
+    for (ssize_t r = 0; r < nr_rows; r++) {
+        purc_variant_t v = MAKE_NUMBER(results[r]);
+        if (v == PURC_VARIANT_INVALID)
+            goto failed;
+
+        bool ok = purc_variant_array_append(result, v);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+    }
+
+    free(values);
+    free(vars);
+    free(results);
+    return result;
+
+failed:
+    free(values);
+    free(vars);
+    free(results);
+    purc_variant_unref(result);
+    return PURC_VARIANT_INVALID;
+}
+
+int FUNC_NAME(const char *input, VALUE_TYPE *d, purc_variant_t param)
+{
+    struct PROGRAM *prog;
+
+    if (COMPILE_FUNC(input, &prog))
+        return 1;
+
+    VALUE_TYPE v;
+    int ret = EVAL_FUNC(prog, &v, param);
+    DELETE_FUNC(prog);
+    if (ret == 0 && d)
+        *d = v;
+
     return ret ? 1 : 0;
 }
 
@@ -641,6 +641,546 @@ failed_subcall:
     return pyobj;
 }
 
+/*
+ * Zero-copy bridging between variants and PyObjects.
+ *
+ * A byte sequence which is not smaller than PY_ZERO_COPY_MIN_BYTES is
+ * exposed to Python as a read-only memoryview over the bytes of the variant
+ * via the buffer protocol; the memoryview keeps a reference to the variant.
+ *
+ * An array, a tuple, or an object which has not less than
+ * PY_LAZY_PROXY_MIN_MEMBERS members is passed to a Python callable as
+ * a proxy, which converts a member only when it is accessed. The proxies
+ * are registered as `collections.abc.Sequence` and `collections.abc.Mapping`
+ * respectively, and a slice of an array proxy is a list. A smaller
+ * container is converted to a list or a dict eagerly.
+ *
+ * Conversely, an immutable Python buffer (e.g., `bytes`) which is not smaller
+ * than PY_ZERO_COPY_MIN_BYTES is wrapped as a read-only byte sequence, and
+ * a memoryview or a proxy made by us is converted back to the original
+ * variant directly.
+ */
+#define PY_ZERO_COPY_MIN_BYTES      4096
+#define PY_LAZY_PROXY_MIN_MEMBERS   64
+
+struct pyvariant_holder {
+    PyObject_HEAD
+    purc_variant_t  v;
+};
+
+static PyObject *make_pyobj_from_variant_lazy(struct dvobj_pyinfo *pyinfo,
+        purc_variant_t v);
+
+static void pyvariant_holder_dealloc(PyObject *self)
+{
+    struct pyvariant_holder *holder = (struct pyvariant_holder *)self;
+    if (holder->v)
+        purc_variant_unref(holder->v);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static int pybsequence_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+    struct pyvariant_holder *holder = (struct pyvariant_holder *)self;
+    const unsigned char *bytes;
+    size_t nr_bytes;
+
+    bytes = purc_variant_get_bytes_const(holder->v, &nr_bytes);
+    if (bytes == NULL) {
+        PyErr_SetString(PyExc_BufferError, "bad byte sequence");
+        view->obj = NULL;
+        return -1;
+    }
+
+    /* PyBuffer_FillInfo() raises BufferError if a writable buffer is
+       requested, because we always export the bytes as read-only. */
+    return PyBuffer_FillInfo(view, self, (void *)bytes, (Py_ssize_t)nr_bytes,
+            1, flags);
+}
+
+static PyBufferProcs pybsequence_as_buffer = {
+    .bf_getbuffer = pybsequence_getbuffer,
+    .bf_releasebuffer = NULL,
+};
+
+static PyTypeObject pybsequence_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "hvml.bsequence",
+    .tp_doc = "The holder of an HVML byte sequence.",
+    .tp_basicsize = sizeof(struct pyvariant_holder),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = pyvariant_holder_dealloc,
+    .tp_as_buffer = &pybsequence_as_buffer,
+};
+
+static PyObject *
+make_pyvariant_holder(PyTypeObject *type, purc_variant_t v)
+{
+    struct pyvariant_holder *holder;
+
+    holder = PyObject_New(struct pyvariant_holder, type);
+    if (holder)
+        holder->v = purc_variant_ref(v);
+    return (PyObject *)holder;
+}
+
+static PyObject *lazy_member_to_pyobj(purc_variant_t mbr)
+{
+    PyObject *pyobj = make_pyobj_from_variant_lazy(get_pyinfo(), mbr);
+
+    /* make_pyobj_from_variant() clears the Python exception. */
+    if (pyobj == NULL && !PyErr_Occurred())
+        PyErr_SetString(PyExc_RuntimeError, "failed to convert HVML value");
+    return pyobj;
+}
+
+static Py_ssize_t pyarray_proxy_length(PyObject *self)
+{
+    struct pyvariant_holder *holder = (struct pyvariant_holder *)self;
+    size_t sz;
+
+    if (!purc_variant_linear_container_size(holder->v, &sz))
+        return 0;
+    return (Py_ssize_t)sz;
+}
+
+static PyObject *pyarray_proxy_item(PyObject *self, Py_ssize_t idx)
+{
+    struct pyvariant_holder *holder = (struct pyvariant_holder *)self;
+    size_t sz;
+
+    /* the negative index has been adjusted by Python */
+    if (!purc_variant_linear_container_size(holder->v, &sz) ||
+            idx < 0 || (size_t)idx >= sz) {
+        PyErr_SetString(PyExc_IndexError, "index out of range");
+        return NULL;
+    }
+
+    return lazy_member_to_pyobj(
+            purc_variant_linear_container_get(holder->v, (size_t)idx));
+}
+
+/* a slice of the proxy is a list, like a slice of a list */
+static PyObject *pyarray_proxy_subscript(PyObject *self, PyObject *key)
+{
+    if (PyIndex_Check(key)) {
+        Py_ssize_t idx = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (idx == -1 && PyErr_Occurred())
+            return NULL;
+        if (idx < 0)
+            idx += pyarray_proxy_length(self);
+        return pyarray_proxy_item(self, idx);
+    }
+
+    if (!PySlice_Check(key)) {
+        PyErr_Format(PyExc_TypeError,
+                "indices must be integers or slices, not %.200s",
+                Py_TYPE(key)->tp_name);
+        return NULL;
+    }
+
+    Py_ssize_t start, stop, step;
+    if (PySlice_Unpack(key, &start, &stop, &step) < 0)
+        return NULL;
+
+    Py_ssize_t len = PySlice_AdjustIndices(pyarray_proxy_length(self),
+            &start, &stop, step);
+    PyObject *list = PyList_New(len);
+    if (list == NULL)
+        return NULL;
+
+    for (Py_ssize_t i = 0, idx = start; i < len; i++, idx += step) {
+        PyObject *item = pyarray_proxy_item(self, idx);
+        if (item == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    return list;
+}
+
+static PySequenceMethods pyarray_proxy_as_sequence = {
+    .sq_length = pyarray_proxy_length,
+    .sq_item = pyarray_proxy_item,
+};
+
+static PyMappingMethods pyarray_proxy_as_mapping = {
+    .mp_length = pyarray_proxy_length,
+    .mp_subscript = pyarray_proxy_subscript,
+};
+
+static PyTypeObject pyarray_proxy_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "hvml.array",
+    .tp_doc = "The lazy proxy of an HVML array or tuple.",
+    .tp_basicsize = sizeof(struct pyvariant_holder),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = pyvariant_holder_dealloc,
+    .tp_as_sequence = &pyarray_proxy_as_sequence,
+    .tp_as_mapping = &pyarray_proxy_as_mapping,
+};
+
+static Py_ssize_t pyobject_proxy_length(PyObject *self)
+{
+    struct pyvariant_holder *holder = (struct pyvariant_holder *)self;
+    size_t sz;
+
+    if (!purc_variant_object_size(holder->v, &sz))
+        return 0;
+    return (Py_ssize_t)sz;
+}
+
+static purc_variant_t
+pyobject_proxy_lookup(struct pyvariant_holder *holder, PyObject *key)
+{
+    const char *c_key;
+
+    if (!PyUnicode_Check(key) || (c_key = PyUnicode_AsUTF8(key)) == NULL)
+        return PURC_VARIANT_INVALID;
+
+    return purc_variant_object_get_by_ckey_ex(holder->v, c_key, true);
+}
+
+static PyObject *pyobject_proxy_subscript(PyObject *self, PyObject *key)
+{
+    purc_variant_t val;
+
+    val = pyobject_proxy_lookup((struct pyvariant_holder *)self, key);
+    if (val == PURC_VARIANT_INVALID) {
+        if (!PyErr_Occurred())
+            PyErr_SetObject(PyExc_KeyError, key);
+        return NULL;
+    }
+
+    return lazy_member_to_pyobj(val);
+}
+
+static int pyobject_proxy_contains(PyObject *self, PyObject *key)
+{
+    purc_variant_t val;
+
+    val = pyobject_proxy_lookup((struct pyvariant_holder *)self, key);
+    if (val == PURC_VARIANT_INVALID) {
+        if (PyErr_Occurred())
+            return -1;
+        return 0;
+    }
+
+    return 1;
+}
+
+enum {
+    PROXY_ITEMS_KEYS = 0,
+    PROXY_ITEMS_VALUES,
+    PROXY_ITEMS_PAIRS,
+};
+
+static PyObject *pyobject_proxy_list(PyObject *self, int which)
+{
+    struct pyvariant_holder *holder = (struct pyvariant_holder *)self;
+    struct pcvrnt_object_iterator* it;
+
+    PyObject *list = PyList_New(0);
+    if (list == NULL)
+        return NULL;
+
+    it = pcvrnt_object_iterator_create_begin(holder->v);
+    while (it) {
+        const char     *key = pcvrnt_object_iterator_get_ckey(it);
+        purc_variant_t  val = pcvrnt_object_iterator_get_value(it);
+        PyObject *item = NULL;
+
+        if (which == PROXY_ITEMS_KEYS) {
+            item = PyUnicode_FromString(key);
+        }
+        else if (which == PROXY_ITEMS_VALUES) {
+            item = lazy_member_to_pyobj(val);
+        }
+        else {
+            PyObject *pyval = lazy_member_to_pyobj(val);
+            if (pyval) {
+                item = Py_BuildValue("(sN)", key, pyval);
+            }
+        }
+
+        if (item == NULL || PyList_Append(list, item)) {
+            Py_XDECREF(item);
+            pcvrnt_object_iterator_release(it);
+            Py_DECREF(list);
+            return NULL;
+        }
+        Py_DECREF(item);
+
+        if (!pcvrnt_object_iterator_next(it))
+            break;
+    }
+    pcvrnt_object_iterator_release(it);
+
+    return list;
+}
+
+static PyObject *pyobject_proxy_keys(PyObject *self, PyObject *unused)
+{
+    UNUSED_PARAM(unused);
+    return pyobject_proxy_list(self, PROXY_ITEMS_KEYS);
+}
+
+static PyObject *pyobject_proxy_values(PyObject *self, PyObject *unused)
+{
+    UNUSED_PARAM(unused);
+    return pyobject_proxy_list(self, PROXY_ITEMS_VALUES);
+}
+
+static PyObject *pyobject_proxy_items(PyObject *self, PyObject *unused)
+{
+    UNUSED_PARAM(unused);
+    return pyobject_proxy_list(self, PROXY_ITEMS_PAIRS);
+}
+
+static PyObject *pyobject_proxy_get(PyObject *self, PyObject *args)
+{
+    PyObject *key, *def = Py_None;
+    purc_variant_t val;
+
+    if (!PyArg_ParseTuple(args, "O|O:get", &key, &def))
+        return NULL;
+
+    val = pyobject_proxy_lookup((struct pyvariant_holder *)self, key);
+    if (val == PURC_VARIANT_INVALID) {
+        if (PyErr_Occurred())
+            return NULL;
+        return Py_NewRef(def);
+    }
+
+    return lazy_member_to_pyobj(val);
+}
+
+static PyObject *pyobject_proxy_iter(PyObject *self)
+{
+    PyObject *keys = pyobject_proxy_list(self, PROXY_ITEMS_KEYS);
+    if (keys == NULL)
+        return NULL;
+
+    PyObject *it = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return it;
+}
+
+static PyMethodDef pyobject_proxy_methods[] = {
+    { "keys",   pyobject_proxy_keys,    METH_NOARGS,    NULL },
+    { "values", pyobject_proxy_values,  METH_NOARGS,    NULL },
+    { "items",  pyobject_proxy_items,   METH_NOARGS,    NULL },
+    { "get",    pyobject_proxy_get,     METH_VARARGS,   NULL },
+    { NULL,     NULL,                   0,              NULL },
+};
+
+static PyMappingMethods pyobject_proxy_as_mapping = {
+    .mp_length = pyobject_proxy_length,
+    .mp_subscript = pyobject_proxy_subscript,
+};
+
+static PySequenceMethods pyobject_proxy_as_sequence = {
+    .sq_contains = pyobject_proxy_contains,
+};
+
+static PyTypeObject pyobject_proxy_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "hvml.object",
+    .tp_doc = "The lazy proxy of an HVML object.",
+    .tp_basicsize = sizeof(struct pyvariant_holder),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = pyvariant_holder_dealloc,
+    .tp_iter = pyobject_proxy_iter,
+    .tp_methods = pyobject_proxy_methods,
+    .tp_as_mapping = &pyobject_proxy_as_mapping,
+    .tp_as_sequence = &pyobject_proxy_as_sequence,
+};
+
+/* Registers a proxy type as a virtual subclass of an abstract base class
+   in `collections.abc`, so that `isinstance()` accepts the proxies. */
+static int register_proxy_type(PyObject *abc, const char *base,
+        PyTypeObject *type)
+{
+    PyObject *klass = PyObject_GetAttrString(abc, base);
+    if (klass == NULL)
+        return -1;
+
+    PyObject *result = PyObject_CallMethod(klass, "register", "O",
+            (PyObject *)type);
+    Py_DECREF(klass);
+    if (result == NULL)
+        return -1;
+
+    Py_DECREF(result);
+    return 0;
+}
+
+static int ready_pyvariant_types(void)
+{
+    if (PyType_Ready(&pybsequence_type) < 0 ||
+            PyType_Ready(&pyarray_proxy_type) < 0 ||
+            PyType_Ready(&pyobject_proxy_type) < 0)
+        return -1;
+
+    PyObject *abc = PyImport_ImportModule("collections.abc");
+    if (abc == NULL)
+        return -1;
+
+    int ret = 0;
+    if (register_proxy_type(abc, "Sequence", &pyarray_proxy_type) ||
+            register_proxy_type(abc, "Mapping", &pyobject_proxy_type))
+        ret = -1;
+
+    Py_DECREF(abc);
+    return ret;
+}
+
+/*
+ * Like make_pyobj_from_variant(), but use a memoryview for a large
+ * byte sequence and a lazy proxy for a large linear container or object.
+ * Use this function only for the positional arguments of a callable,
+ * where the callee does not require an exact list or dict.
+ */
+static PyObject *make_pyobj_from_variant_lazy(struct dvobj_pyinfo *pyinfo,
+        purc_variant_t v)
+{
+    PyTypeObject *type = NULL;
+    size_t sz;
+
+    enum purc_variant_type t = purc_variant_get_type(v);
+    switch (t) {
+    case PURC_VARIANT_TYPE_BSEQUENCE:
+        if (purc_variant_bsequence_bytes(v, &sz) &&
+                sz >= PY_ZERO_COPY_MIN_BYTES)
+            type = &pybsequence_type;
+        break;
+
+    case PURC_VARIANT_TYPE_ARRAY:
+    case PURC_VARIANT_TYPE_TUPLE:
+        if (purc_variant_linear_container_size(v, &sz) &&
+                sz >= PY_LAZY_PROXY_MIN_MEMBERS)
+            type = &pyarray_proxy_type;
+        break;
+
+    case PURC_VARIANT_TYPE_OBJECT:
+        if (purc_variant_object_size(v, &sz) &&
+                sz >= PY_LAZY_PROXY_MIN_MEMBERS)
+            type = &pyobject_proxy_type;
+        break;
+
+    default:
+        break;
+    }
+
+    if (type == NULL)
+        return make_pyobj_from_variant(pyinfo, v);
+
+    PyObject *pyobj = make_pyvariant_holder(type, v);
+    if (pyobj && type == &pybsequence_type) {
+        PyObject *holder = pyobj;
+        pyobj = PyMemoryView_FromObject(holder);
+        Py_DECREF(holder);
+    }
+
+    if (pyobj == NULL)
+        handle_python_error(pyinfo);
+    return pyobj;
+}
+
+/*
+ * Returns the variant behind a memoryview or a proxy made by
+ * make_pyobj_from_variant_lazy(), or PURC_VARIANT_INVALID if the PyObject
+ * is not the one.
+ */
+static purc_variant_t variant_behind_pyobj(PyObject *pyobj)
+{
+    if (PyMemoryView_Check(pyobj)) {
+        Py_buffer *view = PyMemoryView_GET_BUFFER(pyobj);
+        if (view->obj && Py_IS_TYPE(view->obj, &pybsequence_type)) {
+            struct pyvariant_holder *holder = (void *)view->obj;
+            const unsigned char *bytes;
+            size_t nr_bytes;
+
+            bytes = purc_variant_get_bytes_const(holder->v, &nr_bytes);
+            /* not a slice of the byte sequence */
+            if (view->buf == bytes && (size_t)view->len == nr_bytes)
+                return purc_variant_ref(holder->v);
+        }
+    }
+    else if (Py_IS_TYPE(pyobj, &pyarray_proxy_type) ||
+            Py_IS_TYPE(pyobj, &pyobject_proxy_type)) {
+        return purc_variant_ref(((struct pyvariant_holder *)pyobj)->v);
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
+/*
+ * The number of the byte sequences referring to Python buffers; it is
+ * changed only with the GIL held. The interpreter is not finalized while
+ * there is such a byte sequence, so a buffer is always released to a live
+ * interpreter, even after $PY has been unloaded (the shared object of $PY
+ * is loaded with RTLD_NODELETE, so this hook is still there).
+ */
+static size_t nr_external_pybuffers;
+
+static void release_pybuffer(void *ctxt)
+{
+    Py_buffer *view = ctxt;
+
+    PyGILState_STATE state = PyGILState_Ensure();
+    PyBuffer_Release(view);
+    assert(nr_external_pybuffers > 0);
+    nr_external_pybuffers--;
+    PyGILState_Release(state);
+
+    free(view);
+}
+
+/*
+ * Makes a byte sequence from a PyObject supporting the buffer protocol.
+ * The bytes of a large read-only buffer will be referred to directly
+ * instead of copied; the buffer will be released along with the variant.
+ */
+static purc_variant_t make_bsequence_from_pybuffer(PyObject *pyobj)
+{
+    purc_variant_t v = PURC_VARIANT_INVALID;
+    Py_buffer *view = malloc(sizeof(*view));
+
+    if (view == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    if (PyObject_GetBuffer(pyobj, view, PyBUF_SIMPLE)) {
+        free(view);
+        goto failed;
+    }
+
+    if (view->len == 0) {
+        v = purc_variant_make_byte_sequence_empty();
+    }
+    else if (!view->readonly || view->len < PY_ZERO_COPY_MIN_BYTES) {
+        v = purc_variant_make_byte_sequence(view->buf, view->len);
+    }
+    else {
+        v = purc_variant_make_byte_sequence_external(view->buf, view->len,
+                release_pybuffer, view);
+        if (v) {
+            nr_external_pybuffers++;
+            return v;
+        }
+    }
+
+    PyBuffer_Release(view);
+    free(view);
+
+failed:
+    return v;
+}
+
 static purc_nvariant_method
 pyobject_property_getter_getter(void* native_entity,
         const char* property_name);
@@ -757,7 +1297,10 @@ static purc_variant_t make_variant_from_pyobj(PyObject *pyobj)
 
     bool is_basic;
     v = make_variant_from_basic_pyobj(pyobj, &is_basic);
-    if (!is_basic) {
+    if (!is_basic && (v = variant_behind_pyobj(pyobj))) {
+        // do nothing.
+    }
+    else if (!is_basic) {
         Py_INCREF(pyobj);
         v = purc_variant_make_native_entity(pyobj, &native_pyobject_ops,
                 PY_NATIVE_PREFIX "any");
@@ -779,11 +1322,13 @@ static purc_variant_t convert_pyobj_to_variant(struct dvobj_pyinfo *pyinfo,
     if (is_basic) {
         // do nothing.
     }
-    else if (PyBytes_Check(pyobj)) {
-        char *buffer;
-        Py_ssize_t length;
-        PyBytes_AsStringAndSize(pyobj, &buffer, &length);
-        v = purc_variant_make_byte_sequence(buffer, length);
+    else if ((v = variant_behind_pyobj(pyobj))) {
+        // do nothing.
+    }
+    else if (PyBytes_Check(pyobj) || PyMemoryView_Check(pyobj)) {
+        v = make_bsequence_from_pybuffer(pyobj);
+        if (v == PURC_VARIANT_INVALID)
+            goto failed_python;
     }
     else if (PyByteArray_Check(pyobj)) {
         char *buffer = PyByteArray_AS_STRING(pyobj);
@@ -973,7 +1518,7 @@ static purc_variant_t pycallable_self_getter(void* native_entity,
         result = PyObject_CallNoArgs(pyobj);
     }
     else if (nr_args == 1) {
-        PyObject *arg = make_pyobj_from_variant(pyinfo, argv[0]);
+        PyObject *arg = make_pyobj_from_variant_lazy(pyinfo, argv[0]);
         if (arg == NULL)
             goto failed;
 
@@ -986,7 +1531,7 @@ static purc_variant_t pycallable_self_getter(void* native_entity,
             goto failed_python;
 
         for (size_t i = 0; i < nr_args; i++) {
-            PyObject *pymbr = make_pyobj_from_variant(pyinfo, argv[i]);
+            PyObject *pymbr = make_pyobj_from_variant_lazy(pyinfo, argv[i]);
             if (pymbr == NULL) {
                 Py_DECREF(arg);
                 goto failed;
@@ -1057,7 +1602,7 @@ static purc_variant_t pycallable_self_setter(void* native_entity,
         goto failed_python;
 
     for (size_t i = 0; i < nr_args - 1; i++) {
-        PyObject *item = make_pyobj_from_variant(pyinfo, argv[i]);
+        PyObject *item = make_pyobj_from_variant_lazy(pyinfo, argv[i]);
         if (item == NULL)
             goto failed;
         if (PyTuple_SetItem(args, i, item)) {
@@ -1471,7 +2016,7 @@ static purc_variant_t pyobject_method_getter(void* native_entity,
         result = PyObject_CallMethodNoArgs(pyobj, name);
     }
     else if (nr_args == 1) {
-        PyObject *arg = make_pyobj_from_variant(pyinfo, argv[0]);
+        PyObject *arg = make_pyobj_from_variant_lazy(pyinfo, argv[0]);
         if (arg == NULL)
             goto failed;
 
@@ -1483,7 +2028,7 @@ static purc_variant_t pyobject_method_getter(void* native_entity,
         vc_args[0] = pyobj;
 
         for (size_t i = 0; i < nr_args; i++) {
-            PyObject *pymbr = make_pyobj_from_variant(pyinfo, argv[i]);
+            PyObject *pymbr = make_pyobj_from_variant_lazy(pyinfo, argv[i]);
             if (pymbr == NULL) {
                 goto failed;
             }
@@ -1557,7 +2102,7 @@ static purc_variant_t pyobject_method_setter(void* native_entity,
 
     args[0] = pyobj;
     for (size_t i = 1; i < nr_args; i++) {
-        args[i] = make_pyobj_from_variant(pyinfo, argv[i - 1]);
+        args[i] = make_pyobj_from_variant_lazy(pyinfo, argv[i - 1]);
         if (args[i] == NULL) {
             goto failed;
         }
@@ -2922,7 +3467,11 @@ static bool on_py_being_released(purc_variant_t src, pcvar_op_t op,
         Py_DECREF(pyinfo->locals);
 
         assert(Py_IsInitialized());
-        Py_Finalize();
+        /* keep the interpreter for the byte sequences made from Python
+           buffers which are still alive; it will be used again if $PY
+           is loaded again */
+        if (nr_external_pybuffers == 0)
+            Py_Finalize();
 
         pcutils_map_destroy(pyinfo->reserved_symbols);
         free(pyinfo);
@@ -2960,6 +3509,9 @@ static purc_variant_t create_py(void)
     if (m == NULL)
         goto fatal;
 
+    if (ready_pyvariant_types())
+        goto fatal;
+
     py = purc_dvobj_make_from_methods(methods, PCA_TABLESIZE(methods));
     struct dvobj_pyinfo *pyinfo = NULL;
     if (py) {
@@ -32,6 +32,7 @@
 #include "private/instance.h"
 #include "private/atom-buckets.h"
 #include "private/debug.h"
+#include "private/list.h"
 #include "purc-variant.h"
 #include "purc-errors.h"
 
@@ -42,6 +43,9 @@
 
 #define SQLITE_DEFAULT_TIMEOUT      5
 
+/* the max number of prepared statements cached by a connection */
+#define SQLITE_STMT_CACHE_SIZE      32
+
 #define STR(x)                      #x
 #define STR2(x)                     STR(x)
 #define SQLITE_DVOBJ_VERCODE_STR    STR2(SQLITE_DVOBJ_VERCODE)
@@ -86,11 +90,27 @@ struct dvobj_sqlite_info {
     struct pcvar_listener   *listener;          // the listener
 };
 
+/* a prepared statement, which may be cached by the connection */
+struct dvobj_sqlite_stmt {
+    struct list_head                ln;             // node in the LRU list
+    char                            *sql;           // the SQL text (the key)
+    size_t                          nr_sql;
+    sqlite3_stmt                    *st;
+    bool                            is_dml;
+    bool                            cached;         // managed by the cache
+    bool                            in_use;         // used by a cursor
+    int                             nr_cols;
+    purc_variant_t                  *col_names;     // column names (strings)
+};
+
 struct dvobj_sqlite_connection {
     purc_variant_t              root;               // the root variant, itself
     sqlite3                     *db;
     char                        *db_name;
     struct pcvar_listener       *listener;          // the listener
+
+    struct list_head            stmt_cache;         // the most recent first
+    size_t                      nr_cached_stmts;
 };
 
 struct dvobj_sqlite_cursor {
@@ -103,7 +123,8 @@ struct dvobj_sqlite_cursor {
     purc_variant_t                  description;        // description attr
     struct dvobj_sqlite_connection  *conn;
     struct pcvar_listener           *listener;          // the listener
-    sqlite3_stmt                    *st;
+    struct dvobj_sqlite_stmt        *stmt;              // the current stmt
+    sqlite3_stmt                    *st;                // the same as stmt->st
 };
 
 static bool is_conn_closed(struct dvobj_sqlite_connection *conn)
@@ -197,28 +218,89 @@ lstrip_sql(const char *sql)
     return NULL;
 }
 
-static inline int
-cursor_create_st(struct dvobj_sqlite_cursor *cursor, const char *sql)
+static void stmt_clear_columns(struct dvobj_sqlite_stmt *stmt)
+{
+    if (stmt->col_names) {
+        for (int i = 0; i < stmt->nr_cols; i++) {
+            if (stmt->col_names[i])
+                purc_variant_unref(stmt->col_names[i]);
+        }
+        free(stmt->col_names);
+        stmt->col_names = NULL;
+    }
+    stmt->nr_cols = 0;
+}
+
+/* make the column names once for all rows returned by the statement */
+static int stmt_build_columns(struct dvobj_sqlite_stmt *stmt)
+{
+    int nr_cols = sqlite3_column_count(stmt->st);
+
+    stmt_clear_columns(stmt);
+    if (nr_cols <= 0) {
+        return 0;
+    }
+
+    stmt->col_names = calloc(nr_cols, sizeof(purc_variant_t));
+    if (stmt->col_names == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+    stmt->nr_cols = nr_cols;
+
+    for (int i = 0; i < nr_cols; i++) {
+        const char *colname = sqlite3_column_name(stmt->st, i);
+        if (colname == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+
+        stmt->col_names[i] = purc_variant_make_string(colname, true);
+        if (!stmt->col_names[i]) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void stmt_destroy(struct dvobj_sqlite_stmt *stmt)
+{
+    if (stmt->st) {
+        sqlite3_reset(stmt->st);
+        sqlite3_finalize(stmt->st);
+    }
+    stmt_clear_columns(stmt);
+    free(stmt->sql);
+    free(stmt);
+}
+
+static struct dvobj_sqlite_stmt *
+stmt_prepare(struct dvobj_sqlite_connection *conn, const char *sql,
+        size_t size)
 {
-    struct dvobj_sqlite_connection *conn = cursor->conn;
     sqlite3 *db = conn->db;
-    size_t size = strlen(sql);
     int max_length = sqlite3_limit(db, SQLITE_LIMIT_SQL_LENGTH, -1);
     if (size > (size_t)max_length) {
         purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
                 "Query string is too large.");
-        return -1;
+        return NULL;
+    }
+
+    struct dvobj_sqlite_stmt *stmt = calloc(1, sizeof(*stmt));
+    if (stmt == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
     }
 
-    sqlite3_stmt *stmt = NULL;
     const char *tail;
     int rc;
-    rc = sqlite3_prepare_v2(db, sql, (int)size + 1, &stmt, &tail);
+    rc = sqlite3_prepare_v2(db, sql, (int)size + 1, &stmt->st, &tail);
 
     if (rc != SQLITE_OK) {
         purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
                 "sqlite error message is %s", sqlite3_errmsg(conn->db));
-        return -1;
+        goto error;
     }
 
     if (lstrip_sql(tail) != NULL) {
@@ -227,25 +309,144 @@ cursor_create_st(struct dvobj_sqlite_cursor *cursor, const char *sql)
         goto error;
     }
 
-    bool is_dml = false;
     const char *p = lstrip_sql(sql);
     if (p != NULL) {
-        is_dml = (strncasecmp(p, "insert", 6) == 0)
+        stmt->is_dml = (strncasecmp(p, "insert", 6) == 0)
                   || (strncasecmp(p, "update", 6) == 0)
                   || (strncasecmp(p, "delete", 6) == 0)
                   || (strncasecmp(p, "replace", 7) == 0);
     }
 
-    cursor->st = stmt;
-    cursor->is_dml = is_dml;
+    if (stmt_build_columns(stmt)) {
+        goto error;
+    }
 
-    return 0;
+    stmt->sql = strndup(sql, size);
+    if (stmt->sql == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto error;
+    }
+    stmt->nr_sql = size;
+
+    return stmt;
 
 error:
-    if (stmt) {
-        sqlite3_finalize(stmt);
+    stmt_destroy(stmt);
+    return NULL;
+}
+
+/*
+ * Gets a prepared statement for the SQL text from the LRU cache of the
+ * connection, or prepares a new one and puts it into the cache.
+ * If the cached statement is being used by another cursor, a new statement
+ * which will not be cached is returned.
+ */
+static struct dvobj_sqlite_stmt *
+conn_acquire_stmt(struct dvobj_sqlite_connection *conn, const char *sql)
+{
+    struct dvobj_sqlite_stmt *stmt, *tmp, *tmp_n;
+    size_t size = strlen(sql);
+    bool busy = false;
+
+    list_for_each_entry(stmt, &conn->stmt_cache, ln) {
+        if (stmt->nr_sql == size && memcmp(stmt->sql, sql, size) == 0) {
+            if (stmt->in_use) {
+                busy = true;
+                break;
+            }
+
+            /* move it to the head of the LRU list */
+            list_move(&stmt->ln, &conn->stmt_cache);
+            stmt->in_use = true;
+            return stmt;
+        }
+    }
+
+    stmt = stmt_prepare(conn, sql, size);
+    if (stmt == NULL) {
+        return NULL;
+    }
+    stmt->in_use = true;
+
+    if (busy) {
+        return stmt;
+    }
+
+    /* evict the least recently used statements which are not in use */
+    list_for_each_entry_reverse_safe(tmp, tmp_n, &conn->stmt_cache, ln) {
+        if (conn->nr_cached_stmts < SQLITE_STMT_CACHE_SIZE)
+            break;
+
+        if (!tmp->in_use) {
+            list_del(&tmp->ln);
+            conn->nr_cached_stmts--;
+            stmt_destroy(tmp);
+        }
+    }
+
+    if (conn->nr_cached_stmts < SQLITE_STMT_CACHE_SIZE) {
+        list_add(&stmt->ln, &conn->stmt_cache);
+        conn->nr_cached_stmts++;
+        stmt->cached = true;
+    }
+
+    return stmt;
+}
+
+static void
+conn_release_stmt(struct dvobj_sqlite_connection *conn,
+        struct dvobj_sqlite_stmt *stmt)
+{
+    (void) conn;
+    if (stmt->cached) {
+        sqlite3_reset(stmt->st);
+        sqlite3_clear_bindings(stmt->st);
+        stmt->in_use = false;
+    }
+    else {
+        stmt_destroy(stmt);
     }
-    return -1;
+}
+
+/* the statements in use will be destroyed when they are released */
+static void conn_clear_stmt_cache(struct dvobj_sqlite_connection *conn)
+{
+    struct dvobj_sqlite_stmt *stmt, *tmp;
+
+    list_for_each_entry_safe(stmt, tmp, &conn->stmt_cache, ln) {
+        list_del(&stmt->ln);
+        if (stmt->in_use) {
+            stmt->cached = false;
+        }
+        else {
+            stmt_destroy(stmt);
+        }
+    }
+    conn->nr_cached_stmts = 0;
+}
+
+static void cursor_release_st(struct dvobj_sqlite_cursor *cursor)
+{
+    if (cursor->stmt) {
+        conn_release_stmt(cursor->conn, cursor->stmt);
+        cursor->stmt = NULL;
+        cursor->st = NULL;
+    }
+}
+
+static inline int
+cursor_create_st(struct dvobj_sqlite_cursor *cursor, const char *sql)
+{
+    struct dvobj_sqlite_stmt *stmt = conn_acquire_stmt(cursor->conn, sql);
+    if (stmt == NULL) {
+        return -1;
+    }
+
+    cursor->stmt = stmt;
+    cursor->st = stmt->st;
+    cursor->is_dml = stmt->is_dml;
+
+    return 0;
 }
 
 static int
@@ -411,12 +612,8 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
         cursor->description = PURC_VARIANT_INVALID;
     }
 
-    /* reset stmt : FIXME */
-    if (cursor->st) {
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
-    }
+    /* release the stmt used by the last query */
+    cursor_release_st(cursor);
 
     rc = cursor_create_st(cursor, sql);
     if (rc != 0) {
@@ -459,26 +656,20 @@ cursor_exec_query(struct dvobj_sqlite_cursor *cursor, bool multiple,
         }
 
         int numcols = sqlite3_column_count(cursor->st);
+        if (numcols != cursor->stmt->nr_cols) {
+            /* the statement was re-prepared after a schema change */
+            if (stmt_build_columns(cursor->stmt)) {
+                goto failed;
+            }
+        }
+
         if (cursor->description == PURC_VARIANT_INVALID && numcols > 0) {
-            cursor->description = purc_variant_make_tuple(numcols, NULL);
+            cursor->description = purc_variant_make_tuple(numcols,
+                    cursor->stmt->col_names);
             if (!cursor->description) {
                 purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
                 goto failed;
             }
-            for (i = 0; i < numcols; i++) {
-                const char *colname;
-                colname = sqlite3_column_name(cursor->st, i);
-                if (colname == NULL) {
-                    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-                    goto failed;
-                }
-                purc_variant_t val = purc_variant_make_string(colname, true);
-                if (!val) {
-                    goto failed;
-                }
-                purc_variant_tuple_set(cursor->description, i, val);
-                purc_variant_unref(val);
-            }
         }
 
         if (rc == SQLITE_DONE) {
@@ -1342,22 +1533,20 @@ fatal:
 }
 
 static purc_variant_t build_column_name(struct dvobj_sqlite_cursor *cursor,
-        int pos, const char *name, purc_variant_t name_mapping)
+        int pos, purc_variant_t name_mapping)
 {
-    (void) cursor;
-    (void) pos;
-    (void) name;
-    (void) name_mapping;
     purc_variant_t val = PURC_VARIANT_INVALID;
+    purc_variant_t col_name = cursor->stmt->col_names[pos];
     if (!name_mapping) {
-        val = purc_variant_make_string(name, true);
+        val = purc_variant_ref(col_name);
         goto out;
     }
 
+    const char *name = purc_variant_get_string_const(col_name);
     purc_variant_t v =
         purc_variant_object_get_by_ckey_ex(name_mapping, name, false);
     if (!v) {
-        val = purc_variant_make_string(name, true);
+        val = purc_variant_ref(col_name);
         goto out;
     }
 
@@ -1384,6 +1573,47 @@ out:
     return val;
 }
 
+static void free_column_keys(purc_variant_t *keys, int nr_keys)
+{
+    if (keys) {
+        for (int i = 0; i < nr_keys; i++) {
+            if (keys[i])
+                purc_variant_unref(keys[i]);
+        }
+        free(keys);
+    }
+}
+
+/* make the keys of the row objects once for all rows to fetch */
+static int cursor_make_column_keys(struct dvobj_sqlite_cursor *cursor,
+        purc_variant_t name_mapping, purc_variant_t **keys, int *nr_keys)
+{
+    *keys = NULL;
+    *nr_keys = 0;
+    if (cursor->stmt == NULL || cursor->stmt->nr_cols == 0) {
+        return 0;
+    }
+
+    int nr_cols = cursor->stmt->nr_cols;
+    purc_variant_t *names = calloc(nr_cols, sizeof(purc_variant_t));
+    if (names == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    for (int i = 0; i < nr_cols; i++) {
+        names[i] = build_column_name(cursor, i, name_mapping);
+        if (!names[i]) {
+            free_column_keys(names, nr_cols);
+            return -1;
+        }
+    }
+
+    *keys = names;
+    *nr_keys = nr_cols;
+    return 0;
+}
+
 static purc_variant_t build_column_value(struct dvobj_sqlite_cursor *cursor,
         int pos, const char *name, purc_variant_t type_conversion)
 {
@@ -1429,9 +1659,8 @@ out:
 
 static purc_variant_t cursor_fetch_one_row_as_object(
         struct dvobj_sqlite_cursor *cursor, int nr_cols,
-        purc_variant_t name_mapping, purc_variant_t type_conversion)
+        purc_variant_t *keys, purc_variant_t type_conversion)
 {
-    purc_variant_t key = PURC_VARIANT_INVALID;
     purc_variant_t val = PURC_VARIANT_INVALID;
     purc_variant_t row = purc_variant_make_object(0, PURC_VARIANT_INVALID,
             PURC_VARIANT_INVALID);
@@ -1440,37 +1669,28 @@ static purc_variant_t cursor_fetch_one_row_as_object(
         goto fatal;
     }
 
-    sqlite3_stmt *st = cursor->st;
-    for (int i = 0; i < nr_cols; i++) {
-        const char *col_name = sqlite3_column_name(st, i);
-        if (col_name == NULL) {
-            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            goto fatal;
-        }
-        key = build_column_name(cursor, i, col_name, name_mapping);
-        if (!key) {
-            goto fatal;
-        }
+    if (nr_cols > cursor->stmt->nr_cols) {
+        nr_cols = cursor->stmt->nr_cols;
+    }
 
+    for (int i = 0; i < nr_cols; i++) {
+        const char *col_name =
+            purc_variant_get_string_const(cursor->stmt->col_names[i]);
         val = build_column_value(cursor, i, col_name, type_conversion);
         if (!val) {
             goto fatal;
         }
 
-        if (!purc_variant_object_set(row, key, val)) {
+        if (!purc_variant_object_set(row, keys[i], val)) {
             goto fatal;
         }
 
-        purc_variant_unref(key);
         purc_variant_unref(val);
     }
 
     return row;
 
 fatal:
-    if (key) {
-        purc_variant_unref(key);
-    }
     if (val) {
         purc_variant_unref(val);
     }
@@ -1481,7 +1701,7 @@ fatal:
 }
 
 static purc_variant_t cursor_fetch_one_row(struct dvobj_sqlite_cursor *cursor,
-        purc_variant_type result_type, purc_variant_t name_mapping,
+        purc_variant_type result_type, purc_variant_t *keys,
         purc_variant_t type_conversion)
 {
     purc_variant_t row = PURC_VARIANT_INVALID;
@@ -1496,15 +1716,41 @@ static purc_variant_t cursor_fetch_one_row(struct dvobj_sqlite_cursor *cursor,
     }
     else {
         row = cursor_fetch_one_row_as_object(cursor, nr_cols,
-                name_mapping, type_conversion);
+                keys, type_conversion);
     }
 
 out:
     return row;
 }
 
+/*
+ * Steps the statement of the cursor to the next row.
+ * Returns 0 if there is a row, 1 if there is no more row, and -1 on error.
+ * The statement will be released if there is no more row or on error.
+ */
+static int cursor_step(struct dvobj_sqlite_cursor *cursor)
+{
+    int rc = sqlite3_step(cursor->st);
+    if (rc == SQLITE_ROW) {
+        return 0;
+    }
+
+    if (rc == SQLITE_DONE) {
+        if (cursor->is_dml) {
+            cursor->rowcount = (long)sqlite3_changes(cursor->conn->db);
+        }
+        cursor_release_st(cursor);
+        return 1;
+    }
+
+    purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
+            "sqlite error message is %s", sqlite3_errmsg(cursor->conn->db));
+    cursor_release_st(cursor);
+    return -1;
+}
+
 static purc_variant_t cursor_iterator_next(struct dvobj_sqlite_cursor *cursor,
-        purc_variant_type result_type, purc_variant_t name_mapping,
+        purc_variant_type result_type, purc_variant_t *keys,
         purc_variant_t type_conversion)
 {
     purc_variant_t row = PURC_VARIANT_INVALID;;
@@ -1522,29 +1768,14 @@ static purc_variant_t cursor_iterator_next(struct dvobj_sqlite_cursor *cursor,
 
     /* Prevent recursive use of cursors. */
     cursor->locked = 1;
-    row = cursor_fetch_one_row(cursor, result_type, name_mapping,
-            type_conversion);
+    row = cursor_fetch_one_row(cursor, result_type, keys, type_conversion);
     cursor->locked = 0;
 
     if (!row || purc_variant_is_null(row)) {
         goto failed;
     }
 
-    int rc = sqlite3_step(stmt);
-    if (rc == SQLITE_DONE) {
-        if (cursor->is_dml) {
-            cursor->rowcount = (long)sqlite3_changes(cursor->conn->db);
-        }
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
-    }
-    else if (rc != SQLITE_ROW) {
-        purc_set_error_with_info(PURC_ERROR_EXTERNAL_FAILURE,
-                "sqlite error message is %s", sqlite3_errmsg(cursor->conn->db));
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
+    if (cursor_step(cursor) < 0) {
         purc_variant_unref(row);
         row = PURC_VARIANT_INVALID;
     }
@@ -1553,6 +1784,174 @@ failed:
     return row;
 }
 
+/* the rows are appended to the result array in batches */
+#define NR_ROWS_PER_BATCH   64
+
+static bool append_rows(purc_variant_t rows, size_t nr_rows,
+        purc_variant_t *batch)
+{
+    bool ok = purc_variant_array_append_many(rows, nr_rows, batch);
+    for (size_t i = 0; i < nr_rows; i++)
+        purc_variant_unref(batch[i]);
+    return ok;
+}
+
+/* fetches all left rows without checking the cursor for every row */
+static purc_variant_t cursor_fetch_all_rows(struct dvobj_sqlite_cursor *cursor,
+        purc_variant_type result_type, purc_variant_t *keys,
+        purc_variant_t type_conversion)
+{
+    purc_variant_t rows = PURC_VARIANT_INVALID;
+    purc_variant_t row;
+    purc_variant_t batch[NR_ROWS_PER_BATCH];
+    size_t nr_batched = 0;
+    bool ok = true;
+
+    if (!check_cursor(cursor)) {
+        goto failed;
+    }
+
+    /* the statement is released once all rows are fetched */
+    if (cursor->st == NULL) {
+        rows = purc_variant_make_array_0();
+        goto failed;
+    }
+
+    if (sqlite3_data_count(cursor->st) == 0) {
+        rows = purc_variant_make_null();
+        goto failed;
+    }
+
+    rows = purc_variant_make_array_0();
+    if (!rows) {
+        goto failed;
+    }
+
+    /* Prevent recursive use of cursors. */
+    cursor->locked = 1;
+    do {
+        row = cursor_fetch_one_row(cursor, result_type, keys, type_conversion);
+        if (!row || purc_variant_is_null(row)) {
+            if (row)
+                purc_variant_unref(row);
+            break;
+        }
+
+        batch[nr_batched++] = row;
+        if (nr_batched == NR_ROWS_PER_BATCH) {
+            ok = append_rows(rows, nr_batched, batch);
+            nr_batched = 0;
+            if (!ok) {
+                break;
+            }
+        }
+    } while (cursor_step(cursor) == 0);
+    cursor->locked = 0;
+
+    if (ok && nr_batched > 0) {
+        ok = append_rows(rows, nr_batched, batch);
+    }
+
+    if (!ok) {
+        purc_variant_unref(rows);
+        rows = PURC_VARIANT_INVALID;
+    }
+
+failed:
+    return rows;
+}
+
+/*
+ * Fetches all left rows in columnar form: an object whose properties are
+ * the columns and the values are arrays of the values in the columns.
+ */
+static purc_variant_t
+cursor_fetch_all_columns(struct dvobj_sqlite_cursor *cursor,
+        purc_variant_t *keys, purc_variant_t type_conversion)
+{
+    purc_variant_t result = PURC_VARIANT_INVALID;
+    purc_variant_t *columns = NULL;
+    int nr_cols = 0;
+
+    if (!check_cursor(cursor) || cursor->st == NULL) {
+        goto failed;
+    }
+
+    nr_cols = sqlite3_data_count(cursor->st);
+    if (nr_cols <= 0) {
+        result = purc_variant_make_null();
+        goto failed;
+    }
+
+    if (nr_cols > cursor->stmt->nr_cols) {
+        nr_cols = cursor->stmt->nr_cols;
+    }
+
+    columns = calloc(nr_cols, sizeof(purc_variant_t));
+    if (columns == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    for (int i = 0; i < nr_cols; i++) {
+        columns[i] = purc_variant_make_array_0();
+        if (!columns[i]) {
+            goto failed;
+        }
+    }
+
+    /* Prevent recursive use of cursors. */
+    cursor->locked = 1;
+    int rc;
+    do {
+        for (int i = 0; i < nr_cols; i++) {
+            const char *col_name =
+                purc_variant_get_string_const(cursor->stmt->col_names[i]);
+            purc_variant_t val = build_column_value(cursor, i, col_name,
+                    type_conversion);
+            if (!val) {
+                cursor->locked = 0;
+                goto failed;
+            }
+
+            bool ok = purc_variant_array_append(columns[i], val);
+            purc_variant_unref(val);
+            if (!ok) {
+                cursor->locked = 0;
+                goto failed;
+            }
+        }
+    } while ((rc = cursor_step(cursor)) == 0);
+    cursor->locked = 0;
+
+    if (rc < 0) {
+        goto failed;
+    }
+
+    result = purc_variant_make_object_0();
+    if (!result) {
+        goto failed;
+    }
+
+    for (int i = 0; i < nr_cols; i++) {
+        if (!purc_variant_object_set(result, keys[i], columns[i])) {
+            purc_variant_unref(result);
+            result = PURC_VARIANT_INVALID;
+            goto failed;
+        }
+    }
+
+failed:
+    if (columns) {
+        for (int i = 0; i < nr_cols; i++) {
+            if (columns[i])
+                purc_variant_unref(columns[i]);
+        }
+        free(columns);
+    }
+    return result;
+}
+
 static inline struct dvobj_sqlite_cursor *
 get_cursor_from_root(purc_variant_t root)
 {
@@ -1601,10 +2000,7 @@ static bool on_sqlite_cursor_being_released(purc_variant_t src, pcvar_op_t op,
 
     if (op == PCVAR_OPERATION_RELEASING) {
         struct dvobj_sqlite_cursor *cursor = ctxt;
-        if (cursor->st) {
-            sqlite3_reset(cursor->st);
-            sqlite3_finalize(cursor->st);
-        }
+        cursor_release_st(cursor);
         destroy_cursor(cursor);
     }
 
@@ -1693,9 +2089,14 @@ failed:
     return purc_variant_make_boolean(ret);
 }
 
+/*
+ * The result type can be `tuple` or `object` for all fetch methods,
+ * and `columns` for fetchall, which is represented by
+ * PURC_VARIANT_TYPE_ARRAY.
+ */
 static int parse_fetch_params(size_t nr_args, purc_variant_t *argv,
-        purc_variant_type *result_type, purc_variant_t *name_mapping,
-        purc_variant_t *type_conversion)
+        bool allow_columns, purc_variant_type *result_type,
+        purc_variant_t *name_mapping, purc_variant_t *type_conversion)
 {
     purc_variant_t val;
     if (nr_args > 0) {
@@ -1713,6 +2114,9 @@ static int parse_fetch_params(size_t nr_args, purc_variant_t *argv,
         else if (strcasecmp(type, "object") == 0) {
             *result_type = PURC_VARIANT_TYPE_OBJECT;
         }
+        else if (allow_columns && strcasecmp(type, "columns") == 0) {
+            *result_type = PURC_VARIANT_TYPE_ARRAY;
+        }
         else {
             purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
                     "invalid result type '%s'", type);
@@ -1768,6 +2172,8 @@ static purc_variant_t cursor_fetchone_getter(purc_variant_t root,
     purc_variant_type result_type = PURC_VARIANT_TYPE_TUPLE;
     purc_variant_t name_mapping = PURC_VARIANT_INVALID;
     purc_variant_t type_conversion = PURC_VARIANT_INVALID;
+    purc_variant_t *keys = NULL;
+    int nr_keys = 0;
     purc_variant_t val;
 
     struct dvobj_sqlite_cursor *cursor = get_cursor_from_root(root);
@@ -1775,14 +2181,19 @@ static purc_variant_t cursor_fetchone_getter(purc_variant_t root,
         goto failed;
     }
 
-    int rc = parse_fetch_params(nr_args, argv, &result_type, &name_mapping,
-            &type_conversion);
+    int rc = parse_fetch_params(nr_args, argv, false, &result_type,
+            &name_mapping, &type_conversion);
     if (rc != 0) {
         goto failed;
     }
 
-    val = cursor_iterator_next(cursor, result_type, name_mapping,
-            type_conversion);
+    if (result_type == PURC_VARIANT_TYPE_OBJECT &&
+            cursor_make_column_keys(cursor, name_mapping, &keys, &nr_keys)) {
+        goto failed;
+    }
+
+    val = cursor_iterator_next(cursor, result_type, keys, type_conversion);
+    free_column_keys(keys, nr_keys);
 
     return val;
 
@@ -1805,6 +2216,8 @@ static purc_variant_t cursor_fetchmany_getter(purc_variant_t root,
     purc_variant_type result_type = PURC_VARIANT_TYPE_TUPLE;
     purc_variant_t name_mapping = PURC_VARIANT_INVALID;
     purc_variant_t type_conversion = PURC_VARIANT_INVALID;
+    purc_variant_t *keys = NULL;
+    int nr_keys = 0;
     purc_variant_t val;
     uint64_t size = 0;
 
@@ -1838,14 +2251,18 @@ static purc_variant_t cursor_fetchmany_getter(purc_variant_t root,
         goto out;
     }
 
-    int rc = parse_fetch_params(nr_args - 1, argv + 1, &result_type,
+    int rc = parse_fetch_params(nr_args - 1, argv + 1, false, &result_type,
             &name_mapping, &type_conversion);
     if (rc != 0) {
         goto failed;
     }
 
-    val = cursor_iterator_next(cursor, result_type, name_mapping,
-            type_conversion);
+    if (result_type == PURC_VARIANT_TYPE_OBJECT &&
+            cursor_make_column_keys(cursor, name_mapping, &keys, &nr_keys)) {
+        goto failed;
+    }
+
+    val = cursor_iterator_next(cursor, result_type, keys, type_conversion);
 
     if (!val || purc_variant_is_null(val)) {
         goto out;
@@ -1861,8 +2278,7 @@ static purc_variant_t cursor_fetchmany_getter(purc_variant_t root,
 
     size--;
     while (size != 0) {
-        val = cursor_iterator_next(cursor, result_type, name_mapping,
-             type_conversion);
+        val = cursor_iterator_next(cursor, result_type, keys, type_conversion);
         if (!val || purc_variant_is_null(val)) {
             break;
         }
@@ -1873,9 +2289,11 @@ static purc_variant_t cursor_fetchmany_getter(purc_variant_t root,
     val = arr_val;
 
 out:
+    free_column_keys(keys, nr_keys);
     return val;
 
 failed:
+    free_column_keys(keys, nr_keys);
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY) {
         return purc_variant_make_undefined();
     }
@@ -1894,6 +2312,8 @@ static purc_variant_t cursor_fetchall_getter(purc_variant_t root,
     purc_variant_type result_type = PURC_VARIANT_TYPE_TUPLE;
     purc_variant_t name_mapping = PURC_VARIANT_INVALID;
     purc_variant_t type_conversion = PURC_VARIANT_INVALID;
+    purc_variant_t *keys = NULL;
+    int nr_keys = 0;
     purc_variant_t val;
 
     struct dvobj_sqlite_cursor *cursor = get_cursor_from_root(root);
@@ -1901,39 +2321,26 @@ static purc_variant_t cursor_fetchall_getter(purc_variant_t root,
         goto failed;
     }
 
-    int rc = parse_fetch_params(nr_args, argv, &result_type, &name_mapping,
-            &type_conversion);
+    int rc = parse_fetch_params(nr_args, argv, true, &result_type,
+            &name_mapping, &type_conversion);
     if (rc != 0) {
         goto failed;
     }
 
-    val = cursor_iterator_next(cursor, result_type, name_mapping,
-            type_conversion);
-
-    if (!val || purc_variant_is_null(val)) {
-        goto out;
-    }
-
-    purc_variant_t arr_val = purc_variant_make_array(1, val);
-    if (!arr_val) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        purc_variant_unref(val);
+    if (result_type != PURC_VARIANT_TYPE_TUPLE &&
+            cursor_make_column_keys(cursor, name_mapping, &keys, &nr_keys)) {
         goto failed;
     }
-    purc_variant_unref(val);
 
-    while (true) {
-        val = cursor_iterator_next(cursor, result_type, name_mapping,
-             type_conversion);
-        if (!val || purc_variant_is_null(val)) {
-            break;
-        }
-        purc_variant_array_append(arr_val, val);
-        purc_variant_unref(val);
+    if (result_type == PURC_VARIANT_TYPE_ARRAY) {
+        val = cursor_fetch_all_columns(cursor, keys, type_conversion);
+    }
+    else {
+        val = cursor_fetch_all_rows(cursor, result_type, keys,
+                type_conversion);
     }
-    val = arr_val;
 
-out:
+    free_column_keys(keys, nr_keys);
     return val;
 
 failed:
@@ -1970,11 +2377,7 @@ static purc_variant_t cursor_close_getter(purc_variant_t root,
         goto out;
     }
 
-    if (cursor->st) {
-        sqlite3_reset(cursor->st);
-        sqlite3_finalize(cursor->st);
-        cursor->st = NULL;
-    }
+    cursor_release_st(cursor);
 
     cursor->closed = true;
     ret = true;
@@ -2133,6 +2536,7 @@ create_connection(struct dvobj_sqlite_info *sqlite_info, const char *db_name,
     }
 
     connection->db = db;
+    list_head_init(&connection->stmt_cache);
 
     return connection;
 
@@ -2152,6 +2556,7 @@ static bool on_sqlite_connection_being_released(purc_variant_t src, pcvar_op_t o
     if (op == PCVAR_OPERATION_RELEASING) {
         struct dvobj_sqlite_connection *connection = ctxt;
         purc_variant_revoke_listener(src, connection->listener);
+        conn_clear_stmt_cache(connection);
         if (connection->db) {
             sqlite3_close_v2(connection->db);
         }
@@ -2290,6 +2695,9 @@ static purc_variant_t conn_close_getter(purc_variant_t root,
         goto out;
     }
 
+    /* the statements must be finalized before closing the database */
+    conn_clear_stmt_cache(conn);
+
     int rc = sqlite3_close_v2(conn->db);
     if (rc == SQLITE_OK) {
         ret = true;
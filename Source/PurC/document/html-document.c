@@ -250,93 +250,356 @@ failed:
     return root;
 }
 
-static void
-dom_append_subtree_to_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+/*
+ * The fast path for the fragments which the HTML parser would turn into
+ * the same nodes without any adjustment: plain text, and well-nested
+ * sequences of the following elements in the "in body" insertion mode.
+ * The nodes are built directly under a detached holder element; the
+ * fragment is handed to the parser if anything else is found.
+ */
+
+#define MAX_SIMPLE_TAG_LEN      10
+#define MAX_SIMPLE_ATTR_LEN     64
+#define MAX_SIMPLE_DEPTH        32
+
+/* sorted for bsearch() */
+static const char *simple_tags[] = {
+    "abbr", "article", "aside", "b", "bdi", "bdo", "br", "cite", "code",
+    "data", "del", "dfn", "div", "em", "figcaption", "figure", "footer",
+    "header", "hr", "i", "img", "ins", "kbd", "label", "main", "mark",
+    "nav", "q", "s", "samp", "section", "small", "span", "strong", "sub",
+    "sup", "time", "u", "var", "wbr",
+};
+
+static inline bool
+is_void_simple_tag(const char *tag)
 {
-    pcdom_node_t *parent = pcdom_interface_node(element);
+    return strcmp(tag, "br") == 0 || strcmp(tag, "hr") == 0 ||
+        strcmp(tag, "img") == 0 || strcmp(tag, "wbr") == 0;
+}
+
+static int
+cmp_simple_tag(const void *key, const void *item)
+{
+    return strcmp((const char *)key, *(const char **)item);
+}
+
+/* The parent elements in which the tokenizer or the tree builder does not
+   work in the "in body" way. */
+static bool
+is_simple_context(pcdom_element_t *parent)
+{
+    pcdom_node_t *node = pcdom_interface_node(parent);
+    if (node->ns != PCHTML_NS_HTML)
+        return false;
+
+    switch (node->local_name) {
+    case PCHTML_TAG_HTML:
+    case PCHTML_TAG_HEAD:
+    case PCHTML_TAG_FRAMESET:
+    case PCHTML_TAG_TEMPLATE:
+    case PCHTML_TAG_SCRIPT:
+    case PCHTML_TAG_STYLE:
+    case PCHTML_TAG_TEXTAREA:
+    case PCHTML_TAG_TITLE:
+    case PCHTML_TAG_XMP:
+    case PCHTML_TAG_IFRAME:
+    case PCHTML_TAG_NOEMBED:
+    case PCHTML_TAG_NOFRAMES:
+    case PCHTML_TAG_NOSCRIPT:
+    case PCHTML_TAG_PLAINTEXT:
+    case PCHTML_TAG_SELECT:
+    case PCHTML_TAG_OPTGROUP:
+    case PCHTML_TAG_OPTION:
+    case PCHTML_TAG_TABLE:
+    case PCHTML_TAG_CAPTION:
+    case PCHTML_TAG_COLGROUP:
+    case PCHTML_TAG_TBODY:
+    case PCHTML_TAG_THEAD:
+    case PCHTML_TAG_TFOOT:
+    case PCHTML_TAG_TR:
+        return false;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+static inline bool
+is_html_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\f';
+}
+
+/* The characters which the tokenizer replaces or decodes. */
+static inline bool
+is_special_char(char c)
+{
+    return c == '&' || c == '\r' || c == '\0';
+}
+
+/* Copies the lowercase name to @buf; returns the length or 0 if the name
+   is not a simple one. */
+static size_t
+scan_simple_name(const char **p, const char *end, char *buf, size_t sz,
+        bool attr)
+{
+    const char *q = *p;
+    size_t len = 0;
+
+    while (q < end) {
+        char c = *q;
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        else if (!((c >= 'a' && c <= 'z') || (len > 0 && c >= '0' && c <= '9')
+                    || (attr && len > 0 && (c == '-' || c == '_' ||
+                            c == ':' || c == '.'))))
+            break;
+
+        if (len + 1 >= sz)
+            return 0;
+        buf[len++] = c;
+        q++;
+    }
+
+    buf[len] = 0;
+    *p = q;
+    return len;
+}
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
+/* Scans the attributes till the end of a start tag; returns 1 for `>`,
+   2 for `/>`, or 0 for anything not simple. */
+static int
+build_simple_attrs(pcdom_element_t *elem, const char **p, const char *end)
+{
+    const char *q = *p;
+    char name[MAX_SIMPLE_ATTR_LEN];
+
+    while (true) {
+        while (q < end && is_html_space(*q))
+            q++;
+        if (q >= end)
+            return 0;
+
+        if (*q == '>') {
+            *p = q + 1;
+            return 1;
+        }
+        if (*q == '/') {
+            if (q + 1 < end && q[1] == '>') {
+                *p = q + 2;
+                return 2;
+            }
+            return 0;
+        }
+
+        size_t name_len = scan_simple_name(&q, end, name, sizeof(name), true);
+        if (name_len == 0)
+            return 0;
+
+        while (q < end && is_html_space(*q))
+            q++;
 
-        while (div->first_child) {
-            pcdom_node_t *child = div->first_child;
-            pcdom_node_remove(child);
-            pcdom_node_append_child(parent, child);
+        const char *value = "";
+        size_t value_len = 0;
+        if (q < end && *q == '=') {
+            q++;
+            while (q < end && is_html_space(*q))
+                q++;
+            if (q >= end)
+                return 0;
+
+            if (*q == '"' || *q == '\'') {
+                char quote = *q++;
+                value = q;
+                while (q < end && *q != quote) {
+                    if (is_special_char(*q))
+                        return 0;
+                    q++;
+                }
+                if (q >= end)
+                    return 0;
+                value_len = q - value;
+                q++;
+            }
+            else {
+                value = q;
+                while (q < end && !is_html_space(*q) && *q != '>') {
+                    if (is_special_char(*q) || *q == '"' || *q == '\'' ||
+                            *q == '<' || *q == '=' || *q == '`')
+                        return 0;
+                    q++;
+                }
+                value_len = q - value;
+                if (value_len == 0)
+                    return 0;
+            }
         }
+
+        /* like the parser, ignore the duplicate attributes */
+        if (!pcdom_element_has_attribute(elem,
+                    (const unsigned char *)name, name_len) &&
+                !pcdom_element_set_attribute(elem,
+                    (const unsigned char *)name, name_len,
+                    (const unsigned char *)value, value_len))
+            return 0;
     }
+}
+
+static pcdom_node_t *
+dom_build_simple_fragment(pcdom_document_t *dom_doc,
+        pcdom_element_t *parent, const char *fragment, size_t length)
+{
+    if (!is_simple_context(parent))
+        return NULL;
 
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
+    pcdom_element_t *holder;
+    holder = pcdom_document_create_element(dom_doc,
+            (const unsigned char *)"div", 3, NULL, false);
+    if (holder == NULL)
+        return NULL;
+
+    pcdom_node_t *stack[MAX_SIMPLE_DEPTH];
+    const char *tags[MAX_SIMPLE_DEPTH];
+    size_t depth = 1;
+    stack[0] = pcdom_interface_node(holder);
+    tags[0] = NULL;
+
+    const char *p = fragment;
+    const char *end = fragment + length;
+    char tag[MAX_SIMPLE_TAG_LEN + 1];
+
+    while (p < end) {
+        if (*p != '<') {
+            const char *text = p;
+            while (p < end && *p != '<') {
+                if (is_special_char(*p))
+                    goto failed;
+                p++;
+            }
+
+            pcdom_text_t *text_node;
+            text_node = pcdom_document_create_text_node(dom_doc,
+                    (const unsigned char *)text, p - text);
+            if (text_node == NULL)
+                goto failed;
+            pcdom_node_append_child(stack[depth - 1],
+                    pcdom_interface_node(text_node));
+            continue;
+        }
+
+        p++;
+        bool end_tag = false;
+        if (p < end && *p == '/') {
+            end_tag = true;
+            p++;
+        }
+
+        if (scan_simple_name(&p, end, tag, sizeof(tag), false) == 0)
+            goto failed;
+
+        const char **found = bsearch(tag, simple_tags,
+                PCA_TABLESIZE(simple_tags), sizeof(simple_tags[0]),
+                cmp_simple_tag);
+        if (found == NULL)
+            goto failed;
+
+        if (end_tag) {
+            if (p >= end || *p != '>' || depth == 1 ||
+                    tags[depth - 1] != *found)
+                goto failed;
+            p++;
+            depth--;
+            continue;
+        }
+
+        bool is_void = is_void_simple_tag(*found);
+        pcdom_element_t *elem;
+        elem = pcdom_document_create_element(dom_doc,
+                (const unsigned char *)*found, strlen(*found), NULL, is_void);
+        if (elem == NULL)
+            goto failed;
+        pcdom_node_append_child(stack[depth - 1], pcdom_interface_node(elem));
+
+        int ret = build_simple_attrs(elem, &p, end);
+        /* the parser ignores `/>` of a non-void element */
+        if (ret == 0 || (ret == 2 && !is_void))
+            goto failed;
+
+        if (!is_void) {
+            if (depth >= MAX_SIMPLE_DEPTH)
+                goto failed;
+            stack[depth] = pcdom_interface_node(elem);
+            tags[depth] = *found;
+            depth++;
+        }
+    }
+
+    if (depth == 1)
+        return pcdom_interface_node(holder);
+
+failed:
+    pcdom_node_destroy_deep(pcdom_interface_node(holder));
+    return NULL;
 }
 
+/* The following operations move the children of @holder. */
 static void
-dom_prepend_subtree_to_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+dom_append_subtree_to_element(pcdom_element_t *element,
+        pcdom_node_t *holder)
 {
     pcdom_node_t *parent = pcdom_interface_node(element);
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->last_child) {
-            pcdom_node_t *child = div->last_child;
-            pcdom_node_remove(child);
-            pcdom_node_prepend_child(parent, child);
-        }
+    while (holder->first_child) {
+        pcdom_node_t *child = holder->first_child;
+        pcdom_node_remove(child);
+        pcdom_node_append_child(parent, child);
     }
+}
 
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
+static void
+dom_prepend_subtree_to_element(pcdom_element_t *element,
+        pcdom_node_t *holder)
+{
+    pcdom_node_t *parent = pcdom_interface_node(element);
+
+    while (holder->last_child) {
+        pcdom_node_t *child = holder->last_child;
+        pcdom_node_remove(child);
+        pcdom_node_prepend_child(parent, child);
+    }
 }
 
 static void
 dom_insert_subtree_before_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *to = pcdom_interface_node(element);
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->last_child) {
-            pcdom_node_t *child = div->last_child;
-            pcdom_node_remove(child);
-            pcdom_node_insert_before(to, child);
-        }
+    while (holder->last_child) {
+        pcdom_node_t *child = holder->last_child;
+        pcdom_node_remove(child);
+        pcdom_node_insert_before(to, child);
     }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
 }
 
 static void
 dom_insert_subtree_after_element(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *to = pcdom_interface_node(element);
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->first_child) {
-            pcdom_node_t *child = div->first_child;
-            pcdom_node_remove(child);
-            pcdom_node_insert_after(to, child);
-        }
+    while (holder->first_child) {
+        pcdom_node_t *child = holder->first_child;
+        pcdom_node_remove(child);
+        pcdom_node_insert_after(to, child);
     }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
 }
 
 static void
 dom_displace_content_by_subtree(pcdom_element_t *element,
-        pcdom_node_t *subtree)
+        pcdom_node_t *holder)
 {
     pcdom_node_t *parent = pcdom_interface_node(element);
 
@@ -344,23 +607,11 @@ dom_displace_content_by_subtree(pcdom_element_t *element,
         pcdom_node_destroy_deep(parent->first_child);
     }
 
-    if (subtree && subtree->first_child) {
-        pcdom_node_t *div;
-        div = subtree->first_child;
-
-        while (div->first_child) {
-            pcdom_node_t *child = div->first_child;
-            pcdom_node_remove(child);
-            pcdom_node_append_child(parent, child);
-        }
-    }
-
-    if (subtree)
-        pcdom_node_destroy_deep(subtree);
+    dom_append_subtree_to_element(element, holder);
 }
 
 typedef void (*dom_subtree_op)(pcdom_element_t *element,
-        pcdom_node_t *subtree);
+        pcdom_node_t *holder);
 
 static const dom_subtree_op dom_subtree_ops[] = {
     dom_append_subtree_to_element,
@@ -375,30 +626,41 @@ static pcdoc_node new_content(purc_document_t doc,
             const char *content, size_t length)
 {
     pcdoc_node node;
+    node.type = PCDOC_NODE_VOID;
+    node.elem = NULL;
 
     if (UNLIKELY(op >= PCA_TABLESIZE(dom_subtree_ops))) {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
-        node.type = PCDOC_NODE_VOID;
-        node.elem = NULL;
         goto done;
     }
 
+    if (length == 0)
+        length = strlen(content);
+
     pcdom_document_t *dom_doc = pcdom_interface_document(doc->impl);
     pcdom_element_t *dom_elem = pcdom_interface_element(elem);
-    pcdom_node_t *subtree = dom_parse_fragment(dom_doc, dom_elem,
-            content, length ? length : strlen(content));
-
-    pcdom_node_t *dom_node = subtree->first_child->first_child;
 
-    if (subtree) {
-        dom_subtree_ops[op](dom_elem, subtree);
-    }
-    else {
-        purc_set_error(PURC_ERROR_INVALID_VALUE);
+    /* the subtree is the root element returned by the parser,
+       and the holder is the `div` wrapping the fragment in it. */
+    pcdom_node_t *subtree = NULL;
+    pcdom_node_t *holder = dom_build_simple_fragment(dom_doc, dom_elem,
+            content, length);
+    if (holder == NULL) {
+        subtree = dom_parse_fragment(dom_doc, dom_elem, content, length);
+        if (subtree == NULL || subtree->first_child == NULL) {
+            if (subtree)
+                pcdom_node_destroy_deep(subtree);
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            goto done;
+        }
+        holder = subtree->first_child;
     }
 
     node.type = PCDOC_NODE_ELEMENT;
-    node.elem = (pcdoc_element_t)dom_node;
+    node.elem = (pcdoc_element_t)holder->first_child;
+    dom_subtree_ops[op](dom_elem, holder);
+
+    pcdom_node_destroy_deep(subtree ? subtree : holder);
 
 done:
     return node;
@@ -655,10 +917,26 @@ static pcdoc_node prev_sibling(purc_document_t doc, pcdoc_node node)
     return prev;
 }
 
+/*
+ * The caches for the children are changed by the readers, so they are not
+ * used if the document is shared by multiple threads.
+ */
+static inline bool
+use_children_caches(purc_document_t doc)
+{
+    return doc->rwlock.native_impl == NULL;
+}
+
 static int children_count(purc_document_t doc, pcdoc_element_t elem,
         size_t *nrs)
 {
-    UNUSED_PARAM(doc);
+    struct pcdoc_children_counts *counts = &doc->children_counts;
+    bool use_cache = use_children_caches(doc);
+
+    if (use_cache && counts->parent == elem && counts->age == doc->age) {
+        memcpy(nrs, counts->nrs, sizeof(counts->nrs));
+        return 0;
+    }
 
     pcdom_node_t *dom_node = pcdom_interface_node(elem);
     pcdom_node_t *child = dom_node->first_child;
@@ -679,6 +957,12 @@ static int children_count(purc_document_t doc, pcdoc_element_t elem,
         child = child->next;
     }
 
+    if (use_cache) {
+        counts->age = doc->age;
+        counts->parent = elem;
+        memcpy(counts->nrs, nrs, sizeof(counts->nrs));
+    }
+
     return 0;
 }
 
@@ -700,31 +984,63 @@ node_type(pcdom_node_type_t type)
     return PCDOC_NODE_OTHERS;
 }
 
+/*
+ * The walk starts from the child accessed last time if it is nearer than
+ * the first child, so accessing the children by index in sequence (in both
+ * directions) costs O(1) for each child.
+ */
 static pcdoc_node
 get_child(purc_document_t doc,
             pcdoc_element_t elem, pcdoc_node_type_k type, size_t idx)
 {
-    UNUSED_PARAM(doc);
-
     pcdoc_node node;
     node.type = PCDOC_NODE_VOID;
     node.elem = NULL;
 
+    struct pcdoc_child_cursor *cursor = &doc->child_cursor;
+    bool use_cache = use_children_caches(doc);
+    bool backward = false;
+
     size_t i = 0;
     pcdom_node_t *dom_node = pcdom_interface_node(elem);
     pcdom_node_t *child = dom_node->first_child;
+
+    if (use_cache && cursor->parent == elem && cursor->type == type &&
+            cursor->age == doc->age) {
+        if (idx >= cursor->idx) {
+            child = cursor->child;
+            i = cursor->idx;
+        }
+        else if (cursor->idx - idx < idx) {
+            child = cursor->child;
+            i = cursor->idx;
+            backward = true;
+        }
+    }
+
     while (child) {
         if (node_type(child->type) == type) {
             if (i == idx) {
                 node.type = type;
                 node.elem = (pcdoc_element_t)child;
-                return node;
+                break;
             }
 
-            i++;
+            if (backward)
+                i--;
+            else
+                i++;
         }
 
-        child = child->next;
+        child = backward ? child->prev : child->next;
+    }
+
+    if (use_cache && child) {
+        cursor->age = doc->age;
+        cursor->parent = elem;
+        cursor->type = type;
+        cursor->idx = idx;
+        cursor->child = child;
     }
 
     return node;
@@ -777,6 +777,211 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/* the names of the resources used by `usage` and `limits` */
+static const char *resource_names[CO_RESOURCE_NR] = {
+    "cpuTime",
+    "memory",
+    "messages",
+    "observers",
+};
+
+static int
+resource_from_name(const char *name)
+{
+    for (int res = 0; res < CO_RESOURCE_NR; res++) {
+        if (strcmp(name, resource_names[res]) == 0)
+            return res;
+    }
+
+    return -1;
+}
+
+/* set a property and release the value; the value may be invalid */
+static bool
+set_property(purc_variant_t obj, const char *key, purc_variant_t val)
+{
+    if (val == PURC_VARIANT_INVALID)
+        return false;
+
+    bool ok = purc_variant_object_set_by_static_ckey(obj, key, val);
+    purc_variant_unref(val);
+    return ok;
+}
+
+static inline double
+timespec_to_seconds(const struct timespec *ts)
+{
+    return (double)ts->tv_sec + (double)ts->tv_nsec / 1000000000.0;
+}
+
+purc_variant_t
+pcdvobjs_coroutine_usage(struct pcintr_coroutine *cor)
+{
+    pcintr_stack_t stack = &cor->stack;
+
+    purc_variant_t retv = purc_variant_make_object_0();
+    if (retv == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_property(retv, "steps",
+                purc_variant_make_ulongint(stack->nr_steps)) ||
+            !set_property(retv, "cpuTime", purc_variant_make_number(
+                    timespec_to_seconds(&stack->time_executed))) ||
+            !set_property(retv, "maxStepTime", purc_variant_make_number(
+                    timespec_to_seconds(&stack->time_max_step))) ||
+            !set_property(retv, "memory", purc_variant_make_ulongint(
+                    pcintr_coroutine_get_usage(cor, CO_RESOURCE_MEMORY))) ||
+            !set_property(retv, "peakMemory",
+                purc_variant_make_ulongint(stack->peak_mem_use)) ||
+            !set_property(retv, "messages", purc_variant_make_ulongint(
+                    pcintr_coroutine_get_usage(cor, CO_RESOURCE_MESSAGES))) ||
+            !set_property(retv, "observers", purc_variant_make_ulongint(
+                    pcintr_coroutine_get_usage(cor, CO_RESOURCE_OBSERVERS)))) {
+        purc_variant_unref(retv);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return retv;
+}
+
+static purc_variant_t
+usage_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+    UNUSED_PARAM(call_flags);
+
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    return pcdvobjs_coroutine_usage(cor);
+}
+
+/* the CPU time limits are in seconds, and the others are counts */
+static purc_variant_t
+make_limit_value(int res, uint64_t limit)
+{
+    if (res == CO_RESOURCE_CPU_TIME)
+        return purc_variant_make_number(limit / 1000000000.0);
+    return purc_variant_make_ulongint(limit);
+}
+
+static bool
+cast_to_limit(int res, purc_variant_t val, uint64_t *limit)
+{
+    if (res == CO_RESOURCE_CPU_TIME) {
+        double seconds;
+        if (!purc_variant_cast_to_number(val, &seconds, false) ||
+                seconds < 0 || seconds >= UINT64_MAX / 1000000000.0)
+            return false;
+
+        *limit = (uint64_t)(seconds * 1000000000.0);
+        return true;
+    }
+
+    return purc_variant_cast_to_ulongint(val, limit, false);
+}
+
+static purc_variant_t
+make_limit(pcintr_coroutine_t cor, int res)
+{
+    purc_variant_t retv = purc_variant_make_object_0();
+    if (retv == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    if (!set_property(retv, "soft",
+                make_limit_value(res, cor->limits[res].soft)) ||
+            !set_property(retv, "hard",
+                make_limit_value(res, cor->limits[res].hard))) {
+        purc_variant_unref(retv);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return retv;
+}
+
+static purc_variant_t
+limits_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    purc_variant_t retv = PURC_VARIANT_INVALID;
+
+    if (nr_args > 0) {
+        const char *name = purc_variant_get_string_const(argv[0]);
+        if (name == NULL) {
+            purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+            goto failed;
+        }
+
+        int res = resource_from_name(name);
+        if (res < 0) {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            goto failed;
+        }
+
+        return make_limit(cor, res);
+    }
+
+    retv = purc_variant_make_object_0();
+    if (retv == PURC_VARIANT_INVALID)
+        goto failed;
+
+    for (int res = 0; res < CO_RESOURCE_NR; res++) {
+        if (!set_property(retv, resource_names[res], make_limit(cor, res)))
+            goto failed;
+    }
+
+    return retv;
+
+failed:
+    if (retv)
+        purc_variant_unref(retv);
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_undefined();
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+limits_setter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    if (nr_args < 2) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    const char *name = purc_variant_get_string_const(argv[0]);
+    if (name == NULL) {
+        purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        goto failed;
+    }
+
+    int res = resource_from_name(name);
+    if (res < 0) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto failed;
+    }
+
+    uint64_t soft, hard = 0;
+    if (!cast_to_limit(res, argv[1], &soft) ||
+            (nr_args > 2 && !cast_to_limit(res, argv[2], &hard)) ||
+            (soft && hard && soft > hard)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto failed;
+    }
+
+    pcintr_coroutine_t cor = hvml_ctrl_coroutine(root);
+    cor->limits[res].soft = soft;
+    cor->limits[res].hard = hard;
+    cor->soft_limits_hit &= ~(1U << res);
+    return purc_variant_make_boolean(true);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_nvariant_method
 temp_property_getter(void* native_entity, const char* property_name)
 {
@@ -834,6 +1039,8 @@ purc_dvobj_coroutine_new(pcintr_coroutine_t cor)
         { "uri",     uri_getter,     NULL },
         { "token",   token_getter,   token_setter },
         { "curator", curator_getter, NULL },
+        { "usage",   usage_getter,   NULL },
+        { "limits",  limits_getter,  limits_setter },
     };
 
     retv = purc_dvobj_make_from_methods(method, PCA_TABLESIZE(method));
@@ -37,6 +37,7 @@
 #include "helper.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <glib.h>
 #include <regex.h>
@@ -886,6 +887,8 @@ enum {
     K_KW_no_trailing_zero,
 #define _KW_no_slash_escape     "no-slash-escape"
     K_KW_no_slash_escape,
+#define _KW_real_shortest       "real-shortest"
+    K_KW_real_shortest,
 };
 
 static struct keyword_to_atom {
@@ -909,12 +912,13 @@ static struct keyword_to_atom {
     { _KW_bigint_hex,       PCVRNT_SERIALIZE_OPT_BIGINT_HEX, 0 },
     { _KW_no_trailing_zero, PCVRNT_SERIALIZE_OPT_NOZERO, 0 },
     { _KW_no_slash_escape,  PCVRNT_SERIALIZE_OPT_NOSLASHESCAPE, 0 },
+    { _KW_real_shortest,    PCVRNT_SERIALIZE_OPT_REAL_SHORTEST, 0 },
 };
 
 /*
 $DATA.serialize(
     < any $data >
-    [, < '[ [real-json | real-ejson] || [ runtime-null | runtime-string ] || plain || spaced || pretty || pretty_tab || [bseq-hex-string | bseq-hex | bseq-bin | bseq-bin-dots | bseq-base64 | bigint-hex] || no-trailing-zero || no-slash-escape] | default' $options = `'default'`:
+    [, < '[ [real-json | real-ejson] || [ runtime-null | runtime-string ] || plain || spaced || pretty || pretty_tab || [bseq-hex-string | bseq-hex | bseq-bin | bseq-bin-dots | bseq-base64 | bigint-hex] || no-trailing-zero || no-slash-escape || real-shortest] | default' $options = `'default'`:
         - 'real-json':          `Use JSON notation for real numbers, i.e., treat number, longint, ulongint, and longdouble as JSON number, while bigint as string.`
         - 'real-ejson':         `Use eJSON notation for longint, ulongint, and longdouble, e.g., 100L, 999UL, and 100FL.`
         - 'runtime-null':       `Treat all HVML-specific runtime types as null, i.e., undefined, dynamic, and native values will be serialized as null.`
@@ -931,6 +935,7 @@ $DATA.serialize(
         - 'bigint-hex':         `Use hexadecimal form to serialize bigint.`
         - 'no-trailing-zero':   `Drop trailing zero for float values.`
         - 'no-slash-escape':    `Do not escape the forward slashes ('/').`
+        - 'real-shortest':      `Use the shortest form which can recover the original value for real numbers.`
         - 'default':            `Equivalent to 'real-json runtime-string plain bseq-hex-string no-slash-escape'`
        >
         [,
@@ -2601,6 +2606,62 @@ static void map_free_val(void *val)
     pcutils_map_destroy(sort_arg.map);
 #endif
 
+/*
+ * Sorts the members by the number or the (case-folded) string extracted
+ * once from each member. For the auto method, this is only possible when
+ * all members are numbers (excluding bigint), or none of them is a number.
+ * Returns non-zero if the members are not sorted.
+ */
+static int
+sort_by_typed_keys(purc_variant_t container, uintptr_t sort_opt)
+{
+    pcvrnt_compare_method_k method;
+    bool by_number;
+
+    method = (pcvrnt_compare_method_k)(sort_opt & PCVRNT_CMPOPT_MASK);
+    if (method == PCVRNT_COMPARE_METHOD_AUTO) {
+        size_t nr = 0, nr_numbers = 0;
+
+        purc_variant_linear_container_size(container, &nr);
+        for (size_t i = 0; i < nr; i++) {
+            purc_variant_t member;
+            member = purc_variant_linear_container_get(container, i);
+            switch (purc_variant_get_type(member)) {
+            case PURC_VARIANT_TYPE_BIGINT:
+                return -1;
+
+            case PURC_VARIANT_TYPE_NUMBER:
+            case PURC_VARIANT_TYPE_LONGINT:
+            case PURC_VARIANT_TYPE_ULONGINT:
+            case PURC_VARIANT_TYPE_LONGDOUBLE:
+                nr_numbers++;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        if (nr_numbers != 0 && nr_numbers != nr)
+            return -1;
+        by_number = (nr_numbers != 0);
+    }
+    else {
+        by_number = (method == PCVRNT_COMPARE_METHOD_NUMBER);
+    }
+
+    struct pcvariant_sort_spec spec = {
+        .nr_keys            = 1,
+        .by_number          = &by_number,
+        .ascendingly        = !(sort_opt & PCVRNT_SORT_DESC),
+        .casesensitively    = (method != PCVRNT_COMPARE_METHOD_CASELESS),
+        .get_key            = NULL,
+        .ud                 = NULL,
+    };
+
+    return pcvariant_sort_by_keys(container, &spec);
+}
+
 static purc_variant_t
 sort_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
@@ -2707,12 +2768,14 @@ sort_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         }
     }
 
-    /* use the default variant comparison function */
-    if (purc_variant_is_array(argv[0])) {
-        pcvariant_array_sort(argv[0], (void *)sort_opt, NULL);
-    }
-    else {
-        pcvariant_set_sort(argv[0], (void *)sort_opt, NULL);
+    if (sort_by_typed_keys(argv[0], sort_opt)) {
+        /* use the default variant comparison function */
+        if (purc_variant_is_array(argv[0])) {
+            pcvariant_array_sort(argv[0], (void *)sort_opt, NULL);
+        }
+        else {
+            pcvariant_set_sort(argv[0], (void *)sort_opt, NULL);
+        }
     }
 
 done:
@@ -2725,6 +2788,78 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * Feeds the bytes of a variant to a digest engine. The bytes of a byte
+ * sequence or a string are fed directly, the data of a readable stream
+ * entity (e.g., a file opened by $STREAM.open) are read and fed chunk by
+ * chunk, and other variants are stringified.
+ */
+#define SZ_DIGEST_CHUNK         (1024 * 64)
+
+static int
+digest_variant(purc_variant_t v, void *ctxt, pcrws_cb_write update)
+{
+    const void *bytes = NULL;
+    size_t nr_bytes = 0;
+
+    if (purc_variant_is_bsequence(v)) {
+        bytes = purc_variant_get_bytes_const(v, &nr_bytes);
+    }
+    else if (purc_variant_is_string(v)) {
+        bytes = purc_variant_get_string_const_ex(v, &nr_bytes);
+    }
+
+    if (bytes) {
+        update(ctxt, bytes, nr_bytes);
+        return 0;
+    }
+
+    pcdvobjs_stream *stream_ett = dvobjs_stream_check_entity(v, NULL);
+    if (stream_ett) {
+        if (stream_ett->stm4r == NULL) {
+            purc_set_error(PURC_ERROR_NOT_DESIRED_ENTITY);
+            return -1;
+        }
+
+        char *buf = malloc(SZ_DIGEST_CHUNK);
+        if (buf == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+
+        ssize_t nr_read;
+        while ((nr_read = purc_rwstream_read(stream_ett->stm4r, buf,
+                        SZ_DIGEST_CHUNK)) > 0) {
+            update(ctxt, buf, nr_read);
+        }
+        free(buf);
+
+        if (nr_read < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                purc_set_error(PURC_ERROR_AGAIN);
+            else
+                purc_set_error(PURC_ERROR_IO_FAILURE);
+            return -1;
+        }
+        return 0;
+    }
+
+    purc_rwstream_t stream = purc_rwstream_new_for_dump(ctxt, update);
+    if (stream == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    int ret = 0;
+    if (purc_variant_stringify(stream, v,
+            PCVRNT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
+        ret = -1;
+    }
+
+    purc_rwstream_destroy(stream);
+    return ret;
+}
+
 static struct crc32algo_to_atom {
     const char *    algo;
     purc_atom_t     atom;
@@ -2755,8 +2890,6 @@ crc32_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 {
     UNUSED_PARAM(root);
 
-    purc_rwstream_t stream = NULL;
-
     if (nr_args == 0) {
         purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
         goto failed;
@@ -2820,24 +2953,13 @@ crc32_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     }
 
     pcutils_crc32_ctxt ctxt;
-    stream = purc_rwstream_new_for_dump(&ctxt, cb_calc_crc32);
-    if (stream == NULL) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto fatal;
-    }
-
     pcutils_crc32_begin(&ctxt, algo);
-
-    if (purc_variant_stringify(stream, argv[0],
-            PCVRNT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
-        goto fatal;
+    if (digest_variant(argv[0], &ctxt, cb_calc_crc32)) {
+        goto failed;
     }
 
-    purc_rwstream_destroy(stream);
-
     uint32_t crc32;
     pcutils_crc32_end(&ctxt, &crc32);
-    purc_log_info("%08x\n", crc32);
 
     switch (ret_type) {
         case PURC_K_KW_ulongint:
@@ -2859,9 +2981,6 @@ failed:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
         return purc_variant_make_undefined();
 
-fatal:
-    if (stream)
-        purc_rwstream_destroy(stream);
     return PURC_VARIANT_INVALID;
 }
 
@@ -2878,8 +2997,6 @@ md5_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 {
     UNUSED_PARAM(root);
 
-    purc_rwstream_t stream = NULL;
-
     if (nr_args == 0) {
         purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
         goto failed;
@@ -2905,20 +3022,11 @@ md5_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     }
 
     pcutils_md5_ctxt md5_ctxt;
-    stream = purc_rwstream_new_for_dump(&md5_ctxt, cb_calc_md5);
-    if (stream == NULL) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto fatal;
-    }
-
     pcutils_md5_begin(&md5_ctxt);
-    if (purc_variant_stringify(stream, argv[0],
-            PCVRNT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
-        goto fatal;
+    if (digest_variant(argv[0], &md5_ctxt, cb_calc_md5)) {
+        goto failed;
     }
 
-    purc_rwstream_destroy(stream);
-
     unsigned char md5[PCUTILS_MD5_DIGEST_SIZE];
     pcutils_md5_end(&md5_ctxt, md5);
 
@@ -2940,9 +3048,6 @@ failed:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
         return purc_variant_make_undefined();
 
-fatal:
-    if (stream)
-        purc_rwstream_destroy(stream);
     return PURC_VARIANT_INVALID;
 }
 
@@ -2959,8 +3064,6 @@ sha1_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 {
     UNUSED_PARAM(root);
 
-    purc_rwstream_t stream = NULL;
-
     if (nr_args == 0) {
         purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
         goto failed;
@@ -2986,20 +3089,11 @@ sha1_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     }
 
     pcutils_sha1_ctxt sha1_ctxt;
-    stream = purc_rwstream_new_for_dump(&sha1_ctxt, cb_calc_sha1);
-    if (stream == NULL) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto fatal;
-    }
-
     pcutils_sha1_begin(&sha1_ctxt);
-    if (purc_variant_stringify(stream, argv[0],
-            PCVRNT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
-        goto fatal;
+    if (digest_variant(argv[0], &sha1_ctxt, cb_calc_sha1)) {
+        goto failed;
     }
 
-    purc_rwstream_destroy(stream);
-
     unsigned char sha1[PCUTILS_SHA1_DIGEST_SIZE];
     pcutils_sha1_end(&sha1_ctxt, sha1);
 
@@ -3022,9 +3116,6 @@ failed:
     if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
         return purc_variant_make_undefined();
 
-fatal:
-    if (stream)
-        purc_rwstream_destroy(stream);
     return PURC_VARIANT_INVALID;
 }
 
@@ -215,6 +215,66 @@ uri_getter(purc_variant_t root,
     return purc_variant_make_string(inst->endpoint_name, false);
 }
 
+static bool
+append_coroutine_usage(purc_variant_t arr, pcintr_coroutine_t cor)
+{
+    purc_variant_t usage = pcdvobjs_coroutine_usage(cor);
+    if (usage == PURC_VARIANT_INVALID)
+        return false;
+
+    purc_variant_t cid = purc_variant_make_ulongint(cor->cid);
+    purc_variant_t token = purc_variant_make_string(cor->token, false);
+    bool ok = cid && token &&
+        purc_variant_object_set_by_static_ckey(usage, "cid", cid) &&
+        purc_variant_object_set_by_static_ckey(usage, "token", token) &&
+        purc_variant_array_append(arr, usage);
+
+    if (cid)
+        purc_variant_unref(cid);
+    if (token)
+        purc_variant_unref(token);
+    purc_variant_unref(usage);
+    return ok;
+}
+
+/* the resource usage of all coroutines in the runner */
+static purc_variant_t
+usage_getter(purc_variant_t root,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(root);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    struct pcinst* inst = pcinst_current();
+    struct pcintr_heap *heap = inst->intr_heap;
+
+    purc_variant_t retv = purc_variant_make_array_0();
+    if (retv == PURC_VARIANT_INVALID)
+        goto failed;
+
+    if (heap) {
+        pcintr_coroutine_t cor;
+        list_for_each_entry(cor, &heap->crtns, ln) {
+            if (!append_coroutine_usage(retv, cor))
+                goto failed;
+        }
+        list_for_each_entry(cor, &heap->stopped_crtns, ln) {
+            if (!append_coroutine_usage(retv, cor))
+                goto failed;
+        }
+    }
+
+    return retv;
+
+failed:
+    if (retv)
+        purc_variant_unref(retv);
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_undefined();
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t
 auto_switching_rdr_getter(purc_variant_t root,
         size_t nr_args, purc_variant_t *argv, unsigned call_flags)
@@ -282,6 +342,16 @@ chan_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
+    if (pcchan_is_shared_name(chan_name)) {
+        pcchan_shared_t chan = pcchan_shared_retrieve(chan_name);
+        if (chan) {
+            purc_variant_t retv = pcchan_shared_make_entity(chan);
+            pcchan_shared_unref(chan);
+            return retv;
+        }
+        goto failed;
+    }
+
     pcchan_t chan = pcchan_retrieve(chan_name);
     if (chan) {
         return pcchan_make_entity(chan);
@@ -322,6 +392,27 @@ chan_setter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 
     PC_DEBUG("chan_setter(%s, %u)\n", chan_name, cap);
 
+    if (pcchan_is_shared_name(chan_name)) {
+        pcchan_shared_t chan = pcchan_shared_retrieve(chan_name);
+        if (chan) {
+            bool ok = pcchan_shared_ctrl(chan, cap);
+            pcchan_shared_unref(chan);
+            if (!ok) {
+                // error set by pcchan_shared_ctrl()
+                goto failed;
+            }
+        }
+        else if ((chan = pcchan_shared_open(chan_name, cap))) {
+            pcchan_shared_unref(chan);
+        }
+        else {
+            // error set by pcchan_shared_open()
+            goto failed;
+        }
+
+        return purc_variant_make_boolean(true);
+    }
+
     pcchan_t chan = pcchan_retrieve(chan_name);
     if (chan) {
         if (!pcchan_ctrl(chan, cap)) {
@@ -665,6 +756,7 @@ purc_dvobj_runner_new(void)
         { "runLabel",           runner_label_getter,    NULL },
         { "rid",                rid_getter,             NULL },
         { "uri",                uri_getter,             NULL },
+        { "usage",              usage_getter,           NULL },
         { "autoSwitchingRdr",
             auto_switching_rdr_getter, auto_switching_rdr_setter },
         { "chan",               chan_getter,            chan_setter },
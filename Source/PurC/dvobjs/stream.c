@@ -157,6 +157,14 @@ enum {
     K_KW_peer_addr,
 #define _KW_peer_port               "peerPort"
     K_KW_peer_port,
+#define _KW_readjson                "readjson"
+    K_KW_readjson,
+#define _KW_auto                    "auto"
+    K_KW_auto,
+#define _KW_array                   "array"
+    K_KW_array,
+#define _KW_lines                   "lines"
+    K_KW_lines,
 };
 
 static struct keyword_to_atom {
@@ -204,6 +212,10 @@ static struct keyword_to_atom {
     { _KW_fd, 0},                   // "fd"
     { _KW_peer_addr, 0},            // "peerAddr"
     { _KW_peer_port, 0},            // "peerPort"
+    { _KW_readjson, 0},             // "readjson"
+    { _KW_auto, 0},                 // "auto"
+    { _KW_array, 0},                // "array"
+    { _KW_lines, 0},                // "lines"
 };
 
 static struct pcdvobjs_stream *
@@ -226,6 +238,11 @@ dvobjs_stream_new(enum pcdvobjs_stream_type type,
 
 static void native_stream_close(struct pcdvobjs_stream *stream)
 {
+    if (stream->json_reader) {
+        purc_variant_json_reader_delete(stream->json_reader);
+        stream->json_reader = NULL;
+    }
+
     if (stream->stm4r) {
         purc_rwstream_destroy(stream->stm4r);
     }
@@ -251,12 +268,6 @@ static void native_stream_close(struct pcdvobjs_stream *stream)
         }
     }
 
-    if (stream->fp) {
-        fclose(stream->fp);
-        stream->fp = NULL;
-        stream->fd4r = -1; /* fclose will close the file descriptor */
-    }
-
     if (stream->fd4r >= 0) {
         close(stream->fd4r);
     }
@@ -595,120 +606,126 @@ failed:
 
 #else
 
-static int read_lines(struct pcdvobjs_stream *entity, int line_num,
-        purc_variant_t array, const char *line_seperator)
+/* the lines are appended to the array in batches */
+#define NR_LINES_PER_BATCH  64
+
+struct line_batch {
+    purc_variant_t  array;
+    size_t          nr_lines;
+    purc_variant_t  lines[NR_LINES_PER_BATCH];
+};
+
+static int flush_lines(struct line_batch *batch)
 {
-    size_t total_ucs = 0;
-
-    if (entity->fp == NULL) {
-        if (entity->type == STREAM_TYPE_MEM) {
-            void *buff;
-            size_t buff_len;
-            buff = purc_rwstream_get_mem_buffer_ex(entity->stm4r, &buff_len,
-                    NULL, false);
-            assert(buff);
-
-            entity->fp = fmemopen(buff, buff_len, "r");
-            if (entity->fp == NULL) {
-                PC_ERROR("Failed fmemopen(%p, %zu): %s\n", buff, buff_len,
-                        strerror(errno));
-                purc_set_error(purc_error_from_errno(errno));
-                goto failed;
-            }
-        }
-        else {
-            entity->fp = fdopen(entity->fd4r, "r");
-            if (entity->fp == NULL) {
-                PC_ERROR("Failed fdopen(%d): %s\n", entity->fd4r, strerror(errno));
-                purc_set_error(purc_error_from_errno(errno));
-                goto failed;
-            }
-        }
+    bool ok = true;
+
+    if (batch->nr_lines > 0) {
+        ok = purc_variant_array_append_many(batch->array,
+                batch->nr_lines, batch->lines);
+        for (size_t i = 0; i < batch->nr_lines; i++)
+            purc_variant_unref(batch->lines[i]);
+        batch->nr_lines = 0;
+    }
+
+    return ok ? 0 : -1;
+}
+
+static int append_line(struct line_batch *batch,
+        struct pcutils_mystring *mystr)
+{
+    purc_variant_t var;
+
+    if (pcutils_mystring_done(mystr)) {
+        pcutils_mystring_free(mystr);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
     }
 
+    var = purc_variant_make_string_reuse_buff(mystr->buff,
+            mystr->sz_space, false);
+    pcutils_mystring_init(mystr);
+    if (var == PURC_VARIANT_INVALID)
+        return -1;
+
+    batch->lines[batch->nr_lines++] = var;
+    if (batch->nr_lines == NR_LINES_PER_BATCH)
+        return flush_lines(batch);
+    return 0;
+}
+
+/* Scans the data peeked from the stream for the separator, instead of
+   reading the stream character by character. */
+static int read_lines(struct pcdvobjs_stream *entity, int line_num,
+        purc_variant_t array, const char *line_seperator)
+{
+    purc_rwstream_t stm = entity->stm4r;
+    size_t total_read = 0;
     size_t sep_len = strlen(line_seperator);
-    size_t sep_ucs = pcutils_string_utf8_chars(line_seperator, sep_len);
 
     struct pcutils_mystring mystr;
     pcutils_mystring_init(&mystr);
 
-    while (line_num) {
+    struct line_batch batch;
+    batch.array = array;
+    batch.nr_lines = 0;
 
-        unsigned char utf8ch[6];
-        int uchlen = 0;
-        int c = fgetc(entity->fp);
-        if (c == EOF || ferror(entity->fp)) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                clearerr(entity->fp);
+    while (line_num) {
+        const char *data;
+        ssize_t n = purc_rwstream_peek(stm, (const void **)&data, sep_len);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
                 break;
-            }
-            PC_WARN("fgetc() returns EOF\n");
-            if (total_ucs == 0) {
+            PC_WARN("purc_rwstream_peek() failed: %s\n", strerror(errno));
+            if (total_read == 0)
                 goto nothing;
-            }
-            else
-                break;
+            break;
         }
-        else {
-            uchlen = _pcutils_utf8_skip[(unsigned char)c];
-            if (uchlen > 1) {
-                ungetc(c, entity->fp);
-                int n = (int)fread(utf8ch, 1, uchlen, entity->fp);
-                if (n < uchlen) {
-                    PC_WARN("fread() returns less bytes %d for a uchar (%d)\n",
-                            n, uchlen);
-                    if (feof(entity->fp) || ferror(entity->fp)) {
-                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                            clearerr(entity->fp);
-                            break;
-                        }
-
-                        if (total_ucs == 0)
-                            goto nothing;
-                        else
-                            break;
-                    }
-                    else {
-                        for (int i = 0; i < n; i++)
-                            ungetc(utf8ch[n - i - 1], entity->fp);
-                        break;
-                    }
-                }
-
-            }
-            else {
-                utf8ch[0] = (unsigned char)c;
-            }
+        else if (n == 0) {
+            if (total_read == 0)
+                goto nothing;
+            break;
         }
 
-        total_ucs++;
-        pcutils_mystring_append_mchar(&mystr, utf8ch, uchlen);
+        /* EOF or no more data available for now */
+        if ((size_t)n < sep_len) {
+            pcutils_mystring_append_mchar(&mystr,
+                    (const unsigned char *)data, n);
+            purc_rwstream_consume(stm, n);
+            total_read += n;
+            break;
+        }
 
-        if (total_ucs > 0 && (total_ucs % sep_ucs) == 0 &&
-                strncmp(mystr.buff + mystr.nr_bytes - sep_len,
-                    line_seperator, sep_len) == 0) {
-            mystr.buff[mystr.nr_bytes - sep_len] = 0;
+        const char *sep = memmem(data, n, line_seperator, sep_len);
+        size_t len;
+        if (sep) {
+            len = sep - data;
+        }
+        else {
+            /* keep the tail which may be the head of a separator */
+            len = n - (sep_len - 1);
+        }
 
-            purc_variant_t var;
-            var = purc_variant_make_string_reuse_buff(mystr.buff,
-                    mystr.sz_space, false);
-            pcutils_mystring_init(&mystr);
+        if (len > 0)
+            pcutils_mystring_append_mchar(&mystr,
+                    (const unsigned char *)data, len);
 
-            purc_variant_array_append(array, var);
-            purc_variant_unref(var);
+        if (sep) {
+            len += sep_len;
+            if (append_line(&batch, &mystr))
+                goto failed;
             line_num--;
         }
-    }
 
-    if (mystr.nr_bytes > 0) {
-        purc_variant_t var;
-        pcutils_mystring_done(&mystr);
-        var = purc_variant_make_string_reuse_buff(mystr.buff,
-                mystr.sz_space, false);
-        purc_variant_array_append(array, var);
-        purc_variant_unref(var);
+        purc_rwstream_consume(stm, len);
+        total_read += len;
     }
 
+    if (mystr.nr_bytes > 0 && append_line(&batch, &mystr))
+        goto failed;
+
+    if (flush_lines(&batch))
+        goto failed;
+
     return 0;
 
 nothing:
@@ -722,6 +739,9 @@ nothing:
     }
 
 failed:
+    for (size_t i = 0; i < batch.nr_lines; i++)
+        purc_variant_unref(batch.lines[i]);
+    pcutils_mystring_free(&mystr);
     return -1;
 }
 #endif
@@ -802,6 +822,78 @@ out:
     return PURC_VARIANT_INVALID;
 }
 
+/*
+ * $stream.readjson([<'auto | array | lines'> $records = 'auto'])
+ *
+ * Reads the next record of the JSON data in the stream: an element of
+ * the top-level array, or a top-level value in a sequence of values
+ * such as JSON lines. The layout is determined by the first call.
+ * Returns `undefined` if there is no more record, so that the records
+ * can be iterated by `<iterate>` without loading the whole data:
+ *
+ *  <iterate on $s.readjson() with $s.readjson() nosetotail>
+ */
+static purc_variant_t
+readjson_getter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+
+    struct pcdvobjs_stream *stream = get_stream(native_entity);
+    if (stream->stm4r == NULL) {
+        PC_ERROR("The stream (%p) is not readable.\n", stream);
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto failed;
+    }
+
+    if (stream->json_reader == NULL) {
+        pcvrnt_json_records_k records = PCVRNT_JSON_RECORDS_AUTO;
+        if (nr_args > 0) {
+            const char *option = purc_variant_get_string_const(argv[0]);
+            if (option == NULL) {
+                purc_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+                goto failed;
+            }
+
+            purc_atom_t atom = purc_atom_try_string_ex(STREAM_ATOM_BUCKET,
+                    option);
+            if (atom == keywords2atoms[K_KW_array].atom) {
+                records = PCVRNT_JSON_RECORDS_ARRAY;
+            }
+            else if (atom == keywords2atoms[K_KW_lines].atom) {
+                records = PCVRNT_JSON_RECORDS_LINES;
+            }
+            else if (atom != keywords2atoms[K_KW_auto].atom) {
+                purc_set_error(PURC_ERROR_INVALID_VALUE);
+                goto failed;
+            }
+        }
+
+        stream->json_reader = purc_variant_json_reader_new(stream->stm4r,
+                records);
+        if (stream->json_reader == NULL)
+            goto failed;
+    }
+
+    purc_variant_t record;
+    record = purc_variant_json_reader_next(stream->json_reader);
+    if (record == PURC_VARIANT_INVALID) {
+        if (purc_get_last_error() == PURC_ERROR_NO_DATA) {
+            purc_clr_error();
+            return purc_variant_make_undefined();
+        }
+        goto failed;
+    }
+
+    return record;
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
 static purc_variant_t
 writelines_getter(void *native_entity, const char *property_name,
         size_t nr_args, purc_variant_t *argv, unsigned call_flags)
@@ -1368,6 +1460,12 @@ seek_getter(void *native_entity, const char *property_name,
         whence = SEEK_END;
     }
 
+    if (stream->json_reader) {
+        /* the layout of the records is determined again after seeking */
+        purc_variant_json_reader_delete(stream->json_reader);
+        stream->json_reader = NULL;
+    }
+
     off = purc_rwstream_seek(rwstream, byte_num, (int)whence);
     if (off < 0) {
         goto out;
@@ -2228,6 +2326,9 @@ property_getter(void *entity, const char *name)
     else if (atom == keywords2atoms[K_KW_readlines].atom) {
         return readlines_getter;
     }
+    else if (atom == keywords2atoms[K_KW_readjson].atom) {
+        return readjson_getter;
+    }
     else if (atom == keywords2atoms[K_KW_writelines].atom) {
         return writelines_getter;
     }
@@ -64,9 +64,13 @@ struct tkz_reader {
     /* data source type */
     struct tkz_reader_ds *ds;
 
-    struct tkz_ucs *reconsume_ucs;
-    struct tkz_ucs *consumed_ucs;
-    size_t nr_consumed_list;
+    /* The ring of the characters read lately. The counters only increase;
+       a character in [first, next) has been consumed and can be reconsumed,
+       and a character in [next, last) will be returned again. */
+    size_t first;
+    size_t next;
+    size_t last;
+    struct tkz_uc consumed[NR_CONSUMED_LIST_LIMIT];
 
     struct tkz_uc curr_uc;
     struct tkz_lc *lc;
@@ -114,22 +118,47 @@ static void tkz_uc_destroy(struct tkz_uc *uc)
 }
 /* tkz_uc end */
 
+static uint32_t utf8_to_uint32_t(const unsigned char *utf8_char,
+        int utf8_char_len)
+{
+    uint32_t wc = *((unsigned char *)(utf8_char++));
+    int n = utf8_char_len;
+    int t = 0;
+
+    if (wc & 0x80) {
+        wc &= (1 <<(8-n)) - 1;
+        while (--n > 0) {
+            t = *((unsigned char *)(utf8_char++));
+            wc = (wc << 6) | (t & 0x3F);
+        }
+    }
+
+    return wc;
+}
+
 /* tkz_reader_ds begin */
 
 /* tkz_reader_ds_rws begin */
 
-#define  ENABLE_PRELOAD_UC      1
+/* the initial size of the window; it grows if a line is longer */
+#define SZ_RWS_WINDOW           4096
 
 struct tkz_reader_ds_rws {
     struct tkz_reader_ds ds;
     purc_rwstream_t      rws;
-#if ENABLE(PRELOAD_UC)
-    struct tkz_ucs      *preload_ucs;
-#endif
     struct tkz_lc       *lc;
     int                  line;
     int                  column;
     int                  position;
+
+    /* the window of the bytes read from the stream but not decoded yet */
+    unsigned char       *buf;
+    size_t               sz_buf;
+    size_t               pos;
+    size_t               len;
+    bool                 eof;
+    bool                 failed;        // failed to read the stream
+    bool                 line_cached;   // the current line is in lc
 };
 
 static const char *
@@ -139,95 +168,171 @@ tkz_reader_ds_rws_type(struct tkz_reader_ds *ds)
     return "purc_rwstream";
 }
 
-#if ENABLE(PRELOAD_UC)
-static void
-tkz_reader_ds_rws_read_line(struct tkz_reader_ds_rws *ds_rws)
+/* Reads more bytes into the window; returns false if there is no more. */
+static bool
+tkz_reader_ds_rws_fill(struct tkz_reader_ds_rws *ds_rws)
 {
-    char c[8] = {0};
-    uint32_t uc = 0;
-    int nr_c = 0;
-    struct tkz_uc curr_uc = {0};
+    if (ds_rws->eof) {
+        return false;
+    }
 
-again:
-    nr_c = purc_rwstream_read_utf8_char(ds_rws->rws, c, &uc);
-    if (nr_c < 0) {
-        uc = TKZ_INVALID_CHARACTER;
+    if (ds_rws->pos > 0) {
+        memmove(ds_rws->buf, ds_rws->buf + ds_rws->pos,
+                ds_rws->len - ds_rws->pos);
+        ds_rws->len -= ds_rws->pos;
+        ds_rws->pos = 0;
     }
-    else {
-        c[nr_c] = 0;
+
+    if (ds_rws->len == ds_rws->sz_buf) {
+        size_t sz_buf = ds_rws->sz_buf ? ds_rws->sz_buf * 2 : SZ_RWS_WINDOW;
+        unsigned char *buf = realloc(ds_rws->buf, sz_buf);
+        if (!buf) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            ds_rws->eof = true;
+            ds_rws->failed = true;
+            return false;
+        }
+        ds_rws->buf = buf;
+        ds_rws->sz_buf = sz_buf;
     }
 
-    curr_uc.character = uc;
-    curr_uc.line = ds_rws->line;
-    curr_uc.column = ds_rws->column++;
-    curr_uc.position = ds_rws->position++;
-    strcpy((char *)curr_uc.utf8_buf, c);
+    /* take only the bytes the stream has at hand: reading the full window
+       would block on a pipe or a tty until it is filled or closed */
+    const void *data;
+    ssize_t n = purc_rwstream_peek(ds_rws->rws, &data, 1);
+    if (n <= 0) {
+        ds_rws->eof = true;
+        ds_rws->failed = (n < 0);
+        return false;
+    }
+
+    if ((size_t)n > ds_rws->sz_buf - ds_rws->len) {
+        n = ds_rws->sz_buf - ds_rws->len;
+    }
+    memcpy(ds_rws->buf + ds_rws->len, data, n);
+    purc_rwstream_consume(ds_rws->rws, n);
 
-    tkz_ucs_add_tail(ds_rws->preload_ucs, curr_uc);
-    if (uc == '\n' || uc == 0) {
-        if (ds_rws->lc) {
-            tkz_lc_commit(ds_rws->lc, ds_rws->line);
+    ds_rws->len += n;
+    return true;
+}
+
+/* Puts the whole line from the current position into the line cache. */
+static void
+tkz_reader_ds_rws_cache_line(struct tkz_reader_ds_rws *ds_rws)
+{
+    size_t n = 0;
+
+    for (;;) {
+        const unsigned char *p = ds_rws->buf + ds_rws->pos;
+        size_t left = ds_rws->len - ds_rws->pos;
+        while (n < left && p[n] != '\n' && p[n] != 0) {
+            n++;
         }
 
-        ds_rws->line++;
-        ds_rws->column = 0;
-    }
-    else {
-        if (ds_rws->lc) {
-            tkz_lc_append_bytes(ds_rws->lc, c, strlen(c));
+        if (n < left || !tkz_reader_ds_rws_fill(ds_rws)) {
+            break;
         }
-        uc = 0;
-        c[0] = 0;
-        goto again;
     }
+
+    if (n > 0) {
+        tkz_lc_append_bytes(ds_rws->lc,
+                (const char *)ds_rws->buf + ds_rws->pos, n);
+    }
+    tkz_lc_commit(ds_rws->lc, ds_rws->line);
+    ds_rws->line_cached = true;
 }
-#endif
 
-static struct tkz_uc
-tkz_reader_ds_rws_read(struct tkz_reader_ds *ds)
+/* Decodes a character at the current position of the window. */
+static uint32_t
+tkz_reader_ds_rws_decode(struct tkz_reader_ds_rws *ds_rws, uint8_t *utf8)
 {
-    struct tkz_reader_ds_rws *ds_rws = (struct tkz_reader_ds_rws *)ds;
-#if ENABLE(PRELOAD_UC)
-    if (tkz_ucs_is_empty(ds_rws->preload_ucs)) {
-        tkz_reader_ds_rws_read_line(ds_rws);
+    if (ds_rws->pos == ds_rws->len && !tkz_reader_ds_rws_fill(ds_rws)) {
+        if (ds_rws->failed) {
+            /* report the failure once, and then the end of the data */
+            ds_rws->failed = false;
+            return TKZ_INVALID_CHARACTER;
+        }
+        return 0;
     }
 
-    return tkz_ucs_read_head(ds_rws->preload_ucs);
-#else
-    char c[8] = {0};
-    uint32_t char_val = 0;
-    int nr_c = 0;
-    struct tkz_uc curr_uc_val = {0};
+    uint8_t c = ds_rws->buf[ds_rws->pos];
+    if (c < 0x80) {
+        ds_rws->pos++;
+        if (c) {
+            utf8[0] = c;
+            utf8[1] = 0;
+        }
+        return c;
+    }
 
-    nr_c = purc_rwstream_read_utf8_char(ds_rws->rws, c, &char_val);
-    if (nr_c < 0) {
-        char_val = TKZ_INVALID_CHARACTER;
+    int n = 1;
+    if (c <= 0xFD) {
+        while (c & (0x80 >> n)) {
+            n++;
+        }
     }
-    else {
-        c[nr_c] = 0;
+
+    if (c > 0xFD || n < 2) {
+        ds_rws->pos++;
+        utf8[0] = c;
+        utf8[1] = 0;
+        goto bad_encoding;
     }
 
-    curr_uc_val.character = char_val;
-    curr_uc_val.line = ds_rws->line;
-    curr_uc_val.column = ds_rws->column++;
-    curr_uc_val.position = ds_rws->position++;
-    strcpy((char *)curr_uc_val.utf8_buf, c);
+    while (ds_rws->len - ds_rws->pos < (size_t)n &&
+            tkz_reader_ds_rws_fill(ds_rws)) {
+    }
 
-    if (char_val == '\n' || char_val == 0) {
-        if (ds_rws->lc) {
-            tkz_lc_commit(ds_rws->lc, ds_rws->line);
+    /* consume the bytes up to the first bad one like the stream does */
+    const unsigned char *p = ds_rws->buf + ds_rws->pos;
+    size_t left = ds_rws->len - ds_rws->pos;
+    int i = 0;
+    utf8[i] = p[i];
+    for (i = 1; i < n && (size_t)i < left; i++) {
+        utf8[i] = p[i];
+        if ((p[i] & 0xC0) != 0x80) {
+            i++;
+            break;
         }
+    }
+    utf8[i] = 0;
+    ds_rws->pos += i;
+
+    size_t nr_chars;
+    if (i == n && (p[n - 1] & 0xC0) == 0x80 &&
+            pcutils_string_check_utf8_len((const char *)utf8, n,
+                &nr_chars, NULL)) {
+        return utf8_to_uint32_t(utf8, n);
+    }
 
+bad_encoding:
+    pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+    return TKZ_INVALID_CHARACTER;
+}
+
+static struct tkz_uc
+tkz_reader_ds_rws_read(struct tkz_reader_ds *ds)
+{
+    struct tkz_reader_ds_rws *ds_rws = (struct tkz_reader_ds_rws *)ds;
+    struct tkz_uc uc;
+
+    if (ds_rws->lc && !ds_rws->line_cached) {
+        tkz_reader_ds_rws_cache_line(ds_rws);
+    }
+
+    uc.utf8_buf[0] = 0;
+    uc.character = tkz_reader_ds_rws_decode(ds_rws, uc.utf8_buf);
+    uc.line = ds_rws->line;
+    uc.column = ds_rws->column++;
+    uc.position = ds_rws->position++;
+
+    if (uc.character == '\n' || uc.character == 0) {
         ds_rws->line++;
         ds_rws->column = 0;
+        ds_rws->line_cached = false;
     }
-    else {
-        if (ds_rws->lc) {
-            tkz_lc_append_bytes(ds_rws->lc, c, strlen(c));
-        }
-    }
-    return curr_uc_val;
-#endif
+
+    return uc;
 }
 
 static int
@@ -246,33 +351,10 @@ tkz_reader_ds_rws_destroy(struct tkz_reader_ds *ds)
     }
 
     struct tkz_reader_ds_rws *ds_rws = (struct tkz_reader_ds_rws *)ds;
-
-#if ENABLE(PRELOAD_UC)
-    if (ds_rws->preload_ucs) {
-        tkz_ucs_destroy(ds_rws->preload_ucs);
-    }
-#endif
-
+    free(ds_rws->buf);
     free(ds_rws);
 }
 
-#if ENABLE(PRELOAD_UC)
-static void
-tkz_reader_ds_rws_unread_preload(struct tkz_reader_ds *ds)
-{
-    (void)ds;
-    struct tkz_reader_ds_rws *ds_rws = (struct tkz_reader_ds_rws *)ds;
-    if (ds_rws->preload_ucs) {
-        while (!tkz_ucs_is_empty(ds_rws->preload_ucs)) {
-            struct tkz_uc uc = tkz_ucs_read_tail(ds_rws->preload_ucs);
-            size_t sz = strlen((char*)uc.utf8_buf);
-            if (ds->unread && sz) {
-                ds->unread(ds, (const char *)uc.utf8_buf, sz);
-            }
-        }
-    }
-}
-
 static void
 tkz_reader_ds_rws_unread(struct tkz_reader_ds *ds, const char *utf8ch, size_t sz)
 {
@@ -286,7 +368,18 @@ tkz_reader_ds_rws_unread(struct tkz_reader_ds *ds, const char *utf8ch, size_t sz
         purc_rwstream_ungetc(ds_rws->rws, utf8ch, sz);
     }
 }
-#endif
+
+static void
+tkz_reader_ds_rws_unread_preload(struct tkz_reader_ds *ds)
+{
+    struct tkz_reader_ds_rws *ds_rws = (struct tkz_reader_ds_rws *)ds;
+    if (ds_rws->pos < ds_rws->len) {
+        tkz_reader_ds_rws_unread(ds,
+                (const char *)ds_rws->buf + ds_rws->pos,
+                ds_rws->len - ds_rws->pos);
+        ds_rws->pos = ds_rws->len;
+    }
+}
 
 static struct tkz_reader_ds *
 tkz_reader_ds_rws_new(purc_rwstream_t rws)
@@ -298,37 +391,20 @@ tkz_reader_ds_rws_new(purc_rwstream_t rws)
         PC_ERROR("Failed to allocate memory for tkz_reader_ds_rws (%zu)\n",
                 sizeof(*ds_rws));
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto out;
+        return NULL;
     }
 
     ds_rws->rws = rws;
-#if ENABLE(PRELOAD_UC)
-    ds_rws->preload_ucs = tkz_ucs_new();
-    if (!ds_rws->preload_ucs) {
-        goto out_clear_ds;
-    }
-#endif
-
 
     ds = (struct tkz_reader_ds *) ds_rws;
     ds->type = tkz_reader_ds_rws_type;
     ds->read = tkz_reader_ds_rws_read;
     ds->set_lc = tkz_reader_ds_rws_set_lc;
     ds->destroy = tkz_reader_ds_rws_destroy;
-#if ENABLE(PRELOAD_UC)
     ds->unread_preload = tkz_reader_ds_rws_unread_preload;
     ds->unread = tkz_reader_ds_rws_unread;
-#endif
 
     return ds;
-
-#if ENABLE(PRELOAD_UC)
-out_clear_ds:
-    tkz_reader_ds_rws_destroy((struct tkz_reader_ds*)ds_rws);
-#endif
-
-out:
-    return NULL;
 }
 /* tkz_reader_ds_rws end */
 
@@ -410,29 +486,10 @@ struct tkz_reader *tkz_reader_new(void)
         PC_ERROR("Failed to allocate memory for tkz_reader (%zu)\n",
                 sizeof(*reader));
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto failed;
-    }
-
-    reader->reconsume_ucs = tkz_ucs_new();
-    if (!reader->reconsume_ucs) {
-        goto failed_clear_reader;
-    }
-
-    reader->consumed_ucs = tkz_ucs_new();
-    if (!reader->consumed_ucs) {
-        goto failed_clear_reconsume_ucs;
+        return NULL;
     }
 
     return reader;
-
-failed_clear_reconsume_ucs:
-    tkz_ucs_destroy(reader->reconsume_ucs);
-
-failed_clear_reader:
-    free(reader);
-
-failed:
-    return NULL;
 }
 
 void tkz_reader_set_data_source_rws(struct tkz_reader *reader,
@@ -461,45 +518,14 @@ void tkz_reader_set_lc(struct tkz_reader *reader, struct tkz_lc *lc)
     }
 }
 
-static struct tkz_uc*
-tkz_reader_read_from_data_source(struct tkz_reader *reader)
-{
-    reader->curr_uc = reader->ds->read(reader->ds);
-    return &reader->curr_uc;
-}
-
-static struct tkz_uc*
-tkz_reader_read_from_reconsume_list(struct tkz_reader *reader)
-{
-    reader->curr_uc = tkz_ucs_read_head(reader->reconsume_ucs);
-    return &reader->curr_uc;
-}
-
-static bool
-tkz_reader_add_consumed(struct tkz_reader *reader, struct tkz_uc *uc)
-{
-    if (tkz_ucs_add_tail(reader->consumed_ucs, *uc)) {
-        return false;
-    }
-    reader->nr_consumed_list++;
-
-    if (reader->nr_consumed_list > NR_CONSUMED_LIST_LIMIT) {
-        tkz_ucs_read_head(reader->consumed_ucs);
-        reader->nr_consumed_list--;
-    }
-    return true;
-}
+#define CONSUMED_SLOT(reader, n)    \
+    ((reader)->consumed + ((n) % NR_CONSUMED_LIST_LIMIT))
 
 bool tkz_reader_reconsume_last_char(struct tkz_reader *reader)
 {
-    if (!reader->nr_consumed_list) {
-        return true;
+    if (reader->next > reader->first) {
+        reader->next--;
     }
-
-    struct tkz_uc uc = tkz_ucs_read_tail(reader->consumed_ucs);
-    reader->nr_consumed_list--;
-
-    tkz_ucs_add_head(reader->reconsume_ucs, uc);
     return true;
 }
 
@@ -510,18 +536,19 @@ struct tkz_uc *tkz_reader_current(struct tkz_reader *reader)
 
 struct tkz_uc *tkz_reader_next_char(struct tkz_reader *reader)
 {
-    struct tkz_uc *ret = NULL;
-    if (tkz_ucs_is_empty(reader->reconsume_ucs)) {
-        ret = tkz_reader_read_from_data_source(reader);
-    }
-    else {
-        ret = tkz_reader_read_from_reconsume_list(reader);
-    }
+    struct tkz_uc *uc = CONSUMED_SLOT(reader, reader->next);
 
-    if (tkz_reader_add_consumed(reader, ret)) {
-        return ret;
+    if (reader->next == reader->last) {
+        *uc = reader->ds->read(reader->ds);
+        reader->last++;
+        if (reader->last - reader->first > NR_CONSUMED_LIST_LIMIT) {
+            reader->first++;
+        }
     }
-    return NULL;
+
+    reader->next++;
+    reader->curr_uc = *uc;
+    return &reader->curr_uc;
 }
 
 void tkz_reader_destroy(struct tkz_reader *reader)
@@ -531,24 +558,19 @@ void tkz_reader_destroy(struct tkz_reader *reader)
             if (reader->ds->unread_preload) {
                 reader->ds->unread_preload(reader->ds);
             }
-            while (!tkz_ucs_is_empty(reader->reconsume_ucs)) {
-                struct tkz_uc uc = tkz_ucs_read_tail(reader->reconsume_ucs);
-                size_t sz = strlen((char*)uc.utf8_buf);
-                if (sz && reader->ds->unread) {
-                    reader->ds->unread(reader->ds, (const char *)uc.utf8_buf, sz);
+
+            /* give back the characters to reconsume, the last one first */
+            while (reader->ds->unread && reader->last > reader->next) {
+                struct tkz_uc *uc = CONSUMED_SLOT(reader, --reader->last);
+                size_t sz = strlen((char*)uc->utf8_buf);
+                if (sz) {
+                    reader->ds->unread(reader->ds,
+                            (const char *)uc->utf8_buf, sz);
                 }
             }
             reader->ds->destroy(reader->ds);
         }
 
-        if (reader->reconsume_ucs) {
-            tkz_ucs_destroy(reader->reconsume_ucs);
-        }
-
-        if (reader->consumed_ucs) {
-            tkz_ucs_destroy(reader->consumed_ucs);
-        }
-
         PCHVML_FREE(reader);
     }
 }
@@ -867,24 +889,6 @@ static bool is_utf8_leading_byte(char c)
     return (c & 0xC0) != 0x80;
 }
 
-static uint32_t utf8_to_uint32_t(const unsigned char *utf8_char,
-        int utf8_char_len)
-{
-    uint32_t wc = *((unsigned char *)(utf8_char++));
-    int n = utf8_char_len;
-    int t = 0;
-
-    if (wc & 0x80) {
-        wc &= (1 <<(8-n)) - 1;
-        while (--n > 0) {
-            t = *((unsigned char *)(utf8_char++));
-            wc = (wc << 6) | (t & 0x3F);
-        }
-    }
-
-    return wc;
-}
-
 static void tkz_buffer_append_inner(struct tkz_buffer *buffer,
         const char *bytes, size_t nr_bytes)
 {
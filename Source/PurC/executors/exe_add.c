@@ -39,12 +39,14 @@ struct pcexec_exe_add_inst {
     double                      curr;
 };
 
+PCEXE_DEFINE_RULE_PARSER(add)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_add_inst *exe_add_inst)
 {
-    struct exe_add_param *param = &exe_add_inst->param;
-    exe_add_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_add_inst->param, 0, sizeof(exe_add_inst->param));
     pcexecutor_inst_reset(&exe_add_inst->super);
 }
 
@@ -54,21 +56,13 @@ parse_rule(struct pcexec_exe_add_inst *exe_add_inst,
 {
     purc_exec_inst_t inst = &exe_add_inst->super;
 
-    struct exe_add_param param = {0};
-    int r = exe_add_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_add_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            add_parse_param, add_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_add_param_reset(&exe_add_inst->param);
-    exe_add_inst->param = param;
+    exe_add_inst->param = *param;
 
     return true;
 }
@@ -42,12 +42,14 @@ struct pcexec_exe_char_inst {
     wchar_t                   *result_set;
 };
 
+PCEXE_DEFINE_RULE_PARSER(char)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_char_inst *exe_char_inst)
 {
-    struct exe_char_param *param = &exe_char_inst->param;
-    exe_char_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_char_inst->param, 0, sizeof(exe_char_inst->param));
     pcexecutor_inst_reset(&exe_char_inst->super);
     PCEXE_FREE(exe_char_inst->result_set);
 }
@@ -78,21 +80,13 @@ parse_rule(struct pcexec_exe_char_inst *exe_char_inst,
 {
     purc_exec_inst_t inst = &exe_char_inst->super;
 
-    struct exe_char_param param = {0};
-    int r = exe_char_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_char_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            char_parse_param, char_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_char_param_reset(&exe_char_inst->param);
-    exe_char_inst->param = param;
+    exe_char_inst->param = *param;
 
     return prepare_result_set(exe_char_inst);
 }
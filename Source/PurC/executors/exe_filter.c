@@ -39,156 +39,20 @@ struct pcexec_exe_filter_inst {
 
     struct exe_filter_param        param;
 
-    purc_variant_t              result_set;
+    /* the keys of the properties of an object input */
+    struct pcexec_obj_keys      obj_keys;
 };
 
+PCEXE_DEFINE_RULE_PARSER(filter)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_filter_inst *exe_filter_inst)
 {
-    struct exe_filter_param *param = &exe_filter_inst->param;
-    exe_filter_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_filter_inst->param, 0, sizeof(exe_filter_inst->param));
     pcexecutor_inst_reset(&exe_filter_inst->super);
-    PCEXE_CLR_VAR(exe_filter_inst->result_set);
-}
-
-static inline bool
-init_result_set_with_object(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        purc_variant_t arr = purc_variant_make_array(2, k, v);
-        if (arr == PURC_VARIANT_INVALID) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, arr)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set_with_array(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    size_t idx;
-    foreach_value_in_variant_array(input, v, idx)
-        (void)idx;
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set_with_set(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    // FIXME: document-order or content-order?
-    foreach_value_in_variant_set(input, v)
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set(struct pcexec_exe_filter_inst *exe_filter_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_filter_inst->super;
-    purc_variant_t input = inst->input;
-
-    switch (purc_variant_get_type(input)) {
-        case PURC_VARIANT_TYPE_OBJECT:
-            return init_result_set_with_object(exe_filter_inst, result_set);
-        case PURC_VARIANT_TYPE_ARRAY:
-            return init_result_set_with_array(exe_filter_inst, result_set);
-        case PURC_VARIANT_TYPE_SET:
-            return init_result_set_with_set(exe_filter_inst, result_set);
-        default:
-            PC_ASSERT(0);
-            return false;
-    }
-
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        if (!purc_variant_array_append(result_set, k)) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_filter_inst->result_set);
-        exe_filter_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-prepare_result_set(struct pcexec_exe_filter_inst *exe_filter_inst)
-{
-    purc_variant_t result_set;
-    result_set = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (result_set == PURC_VARIANT_INVALID) {
-        return false;
-    }
-
-    bool ok = init_result_set(exe_filter_inst, result_set);
-    purc_variant_unref(result_set);
-
-    return ok;
+    pcexecutor_obj_keys_release(&exe_filter_inst->obj_keys);
 }
 
 static inline bool
@@ -197,23 +61,15 @@ parse_rule(struct pcexec_exe_filter_inst *exe_filter_inst,
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
 
-    struct exe_filter_param param = {0};
-    int r = exe_filter_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_filter_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            filter_parse_param, filter_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_filter_param_reset(&exe_filter_inst->param);
-    exe_filter_inst->param = param;
+    exe_filter_inst->param = *param;
 
-    return prepare_result_set(exe_filter_inst);
+    return true;
 }
 
 int
@@ -238,13 +94,12 @@ filter_rule_eval(struct filter_rule *rule, purc_variant_t val, bool *result)
 
 static inline bool
 check_item_with_object(struct pcexec_exe_filter_inst *exe_filter_inst,
-    const int curr, purc_variant_t item, bool *result)
+    const int curr, purc_variant_t k, purc_variant_t v, bool *result)
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_exec_iter_t it = &inst->it;
     struct filter_rule *rule = &exe_filter_inst->param.rule;
 
-    purc_variant_t v = purc_variant_array_get(item, 1);
     PC_ASSERT(v != PURC_VARIANT_INVALID);
 
     if (filter_rule_eval(rule, v, result)) {
@@ -255,7 +110,6 @@ check_item_with_object(struct pcexec_exe_filter_inst *exe_filter_inst,
     if (!result)
         return false;
 
-    purc_variant_t k = purc_variant_array_get(item, 0);
     PC_ASSERT(k != PURC_VARIANT_INVALID);
 
     purc_variant_t val = PURC_VARIANT_INVALID;
@@ -353,8 +207,6 @@ check_item(struct pcexec_exe_filter_inst *exe_filter_inst,
     purc_variant_t input = inst->input;
 
     switch (purc_variant_get_type(input)) {
-        case PURC_VARIANT_TYPE_OBJECT:
-            return check_item_with_object(exe_filter_inst, curr, item, result);
         case PURC_VARIANT_TYPE_ARRAY:
             return check_item_with_array(exe_filter_inst, curr, item, result);
         case PURC_VARIANT_TYPE_SET:
@@ -378,14 +230,43 @@ check_curr(struct pcexec_exe_filter_inst *exe_filter_inst)
         return false;
     }
 
-    purc_variant_t result_set = exe_filter_inst->result_set;
+    bool result = false;
+    purc_variant_t input = inst->input;
+    if (purc_variant_is_object(input)) {
+        /* the body of `<iterate>` may change the object between two steps,
+           so walk the keys taken by fetch_begin() */
+        while (1) {
+            size_t idx = curr;
+            purc_variant_t k;
+            purc_variant_t v = pcexecutor_obj_keys_fetch(
+                    &exe_filter_inst->obj_keys, input, &idx, &k);
+            if (v == PURC_VARIANT_INVALID)
+                break;
+
+            curr = (int)idx;
+            if (!check_item_with_object(exe_filter_inst, curr, k, v,
+                        &result)) {
+                // TODO: exception
+                PC_ASSERT(0);
+                return false;
+            }
+            if (result)
+                return true;
+
+            curr += 1;
+        }
+
+        return false;
+    }
+
+    /* fetch the members from the input directly, so that no result set
+       is built before the iteration */
     size_t nr;
-    if (!purc_variant_array_size(result_set, &nr)) {
+    if (!purc_variant_linear_container_size(input, &nr)) {
         pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
         return false;
     }
 
-    bool result = false;
     while (!result) {
         if ((size_t)curr >= nr) {
             /* End the loop normally without set error code */
@@ -393,7 +274,7 @@ check_curr(struct pcexec_exe_filter_inst *exe_filter_inst)
             return false;
         }
 
-        purc_variant_t item = purc_variant_array_get(result_set, curr);
+        purc_variant_t item = purc_variant_linear_container_get(input, curr);
         if (!check_item(exe_filter_inst, curr, item, &result)) {
             // TODO: exception
             PC_ASSERT(0);
@@ -417,6 +298,13 @@ fetch_begin(struct pcexec_exe_filter_inst *exe_filter_inst)
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_exec_iter_t it = &inst->it;
     it->curr = 0;
+
+    if (purc_variant_is_object(inst->input) &&
+            !pcexecutor_obj_keys_take(&exe_filter_inst->obj_keys,
+                inst->input)) {
+        return NULL;
+    }
+
     if (check_curr(exe_filter_inst)) {
         return it;
     }
@@ -429,6 +317,7 @@ fetch_next(struct pcexec_exe_filter_inst *exe_filter_inst)
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_exec_iter_t it = &inst->it;
     it->curr += 1;
+
     if (check_curr(exe_filter_inst)) {
         return it;
     }
@@ -39,12 +39,14 @@ struct pcexec_exe_formula_inst {
     purc_variant_t              curr;
 };
 
+PCEXE_DEFINE_RULE_PARSER(formula)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_formula_inst *exe_formula_inst)
 {
-    struct exe_formula_param *param = &exe_formula_inst->param;
-    exe_formula_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_formula_inst->param, 0, sizeof(exe_formula_inst->param));
     pcexecutor_inst_reset(&exe_formula_inst->super);
     PCEXE_CLR_VAR(exe_formula_inst->curr);
 }
@@ -55,21 +57,13 @@ parse_rule(struct pcexec_exe_formula_inst *exe_formula_inst,
 {
     purc_exec_inst_t inst = &exe_formula_inst->super;
 
-    struct exe_formula_param param = {0};
-    int r = exe_formula_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_formula_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            formula_parse_param, formula_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_formula_param_reset(&exe_formula_inst->param);
-    exe_formula_inst->param = param;
+    exe_formula_inst->param = *param;
 
     return true;
 }
@@ -39,61 +39,21 @@ struct pcexec_exe_key_inst {
 
     struct exe_key_param        param;
 
-    purc_variant_t              result_set;
+    /* the keys of the properties of the input object */
+    struct pcexec_obj_keys      obj_keys;
+    size_t                      key_idx;
 };
 
+PCEXE_DEFINE_RULE_PARSER(key)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_key_inst *exe_key_inst)
 {
-    struct exe_key_param *param = &exe_key_inst->param;
-    exe_key_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_key_inst->param, 0, sizeof(exe_key_inst->param));
     pcexecutor_inst_reset(&exe_key_inst->super);
-    PCEXE_CLR_VAR(exe_key_inst->result_set);
-}
-
-static inline bool
-init_result_set(struct pcexec_exe_key_inst *exe_key_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_key_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        if (!purc_variant_array_append(result_set, k)) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_key_inst->result_set);
-        exe_key_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-prepare_result_set(struct pcexec_exe_key_inst *exe_key_inst)
-{
-    purc_variant_t result_set;
-    result_set = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (result_set == PURC_VARIANT_INVALID) {
-        return false;
-    }
-
-    bool ok = init_result_set(exe_key_inst, result_set);
-    purc_variant_unref(result_set);
-
-    return ok;
+    pcexecutor_obj_keys_release(&exe_key_inst->obj_keys);
 }
 
 static inline bool
@@ -102,23 +62,15 @@ parse_rule(struct pcexec_exe_key_inst *exe_key_inst,
 {
     purc_exec_inst_t inst = &exe_key_inst->super;
 
-    struct exe_key_param param = {0};
-    int r = exe_key_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_key_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            key_parse_param, key_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_key_param_reset(&exe_key_inst->param);
-    exe_key_inst->param = param;
+    exe_key_inst->param = *param;
 
-    return prepare_result_set(exe_key_inst);
+    return true;
 }
 
 int
@@ -148,21 +100,22 @@ check_curr(struct pcexec_exe_key_inst *exe_key_inst)
         return false;
     }
 
-    purc_variant_t result_set = exe_key_inst->result_set;
-    size_t nr;
-    if (!purc_variant_array_size(result_set, &nr)) {
-        pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
-        return false;
-    }
-
+    /* walk the keys taken by fetch_begin(), so that no result set is
+       built before the iteration and the body of `<iterate>` can change
+       the object between two steps */
     bool result = false;
     while (!result) {
-        if ((size_t)curr >= nr) {
+        size_t idx = exe_key_inst->key_idx;
+        purc_variant_t k;
+        purc_variant_t v = pcexecutor_obj_keys_fetch(&exe_key_inst->obj_keys,
+                inst->input, &idx, &k);
+        curr += 2 * (int)(idx - exe_key_inst->key_idx);
+        exe_key_inst->key_idx = idx;
+        if (v == PURC_VARIANT_INVALID) {
             pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
             return false;
         }
 
-        purc_variant_t k = purc_variant_array_get(result_set, curr);
         if (key_rule_eval(rule, k, &result)) {
             // TODO: exception
             PC_ASSERT(0);
@@ -170,12 +123,10 @@ check_curr(struct pcexec_exe_key_inst *exe_key_inst)
         }
         if (!result) {
             curr += 2;
+            exe_key_inst->key_idx++;
             continue;
         }
 
-        purc_variant_t v = purc_variant_array_get(result_set, curr+1);
-        PC_ASSERT(v != PURC_VARIANT_INVALID);
-
         purc_variant_t val = PURC_VARIANT_INVALID;
 
         switch (rule->for_clause) {
@@ -210,6 +161,11 @@ fetch_begin(struct pcexec_exe_key_inst *exe_key_inst)
     purc_exec_inst_t inst = &exe_key_inst->super;
     purc_exec_iter_t it = &inst->it;
     it->curr = 0;
+
+    exe_key_inst->key_idx = 0;
+    if (!pcexecutor_obj_keys_take(&exe_key_inst->obj_keys, inst->input))
+        return NULL;
+
     if (check_curr(exe_key_inst)) {
         return it;
     }
@@ -222,6 +178,8 @@ fetch_next(struct pcexec_exe_key_inst *exe_key_inst)
     purc_exec_inst_t inst = &exe_key_inst->super;
     purc_exec_iter_t it = &inst->it;
     it->curr += 2;
+    exe_key_inst->key_idx++;
+
     if (check_curr(exe_key_inst)) {
         return it;
     }
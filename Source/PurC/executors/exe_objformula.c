@@ -40,12 +40,14 @@ struct pcexec_exe_objformula_inst {
     purc_variant_t               curr;
 };
 
+PCEXE_DEFINE_RULE_PARSER(objformula)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_objformula_inst *exe_objformula_inst)
 {
-    struct exe_objformula_param *param = &exe_objformula_inst->param;
-    exe_objformula_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_objformula_inst->param, 0, sizeof(exe_objformula_inst->param));
     pcexecutor_inst_reset(&exe_objformula_inst->super);
     PCEXE_CLR_VAR(exe_objformula_inst->curr);
 }
@@ -56,23 +58,15 @@ parse_rule(struct pcexec_exe_objformula_inst *exe_objformula_inst,
 {
     purc_exec_inst_t inst = &exe_objformula_inst->super;
 
-    struct exe_objformula_param param = {0};
-    int r = exe_objformula_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_objformula_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            objformula_parse_param, objformula_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_objformula_param_reset(&exe_objformula_inst->param);
-    exe_objformula_inst->param = param;
+    exe_objformula_inst->param = *param;
 
-    PC_ASSERT(param.rule.vncle);
+    PC_ASSERT(param->rule.vncle);
     PC_ASSERT(exe_objformula_inst->param.rule.vncle);
 
     return true;
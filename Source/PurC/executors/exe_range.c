@@ -40,153 +40,17 @@ struct pcexec_exe_range_inst {
     struct purc_exec_inst       super;
 
     struct exe_range_param        param;
-
-    purc_variant_t              result_set;
 };
 
+PCEXE_DEFINE_RULE_PARSER(range)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_range_inst *exe_range_inst)
 {
-    struct exe_range_param *param = &exe_range_inst->param;
-    exe_range_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_range_inst->param, 0, sizeof(exe_range_inst->param));
     pcexecutor_inst_reset(&exe_range_inst->super);
-    PCEXE_CLR_VAR(exe_range_inst->result_set);
-}
-
-static inline bool
-init_result_set_with_array(struct pcexec_exe_range_inst *exe_range_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_range_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    size_t idx;
-    foreach_value_in_variant_array(input, v, idx)
-        (void)idx;
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_range_inst->result_set);
-        exe_range_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set_with_set(struct pcexec_exe_range_inst *exe_range_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_range_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    purc_variant_t v;
-    // FIXME: document-order or content-order?
-    foreach_value_in_variant_set(input, v)
-        bool ok = purc_variant_array_append(result_set, v);
-        if (!ok)
-            break;
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_range_inst->result_set);
-        exe_range_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set_with_tuple(struct pcexec_exe_range_inst *exe_range_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_range_inst->super;
-    purc_variant_t input = inst->input;
-
-    bool ok = true;
-    size_t sz = purc_variant_linear_container_get_size(input);
-    purc_variant_t v;
-
-    for (size_t i = 0; i < sz; i++) {
-        v = purc_variant_linear_container_get(input, i);
-        bool ok = purc_variant_array_append(result_set, v);
-        if (!ok)
-            break;
-    }
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_range_inst->result_set);
-        exe_range_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-init_result_set(struct pcexec_exe_range_inst *exe_range_inst,
-        purc_variant_t result_set)
-{
-    purc_exec_inst_t inst = &exe_range_inst->super;
-    purc_variant_t input = inst->input;
-
-    switch (purc_variant_get_type(input)) {
-        case PURC_VARIANT_TYPE_ARRAY:
-            return init_result_set_with_array(exe_range_inst, result_set);
-        case PURC_VARIANT_TYPE_SET:
-            return init_result_set_with_set(exe_range_inst, result_set);
-        case PURC_VARIANT_TYPE_TUPLE:
-            return init_result_set_with_tuple(exe_range_inst, result_set);
-        default:
-            PC_ASSERT(0);
-            return false;
-    }
-
-    bool ok = true;
-    purc_variant_t k, v;
-    foreach_key_value_in_variant_object(input, k, v)
-        if (!purc_variant_array_append(result_set, k)) {
-            ok = false;
-            break;
-        }
-        if (!purc_variant_array_append(result_set, v)) {
-            ok = false;
-            break;
-        }
-    end_foreach;
-
-    if (ok) {
-        PCEXE_CLR_VAR(exe_range_inst->result_set);
-        exe_range_inst->result_set = result_set;
-        purc_variant_ref(result_set);
-    }
-
-    return ok;
-}
-
-static inline bool
-prepare_result_set(struct pcexec_exe_range_inst *exe_range_inst)
-{
-    purc_variant_t result_set;
-    result_set = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (result_set == PURC_VARIANT_INVALID) {
-        return false;
-    }
-
-    bool ok = init_result_set(exe_range_inst, result_set);
-    purc_variant_unref(result_set);
-
-    return ok;
 }
 
 static inline bool
@@ -195,23 +59,15 @@ parse_rule(struct pcexec_exe_range_inst *exe_range_inst,
 {
     purc_exec_inst_t inst = &exe_range_inst->super;
 
-    struct exe_range_param param = {0};
-    int r = exe_range_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_range_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            range_parse_param, range_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_range_param_reset(&exe_range_inst->param);
-    exe_range_inst->param = param;
+    exe_range_inst->param = *param;
 
-    return prepare_result_set(exe_range_inst);
+    return true;
 }
 
 static inline bool
@@ -229,9 +85,11 @@ check_curr(struct pcexec_exe_range_inst *exe_range_inst)
         return false;
     }
 
-    purc_variant_t result_set = exe_range_inst->result_set;
+    /* fetch the members from the input directly, so that no result set
+       is built before the iteration */
+    purc_variant_t input = inst->input;
     size_t nr;
-    if (!purc_variant_array_size(result_set, &nr)) {
+    if (!purc_variant_linear_container_size(input, &nr)) {
         pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
         return false;
     }
@@ -259,7 +117,7 @@ check_curr(struct pcexec_exe_range_inst *exe_range_inst)
         }
     }
 
-    purc_variant_t item = purc_variant_array_get(result_set, curr);
+    purc_variant_t item = purc_variant_linear_container_get(input, curr);
     PCEXE_CLR_VAR(inst->value);
     inst->value = item;
     purc_variant_ref(item);
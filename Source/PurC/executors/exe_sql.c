@@ -22,116 +22,1376 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+
 #include "exe_sql.h"
 
+#include "pcexe-helper.h"
+
 #include "private/executor.h"
+#include "private/variant.h"
 
 #include "private/debug.h"
 #include "private/errors.h"
 
+#include <math.h>
+#include <stdint.h>
+
 struct pcexec_exe_sql_inst {
     struct purc_exec_inst       super;
+
+    struct exe_sql_param        param;
+
+    /* the rows selected by the rule */
+    purc_variant_t              results;
 };
 
-// 创建一个执行器实例
-static purc_exec_inst_t
-exe_sql_create(enum purc_exec_type type,
-        purc_variant_t input, bool asc_desc)
+/* the context to evaluate the expressions */
+struct sql_ctxt {
+    purc_variant_t              input;
+    bool                        single;     // the input object is the row
+    size_t                      nr_rows;
+
+    /* the rows of the current group for the aggregate functions */
+    const size_t               *group;
+    size_t                      nr_group;
+};
+
+/* an entry of the result to sort */
+struct sql_entry {
+    size_t                      idx;        // the (first) source row
+    purc_variant_t              value;      // the output value
+    purc_variant_t             *keys;       // the keys to sort
+    size_t                      nr_keys;
+    int                         dir;        // 1 for ASC, -1 for DESC
+};
+
+PCEXE_DEFINE_RULE_PARSER(sql)
+
+static const char *func_names[] = {
+    "count",    // SQL_FUNC_COUNT
+    "sum",      // SQL_FUNC_SUM
+    "avg",      // SQL_FUNC_AVG
+    "min",      // SQL_FUNC_MIN
+    "max",      // SQL_FUNC_MAX
+};
+
+int
+sql_func_by_name(const char *name, size_t len)
 {
-    if (!purc_variant_is_object(input))
-        return NULL;
+    for (size_t i = 0; i < PCA_TABLESIZE(func_names); i++) {
+        if (strlen(func_names[i]) == len &&
+                strncasecmp(func_names[i], name, len) == 0)
+            return (int)i;
+    }
 
-    struct pcexec_exe_sql_inst *inst;
-    inst = calloc(1, sizeof(*inst));
-    if (!inst) {
-        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
-        return NULL;
+    return -1;
+}
+
+struct sql_exp *
+sql_exp_new(enum sql_exp_type type)
+{
+    struct sql_exp *exp = calloc(1, sizeof(*exp));
+    if (exp)
+        exp->type = type;
+    return exp;
+}
+
+void
+sql_exp_destroy(struct sql_exp *exp)
+{
+    while (exp) {
+        struct sql_exp *next = exp->next;
+
+        free(exp->name);
+        free(exp->sub);
+        free(exp->alias);
+        if (exp->literal)
+            purc_variant_unref(exp->literal);
+        sql_exp_destroy(exp->l);
+        sql_exp_destroy(exp->r);
+        if (exp->pattern) {
+            string_pattern_expression_reset(exp->pattern);
+            free(exp->pattern);
+        }
+        free(exp);
+
+        exp = next;
     }
+}
 
-    inst->super.type        = type;
-    inst->super.input       = input;
-    inst->super.asc_desc    = asc_desc;
+void
+sql_select_destroy(struct sql_select *select)
+{
+    while (select) {
+        struct sql_select *next = select->next;
 
-    purc_variant_ref(input);
+        sql_exp_destroy(select->items);
+        sql_exp_destroy(select->where);
+        sql_exp_destroy(select->group_by);
+        sql_exp_destroy(select->order_by);
+        free(select);
 
-    return &inst->super;
+        select = next;
+    }
 }
 
 static inline bool
-exe_sql_parse_rule(purc_exec_inst_t inst, const char* rule)
+is_numeric(purc_variant_t v)
 {
-    // parse and fill the internal fields from rule
-    // for example, generating the `selected_keys` which contains all
-    // selected keys.
+    switch (purc_variant_get_type(v)) {
+    case PURC_VARIANT_TYPE_BOOLEAN:
+    case PURC_VARIANT_TYPE_NUMBER:
+    case PURC_VARIANT_TYPE_LONGINT:
+    case PURC_VARIANT_TYPE_ULONGINT:
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+        return true;
+    default:
+        return false;
+    }
+}
 
-    // clear previously-selected-keys
-    if (inst->selected_keys) {
-        purc_variant_unref(inst->selected_keys);
-        inst->selected_keys = PURC_VARIANT_INVALID;
+int
+sql_value_rank(purc_variant_t v)
+{
+    if (v == PURC_VARIANT_INVALID)
+        return 0;
+
+    switch (purc_variant_get_type(v)) {
+    case PURC_VARIANT_TYPE_UNDEFINED:
+    case PURC_VARIANT_TYPE_NULL:
+        return 0;
+    case PURC_VARIANT_TYPE_STRING:
+        return 2;
+    default:
+        return is_numeric(v) ? 1 : 3;
     }
+}
 
-    // TODO: parse rule and eval to selected_keys
+static inline int
+sign_of(int r)
+{
+    return (r > 0) - (r < 0);
+}
 
-    UNUSED_PARAM(inst);
-    UNUSED_PARAM(rule);
+static inline int
+compare_doubles(double a, double b)
+{
+    /* NaN comes before all other numbers */
+    if (isnan(a) || isnan(b))
+        return isnan(b) - isnan(a);
+    return (a > b) - (a < b);
+}
+
+int
+sql_value_order(purc_variant_t a, purc_variant_t b)
+{
+    int ra = sql_value_rank(a);
+    int rb = sql_value_rank(b);
+    if (ra != rb)
+        return ra < rb ? -1 : 1;
+
+    switch (ra) {
+    case 0:
+        return 0;
+    case 1:
+        return compare_doubles(purc_variant_numerify(a),
+                purc_variant_numerify(b));
+    case 2:
+        return sign_of(strcmp(purc_variant_get_string_const(a),
+                    purc_variant_get_string_const(b)));
+    default:
+        return sign_of(purc_variant_compare_ex(a, b,
+                    PCVRNT_COMPARE_METHOD_AUTO));
+    }
+}
+
+/* a string is taken as a number only if it is a number literal */
+static bool
+to_number(purc_variant_t v, double *d)
+{
+    if (is_numeric(v)) {
+        *d = purc_variant_numerify(v);
+        return true;
+    }
+
+    if (purc_variant_is_string(v)) {
+        const char *s = purc_variant_get_string_const(v);
+        char *end;
+        *d = strtod(s, &end);
+        return end != s && *end == '\0';
+    }
 
-    pcinst_set_error(PCEXECUTOR_ERROR_NOT_IMPLEMENTED);
     return false;
 }
 
-// 用于执行选择
+/* Compares two values in WHERE; returns false if they are not comparable,
+   e.g., one of them is null, or a string which is not a number is compared
+   with a number. */
+static bool
+compare_values(purc_variant_t a, purc_variant_t b, int *result)
+{
+    int ra = sql_value_rank(a);
+    int rb = sql_value_rank(b);
+    if (ra == 0 || rb == 0)
+        return false;
+
+    if (ra == 2 && rb == 2) {
+        *result = sign_of(strcmp(purc_variant_get_string_const(a),
+                    purc_variant_get_string_const(b)));
+        return true;
+    }
+
+    if (ra <= 2 && rb <= 2) {
+        double da, db;
+        if (!to_number(a, &da) || !to_number(b, &db) ||
+                isnan(da) || isnan(db))
+            return false;
+        *result = (da > db) - (da < db);
+        return true;
+    }
+
+    *result = sign_of(purc_variant_compare_ex(a, b,
+                PCVRNT_COMPARE_METHOD_AUTO));
+    return true;
+}
+
+static inline purc_variant_t
+get_row(struct sql_ctxt *ctxt, size_t idx)
+{
+    if (idx >= ctxt->nr_rows)
+        return PURC_VARIANT_INVALID;
+
+    if (ctxt->single)
+        return ctxt->input;
+
+    return purc_variant_linear_container_get(ctxt->input, idx);
+}
+
+/* returns the property of a row without referencing it */
 static purc_variant_t
-exe_sql_choose(purc_exec_inst_t inst, const char* rule)
+get_column(purc_variant_t row, const char *name, const char *sub)
 {
-    if (!inst || !rule) {
-        pcinst_set_error(PCEXECUTOR_ERROR_BAD_ARG);
+    if (row == PURC_VARIANT_INVALID || !purc_variant_is_object(row))
         return PURC_VARIANT_INVALID;
+
+    purc_variant_t v = purc_variant_object_get_by_ckey(row, name);
+    if (v != PURC_VARIANT_INVALID && sub) {
+        if (!purc_variant_is_object(v))
+            return PURC_VARIANT_INVALID;
+        v = purc_variant_object_get_by_ckey(v, sub);
     }
 
-    if (!exe_sql_parse_rule(inst, rule))
+    return v;
+}
+
+static inline purc_variant_t
+ref_or_undefined(purc_variant_t v)
+{
+    if (v == PURC_VARIANT_INVALID)
+        return purc_variant_make_undefined();
+    return purc_variant_ref(v);
+}
+
+static purc_variant_t
+eval_exp(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx);
+
+static int
+eval_cond(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx,
+        bool *result);
+
+static purc_variant_t
+eval_arith(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx)
+{
+    purc_variant_t l = eval_exp(ctxt, exp->l, idx);
+    if (l == PURC_VARIANT_INVALID)
         return PURC_VARIANT_INVALID;
 
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
+    purc_variant_t r = PURC_VARIANT_INVALID;
+    if (exp->r) {
+        r = eval_exp(ctxt, exp->r, idx);
+        if (r == PURC_VARIANT_INVALID) {
+            purc_variant_unref(l);
+            return PURC_VARIANT_INVALID;
+        }
+    }
+
+    double dl, dr = 0;
+    bool ok = to_number(l, &dl) && (!r || to_number(r, &dr));
+    purc_variant_unref(l);
+    if (r)
+        purc_variant_unref(r);
 
-    purc_variant_t vals = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (vals == PURC_VARIANT_INVALID) {
-        return vals;
+    if (!ok)
+        return purc_variant_make_undefined();
+
+    double d;
+    switch (exp->type) {
+    case SQL_EXP_ADD:
+        d = dl + dr;
+        break;
+    case SQL_EXP_SUB:
+        d = dl - dr;
+        break;
+    case SQL_EXP_MUL:
+        d = dl * dr;
+        break;
+    case SQL_EXP_DIV:
+        d = dl / dr;
+        break;
+    case SQL_EXP_NEG:
+    default:
+        d = -dl;
+        break;
     }
 
-    bool ok = true;
+    return purc_variant_make_number(d);
+}
 
-    for (size_t i=0; i<sz; ++i) {
-        purc_variant_t k;
-        k = purc_variant_array_get(inst->selected_keys, i);
-        purc_variant_t v;
-        v = purc_variant_object_get_ex(inst->input, k, true); // Since 0.9.22
-        if (v==PURC_VARIANT_INVALID)
+static purc_variant_t
+eval_func(struct sql_ctxt *ctxt, struct sql_exp *exp)
+{
+    if (ctxt->group == NULL) {
+        PC_WARN("Aggregate function %s() used out of the select list.\n",
+                exp->name);
+        pcinst_set_error(PCEXECUTOR_ERROR_NOT_ALLOWED);
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* no nested aggregate function */
+    struct sql_ctxt row_ctxt = *ctxt;
+    row_ctxt.group = NULL;
+    row_ctxt.nr_group = 0;
+
+    size_t count = 0;
+    double sum = 0;
+    purc_variant_t best = PURC_VARIANT_INVALID;
+
+    for (size_t i = 0; i < ctxt->nr_group; i++) {
+        purc_variant_t v = eval_exp(&row_ctxt, exp->l, ctxt->group[i]);
+        if (v == PURC_VARIANT_INVALID) {
+            if (best)
+                purc_variant_unref(best);
+            return PURC_VARIANT_INVALID;
+        }
+
+        if (sql_value_rank(v) == 0) {
+            purc_variant_unref(v);
             continue;
-        ok = purc_variant_array_append(vals, v);
-        if (!ok)
+        }
+
+        double d;
+        switch (exp->func) {
+        case SQL_FUNC_COUNT:
+            count++;
+            break;
+
+        case SQL_FUNC_SUM:
+        case SQL_FUNC_AVG:
+            if (to_number(v, &d) && !isnan(d)) {
+                sum += d;
+                count++;
+            }
+            break;
+
+        case SQL_FUNC_MIN:
+        case SQL_FUNC_MAX: {
+            int r = best ? sql_value_order(v, best) : 0;
+            if (best == PURC_VARIANT_INVALID ||
+                    (exp->func == SQL_FUNC_MIN ? r < 0 : r > 0)) {
+                if (best)
+                    purc_variant_unref(best);
+                best = purc_variant_ref(v);
+            }
+            break;
+        }
+        }
+
+        purc_variant_unref(v);
+    }
+
+    switch (exp->func) {
+    case SQL_FUNC_COUNT:
+        return purc_variant_make_number(count);
+    case SQL_FUNC_SUM:
+        return count ? purc_variant_make_number(sum) :
+            purc_variant_make_null();
+    case SQL_FUNC_AVG:
+        return count ? purc_variant_make_number(sum / count) :
+            purc_variant_make_null();
+    case SQL_FUNC_MIN:
+    case SQL_FUNC_MAX:
+    default:
+        return best ? best : purc_variant_make_null();
+    }
+}
+
+static purc_variant_t
+eval_exp(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx)
+{
+    switch (exp->type) {
+    case SQL_EXP_LITERAL:
+        return purc_variant_ref(exp->literal);
+
+    case SQL_EXP_VAR:
+        return ref_or_undefined(get_column(get_row(ctxt, idx),
+                    exp->name, exp->sub));
+
+    case SQL_EXP_ROW:
+        return ref_or_undefined(get_row(ctxt, idx));
+
+    case SQL_EXP_ATTR:
+        if (strcmp(exp->name, "__index") == 0 && idx < ctxt->nr_rows)
+            return purc_variant_make_ulongint(idx);
+        return purc_variant_make_undefined();
+
+    case SQL_EXP_FUNC:
+        return eval_func(ctxt, exp);
+
+    case SQL_EXP_ADD:
+    case SQL_EXP_SUB:
+    case SQL_EXP_MUL:
+    case SQL_EXP_DIV:
+    case SQL_EXP_NEG:
+        return eval_arith(ctxt, exp, idx);
+
+    default: {
+        bool result;
+        if (eval_cond(ctxt, exp, idx, &result))
+            return PURC_VARIANT_INVALID;
+        return purc_variant_make_boolean(result);
+    }
+    }
+}
+
+static int
+eval_comparison(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx,
+        bool *result)
+{
+    *result = false;
+
+    purc_variant_t l = eval_exp(ctxt, exp->l, idx);
+    if (l == PURC_VARIANT_INVALID)
+        return -1;
+
+    purc_variant_t r = eval_exp(ctxt, exp->r, idx);
+    if (r == PURC_VARIANT_INVALID) {
+        purc_variant_unref(l);
+        return -1;
+    }
+
+    int c;
+    if (compare_values(l, r, &c)) {
+        switch (exp->type) {
+        case SQL_EXP_EQ:
+            *result = (c == 0);
+            break;
+        case SQL_EXP_NE:
+            *result = (c != 0);
+            break;
+        case SQL_EXP_LT:
+            *result = (c < 0);
             break;
+        case SQL_EXP_LE:
+            *result = (c <= 0);
+            break;
+        case SQL_EXP_GT:
+            *result = (c > 0);
+            break;
+        case SQL_EXP_GE:
+        default:
+            *result = (c >= 0);
+            break;
+        }
+    }
+
+    purc_variant_unref(l);
+    purc_variant_unref(r);
+    return 0;
+}
+
+static struct string_pattern_expression *
+make_pattern(const char *wildcard)
+{
+    struct string_pattern_expression *pattern;
+    pattern = calloc(1, sizeof(*pattern));
+    if (pattern) {
+        pattern->type = STRING_PATTERN_WILDCARD;
+        pattern->wildcard.wildcard = strdup(wildcard);
+        if (!pattern->wildcard.wildcard) {
+            free(pattern);
+            pattern = NULL;
+        }
+    }
+
+    if (!pattern)
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+    return pattern;
+}
+
+static int
+eval_like(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx,
+        bool *result)
+{
+    *result = false;
+
+    struct string_pattern_expression *pattern = exp->pattern;
+    bool temp = false;
+    if (pattern == NULL) {
+        purc_variant_t r = eval_exp(ctxt, exp->r, idx);
+        if (r == PURC_VARIANT_INVALID)
+            return -1;
+
+        bool is_string = purc_variant_is_string(r);
+        if (is_string)
+            pattern = make_pattern(purc_variant_get_string_const(r));
+        purc_variant_unref(r);
+        if (!is_string)
+            return 0;
+        if (!pattern)
+            return -1;
+
+        /* compile the pattern only once for a literal */
+        if (exp->r->type == SQL_EXP_LITERAL)
+            exp->pattern = pattern;
+        else
+            temp = true;
+    }
+
+    purc_variant_t l = eval_exp(ctxt, exp->l, idx);
+    int ret = 0;
+    if (l == PURC_VARIANT_INVALID) {
+        ret = -1;
+    }
+    else {
+        /* a value too long to match is taken as mismatched */
+        if (sql_value_rank(l) > 0 &&
+                string_pattern_expression_eval(pattern, l, result))
+            *result = false;
+        purc_variant_unref(l);
+    }
+
+    if (temp) {
+        string_pattern_expression_reset(pattern);
+        free(pattern);
+    }
+    return ret;
+}
+
+static int
+eval_in(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx,
+        bool *result)
+{
+    *result = false;
+
+    purc_variant_t l = eval_exp(ctxt, exp->l, idx);
+    if (l == PURC_VARIANT_INVALID)
+        return -1;
+
+    int ret = 0;
+    for (struct sql_exp *e = exp->r; e && !*result; e = e->next) {
+        purc_variant_t r = eval_exp(ctxt, e, idx);
+        if (r == PURC_VARIANT_INVALID) {
+            ret = -1;
+            break;
+        }
+
+        int c;
+        *result = compare_values(l, r, &c) && c == 0;
+        purc_variant_unref(r);
+    }
+
+    purc_variant_unref(l);
+    return ret;
+}
+
+static int
+eval_cond(struct sql_ctxt *ctxt, struct sql_exp *exp, size_t idx,
+        bool *result)
+{
+    switch (exp->type) {
+    case SQL_EXP_AND:
+        if (eval_cond(ctxt, exp->l, idx, result))
+            return -1;
+        if (!*result)
+            return 0;
+        return eval_cond(ctxt, exp->r, idx, result);
+
+    case SQL_EXP_OR:
+        if (eval_cond(ctxt, exp->l, idx, result))
+            return -1;
+        if (*result)
+            return 0;
+        return eval_cond(ctxt, exp->r, idx, result);
+
+    case SQL_EXP_NOT:
+        if (eval_cond(ctxt, exp->l, idx, result))
+            return -1;
+        *result = !*result;
+        return 0;
+
+    case SQL_EXP_EQ:
+    case SQL_EXP_NE:
+    case SQL_EXP_LT:
+    case SQL_EXP_LE:
+    case SQL_EXP_GT:
+    case SQL_EXP_GE:
+        return eval_comparison(ctxt, exp, idx, result);
+
+    case SQL_EXP_LIKE:
+        return eval_like(ctxt, exp, idx, result);
+
+    case SQL_EXP_IN:
+        return eval_in(ctxt, exp, idx, result);
+
+    default: {
+        purc_variant_t v = eval_exp(ctxt, exp, idx);
+        if (v == PURC_VARIANT_INVALID)
+            return -1;
+        *result = purc_variant_booleanize(v);
+        purc_variant_unref(v);
+        return 0;
+    }
+    }
+}
+
+static bool
+has_aggregate(const struct sql_exp *exp)
+{
+    for (; exp; exp = exp->next) {
+        if (exp->type == SQL_EXP_FUNC ||
+                has_aggregate(exp->l) || has_aggregate(exp->r))
+            return true;
+    }
+
+    return false;
+}
+
+/* returns the key of an item in the output object */
+static const char *
+item_key(const struct sql_exp *item, size_t nr, char *buf, size_t sz)
+{
+    if (item->alias)
+        return item->alias;
+
+    switch (item->type) {
+    case SQL_EXP_VAR:
+        return item->sub ? item->sub : item->name;
+
+    case SQL_EXP_ATTR:
+        return item->name;
+
+    case SQL_EXP_FUNC:
+        return func_names[item->func];
+
+    default:
+        snprintf(buf, sz, "_%zu", nr);
+        return buf;
     }
+}
 
-    PC_ASSERT(0); // Not tested yet!!!
+static bool
+is_alias(const struct sql_select *select, const char *name)
+{
+    for (const struct sql_exp *item = select->items; item; item = item->next) {
+        if (item->alias && strcmp(item->alias, name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static purc_variant_t
+make_output(struct sql_ctxt *ctxt, const struct sql_select *select,
+        size_t idx)
+{
+    struct sql_exp *items = select->items;
 
-    if (ok) {
-        size_t n;
-        purc_variant_array_size(vals, &n);
-        if (n == 1) {
-            purc_variant_t v = purc_variant_array_get(vals, 0);
-            purc_variant_ref(v);
-            purc_variant_unref(vals);
-            vals = v;
+    /* SELECT * or SELECT & */
+    if (items->type == SQL_EXP_ROW && !items->alias && !items->next)
+        return ref_or_undefined(get_row(ctxt, idx));
+
+    purc_variant_t obj = purc_variant_make_object(0,
+            PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    size_t nr = 0;
+    for (struct sql_exp *item = items; item; item = item->next) {
+        nr++;
+
+        /* copy the properties of the row */
+        if (item->type == SQL_EXP_ROW && !item->alias) {
+            purc_variant_t row = get_row(ctxt, idx);
+            if (row == PURC_VARIANT_INVALID || !purc_variant_is_object(row))
+                continue;
+
+            purc_variant_t k, v;
+            bool ok = true;
+            foreach_key_value_in_variant_object(row, k, v)
+                ok = purc_variant_object_set(obj, k, v);
+                if (!ok)
+                    break;
+            end_foreach;
+
+            if (!ok)
+                goto failed;
+            continue;
         }
+
+        purc_variant_t v = eval_exp(ctxt, item, idx);
+        if (v == PURC_VARIANT_INVALID)
+            goto failed;
+
+        char buf[32];
+        bool ok = purc_variant_object_set_by_ckey(obj,
+                item_key(item, nr, buf, sizeof(buf)), v);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
     }
 
-    if (ok)
-        return vals;
+    return obj;
 
-    purc_variant_unref(vals);
+failed:
+    purc_variant_unref(obj);
     return PURC_VARIANT_INVALID;
 }
 
+/* an alias in ORDER BY refers to the property of the output */
+static purc_variant_t
+eval_order_key(struct sql_ctxt *ctxt, const struct sql_select *select,
+        struct sql_exp *exp, size_t idx, purc_variant_t value)
+{
+    if (exp->sub == NULL && is_alias(select, exp->name) &&
+            purc_variant_is_object(value)) {
+        return ref_or_undefined(purc_variant_object_get_by_ckey(value,
+                    exp->name));
+    }
+
+    return eval_exp(ctxt, exp, idx);
+}
+
+static int
+compare_entries(const void *a, const void *b)
+{
+    const struct sql_entry *ea = a;
+    const struct sql_entry *eb = b;
+
+    for (size_t i = 0; i < ea->nr_keys; i++) {
+        int r = sql_value_order(ea->keys[i], eb->keys[i]);
+        if (r)
+            return r * ea->dir;
+    }
+
+    /* keep the order of the rows for the equal keys */
+    return (ea->idx > eb->idx) - (ea->idx < eb->idx);
+}
+
+static size_t
+nr_exps(const struct sql_exp *exp)
+{
+    size_t n = 0;
+    for (; exp; exp = exp->next)
+        n++;
+    return n;
+}
+
+static void
+release_entries(struct sql_entry *entries, size_t nr, purc_variant_t *keys,
+        size_t nr_keys)
+{
+    for (size_t i = 0; i < nr; i++) {
+        PCEXE_CLR_VAR(entries[i].value);
+    }
+    for (size_t i = 0; i < nr * nr_keys; i++) {
+        PCEXE_CLR_VAR(keys[i]);
+    }
+    free(entries);
+    free(keys);
+}
+
+/* Sorts the rows by the expressions; the keys are evaluated on the rows. */
+static int
+sort_rows(struct sql_ctxt *ctxt, struct sql_exp *exps, size_t *rows,
+        size_t nr)
+{
+    size_t nr_keys = nr_exps(exps);
+    struct sql_entry *entries = calloc(nr, sizeof(*entries));
+    purc_variant_t *keys = calloc(nr * nr_keys, sizeof(*keys));
+    if (!entries || !keys) {
+        free(entries);
+        free(keys);
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return -1;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        struct sql_entry *entry = entries + i;
+        entry->idx = rows[i];
+        entry->keys = keys + i * nr_keys;
+        entry->nr_keys = nr_keys;
+        entry->dir = 1;
+
+        size_t j = 0;
+        for (struct sql_exp *exp = exps; exp; exp = exp->next, j++) {
+            entry->keys[j] = eval_exp(ctxt, exp, rows[i]);
+            if (entry->keys[j] == PURC_VARIANT_INVALID) {
+                release_entries(entries, nr, keys, nr_keys);
+                return -1;
+            }
+        }
+    }
+
+    qsort(entries, nr, sizeof(*entries), compare_entries);
+    for (size_t i = 0; i < nr; i++)
+        rows[i] = entries[i].idx;
+
+    release_entries(entries, nr, keys, nr_keys);
+    return 0;
+}
+
+static bool
+is_column(const struct sql_exp *exp)
+{
+    return exp->type == SQL_EXP_VAR && exp->sub == NULL;
+}
+
+static bool
+is_literal(const struct sql_exp *exp)
+{
+    return exp->type == SQL_EXP_LITERAL;
+}
+
+/* Finds the predicates which can use an index in the conjunction. */
+static void
+find_predicates(struct sql_exp *exp, struct sql_exp **equal,
+        struct sql_exp **range)
+{
+    switch (exp->type) {
+    case SQL_EXP_AND:
+        find_predicates(exp->l, equal, range);
+        find_predicates(exp->r, equal, range);
+        break;
+
+    case SQL_EXP_IN:
+        if (*equal == NULL && is_column(exp->l)) {
+            struct sql_exp *e = exp->r;
+            while (e && is_literal(e))
+                e = e->next;
+            if (e == NULL)
+                *equal = exp;
+        }
+        break;
+
+    case SQL_EXP_EQ:
+    case SQL_EXP_LT:
+    case SQL_EXP_LE:
+    case SQL_EXP_GT:
+    case SQL_EXP_GE: {
+        struct sql_exp **found = (exp->type == SQL_EXP_EQ) ? equal : range;
+        if (*found == NULL &&
+                ((is_column(exp->l) && is_literal(exp->r)) ||
+                 (is_literal(exp->l) && is_column(exp->r))))
+            *found = exp;
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+/* Finds the candidate rows for WHERE with an index; returns -1 if no index
+   can be used. The condition should be evaluated on the candidates still. */
+static int
+plan_where(struct sql_index_cache *cache, struct sql_exp *where,
+        struct sql_candidates *cands)
+{
+    struct sql_exp *equal = NULL, *range = NULL;
+    find_predicates(where, &equal, &range);
+
+    if (equal && equal->type == SQL_EXP_IN) {
+        size_t nr = nr_exps(equal->r);
+        purc_variant_t *values = malloc(sizeof(*values) * nr);
+        if (!values)
+            return -1;
+
+        size_t i = 0;
+        for (struct sql_exp *e = equal->r; e; e = e->next)
+            values[i++] = e->literal;
+
+        int r = sql_index_find_equal(cache, equal->l->name, values, nr,
+                cands);
+        free(values);
+        return r;
+    }
+
+    struct sql_exp *pred = equal ? equal : range;
+    if (pred == NULL)
+        return -1;
+
+    struct sql_exp *column = pred->l;
+    struct sql_exp *literal = pred->r;
+    enum sql_exp_type op = pred->type;
+    if (is_literal(column)) {
+        column = pred->r;
+        literal = pred->l;
+
+        /* `literal < column` is `column > literal` */
+        switch (op) {
+        case SQL_EXP_LT:
+            op = SQL_EXP_GT;
+            break;
+        case SQL_EXP_LE:
+            op = SQL_EXP_GE;
+            break;
+        case SQL_EXP_GT:
+            op = SQL_EXP_LT;
+            break;
+        case SQL_EXP_GE:
+            op = SQL_EXP_LE;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (op == SQL_EXP_EQ)
+        return sql_index_find_equal(cache, column->name,
+                &literal->literal, 1, cands);
+
+    return sql_index_find_range(cache, column->name, op, literal->literal,
+            cands);
+}
+
+/* Selects the rows satisfying WHERE; @rows are the candidates found by
+   an index, or NULL for all rows. */
+static int
+filter_rows(struct sql_ctxt *ctxt, const struct sql_select *select,
+        const size_t *rows, size_t nr, size_t **selected, size_t *nr_selected)
+{
+    *nr_selected = 0;
+    *selected = malloc(sizeof(size_t) * (nr ? nr : 1));
+    if (*selected == NULL) {
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return -1;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        size_t idx = rows ? rows[i] : i;
+        bool result = true;
+        if (select->where &&
+                eval_cond(ctxt, select->where, idx, &result)) {
+            free(*selected);
+            *selected = NULL;
+            return -1;
+        }
+
+        if (result)
+            (*selected)[(*nr_selected)++] = idx;
+    }
+
+    return 0;
+}
+
+struct sql_emitter {
+    purc_variant_t              results;
+    size_t                      nr_skip;
+    size_t                      nr_left;
+};
+
+static bool
+can_walk_index(const struct sql_select *select)
+{
+    struct sql_exp *order_by = select->order_by;
+    return order_by && order_by->next == NULL && is_column(order_by) &&
+        select->group_by == NULL && !has_aggregate(select->items) &&
+        !is_alias(select, order_by->name);
+}
+
+static int
+emit_row(struct sql_ctxt *ctxt, const struct sql_select *select,
+        struct sql_emitter *emitter, size_t idx)
+{
+    bool result = true;
+    if (select->where && eval_cond(ctxt, select->where, idx, &result))
+        return -1;
+
+    if (!result)
+        return 0;
+
+    if (emitter->nr_skip > 0) {
+        emitter->nr_skip--;
+        return 0;
+    }
+
+    purc_variant_t v = make_output(ctxt, select, idx);
+    if (v == PURC_VARIANT_INVALID)
+        return -1;
+
+    bool ok = purc_variant_array_append(emitter->results, v);
+    purc_variant_unref(v);
+    if (!ok)
+        return -1;
+
+    emitter->nr_left--;
+    return 0;
+}
+
+/* Walks the rows (all rows if @rows is NULL) in order; stops once enough
+   rows are selected. */
+static int
+walk_rows(struct sql_ctxt *ctxt, const struct sql_select *select,
+        const size_t *rows, size_t nr, struct sql_emitter *emitter)
+{
+    for (size_t i = 0; i < nr && emitter->nr_left; i++) {
+        if (emit_row(ctxt, select, emitter, rows ? rows[i] : i))
+            return -1;
+    }
+
+    return 0;
+}
+
+/* Walks the rows in the order of the index, so no sort is needed. */
+static int
+walk_index(struct sql_ctxt *ctxt, const struct sql_select *select,
+        const size_t *order, size_t nr, struct sql_emitter *emitter)
+{
+    const char *name = select->order_by->name;
+
+    if (!select->desc)
+        return walk_rows(ctxt, select, order, nr, emitter);
+
+    /* walk the runs of the equal keys backwards, but the rows in a run
+       forwards, to keep the order of the rows for the equal keys */
+    size_t end = nr;
+    while (end > 0 && emitter->nr_left) {
+        size_t start = end - 1;
+        purc_variant_t key = get_column(get_row(ctxt, order[start]),
+                name, NULL);
+        while (start > 0 && sql_value_order(get_column(get_row(ctxt,
+                            order[start - 1]), name, NULL), key) == 0)
+            start--;
+
+        for (size_t i = start; i < end && emitter->nr_left; i++) {
+            if (emit_row(ctxt, select, emitter, order[i]))
+                return -1;
+        }
+
+        end = start;
+    }
+
+    return 0;
+}
+
+/* Produces the outputs of the rows or the groups, then sorts them. */
+static int
+sort_outputs(struct sql_ctxt *ctxt, const struct sql_select *select,
+        bool grouped, size_t *rows, size_t nr_rows,
+        struct sql_emitter *emitter)
+{
+
+    /* the groups: the start of each group in the sorted rows */
+    size_t *starts = NULL;
+    size_t nr_groups = nr_rows;
+    if (grouped) {
+        if (select->group_by && sort_rows(ctxt, select->group_by,
+                    rows, nr_rows))
+            return -1;
+
+        /* one more for the empty group when there is no row */
+        starts = malloc(sizeof(size_t) * (nr_rows + 2));
+        if (!starts) {
+            pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+            return -1;
+        }
+
+        /* the whole is a group without GROUP BY, even if it is empty */
+        nr_groups = 0;
+        starts[nr_groups++] = 0;
+        for (size_t i = 1; select->group_by && i < nr_rows; i++) {
+            for (struct sql_exp *exp = select->group_by; exp;
+                    exp = exp->next) {
+                purc_variant_t a = eval_exp(ctxt, exp, rows[i - 1]);
+                purc_variant_t b = eval_exp(ctxt, exp, rows[i]);
+                int r = (a && b) ? sql_value_order(a, b) : 1;
+                PCEXE_CLR_VAR(a);
+                PCEXE_CLR_VAR(b);
+                if (r) {
+                    starts[nr_groups++] = i;
+                    break;
+                }
+            }
+        }
+
+        if (select->group_by && nr_rows == 0)
+            nr_groups = 0;
+        starts[nr_groups] = nr_rows;
+    }
+
+    size_t nr_keys = nr_exps(select->order_by);
+    struct sql_entry *entries = calloc(nr_groups ? nr_groups : 1,
+            sizeof(*entries));
+    purc_variant_t *keys = calloc(nr_groups * nr_keys + 1, sizeof(*keys));
+    if (!entries || !keys) {
+        free(entries);
+        free(keys);
+        free(starts);
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return -1;
+    }
+
+    for (size_t i = 0; i < nr_groups; i++) {
+        struct sql_entry *entry = entries + i;
+        if (grouped) {
+            ctxt->group = rows + starts[i];
+            ctxt->nr_group = starts[i + 1] - starts[i];
+            entry->idx = ctxt->nr_group ? ctxt->group[0] : SIZE_MAX;
+        }
+        else {
+            entry->idx = rows[i];
+        }
+        entry->keys = keys + i * nr_keys;
+        entry->nr_keys = nr_keys;
+        entry->dir = select->desc ? -1 : 1;
+
+        entry->value = make_output(ctxt, select, entry->idx);
+        if (entry->value == PURC_VARIANT_INVALID)
+            goto failed;
+
+        size_t j = 0;
+        for (struct sql_exp *exp = select->order_by; exp;
+                exp = exp->next, j++) {
+            entry->keys[j] = eval_order_key(ctxt, select, exp, entry->idx,
+                    entry->value);
+            if (entry->keys[j] == PURC_VARIANT_INVALID)
+                goto failed;
+        }
+    }
+
+    ctxt->group = NULL;
+    ctxt->nr_group = 0;
+
+    if (nr_keys)
+        qsort(entries, nr_groups, sizeof(*entries), compare_entries);
+
+    for (size_t i = emitter->nr_skip; i < nr_groups && emitter->nr_left; i++) {
+        if (!purc_variant_array_append(emitter->results, entries[i].value))
+            goto failed;
+        emitter->nr_left--;
+    }
+
+    release_entries(entries, nr_groups, keys, nr_keys);
+    free(starts);
+    return 0;
+
+failed:
+    ctxt->group = NULL;
+    ctxt->nr_group = 0;
+    release_entries(entries, nr_groups, keys, nr_keys);
+    free(starts);
+    return -1;
+}
+
+static purc_variant_t
+run_select(purc_variant_t input, const struct sql_select *select)
+{
+    if (select->next || select->travel != SQL_TRAVEL_NONE) {
+        PC_WARN("UNION and TRAVEL IN are not supported by SQL executor.\n");
+        pcinst_set_error(PCEXECUTOR_ERROR_NOT_IMPLEMENTED);
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct sql_ctxt ctxt = { input, false, 0, NULL, 0 };
+    if (purc_variant_is_object(input)) {
+        ctxt.single = true;
+        ctxt.nr_rows = 1;
+    }
+    else {
+        purc_variant_linear_container_size(input, &ctxt.nr_rows);
+    }
+
+    struct sql_emitter emitter;
+    emitter.nr_skip = select->offset > 0 ? select->offset : 0;
+    emitter.nr_left = select->limit >= 0 ? (size_t)select->limit : SIZE_MAX;
+    emitter.results = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    if (emitter.results == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    /* the indexes are built only for big containers */
+    struct sql_index_cache *cache = NULL;
+    if (!ctxt.single)
+        cache = sql_index_cache_get(input);
+
+    const size_t *order = NULL;
+    size_t nr_order = 0;
+    if (cache && can_walk_index(select))
+        order = sql_index_get_order(cache, select->order_by->name,
+                &nr_order);
+
+    int r;
+    if (order) {
+        r = walk_index(&ctxt, select, order, nr_order, &emitter);
+    }
+    else {
+        struct sql_candidates cands = { NULL, 0, 0 };
+        bool use_index = select->where && cache &&
+            plan_where(cache, select->where, &cands) == 0;
+        const size_t *rows = use_index ? cands.idx : NULL;
+        size_t nr_rows = use_index ? cands.nr : ctxt.nr_rows;
+
+        bool grouped = select->group_by || has_aggregate(select->items);
+        if (!grouped && select->order_by == NULL) {
+            r = walk_rows(&ctxt, select, rows, nr_rows, &emitter);
+        }
+        else {
+            size_t *selected, nr_selected;
+            r = filter_rows(&ctxt, select, rows, nr_rows,
+                    &selected, &nr_selected);
+            if (r == 0) {
+                r = sort_outputs(&ctxt, select, grouped,
+                        selected, nr_selected, &emitter);
+                free(selected);
+            }
+        }
+
+        sql_candidates_release(&cands);
+    }
+
+    if (r) {
+        purc_variant_unref(emitter.results);
+        return PURC_VARIANT_INVALID;
+    }
+
+    return emitter.results;
+}
+
+// clear internal data except `input`
+static inline void
+reset(struct pcexec_exe_sql_inst *exe_sql_inst)
+{
+    // the fields of param are owned by the rule cache
+    memset(&exe_sql_inst->param, 0, sizeof(exe_sql_inst->param));
+    pcexecutor_inst_reset(&exe_sql_inst->super);
+    PCEXE_CLR_VAR(exe_sql_inst->results);
+}
+
+static inline bool
+parse_rule(struct pcexec_exe_sql_inst *exe_sql_inst,
+        const char* rule)
+{
+    purc_exec_inst_t inst = &exe_sql_inst->super;
+
+    const struct exe_sql_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            sql_parse_param, sql_release_param);
+    if (!param)
+        return false;
+
+    exe_sql_inst->param = *param;
+
+    return true;
+}
+
+static bool
+query(struct pcexec_exe_sql_inst *exe_sql_inst, const char *rule)
+{
+    if (!parse_rule(exe_sql_inst, rule))
+        return false;
+
+    PCEXE_CLR_VAR(exe_sql_inst->results);
+    exe_sql_inst->results = run_select(exe_sql_inst->super.input,
+            exe_sql_inst->param.select);
+    return exe_sql_inst->results != PURC_VARIANT_INVALID;
+}
+
+static inline void
+destroy(struct pcexec_exe_sql_inst *exe_sql_inst)
+{
+    purc_exec_inst_t inst = &exe_sql_inst->super;
+
+    reset(exe_sql_inst);
+
+    PCEXE_CLR_VAR(inst->input);
+    PCEXE_CLR_VAR(inst->value);
+
+    free(exe_sql_inst);
+}
+
+// 创建一个执行器实例
+static purc_exec_inst_t
+exe_sql_create(enum purc_exec_type type,
+        purc_variant_t input, bool asc_desc)
+{
+    switch (purc_variant_get_type(input)) {
+    case PURC_VARIANT_TYPE_OBJECT:
+    case PURC_VARIANT_TYPE_ARRAY:
+    case PURC_VARIANT_TYPE_SET:
+        break;
+    default:
+        pcinst_set_error(PCEXECUTOR_ERROR_BAD_ARG);
+        return NULL;
+    }
+
+    struct pcexec_exe_sql_inst *exe_sql_inst;
+    exe_sql_inst = calloc(1, sizeof(*exe_sql_inst));
+    if (!exe_sql_inst) {
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return NULL;
+    }
+
+    purc_exec_inst_t inst = &exe_sql_inst->super;
+
+    inst->type        = type;
+    inst->asc_desc    = asc_desc;
+    inst->input       = purc_variant_ref(input);
+
+    int debug_flex, debug_bison;
+    pcexecutor_get_debug(&debug_flex, &debug_bison);
+    exe_sql_inst->param.debug_flex  = debug_flex;
+    exe_sql_inst->param.debug_bison = debug_bison;
+
+    return inst;
+}
+
+// 用于执行选择
+static purc_variant_t
+exe_sql_choose(purc_exec_inst_t inst, const char* rule)
+{
+    if (!inst || !rule) {
+        pcinst_set_error(PCEXECUTOR_ERROR_BAD_ARG);
+        return PURC_VARIANT_INVALID;
+    }
+
+    struct pcexec_exe_sql_inst *exe_sql_inst;
+    exe_sql_inst = (struct pcexec_exe_sql_inst*)inst;
+
+    if (!query(exe_sql_inst, rule))
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t vals = exe_sql_inst->results;
+    if (purc_variant_array_get_size(vals) == 1)
+        return purc_variant_ref(purc_variant_array_get(vals, 0));
+
+    return purc_variant_ref(vals);
+}
+
+static inline purc_exec_iter_t
+check_curr(struct pcexec_exe_sql_inst *exe_sql_inst)
+{
+    purc_exec_inst_t inst = &exe_sql_inst->super;
+    purc_exec_iter_t it = &inst->it;
+
+    size_t sz = 0;
+    purc_variant_array_size(exe_sql_inst->results, &sz);
+    if (it->curr >= sz) {
+        pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
+        return NULL;
+    }
+
+    return it;
+}
+
 // 获得用于迭代的初始迭代子
 static purc_exec_iter_t
 exe_sql_it_begin(purc_exec_inst_t inst, const char* rule)
@@ -141,17 +1401,19 @@ exe_sql_it_begin(purc_exec_inst_t inst, const char* rule)
         return NULL;
     }
 
-    inst->it.curr = 0;
-    if (!exe_sql_parse_rule(inst, rule))
+    if (inst->type != PURC_EXEC_TYPE_ITERATE) {
+        pcinst_set_error(PCEXECUTOR_ERROR_NOT_ALLOWED);
         return NULL;
+    }
+
+    struct pcexec_exe_sql_inst *exe_sql_inst;
+    exe_sql_inst = (struct pcexec_exe_sql_inst*)inst;
 
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
-    if (sz<=0) {
-        pcinst_set_error(PCEXECUTOR_ERROR_NO_KEYS_SELECTED);
+    inst->it.curr = 0;
+    if (!query(exe_sql_inst, rule))
         return NULL;
-    }
 
-    return &inst->it;
+    return check_curr(exe_sql_inst);
 }
 
 // 根据迭代子获得对应的变体值
@@ -164,15 +1426,12 @@ exe_sql_it_value(purc_exec_inst_t inst, purc_exec_iter_t it)
     }
 
     PC_ASSERT(&inst->it == it);
-    PC_ASSERT(inst->selected_keys != PURC_VARIANT_INVALID);
-    PC_ASSERT(inst->input != PURC_VARIANT_INVALID);
 
-    purc_variant_t k;
-    k = purc_variant_array_get(inst->selected_keys, it->curr);
-    purc_variant_t v;
-    v = purc_variant_object_get_ex(inst->input, k, true); // Since 0.9.22
+    struct pcexec_exe_sql_inst *exe_sql_inst;
+    exe_sql_inst = (struct pcexec_exe_sql_inst*)inst;
+    PC_ASSERT(exe_sql_inst->results != PURC_VARIANT_INVALID);
 
-    return v;
+    return purc_variant_array_get(exe_sql_inst->results, it->curr);
 }
 
 // 获得下一个迭代子
@@ -188,26 +1447,31 @@ exe_sql_it_next(purc_exec_inst_t inst, purc_exec_iter_t it, const char* rule)
 
     PC_ASSERT(&inst->it == it);
 
-    if (rule) {
-        // clear previously-selected-keys
-        if (inst->selected_keys) {
-            purc_variant_unref(inst->selected_keys);
-            inst->selected_keys = PURC_VARIANT_INVALID;
-        }
+    struct pcexec_exe_sql_inst *exe_sql_inst;
+    exe_sql_inst = (struct pcexec_exe_sql_inst*)inst;
 
-        if (!exe_sql_parse_rule(inst, rule))
+    if (rule) {
+        if (!query(exe_sql_inst, rule))
             return NULL;
     }
 
     ++it->curr;
+    return check_curr(exe_sql_inst);
+}
 
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
-    if (it->curr >= sz) {
-        it->curr = sz;
-        return NULL;
-    }
-
-    return it;
+#define SET_KEY_AND_NUM(_o, _k, _d) {                        \
+    purc_variant_t v;                                        \
+    bool ok;                                                 \
+    v = purc_variant_make_number(_d);                        \
+    if (v == PURC_VARIANT_INVALID) {                         \
+        ok = false;                                          \
+        break;                                               \
+    }                                                        \
+    ok = purc_variant_object_set_by_static_ckey(obj,         \
+            _k, v);                                          \
+    purc_variant_unref(v);                                   \
+    if (!ok)                                                 \
+        break;                                               \
 }
 
 // 用于执行规约
@@ -219,36 +1483,63 @@ exe_sql_reduce(purc_exec_inst_t inst, const char* rule)
         return PURC_VARIANT_INVALID;
     }
 
-    if (!exe_sql_parse_rule(inst, rule))
+    struct pcexec_exe_sql_inst *exe_sql_inst;
+    exe_sql_inst = (struct pcexec_exe_sql_inst*)inst;
+
+    if (!query(exe_sql_inst, rule))
         return PURC_VARIANT_INVALID;
 
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
+    /* reduce the first item of the select list */
+    const struct sql_exp *first = exe_sql_inst->param.select->items;
+    char buf[32];
+    const char *key = NULL;
+    if (first->type != SQL_EXP_ROW || first->alias)
+        key = item_key(first, 1, buf, sizeof(buf));
 
-    purc_variant_t objs;
-    objs = purc_variant_make_object(0,
-                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
-    if (objs == PURC_VARIANT_INVALID) {
-        return objs;
-    }
+    size_t count = 0;
+    double sum   = 0;
+    double avg   = 0;
+    double max   = NAN;
+    double min   = NAN;
 
-    bool ok = false;
+    size_t nr = purc_variant_array_get_size(exe_sql_inst->results);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_array_get(exe_sql_inst->results, i);
+        if (key)
+            v = purc_variant_object_get_by_ckey(v, key);
 
-    for (size_t i=0; i<sz; ++i) {
-        purc_variant_t k;
-        k = purc_variant_array_get(inst->selected_keys, i);
-        purc_variant_t v;
-        v = purc_variant_object_get_ex(inst->input, k, true); // Since 0.9.22
-        if (v==PURC_VARIANT_INVALID)
+        ++count;
+        double d = v ? purc_variant_numerify(v) : NAN;
+        if (isnan(d))
             continue;
-        ok = purc_variant_object_set(objs, k, v);
-        if (!ok)
-            break;
+        sum += d;
+        if (isnan(max) || d > max)
+            max = d;
+        if (isnan(min) || d < min)
+            min = d;
     }
 
-    if (ok)
-        return objs;
+    if (count > 0) {
+        avg = sum / count;
+    }
+
+    purc_variant_t obj = purc_variant_make_object(0,
+            PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    do {
+        SET_KEY_AND_NUM(obj, "count", count);
+        SET_KEY_AND_NUM(obj, "sum", sum);
+        SET_KEY_AND_NUM(obj, "avg", avg);
+        SET_KEY_AND_NUM(obj, "max", max);
+        SET_KEY_AND_NUM(obj, "min", min);
+
+        return obj;
+    } while (0);
 
-    purc_variant_unref(objs);
+    purc_variant_unref(obj);
     return PURC_VARIANT_INVALID;
 }
 
@@ -261,18 +1552,10 @@ exe_sql_destroy(purc_exec_inst_t inst)
         return false;
     }
 
-    struct pcexec_exe_sql_inst *exe_sql_inst = (struct pcexec_exe_sql_inst*)inst;
+    struct pcexec_exe_sql_inst *exe_sql_inst;
+    exe_sql_inst = (struct pcexec_exe_sql_inst*)inst;
+    destroy(exe_sql_inst);
 
-    if (exe_sql_inst->super.input) {
-        purc_variant_unref(exe_sql_inst->super.input);
-        exe_sql_inst->super.input = PURC_VARIANT_INVALID;
-    }
-    if (exe_sql_inst->super.selected_keys) {
-        purc_variant_unref(exe_sql_inst->super.selected_keys);
-        exe_sql_inst->super.selected_keys = PURC_VARIANT_INVALID;
-    }
-
-    free(exe_sql_inst);
     return true;
 }
 
@@ -291,4 +1574,3 @@ int pcexec_exe_sql_register(void)
     bool ok = purc_register_executor("SQL", &exe_sql_ops);
     return ok ? 0 : -1;
 }
-
@@ -29,11 +29,184 @@
 #include "config.h"
 
 #include "purc-macros.h"
+#include "purc-variant.h"
+
+#include "private/debug.h"
+
+#include "pcexe-helper.h"
+
+#include <stdbool.h>
+
+enum sql_exp_type {
+    SQL_EXP_LITERAL,        // a number or a string
+    SQL_EXP_VAR,            // a property of the row: `name` or `name.sub`
+    SQL_EXP_ROW,            // `*` or `&`: the row itself
+    SQL_EXP_ATTR,           // `@name`: an attribute of the row
+    SQL_EXP_FUNC,           // an aggregate function
+    SQL_EXP_LIKE,
+    SQL_EXP_IN,
+    SQL_EXP_AND,
+    SQL_EXP_OR,
+    SQL_EXP_NOT,
+    SQL_EXP_EQ,
+    SQL_EXP_NE,
+    SQL_EXP_LT,
+    SQL_EXP_LE,
+    SQL_EXP_GT,
+    SQL_EXP_GE,
+    SQL_EXP_ADD,
+    SQL_EXP_SUB,
+    SQL_EXP_MUL,
+    SQL_EXP_DIV,
+    SQL_EXP_NEG,
+};
+
+enum sql_func_type {
+    SQL_FUNC_COUNT,
+    SQL_FUNC_SUM,
+    SQL_FUNC_AVG,
+    SQL_FUNC_MIN,
+    SQL_FUNC_MAX,
+};
+
+struct sql_exp
+{
+    enum sql_exp_type           type;
+    enum sql_func_type          func;       // for SQL_EXP_FUNC
+
+    char                       *name;       // for VAR, ATTR, and FUNC
+    char                       *sub;        // for VAR: `sub` in `name.sub`
+    char                       *alias;      // for the items of select list
+
+    purc_variant_t              literal;    // for SQL_EXP_LITERAL
+
+    /* the operands; the right one is the list of values for IN */
+    struct sql_exp             *l;
+    struct sql_exp             *r;
+
+    /* the wildcard pattern for LIKE a literal string; compiled on demand */
+    struct string_pattern_expression *pattern;
+
+    /* the next one in a list */
+    struct sql_exp             *next;
+};
+
+enum sql_travel_type {
+    SQL_TRAVEL_NONE,
+    SQL_TRAVEL_SIBLINGS,
+    SQL_TRAVEL_DEPTH,
+    SQL_TRAVEL_BREADTH,
+    SQL_TRAVEL_LEAVES,
+};
+
+struct sql_select
+{
+    struct sql_exp             *items;
+    struct sql_exp             *where;
+    struct sql_exp             *group_by;
+    struct sql_exp             *order_by;
+    bool                        desc;
+
+    long int                    limit;      // negative for no limit
+    long int                    offset;
+
+    enum sql_travel_type        travel;
+
+    /* the next select clause in UNION */
+    struct sql_select          *next;
+};
+
+struct exe_sql_param {
+    char *err_msg;
+    int debug_flex;
+    int debug_bison;
+
+    struct sql_select          *select;
+};
 
 PCA_EXTERN_C_BEGIN
 
 int pcexec_exe_sql_register(void);
 
+int exe_sql_parse(const char *input, size_t len,
+        struct exe_sql_param *param);
+
+struct sql_exp *sql_exp_new(enum sql_exp_type type);
+void sql_exp_destroy(struct sql_exp *exp);
+void sql_select_destroy(struct sql_select *select);
+
+/* Returns the aggregate function by name, or -1 if it is not supported. */
+int sql_func_by_name(const char *name, size_t len);
+
+static inline void
+exe_sql_param_reset(struct exe_sql_param *param)
+{
+    if (!param)
+        return;
+
+    if (param->err_msg) {
+        free(param->err_msg);
+        param->err_msg = NULL;
+    }
+
+    if (param->select) {
+        sql_select_destroy(param->select);
+        param->select = NULL;
+    }
+}
+
+/*
+ * The indexes built on the properties of the rows in a container for
+ * the SQL executor. The indexes are cached on the container, and dropped
+ * once the container or any row of it changes.
+ */
+struct sql_index_cache;
+
+/* The candidate rows found by an index, in the order of the rows. */
+struct sql_candidates {
+    size_t                     *idx;
+    size_t                      nr;
+    size_t                      sz;
+};
+
+/* Gets the index cache of @ctnr, creates it if there is none. */
+struct sql_index_cache *sql_index_cache_get(purc_variant_t ctnr);
+
+/* Sets the minimal number of rows of a container to build the indexes on
+   in the current instance; zero for the default and SIZE_MAX to always scan
+   the rows. Returns the old one. */
+size_t sql_index_set_min_rows(size_t nr_rows);
+
+/* Finds the rows whose property @name may be equal to one of @values. */
+int sql_index_find_equal(struct sql_index_cache *cache, const char *name,
+        purc_variant_t *values, size_t nr_values,
+        struct sql_candidates *cands);
+
+/* Finds the rows whose property @name may satisfy `@name @op @value`. */
+int sql_index_find_range(struct sql_index_cache *cache, const char *name,
+        enum sql_exp_type op, purc_variant_t value,
+        struct sql_candidates *cands);
+
+/* Gets the rows ordered by the property @name; the returned array is
+   owned by the cache and valid until the container or a row changes. */
+const size_t *sql_index_get_order(struct sql_index_cache *cache,
+        const char *name, size_t *nr);
+
+static inline void
+sql_candidates_release(struct sql_candidates *cands)
+{
+    free(cands->idx);
+    cands->idx = NULL;
+    cands->nr = cands->sz = 0;
+}
+
+/* The rank of the type of a value in ORDER BY: undefined and null first,
+   then the numbers, the strings, and others. */
+int sql_value_rank(purc_variant_t v);
+
+/* Compares two values in the total order used by ORDER BY. */
+int sql_value_order(purc_variant_t a, purc_variant_t b);
+
 PCA_EXTERN_C_END
 
 #endif // PURC_EXECUTOR_SQL_H
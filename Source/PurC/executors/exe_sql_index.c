@@ -0,0 +1,601 @@
+/*
+ * @file exe_sql_index.c
+ * @brief The indexes on the rows of a container for SQL executor.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "exe_sql.h"
+
+#include "private/executor.h"
+#include "private/variant.h"
+#include "private/hashtable.h"
+
+#include "private/debug.h"
+#include "private/errors.h"
+#include "private/instance.h"
+
+#include <math.h>
+#include <stdint.h>
+
+/*
+ * An index is built on a property of the rows when a query needs it, and
+ * is cached on the container with a post listener. The cache references
+ * and listens to the rows while there are indexes; any change of the
+ * container or a row drops all indexes, which will be rebuilt by the next
+ * query needing them.
+ *
+ * The rows are sorted by the rank of the type of the property (see
+ * sql_value_rank()), then the value, then the position. A number can be
+ * equal to a string in WHERE (e.g., 10 = '10'), so the whole segment of
+ * the other rank and the segment of other types are always candidates.
+ */
+
+#define SQL_INDEX_MIN_ROWS      64
+#define SQL_INDEX_MAX_COLUMNS   8
+
+#define NR_RANKS                4
+#define RANK_NUMBER             1
+#define RANK_STRING             2
+#define RANK_OTHER              3
+
+#define NO_ROW                  SIZE_MAX
+
+struct sql_index {
+    char                       *name;
+
+    /* the property of every row; not referenced */
+    purc_variant_t             *keys;
+
+    /* the rows sorted by (rank, key, position) */
+    size_t                     *sorted;
+
+    /* the start of the rows of each rank in `sorted` */
+    size_t                      segs[NR_RANKS + 1];
+
+    /* the hash table of the numbers and the strings; built on demand */
+    size_t                      nr_buckets;
+    size_t                     *buckets;
+    size_t                     *chain;
+};
+
+struct sql_index_cache {
+    purc_variant_t              ctnr;
+    struct pcvar_listener      *listener;
+
+    size_t                      nr_rows;
+    purc_variant_t             *rows;
+    struct pcvar_listener     **row_listeners;
+
+    struct sql_index           *indexes[SQL_INDEX_MAX_COLUMNS];
+    size_t                      nr_indexes;
+};
+
+static void
+index_destroy(struct sql_index *index)
+{
+    free(index->name);
+    free(index->keys);
+    free(index->sorted);
+    free(index->buckets);
+    free(index->chain);
+    free(index);
+}
+
+static void
+drop_indexes(struct sql_index_cache *cache)
+{
+    for (size_t i = 0; i < cache->nr_indexes; i++) {
+        index_destroy(cache->indexes[i]);
+        cache->indexes[i] = NULL;
+    }
+    cache->nr_indexes = 0;
+
+    if (cache->rows) {
+        for (size_t i = 0; i < cache->nr_rows; i++) {
+            if (cache->row_listeners[i])
+                purc_variant_revoke_listener(cache->rows[i],
+                        cache->row_listeners[i]);
+            purc_variant_unref(cache->rows[i]);
+        }
+
+        free(cache->rows);
+        free(cache->row_listeners);
+        cache->rows = NULL;
+        cache->row_listeners = NULL;
+        cache->nr_rows = 0;
+    }
+}
+
+static bool
+on_row_changed(purc_variant_t src, pcvar_op_t op, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    UNUSED_PARAM(src);
+    UNUSED_PARAM(op);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    drop_indexes(ctxt);
+    return true;
+}
+
+static bool
+on_container_changed(purc_variant_t src, pcvar_op_t op, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    struct sql_index_cache *cache = ctxt;
+    drop_indexes(cache);
+
+    if (op == PCVAR_OPERATION_RELEASING) {
+        purc_variant_revoke_listener(src, cache->listener);
+        free(cache);
+    }
+
+    return true;
+}
+
+size_t
+sql_index_set_min_rows(size_t nr_rows)
+{
+    struct pcexecutor_heap *heap = pcinst_current()->executor_heap;
+    size_t old = heap->sql_index_min_rows;
+    heap->sql_index_min_rows = nr_rows;
+    return old;
+}
+
+struct sql_index_cache *
+sql_index_cache_get(purc_variant_t ctnr)
+{
+    struct pcexecutor_heap *heap = pcinst_current()->executor_heap;
+    size_t min_rows = heap->sql_index_min_rows ?
+        heap->sql_index_min_rows : SQL_INDEX_MIN_ROWS;
+
+    size_t nr = 0;
+    if (!purc_variant_linear_container_size(ctnr, &nr) || nr < min_rows)
+        return NULL;
+
+    struct pcvar_listener *listener;
+    list_for_each_entry(listener, &ctnr->listeners, list_node) {
+        if (listener->handler == on_container_changed)
+            return listener->ctxt;
+    }
+
+    struct sql_index_cache *cache = calloc(1, sizeof(*cache));
+    if (cache == NULL)
+        return NULL;
+
+    cache->ctnr = ctnr;
+    cache->listener = purc_variant_register_post_listener(ctnr,
+            PCVAR_OPERATION_INFLATED | PCVAR_OPERATION_DEFLATED |
+            PCVAR_OPERATION_MODIFIED | PCVAR_OPERATION_RELEASING,
+            on_container_changed, cache);
+    if (cache->listener == NULL) {
+        free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+/* a row may occur more than once in the container, but is listened once */
+static bool
+is_listened(struct sql_index_cache *cache, purc_variant_t row)
+{
+    struct pcvar_listener *listener;
+    list_for_each_entry(listener, &row->listeners, list_node) {
+        if (listener->handler == on_row_changed && listener->ctxt == cache)
+            return true;
+    }
+
+    return false;
+}
+
+/* references and listens to the rows before building the first index */
+static int
+attach_rows(struct sql_index_cache *cache)
+{
+    if (cache->rows)
+        return 0;
+
+    size_t nr = 0;
+    purc_variant_linear_container_size(cache->ctnr, &nr);
+    cache->rows = calloc(nr, sizeof(purc_variant_t));
+    cache->row_listeners = calloc(nr, sizeof(struct pcvar_listener *));
+    if (!cache->rows || !cache->row_listeners)
+        goto failed;
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t row = purc_variant_linear_container_get(cache->ctnr, i);
+        cache->rows[i] = purc_variant_ref(row);
+        cache->nr_rows = i + 1;
+
+        if (purc_variant_is_object(row) && !is_listened(cache, row)) {
+            cache->row_listeners[i] = purc_variant_register_post_listener(row,
+                    PCVAR_OPERATION_INFLATED | PCVAR_OPERATION_DEFLATED |
+                    PCVAR_OPERATION_MODIFIED, on_row_changed, cache);
+            if (cache->row_listeners[i] == NULL)
+                goto failed;
+        }
+    }
+
+    return 0;
+
+failed:
+    if (cache->rows) {
+        drop_indexes(cache);
+    }
+    else {
+        free(cache->row_listeners);
+        cache->row_listeners = NULL;
+    }
+    return -1;
+}
+
+struct sort_item {
+    purc_variant_t      key;
+    size_t              idx;
+};
+
+static int
+compare_items(const void *a, const void *b)
+{
+    const struct sort_item *ia = a;
+    const struct sort_item *ib = b;
+
+    int r = sql_value_order(ia->key, ib->key);
+    if (r)
+        return r;
+    return (ia->idx > ib->idx) - (ia->idx < ib->idx);
+}
+
+static struct sql_index *
+index_build(struct sql_index_cache *cache, const char *name)
+{
+    size_t nr = cache->nr_rows;
+    struct sql_index *index = calloc(1, sizeof(*index));
+    struct sort_item *items = malloc(sizeof(*items) * nr);
+    if (!index || !items)
+        goto failed;
+
+    index->name = strdup(name);
+    index->keys = calloc(nr, sizeof(purc_variant_t));
+    index->sorted = malloc(sizeof(size_t) * nr);
+    if (!index->name || !index->keys || !index->sorted)
+        goto failed;
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t row = cache->rows[i];
+        if (purc_variant_is_object(row))
+            index->keys[i] = purc_variant_object_get_by_ckey(row, name);
+
+        items[i].key = index->keys[i];
+        items[i].idx = i;
+    }
+
+    qsort(items, nr, sizeof(*items), compare_items);
+
+    size_t counts[NR_RANKS] = { 0 };
+    for (size_t i = 0; i < nr; i++) {
+        index->sorted[i] = items[i].idx;
+        counts[sql_value_rank(items[i].key)]++;
+    }
+
+    index->segs[0] = 0;
+    for (int r = 0; r < NR_RANKS; r++)
+        index->segs[r + 1] = index->segs[r] + counts[r];
+
+    free(items);
+    return index;
+
+failed:
+    free(items);
+    if (index)
+        index_destroy(index);
+    return NULL;
+}
+
+static struct sql_index *
+index_get(struct sql_index_cache *cache, const char *name)
+{
+    if (attach_rows(cache))
+        return NULL;
+
+    for (size_t i = 0; i < cache->nr_indexes; i++) {
+        if (strcmp(cache->indexes[i]->name, name) == 0)
+            return cache->indexes[i];
+    }
+
+    if (cache->nr_indexes == SQL_INDEX_MAX_COLUMNS)
+        return NULL;
+
+    struct sql_index *index = index_build(cache, name);
+    if (index)
+        cache->indexes[cache->nr_indexes++] = index;
+    return index;
+}
+
+/* the values equal in sql_value_order() have the same hash value */
+static bool
+hash_key(purc_variant_t key, uint32_t *hash)
+{
+    switch (sql_value_rank(key)) {
+    case RANK_NUMBER: {
+        double d = purc_variant_numerify(key);
+        if (isnan(d))
+            return false;
+        if (d == 0)
+            d = 0;      // -0 and +0
+
+        uint64_t u;
+        memcpy(&u, &d, sizeof(u));
+        *hash = (uint32_t)(u ^ (u >> 32));
+        return true;
+    }
+
+    case RANK_STRING:
+        *hash = pchash_fnv1a_str_hash(purc_variant_get_string_const(key));
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static int
+index_build_hash(struct sql_index *index, size_t nr)
+{
+    if (index->buckets)
+        return 0;
+
+    size_t nr_buckets = 16;
+    while (nr_buckets < nr)
+        nr_buckets <<= 1;
+
+    index->buckets = malloc(sizeof(size_t) * nr_buckets);
+    index->chain = malloc(sizeof(size_t) * nr);
+    if (!index->buckets || !index->chain) {
+        free(index->buckets);
+        free(index->chain);
+        index->buckets = NULL;
+        index->chain = NULL;
+        return -1;
+    }
+
+    index->nr_buckets = nr_buckets;
+    for (size_t i = 0; i < nr_buckets; i++)
+        index->buckets[i] = NO_ROW;
+
+    /* insert backwards, so that a chain is in the order of the rows */
+    for (size_t i = nr; i > 0; i--) {
+        size_t idx = i - 1;
+        uint32_t hash;
+        index->chain[idx] = NO_ROW;
+        if (hash_key(index->keys[idx], &hash)) {
+            size_t b = hash & (nr_buckets - 1);
+            index->chain[idx] = index->buckets[b];
+            index->buckets[b] = idx;
+        }
+    }
+
+    return 0;
+}
+
+static int
+append_candidate(struct sql_candidates *cands, size_t idx)
+{
+    if (cands->nr == cands->sz) {
+        size_t sz = cands->sz ? cands->sz * 2 : 16;
+        size_t *p = realloc(cands->idx, sizeof(size_t) * sz);
+        if (p == NULL)
+            return -1;
+
+        cands->idx = p;
+        cands->sz = sz;
+    }
+
+    cands->idx[cands->nr++] = idx;
+    return 0;
+}
+
+static int
+append_sorted(struct sql_candidates *cands, const struct sql_index *index,
+        size_t from, size_t to)
+{
+    for (size_t i = from; i < to; i++) {
+        if (append_candidate(cands, index->sorted[i]))
+            return -1;
+    }
+
+    return 0;
+}
+
+/* the rows which may be compared with a value of @rank other than the
+   rows of the same rank */
+static int
+append_others(struct sql_candidates *cands, const struct sql_index *index,
+        int rank)
+{
+    if (rank == RANK_NUMBER || rank == RANK_STRING) {
+        int other = (rank == RANK_NUMBER) ? RANK_STRING : RANK_NUMBER;
+        if (append_sorted(cands, index, index->segs[other],
+                    index->segs[other + 1]))
+            return -1;
+    }
+
+    return append_sorted(cands, index, index->segs[RANK_OTHER],
+            index->segs[RANK_OTHER + 1]);
+}
+
+static int
+compare_sizes(const void *a, const void *b)
+{
+    size_t sa = *(const size_t *)a;
+    size_t sb = *(const size_t *)b;
+    return (sa > sb) - (sa < sb);
+}
+
+/* sorts the candidates in the order of the rows, and removes duplicates */
+static void
+normalize_candidates(struct sql_candidates *cands)
+{
+    if (cands->nr == 0)
+        return;
+
+    qsort(cands->idx, cands->nr, sizeof(size_t), compare_sizes);
+
+    size_t n = 1;
+    for (size_t i = 1; i < cands->nr; i++) {
+        if (cands->idx[i] != cands->idx[n - 1])
+            cands->idx[n++] = cands->idx[i];
+    }
+    cands->nr = n;
+}
+
+int
+sql_index_find_equal(struct sql_index_cache *cache, const char *name,
+        purc_variant_t *values, size_t nr_values,
+        struct sql_candidates *cands)
+{
+    struct sql_index *index = index_get(cache, name);
+    if (index == NULL || index_build_hash(index, cache->nr_rows))
+        return -1;
+
+    bool others[NR_RANKS] = { false };
+    for (size_t i = 0; i < nr_values; i++) {
+        int rank = sql_value_rank(values[i]);
+        uint32_t hash;
+        if (!hash_key(values[i], &hash)) {
+            /* null is equal to nothing, and others may be equal to any */
+            if (rank == RANK_OTHER) {
+                others[RANK_NUMBER] = others[RANK_STRING] = true;
+                if (append_others(cands, index, RANK_NUMBER) ||
+                        append_others(cands, index, RANK_STRING))
+                    goto failed;
+            }
+            continue;
+        }
+
+        others[rank] = true;
+        size_t idx = index->buckets[hash & (index->nr_buckets - 1)];
+        for (; idx != NO_ROW; idx = index->chain[idx]) {
+            if (sql_value_order(index->keys[idx], values[i]) == 0 &&
+                    append_candidate(cands, idx))
+                goto failed;
+        }
+    }
+
+    for (int rank = 1; rank < NR_RANKS; rank++) {
+        if (others[rank] && append_others(cands, index, rank))
+            goto failed;
+    }
+
+    normalize_candidates(cands);
+    return 0;
+
+failed:
+    sql_candidates_release(cands);
+    return -1;
+}
+
+/* the first position in [from, to) of `sorted` whose key is not less than
+   (or greater than if @upper is true) @value */
+static size_t
+bound_of(const struct sql_index *index, size_t from, size_t to,
+        purc_variant_t value, bool upper)
+{
+    while (from < to) {
+        size_t mid = from + (to - from) / 2;
+        int r = sql_value_order(index->keys[index->sorted[mid]], value);
+        if (r < 0 || (upper && r == 0))
+            from = mid + 1;
+        else
+            to = mid;
+    }
+
+    return from;
+}
+
+int
+sql_index_find_range(struct sql_index_cache *cache, const char *name,
+        enum sql_exp_type op, purc_variant_t value,
+        struct sql_candidates *cands)
+{
+    struct sql_index *index = index_get(cache, name);
+    if (index == NULL)
+        return -1;
+
+    int rank = sql_value_rank(value);
+    if (rank == 0)
+        return 0;
+
+    size_t from = index->segs[rank];
+    size_t to = index->segs[rank + 1];
+    if (rank == RANK_OTHER) {
+        /* any value but null may be comparable with it */
+        from = index->segs[RANK_NUMBER];
+        to = index->segs[NR_RANKS];
+    }
+    else {
+        switch (op) {
+        case SQL_EXP_LT:
+            to = bound_of(index, from, to, value, false);
+            break;
+        case SQL_EXP_LE:
+            to = bound_of(index, from, to, value, true);
+            break;
+        case SQL_EXP_GT:
+            from = bound_of(index, from, to, value, true);
+            break;
+        case SQL_EXP_GE:
+            from = bound_of(index, from, to, value, false);
+            break;
+        default:
+            return -1;
+        }
+    }
+
+    if (append_sorted(cands, index, from, to) ||
+            (rank != RANK_OTHER && append_others(cands, index, rank))) {
+        sql_candidates_release(cands);
+        return -1;
+    }
+
+    normalize_candidates(cands);
+    return 0;
+}
+
+const size_t *
+sql_index_get_order(struct sql_index_cache *cache, const char *name,
+        size_t *nr)
+{
+    struct sql_index *index = index_get(cache, name);
+    if (index == NULL)
+        return NULL;
+
+    /* the order of other values may change without notification,
+       e.g., when a property of an object key changes */
+    if (index->segs[RANK_OTHER] != index->segs[NR_RANKS])
+        return NULL;
+
+    *nr = cache->nr_rows;
+    return index->sorted;
+}
@@ -42,12 +42,14 @@ struct pcexec_exe_token_inst {
     purc_variant_t              result_set;
 };
 
+PCEXE_DEFINE_RULE_PARSER(token)
+
 // clear internal data except `input`
 static inline void
 reset(struct pcexec_exe_token_inst *exe_token_inst)
 {
-    struct exe_token_param *param = &exe_token_inst->param;
-    exe_token_param_reset(param);
+    // the fields of param are owned by the rule cache
+    memset(&exe_token_inst->param, 0, sizeof(exe_token_inst->param));
     pcexecutor_inst_reset(&exe_token_inst->super);
     PCEXE_CLR_VAR(exe_token_inst->result_set);
 }
@@ -163,21 +165,13 @@ parse_rule(struct pcexec_exe_token_inst *exe_token_inst,
 {
     purc_exec_inst_t inst = &exe_token_inst->super;
 
-    struct exe_token_param param = {0};
-    int r = exe_token_parse(rule, strlen(rule), &param);
-    if (inst->err_msg) {
-        free(inst->err_msg);
-        inst->err_msg = NULL;
-    }
-
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    const struct exe_token_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            token_parse_param, token_release_param);
+    if (!param)
         return false;
-    }
 
-    exe_token_param_reset(&exe_token_inst->param);
-    exe_token_inst->param = param;
+    exe_token_inst->param = *param;
 
     return prepare_result_set(exe_token_inst);
 }
@@ -24,59 +24,509 @@
 
 #include "exe_travel.h"
 
+#include "pcexe-helper.h"
+
 #include "private/executor.h"
+#include "private/variant.h"
 
 #include "private/debug.h"
 #include "private/errors.h"
 
+#include <math.h>
+
+#define NR_MIN_FRAMES       16
+#define NO_PARENT           ((size_t)-1)
+
+/*
+ * The tree is walked with an explicit stack (or queue) of the containers
+ * being visited instead of recursion, so a step of the walk costs no
+ * allocation except for the growth of the stack, and the depth of the tree
+ * is limited by the memory only.
+ */
+struct travel_frame {
+    purc_variant_t                  ctnr;
+    struct pcexec_obj_keys          obj_keys;   // for an object
+    size_t                          idx;        // the next member to visit
+
+    /* the position of the container in its parent */
+    purc_variant_t                  key;        // for a member of object
+    size_t                          pos;
+    size_t                          parent;
+    size_t                          depth;
+
+    bool                            rewound;    // in the second pass
+};
+
 struct pcexec_exe_travel_inst {
     struct purc_exec_inst       super;
+
+    struct exe_travel_param     param;
+
+    /* the order of the current walk, which is fixed when the walk begins */
+    enum travel_order           order;
+
+    /* the stack of the containers for the depth-first orders, or the queue
+       for BREADTH; the frames passed by the head of the queue are kept
+       for the paths, but they hold no container any more. */
+    struct travel_frame        *frames;
+    size_t                      nr_frames;
+    size_t                      sz_frames;
+    size_t                      head;
+
+    /* the scratch to build a path */
+    size_t                     *chain;
 };
 
-// 创建一个执行器实例
-static purc_exec_inst_t
-exe_travel_create(enum purc_exec_type type,
-        purc_variant_t input, bool asc_desc)
+PCEXE_DEFINE_RULE_PARSER(travel)
+
+static void
+frame_release(struct travel_frame *frame)
 {
-    if (!purc_variant_is_object(input))
-        return NULL;
+    pcexecutor_obj_keys_release(&frame->obj_keys);
+    PCEXE_CLR_VAR(frame->ctnr);
+}
 
-    struct pcexec_exe_travel_inst *inst;
-    inst = calloc(1, sizeof(*inst));
-    if (!inst) {
-        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
-        return NULL;
+/* The keys of an object are taken once when the frame is pushed, so both
+   passes of SIBLINGS walk the same members even if the object is changed
+   by the body of the element in between. */
+static inline void
+frame_rewind(struct travel_frame *frame)
+{
+    frame->idx = 0;
+}
+
+/* Fetches the next member of the container; returns false if no more. */
+static bool
+frame_next_member(struct travel_frame *frame, purc_variant_t *value,
+        purc_variant_t *key, size_t *pos)
+{
+    if (frame->ctnr == PURC_VARIANT_INVALID)
+        return false;
+
+    if (purc_variant_is_object(frame->ctnr)) {
+        /* the properties removed since the keys were taken are skipped */
+        *value = pcexecutor_obj_keys_fetch(&frame->obj_keys, frame->ctnr,
+                &frame->idx, key);
+        if (*value == PURC_VARIANT_INVALID)
+            return false;
+
+        *pos = frame->idx++;
+        return true;
+    }
+
+    size_t sz;
+    if (!purc_variant_linear_container_size(frame->ctnr, &sz) ||
+            frame->idx >= sz)
+        return false;
+
+    *key = PURC_VARIANT_INVALID;
+    *pos = frame->idx;
+    *value = purc_variant_linear_container_get(frame->ctnr, frame->idx++);
+    return *value != PURC_VARIANT_INVALID;
+}
+
+static void
+clear_frames(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    for (size_t i = 0; i < exe_travel_inst->nr_frames; i++) {
+        struct travel_frame *frame = exe_travel_inst->frames + i;
+        frame_release(frame);
+        PCEXE_CLR_VAR(frame->key);
+    }
+
+    exe_travel_inst->nr_frames = 0;
+    exe_travel_inst->head = 0;
+}
+
+static bool
+push_frame(struct pcexec_exe_travel_inst *exe_travel_inst,
+        purc_variant_t ctnr, purc_variant_t key, size_t pos,
+        size_t parent, size_t depth)
+{
+    if (exe_travel_inst->nr_frames == exe_travel_inst->sz_frames) {
+        size_t sz = exe_travel_inst->sz_frames ?
+            exe_travel_inst->sz_frames * 2 : NR_MIN_FRAMES;
+
+        struct travel_frame *frames = realloc(exe_travel_inst->frames,
+                sizeof(*frames) * sz);
+        if (frames == NULL)
+            goto failed;
+        exe_travel_inst->frames = frames;
+
+        size_t *chain = realloc(exe_travel_inst->chain, sizeof(*chain) * sz);
+        if (chain == NULL)
+            goto failed;
+        exe_travel_inst->chain = chain;
+
+        exe_travel_inst->sz_frames = sz;
+    }
+
+    struct travel_frame *frame;
+    frame = exe_travel_inst->frames + exe_travel_inst->nr_frames++;
+    memset(frame, 0, sizeof(*frame));
+    frame->ctnr = purc_variant_ref(ctnr);
+    frame->key = key ? purc_variant_ref(key) : PURC_VARIANT_INVALID;
+    frame->pos = pos;
+    frame->parent = parent;
+    frame->depth = depth;
+    if (purc_variant_is_object(ctnr) &&
+            !pcexecutor_obj_keys_take(&frame->obj_keys, ctnr)) {
+        /* keep the frame to be released with the others */
+        return false;
+    }
+    return true;
+
+failed:
+    pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+    return false;
+}
+
+static void
+pop_frame(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    struct travel_frame *frame;
+    frame = exe_travel_inst->frames + --exe_travel_inst->nr_frames;
+    frame_release(frame);
+    PCEXE_CLR_VAR(frame->key);
+}
+
+static bool
+append_step(purc_variant_t path, purc_variant_t key, size_t pos)
+{
+    if (key)
+        return purc_variant_array_append(path, key);
+
+    purc_variant_t v = purc_variant_make_ulongint(pos);
+    if (v == PURC_VARIANT_INVALID)
+        return false;
+
+    bool ok = purc_variant_array_append(path, v);
+    purc_variant_unref(v);
+    return ok;
+}
+
+/* The path of a node is an array of the keys and indices from the input
+   to the node, which is the member at `key` or `pos` of frame `parent`. */
+static purc_variant_t
+make_path(struct pcexec_exe_travel_inst *exe_travel_inst, size_t parent,
+        purc_variant_t key, size_t pos)
+{
+    struct travel_frame *frames = exe_travel_inst->frames;
+    size_t *chain = exe_travel_inst->chain;
+    size_t n = 0;
+
+    for (size_t i = parent; frames[i].parent != NO_PARENT;
+            i = frames[i].parent)
+        chain[n++] = i;
+
+    purc_variant_t path = purc_variant_make_array_0();
+    if (path == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    while (n > 0) {
+        struct travel_frame *frame = frames + chain[--n];
+        if (!append_step(path, frame->key, frame->pos))
+            goto failed;
     }
 
-    inst->super.type        = type;
-    inst->super.input       = input;
-    inst->super.asc_desc    = asc_desc;
+    if (!append_step(path, key, pos))
+        goto failed;
+
+    return path;
+
+failed:
+    purc_variant_unref(path);
+    return PURC_VARIANT_INVALID;
+}
+
+/* Makes the node the current one. */
+static bool
+visit(struct pcexec_exe_travel_inst *exe_travel_inst, size_t parent,
+        purc_variant_t value, purc_variant_t key, size_t pos)
+{
+    purc_exec_inst_t inst = &exe_travel_inst->super;
+    purc_variant_t val = PURC_VARIANT_INVALID;
+    purc_variant_t path;
+
+    switch (exe_travel_inst->param.rule.for_clause) {
+        case FOR_CLAUSE_VALUE:
+            val = purc_variant_ref(value);
+            break;
+        case FOR_CLAUSE_KEY:
+            val = make_path(exe_travel_inst, parent, key, pos);
+            break;
+        case FOR_CLAUSE_KV:
+            path = make_path(exe_travel_inst, parent, key, pos);
+            if (path) {
+                val = purc_variant_make_object_by_static_ckey(2,
+                        "k", path, "v", value);
+                purc_variant_unref(path);
+            }
+            break;
+    }
 
-    purc_variant_ref(input);
+    PCEXE_CLR_VAR(inst->value);
+    inst->value = val;
+    return val != PURC_VARIANT_INVALID;
+}
 
-    return &inst->super;
+static bool
+has_members(purc_variant_t ctnr)
+{
+    size_t sz = 0;
+    if (purc_variant_is_object(ctnr))
+        purc_variant_object_size(ctnr, &sz);
+    else
+        purc_variant_linear_container_size(ctnr, &sz);
+    return sz > 0;
 }
 
 static inline bool
-exe_travel_parse_rule(purc_exec_inst_t inst, const char* rule)
+can_descend(struct pcexec_exe_travel_inst *exe_travel_inst,
+        purc_variant_t value, size_t depth)
 {
-    // parse and fill the internal fields from rule
-    // for example, generating the `selected_keys` which contains all
-    // selected keys.
-
-    // clear previously-selected-keys
-    if (inst->selected_keys) {
-        purc_variant_unref(inst->selected_keys);
-        inst->selected_keys = PURC_VARIANT_INVALID;
+    long int max_depth = exe_travel_inst->param.rule.max_depth;
+    if (max_depth > 0 && depth >= (size_t)max_depth)
+        return false;
+
+    return purc_variant_is_container(value) && has_members(value);
+}
+
+/* The walks return 1 if a node is visited, 0 if there is no more node,
+   or -1 on error. */
+static int
+walk_depth_first(struct pcexec_exe_travel_inst *exe_travel_inst,
+        bool leaves_only)
+{
+    while (exe_travel_inst->nr_frames > 0) {
+        size_t top = exe_travel_inst->nr_frames - 1;
+        struct travel_frame *frame = exe_travel_inst->frames + top;
+        purc_variant_t value, key;
+        size_t pos;
+
+        if (!frame_next_member(frame, &value, &key, &pos)) {
+            pop_frame(exe_travel_inst);
+            continue;
+        }
+
+        size_t depth = frame->depth + 1;
+        bool descend = can_descend(exe_travel_inst, value, depth);
+
+        /* the nodes at the limit of depth are the leaves of the walk */
+        bool visited = !leaves_only || !descend;
+        if (visited && !visit(exe_travel_inst, top, value, key, pos))
+            return -1;
+
+        if (descend && !push_frame(exe_travel_inst, value, key, pos,
+                    top, depth))
+            return -1;
+
+        if (visited)
+            return 1;
     }
 
-    // TODO: parse rule and eval to selected_keys
+    return 0;
+}
 
-    UNUSED_PARAM(inst);
-    UNUSED_PARAM(rule);
+/* Visits all members of a container in the first pass, then descends into
+   them one by one in the second pass. */
+static int
+walk_siblings_first(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    while (exe_travel_inst->nr_frames > 0) {
+        size_t top = exe_travel_inst->nr_frames - 1;
+        struct travel_frame *frame = exe_travel_inst->frames + top;
+        purc_variant_t value, key;
+        size_t pos;
+
+        if (!frame_next_member(frame, &value, &key, &pos)) {
+            if (frame->rewound) {
+                pop_frame(exe_travel_inst);
+            }
+            else {
+                frame->rewound = true;
+                frame_rewind(frame);
+            }
+            continue;
+        }
 
-    pcinst_set_error(PCEXECUTOR_ERROR_NOT_IMPLEMENTED);
-    return false;
+        size_t depth = frame->depth + 1;
+        if (!frame->rewound)
+            return visit(exe_travel_inst, top, value, key, pos) ? 1 : -1;
+
+        if (can_descend(exe_travel_inst, value, depth) &&
+                !push_frame(exe_travel_inst, value, key, pos, top, depth))
+            return -1;
+    }
+
+    return 0;
+}
+
+static int
+walk_breadth_first(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    while (exe_travel_inst->head < exe_travel_inst->nr_frames) {
+        size_t head = exe_travel_inst->head;
+        struct travel_frame *frame = exe_travel_inst->frames + head;
+        purc_variant_t value, key;
+        size_t pos;
+
+        if (!frame_next_member(frame, &value, &key, &pos)) {
+            frame_release(frame);
+            exe_travel_inst->head++;
+            continue;
+        }
+
+        size_t depth = frame->depth + 1;
+        if (!visit(exe_travel_inst, head, value, key, pos))
+            return -1;
+
+        if (can_descend(exe_travel_inst, value, depth) &&
+                !push_frame(exe_travel_inst, value, key, pos, head, depth))
+            return -1;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+static int
+walk_next(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    switch (exe_travel_inst->order) {
+        case TRAVEL_ORDER_SIBLINGS:
+            return walk_siblings_first(exe_travel_inst);
+        case TRAVEL_ORDER_DEPTH:
+            return walk_depth_first(exe_travel_inst, false);
+        case TRAVEL_ORDER_BREADTH:
+            return walk_breadth_first(exe_travel_inst);
+        case TRAVEL_ORDER_LEAVES:
+            return walk_depth_first(exe_travel_inst, true);
+    }
+
+    return 0;
+}
+
+static int
+walk_begin(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    purc_exec_inst_t inst = &exe_travel_inst->super;
+
+    clear_frames(exe_travel_inst);
+    PCEXE_CLR_VAR(inst->value);
+
+    exe_travel_inst->order = exe_travel_inst->param.rule.order;
+    if (!push_frame(exe_travel_inst, inst->input, PURC_VARIANT_INVALID, 0,
+                NO_PARENT, 0))
+        return -1;
+
+    return walk_next(exe_travel_inst);
+}
+
+// clear internal data except `input`
+static inline void
+reset(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    // the fields of param are owned by the rule cache
+    memset(&exe_travel_inst->param, 0, sizeof(exe_travel_inst->param));
+    pcexecutor_inst_reset(&exe_travel_inst->super);
+    clear_frames(exe_travel_inst);
+}
+
+static inline bool
+parse_rule(struct pcexec_exe_travel_inst *exe_travel_inst,
+        const char* rule)
+{
+    purc_exec_inst_t inst = &exe_travel_inst->super;
+
+    const struct exe_travel_param *param;
+    param = pcexecutor_inst_parse_rule(inst, rule, sizeof(*param),
+            travel_parse_param, travel_release_param);
+    if (!param)
+        return false;
+
+    exe_travel_inst->param = *param;
+
+    return true;
+}
+
+static inline purc_exec_iter_t
+fetch_begin(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    purc_exec_inst_t inst = &exe_travel_inst->super;
+    purc_exec_iter_t it = &inst->it;
+    it->curr = 0;
+
+    int r = walk_begin(exe_travel_inst);
+    if (r > 0)
+        return it;
+
+    if (r == 0)
+        pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
+    return NULL;
+}
+
+static inline purc_exec_iter_t
+fetch_next(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    purc_exec_inst_t inst = &exe_travel_inst->super;
+    purc_exec_iter_t it = &inst->it;
+    it->curr++;
+
+    int r = walk_next(exe_travel_inst);
+    if (r > 0)
+        return it;
+
+    if (r == 0)
+        pcinst_set_error(PCEXECUTOR_ERROR_NOT_EXISTS);
+    return NULL;
+}
+
+static inline void
+destroy(struct pcexec_exe_travel_inst *exe_travel_inst)
+{
+    purc_exec_inst_t inst = &exe_travel_inst->super;
+
+    reset(exe_travel_inst);
+
+    PCEXE_CLR_VAR(inst->input);
+    PCEXE_CLR_VAR(inst->value);
+
+    free(exe_travel_inst->frames);
+    free(exe_travel_inst->chain);
+    free(exe_travel_inst);
+}
+
+// 创建一个执行器实例
+static purc_exec_inst_t
+exe_travel_create(enum purc_exec_type type,
+        purc_variant_t input, bool asc_desc)
+{
+    if (input == PURC_VARIANT_INVALID || !purc_variant_is_container(input)) {
+        pcinst_set_error(PCEXECUTOR_ERROR_BAD_ARG);
+        return NULL;
+    }
+
+    struct pcexec_exe_travel_inst *exe_travel_inst;
+    exe_travel_inst = calloc(1, sizeof(*exe_travel_inst));
+    if (!exe_travel_inst) {
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return NULL;
+    }
+
+    purc_exec_inst_t inst = &exe_travel_inst->super;
+
+    inst->type        = type;
+    inst->input       = purc_variant_ref(input);
+    inst->asc_desc    = asc_desc;
+
+    int debug_flex, debug_bison;
+    pcexecutor_get_debug(&debug_flex, &debug_bison);
+    exe_travel_inst->param.debug_flex  = debug_flex;
+    exe_travel_inst->param.debug_bison = debug_bison;
+
+    return inst;
 }
 
 // 用于执行选择
@@ -88,46 +538,40 @@ exe_travel_choose(purc_exec_inst_t inst, const char* rule)
         return PURC_VARIANT_INVALID;
     }
 
-    if (!exe_travel_parse_rule(inst, rule))
-        return PURC_VARIANT_INVALID;
+    struct pcexec_exe_travel_inst *exe_travel_inst;
+    exe_travel_inst = (struct pcexec_exe_travel_inst*)inst;
 
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
+    if (!parse_rule(exe_travel_inst, rule))
+        return PURC_VARIANT_INVALID;
 
     purc_variant_t vals = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (vals == PURC_VARIANT_INVALID) {
-        return vals;
-    }
-
-    bool ok = true;
+    if (vals == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
 
-    for (size_t i=0; i<sz; ++i) {
-        purc_variant_t k;
-        k = purc_variant_array_get(inst->selected_keys, i);
-        purc_variant_t v;
-        v = purc_variant_object_get_ex(inst->input, k, true); // Since 0.9.22
-        if (v==PURC_VARIANT_INVALID)
-            continue;
-        ok = purc_variant_array_append(vals, v);
-        if (!ok)
+    int r;
+    for (r = walk_begin(exe_travel_inst); r > 0;
+            r = walk_next(exe_travel_inst)) {
+        if (!purc_variant_array_append(vals, inst->value)) {
+            r = -1;
             break;
+        }
     }
 
-    if (ok) {
-        size_t n;
-        purc_variant_array_size(vals, &n);
-        if (n == 1) {
-            purc_variant_t v = purc_variant_array_get(vals, 0);
-            purc_variant_ref(v);
-            purc_variant_unref(vals);
-            vals = v;
-        }
+    if (r < 0) {
+        purc_variant_unref(vals);
+        return PURC_VARIANT_INVALID;
     }
 
-    if (ok)
-        return vals;
+    size_t n;
+    purc_variant_array_size(vals, &n);
+    if (n == 1) {
+        purc_variant_t v = purc_variant_array_get(vals, 0);
+        purc_variant_ref(v);
+        purc_variant_unref(vals);
+        vals = v;
+    }
 
-    purc_variant_unref(vals);
-    return PURC_VARIANT_INVALID;
+    return vals;
 }
 
 // 获得用于迭代的初始迭代子
@@ -139,17 +583,18 @@ exe_travel_it_begin(purc_exec_inst_t inst, const char* rule)
         return NULL;
     }
 
-    inst->it.curr = 0;
-    if (!exe_travel_parse_rule(inst, rule))
+    if (inst->type != PURC_EXEC_TYPE_ITERATE) {
+        pcinst_set_error(PCEXECUTOR_ERROR_NOT_ALLOWED);
         return NULL;
+    }
+
+    struct pcexec_exe_travel_inst *exe_travel_inst;
+    exe_travel_inst = (struct pcexec_exe_travel_inst*)inst;
 
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
-    if (sz<=0) {
-        pcinst_set_error(PCEXECUTOR_ERROR_NO_KEYS_SELECTED);
+    if (!parse_rule(exe_travel_inst, rule))
         return NULL;
-    }
 
-    return &inst->it;
+    return fetch_begin(exe_travel_inst);
 }
 
 // 根据迭代子获得对应的变体值
@@ -162,20 +607,16 @@ exe_travel_it_value(purc_exec_inst_t inst, purc_exec_iter_t it)
     }
 
     PC_ASSERT(&inst->it == it);
-    PC_ASSERT(inst->selected_keys != PURC_VARIANT_INVALID);
     PC_ASSERT(inst->input != PURC_VARIANT_INVALID);
+    PC_ASSERT(inst->value != PURC_VARIANT_INVALID);
 
-    purc_variant_t k;
-    k = purc_variant_array_get(inst->selected_keys, it->curr);
-    purc_variant_t v;
-    v = purc_variant_object_get_ex(inst->input, k, true); // Since 0.9.22
-
-    return v;
+    return inst->value;
 }
 
 // 获得下一个迭代子
 // 注意: 规则字符串可能在前后两次迭代中发生变化，比如在规则中引用了变量的情形下。
 // 如果规则并没有发生变化，则对 `rule` 参数传递 NULL。
+// 遍历的顺序在开始迭代时确定，此后规则的变化仅影响深度限制和 FOR 子句。
 static purc_exec_iter_t
 exe_travel_it_next(purc_exec_inst_t inst, purc_exec_iter_t it, const char* rule)
 {
@@ -185,27 +626,32 @@ exe_travel_it_next(purc_exec_inst_t inst, purc_exec_iter_t it, const char* rule)
     }
 
     PC_ASSERT(&inst->it == it);
+    PC_ASSERT(inst->input != PURC_VARIANT_INVALID);
 
-    if (rule) {
-        // clear previously-selected-keys
-        if (inst->selected_keys) {
-            purc_variant_unref(inst->selected_keys);
-            inst->selected_keys = PURC_VARIANT_INVALID;
-        }
+    struct pcexec_exe_travel_inst *exe_travel_inst;
+    exe_travel_inst = (struct pcexec_exe_travel_inst*)inst;
 
-        if (!exe_travel_parse_rule(inst, rule))
+    if (rule) {
+        if (!parse_rule(exe_travel_inst, rule))
             return NULL;
     }
 
-    ++it->curr;
-
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
-    if (it->curr >= sz) {
-        it->curr = sz;
-        return NULL;
-    }
+    return fetch_next(exe_travel_inst);
+}
 
-    return it;
+#define SET_KEY_AND_NUM(_o, _k, _d) {                        \
+    purc_variant_t v;                                        \
+    bool ok;                                                 \
+    v = purc_variant_make_number(_d);                        \
+    if (v == PURC_VARIANT_INVALID) {                         \
+        ok = false;                                          \
+        break;                                               \
+    }                                                        \
+    ok = purc_variant_object_set_by_static_ckey(obj,         \
+            _k, v);                                          \
+    purc_variant_unref(v);                                   \
+    if (!ok)                                                 \
+        break;                                               \
 }
 
 // 用于执行规约
@@ -217,36 +663,56 @@ exe_travel_reduce(purc_exec_inst_t inst, const char* rule)
         return PURC_VARIANT_INVALID;
     }
 
-    if (!exe_travel_parse_rule(inst, rule))
-        return PURC_VARIANT_INVALID;
+    struct pcexec_exe_travel_inst *exe_travel_inst;
+    exe_travel_inst = (struct pcexec_exe_travel_inst*)inst;
 
-    size_t sz = purc_variant_array_get_size(inst->selected_keys);
+    if (!parse_rule(exe_travel_inst, rule))
+        return PURC_VARIANT_INVALID;
 
-    purc_variant_t objs;
-    objs = purc_variant_make_object(0,
-                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
-    if (objs == PURC_VARIANT_INVALID) {
-        return objs;
+    size_t count = 0;
+    double sum   = 0;
+    double avg   = 0;
+    double max   = NAN;
+    double min   = NAN;
+
+    int r;
+    for (r = walk_begin(exe_travel_inst); r > 0;
+            r = walk_next(exe_travel_inst)) {
+        double d = purc_variant_numerify(inst->value);
+        ++count;
+        if (isnan(d))
+            continue;
+        sum += d;
+        if (isnan(max) || d > max)
+            max = d;
+        if (isnan(min) || d < min)
+            min = d;
     }
 
-    bool ok = false;
+    if (r < 0)
+        return PURC_VARIANT_INVALID;
 
-    for (size_t i=0; i<sz; ++i) {
-        purc_variant_t k;
-        k = purc_variant_array_get(inst->selected_keys, i);
-        purc_variant_t v;
-        v = purc_variant_object_get_ex(inst->input, k, true);  // Since 0.9.22
-        if (v==PURC_VARIANT_INVALID)
-            continue;
-        ok = purc_variant_object_set(objs, k, v);
-        if (!ok)
-            break;
+    if (count > 0) {
+        avg = sum / count;
     }
 
-    if (ok)
-        return objs;
+    purc_variant_t obj = purc_variant_make_object(0,
+            PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+
+    if (obj == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    do {
+        SET_KEY_AND_NUM(obj, "count", count);
+        SET_KEY_AND_NUM(obj, "sum", sum);
+        SET_KEY_AND_NUM(obj, "avg", avg);
+        SET_KEY_AND_NUM(obj, "max", max);
+        SET_KEY_AND_NUM(obj, "min", min);
 
-    purc_variant_unref(objs);
+        return obj;
+    } while (0);
+
+    purc_variant_unref(obj);
     return PURC_VARIANT_INVALID;
 }
 
@@ -259,18 +725,10 @@ exe_travel_destroy(purc_exec_inst_t inst)
         return false;
     }
 
-    struct pcexec_exe_travel_inst *exe_travel_inst = (struct pcexec_exe_travel_inst*)inst;
-
-    if (exe_travel_inst->super.input) {
-        purc_variant_unref(exe_travel_inst->super.input);
-        exe_travel_inst->super.input = PURC_VARIANT_INVALID;
-    }
-    if (exe_travel_inst->super.selected_keys) {
-        purc_variant_unref(exe_travel_inst->super.selected_keys);
-        exe_travel_inst->super.selected_keys = PURC_VARIANT_INVALID;
-    }
+    struct pcexec_exe_travel_inst *exe_travel_inst;
+    exe_travel_inst = (struct pcexec_exe_travel_inst*)inst;
+    destroy(exe_travel_inst);
 
-    free(exe_travel_inst);
     return true;
 }
 
@@ -289,4 +747,3 @@ int pcexec_exe_travel_register(void)
     bool ok = purc_register_executor("TRAVEL", &exe_travel_ops);
     return ok ? 0 : -1;
 }
-
@@ -30,10 +30,53 @@
 
 #include "purc-macros.h"
 
+#include "private/debug.h"
+
+#include "pcexe-helper.h"
+
+enum travel_order {
+    TRAVEL_ORDER_SIBLINGS,      // all children of a node before any grandchild
+    TRAVEL_ORDER_DEPTH,         // pre-order, depth first
+    TRAVEL_ORDER_BREADTH,       // level by level
+    TRAVEL_ORDER_LEAVES,        // the leaves only, depth first
+};
+
+struct travel_rule
+{
+    enum travel_order           order;
+    /* the depth of the deepest nodes to visit; 0 for no limit */
+    long int                    max_depth;
+    /* FOR KEY gives the path of the node, FOR KV gives both */
+    enum for_clause_type        for_clause;
+};
+
+struct exe_travel_param {
+    char *err_msg;
+    int debug_flex;
+    int debug_bison;
+
+    struct travel_rule    rule;
+};
+
 PCA_EXTERN_C_BEGIN
 
 int pcexec_exe_travel_register(void);
 
+int exe_travel_parse(const char *input, size_t len,
+        struct exe_travel_param *param);
+
+static inline void
+exe_travel_param_reset(struct exe_travel_param *param)
+{
+    if (!param)
+        return;
+
+    if (param->err_msg) {
+        free(param->err_msg);
+        param->err_msg = NULL;
+    }
+}
+
 PCA_EXTERN_C_END
 
 #endif // PURC_EXECUTOR_TRAVEL_H
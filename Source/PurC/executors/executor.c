@@ -26,6 +26,7 @@
 #include "private/debug.h"
 #include "private/errors.h"
 #include "private/instance.h"
+#include "private/variant.h"
 #include "keywords.h"
 
 #include "purc-utils.h"
@@ -179,16 +180,56 @@ static int _init_instance(struct pcinst *inst,
 
     inst->executor_heap->debug_flex = 0;
     inst->executor_heap->debug_bison = 0;
+    list_head_init(&inst->executor_heap->rule_cache);
+    inst->executor_heap->nr_cached_rules = 0;
 
     PC_ASSERT(purc_get_last_error() == 0);
     return 0;
 }
 
+static void
+parsed_rule_destroy(struct pcexec_parsed_rule *parsed)
+{
+    if (parsed->param) {
+        parsed->release(parsed->param);
+        free(parsed->param);
+    }
+    free(parsed->rule);
+    free(parsed);
+}
+
+static void
+parsed_rule_release(struct pcexec_parsed_rule *parsed)
+{
+    PC_ASSERT(parsed->refc > 0);
+    if (--parsed->refc == 0 && parsed->detached)
+        parsed_rule_destroy(parsed);
+}
+
+/* removes the rule from the cache; it is destroyed when no longer used */
+static void
+rule_cache_evict(struct pcexecutor_heap *heap,
+        struct pcexec_parsed_rule *parsed)
+{
+    list_del(&parsed->ln);
+    heap->nr_cached_rules--;
+
+    if (parsed->refc == 0)
+        parsed_rule_destroy(parsed);
+    else
+        parsed->detached = 1;
+}
+
 static void _cleanup_instance(struct pcinst *inst)
 {
     if (!inst->executor_heap)
         return;
 
+    struct pcexec_parsed_rule *p, *n;
+    list_for_each_entry_safe(p, n, &inst->executor_heap->rule_cache, ln) {
+        rule_cache_evict(inst->executor_heap, p);
+    }
+
     free(inst->executor_heap);
     inst->executor_heap = NULL;
 }
@@ -385,6 +426,165 @@ pcexecutor_inst_reset(struct purc_exec_inst *inst)
         free(inst->err_msg);
         inst->err_msg = NULL;
     }
+    if (inst->parsed_rule) {
+        parsed_rule_release(inst->parsed_rule);
+        inst->parsed_rule = NULL;
+    }
+}
+
+bool
+pcexecutor_obj_keys_take(struct pcexec_obj_keys *snapshot,
+        purc_variant_t obj)
+{
+    pcexecutor_obj_keys_release(snapshot);
+
+    size_t nr;
+    if (!purc_variant_object_size(obj, &nr) || nr == 0)
+        return true;
+
+    snapshot->keys = malloc(sizeof(purc_variant_t) * nr);
+    if (snapshot->keys == NULL) {
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return false;
+    }
+
+    purc_variant_t k, v;
+    size_t i = 0;
+    foreach_key_value_in_variant_object(obj, k, v) {
+        (void)v;
+        snapshot->keys[i++] = purc_variant_ref(k);
+    } end_foreach;
+
+    snapshot->nr_keys = i;
+    return true;
+}
+
+void
+pcexecutor_obj_keys_release(struct pcexec_obj_keys *snapshot)
+{
+    for (size_t i = 0; i < snapshot->nr_keys; i++) {
+        purc_variant_unref(snapshot->keys[i]);
+    }
+
+    free(snapshot->keys);
+    snapshot->keys = NULL;
+    snapshot->nr_keys = 0;
+}
+
+purc_variant_t
+pcexecutor_obj_keys_fetch(const struct pcexec_obj_keys *snapshot,
+        purc_variant_t obj, size_t *idx, purc_variant_t *key)
+{
+    for (size_t i = *idx; i < snapshot->nr_keys; i++) {
+        purc_variant_t v = purc_variant_object_get_ex(obj,
+                snapshot->keys[i], true);
+        if (v != PURC_VARIANT_INVALID) {
+            *idx = i;
+            *key = snapshot->keys[i];
+            return v;
+        }
+    }
+
+    *idx = snapshot->nr_keys;
+    return PURC_VARIANT_INVALID;
+}
+
+static struct pcexec_parsed_rule *
+rule_cache_find(struct pcexecutor_heap *heap, const char *rule,
+        uint32_t hash, pcexec_rule_parse_f parse)
+{
+    struct pcexec_parsed_rule *p;
+    list_for_each_entry(p, &heap->rule_cache, ln) {
+        if (p->hash == hash && p->parse == parse && strcmp(p->rule, rule) == 0)
+            return p;
+    }
+
+    return NULL;
+}
+
+static struct pcexec_parsed_rule *
+rule_cache_parse(struct pcexecutor_heap *heap, const char *rule,
+        uint32_t hash, size_t sz_param, pcexec_rule_parse_f parse,
+        pcexec_rule_release_f release, char **err_msg)
+{
+    struct pcexec_parsed_rule *parsed;
+    parsed = (struct pcexec_parsed_rule *)calloc(1, sizeof(*parsed));
+    if (!parsed)
+        goto oom;
+
+    parsed->rule = strdup(rule);
+    parsed->param = calloc(1, sz_param);
+    if (!parsed->rule || !parsed->param)
+        goto oom;
+
+    if (parse(rule, parsed->param, err_msg)) {
+        // the param has been released by the parser
+        free(parsed->param);
+        parsed->param = NULL;
+        parsed_rule_destroy(parsed);
+        return NULL;
+    }
+
+    parsed->parse = parse;
+    parsed->release = release;
+    parsed->hash = hash;
+
+    list_add(&parsed->ln, &heap->rule_cache);
+    if (++heap->nr_cached_rules > PCEXEC_RULE_CACHE_SIZE) {
+        struct pcexec_parsed_rule *last;
+        last = list_last_entry(&heap->rule_cache,
+                struct pcexec_parsed_rule, ln);
+        rule_cache_evict(heap, last);
+    }
+
+    return parsed;
+
+oom:
+    if (parsed) {
+        free(parsed->param);
+        parsed->param = NULL;
+        parsed_rule_destroy(parsed);
+    }
+    pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+    return NULL;
+}
+
+const void *
+pcexecutor_inst_parse_rule(struct purc_exec_inst *inst, const char *rule,
+        size_t sz_param, pcexec_rule_parse_f parse,
+        pcexec_rule_release_f release)
+{
+    struct pcexec_parsed_rule *parsed = inst->parsed_rule;
+
+    if (inst->err_msg) {
+        free(inst->err_msg);
+        inst->err_msg = NULL;
+    }
+
+    // the rule does not change between two iterations
+    if (parsed && parsed->parse == parse && strcmp(parsed->rule, rule) == 0)
+        return parsed->param;
+
+    struct pcexecutor_heap *heap = pcinst_current()->executor_heap;
+    uint32_t hash = pchash_default_str_hash(rule);
+
+    parsed = rule_cache_find(heap, rule, hash, parse);
+    if (parsed) {
+        list_move(&parsed->ln, &heap->rule_cache);
+    }
+    else {
+        parsed = rule_cache_parse(heap, rule, hash, sz_param, parse, release,
+                &inst->err_msg);
+        if (!parsed)
+            return NULL;
+    }
+
+    parsed->refc++;
+    if (inst->parsed_rule)
+        parsed_rule_release(inst->parsed_rule);
+    inst->parsed_rule = parsed;
+
+    return parsed->param;
 }
 
 purc_atom_t
@@ -30,26 +30,27 @@
 }
 
 %code requires {
-    struct exe_sql_param {
-        char *err_msg;
-        int debug_flex;
-        int debug_bison;
-    };
-
     struct exe_sql_token {
         const char      *text;
         size_t           leng;
     };
 
+    struct exe_sql_order {
+        struct sql_exp  *exps;
+        bool             desc;
+    };
+
+    struct exe_sql_limit {
+        long int         limit;
+        long int         offset;
+    };
+
     #define YYSTYPE       EXE_SQL_YYSTYPE
     #define YYLTYPE       EXE_SQL_YYLTYPE
     #ifndef YY_TYPEDEF_YY_SCANNER_T
     #define YY_TYPEDEF_YY_SCANNER_T
     typedef void* yyscan_t;
     #endif
-
-    int exe_sql_parse(const char *input, size_t len,
-            struct exe_sql_param *param);
 }
 
 %code provides {
@@ -65,22 +66,154 @@
         const char *errsg
     );
 
-    #define SET_ARGS(_r, _a) do {              \
-        _r = strndup(_a.text, _a.leng);        \
-        if (!_r)                               \
-            YYABORT;                           \
+    /* the helpers below take the ownership of the operands,
+       and release them on failure */
+    static struct sql_exp *
+    exp_binary(enum sql_exp_type type, struct sql_exp *l, struct sql_exp *r)
+    {
+        struct sql_exp *exp = sql_exp_new(type);
+        if (!exp) {
+            sql_exp_destroy(l);
+            sql_exp_destroy(r);
+            return NULL;
+        }
+
+        exp->l = l;
+        exp->r = r;
+        return exp;
+    }
+
+    static struct sql_exp *
+    exp_append(struct sql_exp *list, struct sql_exp *exp)
+    {
+        struct sql_exp *last = list;
+        while (last->next)
+            last = last->next;
+        last->next = exp;
+        return list;
+    }
+
+    static struct sql_exp *
+    exp_var(struct exe_sql_token name, struct exe_sql_token *sub)
+    {
+        struct sql_exp *exp = sql_exp_new(SQL_EXP_VAR);
+        if (!exp)
+            return NULL;
+
+        exp->name = strndup(name.text, name.leng);
+        if (sub)
+            exp->sub = strndup(sub->text, sub->leng);
+        if (!exp->name || (sub && !exp->sub)) {
+            sql_exp_destroy(exp);
+            return NULL;
+        }
+        return exp;
+    }
+
+    static struct sql_exp *
+    exp_literal(purc_variant_t v)
+    {
+        if (v == PURC_VARIANT_INVALID)
+            return NULL;
+
+        struct sql_exp *exp = sql_exp_new(SQL_EXP_LITERAL);
+        if (!exp) {
+            purc_variant_unref(v);
+            return NULL;
+        }
+        exp->literal = v;
+        return exp;
+    }
+
+    static struct sql_exp *
+    exp_string(struct pcexe_strlist *slist)
+    {
+        char *s = pcexe_strlist_to_str(slist);
+        pcexe_strlist_reset(slist);
+        if (!s)
+            return NULL;
+
+        return exp_literal(purc_variant_make_string_reuse_buff(s,
+                    strlen(s) + 1, false));
+    }
+
+    static struct sql_exp *
+    exp_func(struct exe_sql_param *param, YYLTYPE *yylloc,
+            struct exe_sql_token name, struct sql_exp *arg)
+    {
+        int func = sql_func_by_name(name.text, name.leng);
+        if (func < 0) {
+            yyerror(yylloc, NULL, param, "unknown function");
+            sql_exp_destroy(arg);
+            return NULL;
+        }
+
+        struct sql_exp *exp = exp_binary(SQL_EXP_FUNC, arg, NULL);
+        if (exp) {
+            exp->func = (enum sql_func_type)func;
+            exp->name = strndup(name.text, name.leng);
+            if (!exp->name) {
+                sql_exp_destroy(exp);
+                return NULL;
+            }
+        }
+        return exp;
+    }
+
+    static struct sql_select *
+    select_new(struct sql_exp *items, struct sql_exp *where,
+            struct sql_exp *group_by, struct exe_sql_order order,
+            struct exe_sql_limit limit, enum sql_travel_type travel)
+    {
+        struct sql_select *select = calloc(1, sizeof(*select));
+        if (!select) {
+            sql_exp_destroy(items);
+            sql_exp_destroy(where);
+            sql_exp_destroy(group_by);
+            sql_exp_destroy(order.exps);
+            return NULL;
+        }
+
+        select->items = items;
+        select->where = where;
+        select->group_by = group_by;
+        select->order_by = order.exps;
+        select->desc = order.desc;
+        select->limit = limit.limit;
+        select->offset = limit.offset;
+        select->travel = travel;
+        return select;
+    }
+
+    static struct sql_select *
+    select_union(struct sql_select *l, struct sql_select *r)
+    {
+        struct sql_select *last = l;
+        while (last->next)
+            last = last->next;
+        last->next = r;
+        return l;
+    }
+
+    #define CHECK_EXP(_exp) do {                        \
+        if (!(_exp))                                    \
+            YYABORT;                                    \
+    } while (0)
+
+    #define SET_ALIAS(_exp, _alias) do {                \
+        _exp->alias = strndup(_alias.text, _alias.leng);\
+        if (!_exp->alias) {                             \
+            sql_exp_destroy(_exp);                      \
+            YYABORT;                                    \
+        }                                               \
     } while (0)
 
-    #define APPEND_ARGS(_r, _a, _b) do {       \
-        size_t len = strlen(_a);               \
-        size_t n   = len + _b.leng;            \
-        char *s = (char*)realloc(_a, n+1);     \
-        if (!s) {                              \
-            free(_r);                          \
-            YYABORT;                           \
-        }                                      \
-        memcpy(s+len, _b.text, _b.leng);       \
-        _r = s;                                \
+    #define SET_SELECT(_select) do {                    \
+        if (param) {                                    \
+            param->select = _select;                    \
+        } else {                                        \
+            sql_select_destroy(_select);                \
+        }                                               \
     } while (0)
 }
 
@@ -100,29 +233,45 @@
 
 // union members
 %union { struct exe_sql_token token; }
-%union { char *str; }
 %union { char c; }
-
-    /* %destructor { free($$); } <str> */ // destructor for `str`
+%union { long int num; }
+%union { struct pcexe_strlist slist; }
+%union { struct sql_exp *exp; }
+%union { struct sql_select *select; }
+%union { struct exe_sql_order order; }
+%union { struct exe_sql_limit limit; }
+%union { enum sql_travel_type travel; }
+
+%destructor { pcexe_strlist_reset(&$$); } <slist>
+%destructor { sql_exp_destroy($$); } <exp>
+%destructor { sql_select_destroy($$); } <select>
+%destructor { sql_exp_destroy($$.exps); } <order>
 
 %token SQL SELECT WHERE GROUP BY ORDER TRAVEL IN LIKE UNION AS ASC DESC
+%token LIMIT OFFSET
 %token SIBLINGS DEPTH BREADTH LEAVES
 %token NOT GE LE NE AT
-%token <c> CHR UNI
-%token <token> STR INTERIOR
+%token <c> CHR
+%token <token> STR UNI
 %token <token> INTEGER NUMBER ID
 
 %left UNION
-%left IN LIKE
-%left AND OR
-%right '=' '<' '>' GE LE NE
+%left OR
+%left AND
+%precedence NEG
+%left '=' '<' '>' GE LE NE IN LIKE
 %left '-' '+'
 %left '*' '/'
 %precedence UMINUS
-%precedence NEG
 
- /* %nterm <str>   args */ // non-terminal `input` use `str` to store
-                           // token value as well
+%nterm <select> union_clause select_clause
+%nterm <exp>    select_list select_item var var_list exp exp_list
+%nterm <exp>    where_clause group_by_clause
+%nterm <order>  order_by_clause
+%nterm <limit>  limit_clause
+%nterm <num>    integer
+%nterm <travel> travel_in_clause
+%nterm <slist>  str
 
 %% /* The grammar follows. */
 
@@ -135,103 +284,121 @@ rule:
 ;
 
 sql_rule:
-  SQL ':' union_clause
+  SQL ':' union_clause      { SET_SELECT($3); }
 ;
 
 select_clause:
-  SELECT select_list where_clause group_by_clause order_by_clause travel_in_clause
+  SELECT select_list where_clause group_by_clause order_by_clause limit_clause travel_in_clause
+    { $$ = select_new($2, $3, $4, $5, $6, $7); CHECK_EXP($$); }
 ;
 
 union_clause:
-  select_clause
-| '(' union_clause ')'
-| union_clause UNION union_clause
+  select_clause                         { $$ = $1; }
+| '(' union_clause ')'                  { $$ = $2; }
+| union_clause UNION union_clause       { $$ = select_union($1, $3); }
 ;
 
 select_list:
-  select_item
-| select_list ',' select_item
+  select_item                   { $$ = $1; }
+| select_list ',' select_item   { $$ = exp_append($1, $3); }
 ;
 
 select_item:
-  exp
-| exp AS ID
+  exp               { $$ = $1; }
+| exp AS ID         { SET_ALIAS($1, $3); $$ = $1; }
 ;
 
 var:
-  ID
-| ID '.' ID
+  ID                { $$ = exp_var($1, NULL); CHECK_EXP($$); }
+| ID '.' ID         { $$ = exp_var($1, &$3); CHECK_EXP($$); }
 ;
 
 var_list:
-  var
-| var_list ',' var
+  var               { $$ = $1; }
+| var_list ',' var  { $$ = exp_append($1, $3); }
 ;
 
 where_clause:
-  %empty
-| WHERE exp
+  %empty            { $$ = NULL; }
+| WHERE exp         { $$ = $2; }
 ;
 
 group_by_clause:
-  %empty
-| GROUP BY var_list
+  %empty            { $$ = NULL; }
+| GROUP BY var_list { $$ = $3; }
 ;
 
 order_by_clause:
-  %empty
-| ORDER BY var_list
-| ORDER BY var_list ASC
-| ORDER BY var_list DESC
+  %empty                    { $$.exps = NULL; $$.desc = false; }
+| ORDER BY var_list         { $$.exps = $3; $$.desc = false; }
+| ORDER BY var_list ASC     { $$.exps = $3; $$.desc = false; }
+| ORDER BY var_list DESC    { $$.exps = $3; $$.desc = true; }
+;
+
+limit_clause:
+  %empty                        { $$.limit = -1; $$.offset = 0; }
+| LIMIT integer                 { $$.limit = $2; $$.offset = 0; }
+| LIMIT integer OFFSET integer  { $$.limit = $2; $$.offset = $4; }
+;
+
+integer:
+  INTEGER           { STRTOL($$, $1); }
 ;
 
 travel_in_clause:
-  %empty
-| TRAVEL IN SIBLINGS
-| TRAVEL IN DEPTH
-| TRAVEL IN BREADTH
-| TRAVEL IN LEAVES
+  %empty                { $$ = SQL_TRAVEL_NONE; }
+| TRAVEL IN SIBLINGS    { $$ = SQL_TRAVEL_SIBLINGS; }
+| TRAVEL IN DEPTH       { $$ = SQL_TRAVEL_DEPTH; }
+| TRAVEL IN BREADTH     { $$ = SQL_TRAVEL_BREADTH; }
+| TRAVEL IN LEAVES      { $$ = SQL_TRAVEL_LEAVES; }
 ;
 
 exp:
-  INTEGER
-| NUMBER
-| var
-| '*'
-| '&'
-| '"' str '"'
-| AT ID
-| exp LIKE exp
+  integer           { $$ = exp_literal(purc_variant_make_longint($1));
+                      CHECK_EXP($$); }
+| NUMBER            { double d; STRTOD(d, $1);
+                      $$ = exp_literal(purc_variant_make_number(d));
+                      CHECK_EXP($$); }
+| var               { $$ = $1; }
+| '*'               { $$ = sql_exp_new(SQL_EXP_ROW); CHECK_EXP($$); }
+| '&'               { $$ = sql_exp_new(SQL_EXP_ROW); CHECK_EXP($$); }
+| '"' str '"'       { $$ = exp_string(&$2); CHECK_EXP($$); }
+| AT ID             { $$ = exp_var($2, NULL); CHECK_EXP($$);
+                      $$->type = SQL_EXP_ATTR; }
+| ID '(' exp ')'    { $$ = exp_func(param, &@1, $1, $3); CHECK_EXP($$); }
+| exp LIKE exp      { $$ = exp_binary(SQL_EXP_LIKE, $1, $3); CHECK_EXP($$); }
 | exp IN '(' exp_list ')'
-| exp AND exp
-| exp OR exp
-| NOT exp %prec NEG
-| exp '=' exp
-| exp NE exp
-| exp LE exp
-| exp GE exp
-| exp '>' exp
-| exp '<' exp
-| exp '+' exp
-| exp '-' exp
-| exp '*' exp
-| exp '/' exp
+                    { $$ = exp_binary(SQL_EXP_IN, $1, $4); CHECK_EXP($$); }
+| exp AND exp       { $$ = exp_binary(SQL_EXP_AND, $1, $3); CHECK_EXP($$); }
+| exp OR exp        { $$ = exp_binary(SQL_EXP_OR, $1, $3); CHECK_EXP($$); }
+| NOT exp %prec NEG { $$ = exp_binary(SQL_EXP_NOT, $2, NULL); CHECK_EXP($$); }
+| exp '=' exp       { $$ = exp_binary(SQL_EXP_EQ, $1, $3); CHECK_EXP($$); }
+| exp NE exp        { $$ = exp_binary(SQL_EXP_NE, $1, $3); CHECK_EXP($$); }
+| exp LE exp        { $$ = exp_binary(SQL_EXP_LE, $1, $3); CHECK_EXP($$); }
+| exp GE exp        { $$ = exp_binary(SQL_EXP_GE, $1, $3); CHECK_EXP($$); }
+| exp '>' exp       { $$ = exp_binary(SQL_EXP_GT, $1, $3); CHECK_EXP($$); }
+| exp '<' exp       { $$ = exp_binary(SQL_EXP_LT, $1, $3); CHECK_EXP($$); }
+| exp '+' exp       { $$ = exp_binary(SQL_EXP_ADD, $1, $3); CHECK_EXP($$); }
+| exp '-' exp       { $$ = exp_binary(SQL_EXP_SUB, $1, $3); CHECK_EXP($$); }
+| exp '*' exp       { $$ = exp_binary(SQL_EXP_MUL, $1, $3); CHECK_EXP($$); }
+| exp '/' exp       { $$ = exp_binary(SQL_EXP_DIV, $1, $3); CHECK_EXP($$); }
 | '-' exp %prec UMINUS
-| '(' exp ')'
+                    { $$ = exp_binary(SQL_EXP_NEG, $2, NULL); CHECK_EXP($$); }
+| '(' exp ')'       { $$ = $2; }
 ;
 
 exp_list:
-  exp
-| exp ',' exp
+  exp               { $$ = $1; }
+| exp_list ',' exp  { $$ = exp_append($1, $3); }
 ;
 
 str:
-  STR
-| CHR
-| UNI
-| str STR
-| str CHR
-| str UNI
+  STR               { STRLIST_INIT_STR($$, $1); }
+| CHR               { STRLIST_INIT_CHR($$, $1); }
+| UNI               { STRLIST_INIT_UNI($$, $1); }
+| str STR           { STRLIST_APPEND_STR($1, $2); $$ = $1; }
+| str CHR           { STRLIST_APPEND_CHR($1, $2); $$ = $1; }
+| str UNI           { STRLIST_APPEND_UNI($1, $2); $$ = $1; }
 ;
 
 %%
@@ -249,7 +416,7 @@ yyerror(
     (void)yylloc;
     (void)arg;
     (void)param;
-    if (!param)
+    if (!param || param->err_msg)
         return;
     int r = asprintf(&param->err_msg, "(%d,%d)->(%d,%d): %s",
         yylloc->first_line, yylloc->first_column,
@@ -272,6 +439,12 @@ int exe_sql_parse(const char *input, size_t len,
     yy_scan_bytes(input ? input : "", input ? len : 0, arg);
     int ret =yyparse(arg, param);
     yylex_destroy(arg);
+    if (ret && param) {
+        if (param->err_msg==NULL) {
+            purc_set_error(PCEXECUTOR_ERROR_OOM);
+        } else {
+            purc_set_error(PCEXECUTOR_ERROR_BAD_SYNTAX);
+        }
+    }
     return ret ? -1 : 0;
 }
-
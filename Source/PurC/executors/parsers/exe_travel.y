@@ -30,12 +30,6 @@
 }
 
 %code requires {
-    struct exe_travel_param {
-        char *err_msg;
-        int debug_flex;
-        int debug_bison;
-    };
-
     struct exe_travel_token {
         const char      *text;
         size_t           leng;
@@ -47,9 +41,6 @@
     #define YY_TYPEDEF_YY_SCANNER_T
     typedef void* yyscan_t;
     #endif
-
-    int exe_travel_parse(const char *input, size_t len,
-            struct exe_travel_param *param);
 }
 
 %code provides {
@@ -65,22 +56,18 @@
         const char *errsg
     );
 
-    #define SET_ARGS(_r, _a) do {              \
-        _r = strndup(_a.text, _a.leng);        \
-        if (!_r)                               \
-            YYABORT;                           \
+    #define SET_RULE(_rule) do {                            \
+        if (param) {                                        \
+            param->rule = _rule;                            \
+        }                                                   \
     } while (0)
 
-    #define APPEND_ARGS(_r, _a, _b) do {       \
-        size_t len = strlen(_a);               \
-        size_t n   = len + _b.leng;            \
-        char *s = (char*)realloc(_a, n+1);     \
-        if (!s) {                              \
-            free(_r);                          \
-            YYABORT;                           \
-        }                                      \
-        memcpy(s+len, _b.text, _b.leng);       \
-        _r = s;                                \
+    #define SET_MAX_DEPTH(_v, _s) do {                      \
+        STRTOL(_v, _s);                                     \
+        if (_v <= 0) {                                      \
+            yyerror(&yylloc, arg, param, "bad depth");      \
+            YYABORT;                                        \
+        }                                                   \
     } while (0)
 }
 
@@ -102,11 +89,17 @@
 %union { struct exe_travel_token token; }
 %union { char *str; }
 %union { char c; }
+%union { long int max_depth; }
+%union { enum travel_order order; }
+%union { enum for_clause_type for_clause; }
+%union { struct travel_rule rule; }
 
     /* %destructor { free($$); } <str> */ // destructor for `str`
 
 %token TRAVEL
 %token SIBLINGS DEPTH BREADTH LEAVES
+%token WITHIN FOR KEY VALUE KV
+%token <token> INTEGER
 
 %left '-' '+'
 %left '*' '/'
@@ -115,8 +108,10 @@
 %left AND OR XOR
 %precedence NEG
 
- /* %nterm <str>   args */ // non-terminal `input` use `str` to store
-                           // token value as well
+%nterm <order>       subrule;
+%nterm <max_depth>   within_clause;
+%nterm <for_clause>  for_clause;
+%nterm <rule>        travel_rule;
 
 %% /* The grammar follows. */
 
@@ -125,18 +120,31 @@ input:
 ;
 
 rule:
-  travel_rule
+  travel_rule      { SET_RULE($1); }
 ;
 
 travel_rule:
-  TRAVEL ':' subrule
+  TRAVEL ':' subrule within_clause for_clause {
+        $$.order = $3; $$.max_depth = $4; $$.for_clause = $5; }
 ;
 
 subrule:
-  SIBLINGS
-| DEPTH
-| BREADTH
-| LEAVES
+  SIBLINGS         { $$ = TRAVEL_ORDER_SIBLINGS; }
+| DEPTH            { $$ = TRAVEL_ORDER_DEPTH; }
+| BREADTH          { $$ = TRAVEL_ORDER_BREADTH; }
+| LEAVES           { $$ = TRAVEL_ORDER_LEAVES; }
+;
+
+within_clause:
+  %empty           { $$ = 0; }
+| WITHIN INTEGER   { SET_MAX_DEPTH($$, $2); }
+;
+
+for_clause:
+  %empty           { $$ = FOR_CLAUSE_VALUE; }
+| FOR KV           { $$ = FOR_CLAUSE_KV; }
+| FOR KEY          { $$ = FOR_CLAUSE_KEY; }
+| FOR VALUE        { $$ = FOR_CLAUSE_VALUE; }
 ;
 
 %%
@@ -177,6 +185,13 @@ int exe_travel_parse(const char *input, size_t len,
     yy_scan_bytes(input ? input : "", input ? len : 0, arg);
     int ret =yyparse(arg, param);
     yylex_destroy(arg);
+    if (ret) {
+        if (param == NULL || param->err_msg == NULL) {
+            purc_set_error(PCEXECUTOR_ERROR_OOM);
+        } else {
+            purc_set_error(PCEXECUTOR_ERROR_BAD_SYNTAX);
+        }
+    }
     return ret ? -1 : 0;
 }
 
@@ -52,6 +52,30 @@
     }                                             \
 } while (0)
 
+/* defines the parse and release functions of `exe_<name>_param` for
+   pcexecutor_inst_parse_rule() */
+#define PCEXE_DEFINE_RULE_PARSER(_name)                                   \
+static int                                                                \
+_name##_parse_param(const char *rule, void *param, char **err_msg)        \
+{                                                                         \
+    struct exe_##_name##_param *p = (struct exe_##_name##_param *)param;  \
+    /* the param is a fresh one owned by the rule cache */                \
+    pcexecutor_get_debug(&p->debug_flex, &p->debug_bison);                \
+    int r = exe_##_name##_parse(rule, strlen(rule), p);                   \
+    if (r) {                                                              \
+        *err_msg = p->err_msg;                                            \
+        p->err_msg = NULL;                                                \
+        exe_##_name##_param_reset(p);                                     \
+    }                                                                     \
+    return r;                                                             \
+}                                                                         \
+                                                                          \
+static void                                                               \
+_name##_release_param(void *param)                                        \
+{                                                                         \
+    exe_##_name##_param_reset((struct exe_##_name##_param *)param);       \
+}
+
 PCA_EXTERN_C_BEGIN
 
 int pcexe_ucs2utf8(char *utf, const char *uni, size_t n);
@@ -263,7 +263,11 @@ purc_rwstream_t pcfetcher_local_request_sync(
 
     const char* file = cpath.data();
 
-    purc_rwstream_t rws = purc_rwstream_new_from_file(file, "r");
+    purc_rwstream_t rws = purc_rwstream_new_from_mmap(file);
+    if (rws == NULL) {
+        purc_clr_error();
+        rws = purc_rwstream_new_from_file(file, "r");
+    }
     if (rws && resp_header) {
         resp_header->ret_code = 200;
         resp_header->sz_resp = filesize(file);
@@ -120,6 +120,11 @@ pcutils_array_list_init(struct pcutils_array_list *al);
 void
 pcutils_array_list_reset(struct pcutils_array_list *al);
 
+/* Resets the array list without touching the nodes, which are freed
+   by the caller in bulk. */
+void
+pcutils_array_list_clear(struct pcutils_array_list *al);
+
 static inline size_t
 pcutils_array_list_length(struct pcutils_array_list *al)
 {
@@ -199,6 +204,11 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
         void *ud, int (*cmp)(struct pcutils_array_list_node *l,
                 struct pcutils_array_list_node *r, void *ud));
 
+/* Reorder the nodes: the node at `order[i]` moves to the position `i`. */
+int
+pcutils_array_list_permute(struct pcutils_array_list *al,
+        const size_t *order);
+
 PCA_EXTERN_C_END
 
 #endif // PURC_PRIVATE_ARRAY_LIST_H
@@ -26,6 +26,7 @@
 #define PURC_PRIVATE_CHANNEL_H
 
 #include <stdbool.h>
+#include <string.h>
 
 #include "private/list.h"
 #include "private/utils.h"
@@ -41,6 +42,23 @@
 
 #define PCCHAN_MAX_LEN_NAME     63
 
+#define MSG_TYPE_SENDABLE       "sendable"
+#define MSG_TYPE_RECEIVABLE     "receivable"
+#define MSG_TYPE_CLOSED         "closed"
+
+/*
+ * A shared channel is named by a runner-qualified URI, i.e., the endpoint
+ * name of the owner runner followed by a slash and the channel name:
+ *
+ *      edpt://localhost/cn.fmsoft.hvml.test/producer/chan0
+ *
+ * The owner runner opens, resizes, and closes the channel; the other runners
+ * in the same process retrieve it by the URI. The data in the ring buffer
+ * live in the move heap, and the coroutines blocked in sending or receiving
+ * are woken through the message queues of their instances.
+ */
+#define PCCHAN_URI_SEPARATOR    '/'
+
 struct pcchan {
     /* the name of the channel */
     char           *name;
@@ -69,6 +87,10 @@ struct pcchan {
 
 typedef struct pcchan *pcchan_t;
 
+struct pcchan_shared;
+struct pcintr_coroutine;
+typedef struct pcchan_shared *pcchan_shared_t;
+
 PCA_EXTERN_C_BEGIN
 
 pcchan_t
@@ -86,6 +108,50 @@ pcchan_destroy(pcchan_t chan) WTF_INTERNAL;
 purc_variant_t
 pcchan_make_entity(pcchan_t chan) WTF_INTERNAL;
 
+int
+pcchan_post_event(const char *chan_name, const char *type,
+        const char *sub_type, purc_variant_t data) WTF_INTERNAL;
+
+bool
+pcchan_is_observed(purc_variant_t val, const char *chan_name) WTF_INTERNAL;
+
+static inline bool
+pcchan_is_shared_name(const char *chan_name) {
+    return strchr(chan_name, PCCHAN_URI_SEPARATOR) != NULL;
+}
+
+int
+pcchan_shared_init_once(void) WTF_INTERNAL;
+
+pcchan_shared_t
+pcchan_shared_open(const char *chan_uri, unsigned int cap) WTF_INTERNAL;
+
+/* The channel returned is referenced; call pcchan_shared_unref() after use. */
+pcchan_shared_t
+pcchan_shared_retrieve(const char *chan_uri) WTF_INTERNAL;
+
+void
+pcchan_shared_unref(pcchan_shared_t chan) WTF_INTERNAL;
+
+bool
+pcchan_shared_ctrl(pcchan_shared_t chan, unsigned int new_cap) WTF_INTERNAL;
+
+purc_variant_t
+pcchan_shared_make_entity(pcchan_shared_t chan) WTF_INTERNAL;
+
+/* Closes the shared channels owned by the runner @rid. */
+void
+pcchan_shared_close_owned(purc_atom_t rid) WTF_INTERNAL;
+
+/* Handles the notification that the coroutine @cid may send or receive. */
+void
+pcchan_shared_on_wakeup(const char *chan_uri, purc_atom_t cid,
+        bool sending) WTF_INTERNAL;
+
+/* Releases the shared channel the coroutine @crtn is waiting on, if any. */
+void
+pcchan_shared_on_coroutine_gone(struct pcintr_coroutine *crtn) WTF_INTERNAL;
+
 static inline unsigned int
 pcchan_capability(pcchan_t chan) {
     return chan->qsize;
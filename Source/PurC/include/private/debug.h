@@ -48,11 +48,29 @@ extern "C" {
 
 #define PC_ENABLE_DEBUG(x)  purc_enable_log(x, true)
 #define PC_ENABLE_SYSLOG(x) purc_enable_log(x?true:false, x)
-#define PC_ERROR(x, ...)    purc_log_error(x, ##__VA_ARGS__)
-#define PC_WARN(x, ...)     purc_log_warn(x, ##__VA_ARGS__)
-#define PC_NOTICE(x, ...)   purc_log_notice(x, ##__VA_ARGS__)
-#define PC_INFO(x, ...)     purc_log_info(x, ##__VA_ARGS__)
-#define PC_DEBUG(x, ...)    purc_log_debug(x, ##__VA_ARGS__)
+
+/* logs a message with the source location */
+PCA_ATTRIBUTE_PRINTF(4, 5)
+static inline void
+pcdebug_log(purc_log_level_k level, const char *file, int line,
+        const char *msg, ...)
+{
+    va_list ap;
+    va_start(ap, msg);
+    purc_log_with_location(level, NULL, file, line, msg, ap);
+    va_end(ap);
+}
+
+#define PC_ERROR(x, ...)    \
+    pcdebug_log(PURC_LOG_ERR, __FILE__, __LINE__, x, ##__VA_ARGS__)
+#define PC_WARN(x, ...)     \
+    pcdebug_log(PURC_LOG_WARNING, __FILE__, __LINE__, x, ##__VA_ARGS__)
+#define PC_NOTICE(x, ...)   \
+    pcdebug_log(PURC_LOG_NOTICE, __FILE__, __LINE__, x, ##__VA_ARGS__)
+#define PC_INFO(x, ...)     \
+    pcdebug_log(PURC_LOG_INFO, __FILE__, __LINE__, x, ##__VA_ARGS__)
+#define PC_DEBUG(x, ...)    \
+    pcdebug_log(PURC_LOG_DEBUG, __FILE__, __LINE__, x, ##__VA_ARGS__)
 #define PC_NONE(x, ...)                         \
     do {                                        \
         if (0) {                                \
@@ -158,6 +158,23 @@ struct pcdoc_elem_content {
     pcutils_str_t      *data;
 };
 
+/* The cursor of the child accessed by index last time; it is valid only
+   if the age of the document does not change. */
+struct pcdoc_child_cursor {
+    unsigned age;
+    pcdoc_element_t parent;
+    pcdoc_node_type_k type;
+    size_t idx;
+    void *child;
+};
+
+/* The numbers of children of the element counted last time. */
+struct pcdoc_children_counts {
+    unsigned age;
+    pcdoc_element_t parent;
+    size_t nrs[PCDOC_NODE_OTHERS + 1];
+};
+
 struct purc_document {
     purc_document_type_k type;
     pcrdr_msg_data_type def_text_type;
@@ -183,6 +200,10 @@ struct purc_document {
     /* global selector */
     char *selector;
 
+    /* the caches to access the children by index */
+    struct pcdoc_child_cursor child_cursor;
+    struct pcdoc_children_counts children_counts;
+
     purc_rwlock rwlock;
 
     void *impl;
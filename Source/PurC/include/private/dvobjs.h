@@ -285,6 +285,10 @@ int pcdvobj_url_decode(struct pcutils_mystring *mystr,
 purc_variant_t
 pcdvobjs_doc_new(purc_document_t doc);
 
+/* make an object reporting the resource usage of a coroutine */
+purc_variant_t
+pcdvobjs_coroutine_usage(struct pcintr_coroutine *cor) WTF_INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -32,6 +32,7 @@
 #include "purc-executor.h"
 
 #include "private/map.h"
+#include "private/list.h"
 
 PCA_EXTERN_C_BEGIN
 
@@ -98,9 +99,43 @@ int pcexec_register_ops(pcexec_ops_t ops);
 int pcexec_get_by_rule(const char *rule, pcexec_ops_t ops);
 
 
+/* the maximal number of parsed rules kept by an instance */
+#define PCEXEC_RULE_CACHE_SIZE      64
+
 struct pcexecutor_heap {
     unsigned int       debug_flex:1;
     unsigned int       debug_bison:1;
+
+    // the cache of parsed rules in LRU order
+    struct list_head   rule_cache;
+    size_t             nr_cached_rules;
+
+    // the minimal number of rows to build SQL indexes; zero for the default
+    size_t             sql_index_min_rows;
+};
+
+/* parses `rule` into `param`; on failure, returns non-zero and moves
+   the error message (if any) to `err_msg` */
+typedef int (*pcexec_rule_parse_f)(const char *rule, void *param,
+        char **err_msg);
+/* releases the fields of `param`, but not `param` itself */
+typedef void (*pcexec_rule_release_f)(void *param);
+
+// 解析后的规则，由同一实例中的执行器实例共享
+struct pcexec_parsed_rule {
+    struct list_head           ln;
+
+    // the executor is identified by its parse function
+    pcexec_rule_parse_f        parse;
+    pcexec_rule_release_f      release;
+
+    char                      *rule;
+    uint32_t                   hash;
+
+    unsigned int               refc;
+    unsigned int               detached:1;
+
+    void                      *param;
 };
 
 // 用于迭代的迭代器
@@ -123,6 +158,9 @@ struct purc_exec_inst {
     char                       *err_msg;
 
     purc_variant_t              value;
+
+    // the parsed rule currently used by this executor instance
+    struct pcexec_parsed_rule  *parsed_rule;
 };
 
 struct pcinst;
@@ -132,6 +170,45 @@ void pcexecutor_get_debug(int *debug_flex, int *debug_bison);
 
 void pcexecutor_inst_reset(struct purc_exec_inst *inst);
 
+// the keys of an object taken when an iteration over the object begins
+struct pcexec_obj_keys {
+    purc_variant_t             *keys;
+    size_t                      nr_keys;
+};
+
+/*
+ * Takes the keys of `obj`, so that the iteration is not broken if the
+ * object is changed between two steps, for example by the body of
+ * `<iterate>`. Returns false on memory failure.
+ */
+bool pcexecutor_obj_keys_take(struct pcexec_obj_keys *snapshot,
+        purc_variant_t obj);
+
+void pcexecutor_obj_keys_release(struct pcexec_obj_keys *snapshot);
+
+/*
+ * Returns the value of the first property of `obj` whose key is in the
+ * snapshot at `*idx` or after; the properties removed since the snapshot
+ * was taken are skipped. On return, `*idx` and `*key` locate the property.
+ * Returns PURC_VARIANT_INVALID when there is no more property.
+ */
+purc_variant_t
+pcexecutor_obj_keys_fetch(const struct pcexec_obj_keys *snapshot,
+        purc_variant_t obj, size_t *idx, purc_variant_t *key);
+
+/*
+ * Returns the parsed param of `rule` for the executor instance.
+ *
+ * The rule is parsed only when it is not in the rule cache of the current
+ * PurC instance; the returned param is owned by the cache and keeps valid
+ * until the executor instance is reset or parses another rule. On failure,
+ * returns NULL and sets `inst->err_msg` if the parser reports one.
+ */
+const void *
+pcexecutor_inst_parse_rule(struct purc_exec_inst *inst, const char *rule,
+        size_t sz_param, pcexec_rule_parse_f parse,
+        pcexec_rule_release_f release);
+
 
 int pcexecutor_register(pcexec_ops_t ops);
 
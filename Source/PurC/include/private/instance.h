@@ -143,6 +143,14 @@ struct pcinst {
     /* Since 0.9.22 */
     unsigned long long     unique_ull;
 
+    /* Since 0.9.26 */
+    struct pcregex_cache  *regex_cache;
+
+    /* Since 0.9.26; the options and the asynchronous writer of the log */
+    unsigned int           log_options;
+    size_t                 nr_log_dropped;
+    struct pclog_async    *log_async;
+
 #if ENABLE(QUICKJS)
     /* Since 0.9.26 */
     struct JSRuntime      *js_rt;
@@ -179,6 +187,9 @@ pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
 
 void pcinst_clear_error(struct pcinst *inst) WTF_INTERNAL;
 
+/* stops the asynchronous writer of the log after writing all records */
+void pcinst_stop_async_log(struct pcinst *inst) WTF_INTERNAL;
+
 purc_atom_t
 pcinst_endpoint_get(char *endpoint_name, size_t sz,
         const char *app_name, const char *runner_name) WTF_INTERNAL;
@@ -63,6 +63,7 @@
 #define MSG_TYPE_REQUEST_CHAN         "requestChan"
 #define MSG_TYPE_NEW_RENDERER         "newRenderer"
 #define MSG_TYPE_DUP_RENDERER         "dupRenderer"
+#define MSG_TYPE_CHAN_STATE           "chanState"
 
 #define MSG_SUB_TYPE_INFLATED         "inflated"
 #define MSG_SUB_TYPE_DEFLATED         "deflated"
@@ -90,6 +91,8 @@
 #define MSG_SUB_TYPE_NEW_DUPLICATE    "newDuplicate"
 #define MSG_SUB_TYPE_LOST_DUPLICATE   "lostDuplicate"
 #define MSG_SUB_TYPE_REQUESTFAILED    "RequestFailed"
+#define MSG_SUB_TYPE_SENDABLE         "sendable"
+#define MSG_SUB_TYPE_RECEIVABLE       "receivable"
 
 #define CRTN_TOKEN_MAIN               "_main"
 #define CRTN_TOKEN_FIRST              "_first"
@@ -242,8 +245,11 @@ struct pcintr_stack {
     struct pcintr_exception       exception;
 
     // executing statistics
-    struct timespec               time_executed;
+    struct timespec               time_executed;    // CPU time of all steps
     struct timespec               time_idle;
+    struct timespec               time_max_step;    // the longest step
+    uint64_t                      nr_steps;
+    int64_t                       mem_use;  // variant bytes charged
     size_t                        peak_mem_use;
     size_t                        peak_nr_variants;
 
@@ -302,6 +308,22 @@ struct pcintr_msg {
     struct list_head            node;
 };
 
+/* the resources accounted for a coroutine */
+enum pcintr_coroutine_resource {
+    CO_RESOURCE_CPU_TIME = 0,       /* CPU time in nanoseconds */
+    CO_RESOURCE_MEMORY,             /* variant bytes charged */
+    CO_RESOURCE_MESSAGES,           /* depth of the message queue */
+    CO_RESOURCE_OBSERVERS,          /* number of observers */
+    CO_RESOURCE_NR,
+};
+
+struct pcintr_coroutine_limit {
+    /* raise an exception once the usage exceeds the soft limit */
+    uint64_t                    soft;
+    /* terminate the coroutine once the usage exceeds the hard limit */
+    uint64_t                    hard;
+};
+
 struct pcintr_coroutine_child {
     struct list_head            ln;
     purc_atom_t                 cid;
@@ -376,6 +398,9 @@ struct pcintr_coroutine {
     struct list_head            ln_stopped;
     struct list_head            registered_cancels;
 
+    /* the shared channel on which the coroutine is blocked */
+    void                       *waiting_chan;
+
     struct pcinst_msg_queue    *mq;     /* message queue */
     struct list_head            tasks;  /* one event with multiple observers */
 
@@ -398,6 +423,11 @@ struct pcintr_coroutine {
 
     /** The default timeout value for remote requests or channel operations. */
     struct timespec             timeout;
+
+    /** The limits on the resources; zero for no limit. */
+    struct pcintr_coroutine_limit limits[CO_RESOURCE_NR];
+    /** The resources of which the soft limits have been reported. */
+    uint32_t                    soft_limits_hit;
     /* $CRTN  end */
 
     struct pcintr_timers       *timers;     // $TIMERS
@@ -1010,6 +1040,11 @@ pcintr_coroutine_is_match_dom_handle(pcintr_coroutine_t cor, uint64_t handle);
 bool
 pcintr_coroutine_is_rdr_attached(pcintr_coroutine_t cor);
 
+/* Returns the current usage of a resource in the unit of its limits. */
+uint64_t
+pcintr_coroutine_get_usage(pcintr_coroutine_t cor,
+        enum pcintr_coroutine_resource res);
+
 pcintr_coroutine_t
 pcintr_get_first_crtn(struct pcinst *inst);
 
@@ -71,13 +71,31 @@ enum pcregex_match_flags {
 struct pcregex;
 struct pcregex_match_info;
 
+/* The compiled patterns cached for an instance. */
+struct pcregex_cache;
+
+struct pcregex_cache_stat {
+    size_t nr_entries;      // the number of patterns in the cache
+    size_t nr_simple;       // the matches done without the regex engine
+    size_t nr_hits;         // the matches using a cached pattern
+    size_t nr_misses;       // the matches compiling the pattern
+    size_t nr_evictions;    // the patterns evicted from the cache
+};
+
+struct pcinst;
+
 #ifdef __cplusplus
 extern "C" {
 #endif  /* __cplusplus */
 
 
 /*
- * Scans for a match in string for pattern
+ * Scans for a match in string for pattern.
+ *
+ * The plain literal patterns, optionally anchored by `^` and/or `$`, and
+ * `.*` are matched without the regex engine if there is no option. Other
+ * patterns are compiled once and kept in an LRU cache of the current
+ * instance.
  */
 bool pcregex_is_match_ex(const char *pattern, const char *str,
         enum pcregex_compile_flags compile_options,
@@ -130,6 +148,16 @@ char *pcregex_match_info_fetch(const struct pcregex_match_info *match_info,
 
 void pcregex_match_info_destroy(struct pcregex_match_info *match_info);
 
+/*
+ * Gets the statistics of the pattern cache of the current instance.
+ */
+void pcregex_cache_get_stat(struct pcregex_cache_stat *stat);
+
+/*
+ * Destroys the pattern cache of an instance.
+ */
+void pcregex_cache_delete(struct pcinst *inst);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -0,0 +1,78 @@
+/**
+ * @file slab.h
+ * @brief The interfaces of the size-classed slab allocator.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_PRIVATE_SLAB_H
+#define PURC_PRIVATE_SLAB_H
+
+#include "purc-macros.h"
+
+#include <stddef.h>
+
+/*
+ * A slab is a pool of small blocks which are carved out of big aligned
+ * chunks and grouped by size classes. A slab is owned by one thread (in
+ * PurC, the variant heap of an instance); allocating from and freeing to
+ * the owning slab need no lock.
+ *
+ * A block can be freed by another thread, for example, when a variant
+ * has been moved to another instance. Such block is pushed to the remote
+ * list of the owning slab without lock, and will be reused after the owner
+ * collects it. If the owner has gone, the slab is released when the last
+ * block comes back.
+ *
+ * Like g_slice_alloc(), the caller should pass the same size when freeing
+ * a block. The requests larger than PCUTILS_SLAB_MAX_SIZE are served by
+ * malloc() and free().
+ */
+
+#define PCUTILS_SLAB_MAX_SIZE       256
+
+typedef struct pcutils_slab pcutils_slab;
+
+struct pcutils_slab_stat {
+    size_t nr_chunks;       // the number of chunks allocated
+    size_t sz_chunks;       // the memory used by the chunks in bytes
+    size_t nr_used;         // the number of blocks in use
+    size_t nr_free;         // the number of free blocks cached
+};
+
+PCA_EXTERN_C_BEGIN
+
+pcutils_slab *pcutils_slab_new(void);
+
+/* Deletes the slab; the chunks having blocks still in use (by other
+   threads) will be released when the last block is freed. */
+void pcutils_slab_delete(pcutils_slab *slab);
+
+/* Allocates a block from @slab; the content is zeroed. If @slab is NULL,
+   the block comes from a slab shared by the threads having no slab. */
+void *pcutils_slab_alloc0(pcutils_slab *slab, size_t size);
+
+/* Frees a block; @slab is the slab of the caller, which can be NULL or
+   different from the slab allocated the block. */
+void pcutils_slab_free(pcutils_slab *slab, size_t size, void *p);
+
+void pcutils_slab_get_stat(pcutils_slab *slab, struct pcutils_slab_stat *stat);
+
+PCA_EXTERN_C_END
+
+#endif /* PURC_PRIVATE_SLAB_H */
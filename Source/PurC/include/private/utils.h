@@ -160,6 +160,14 @@ typedef enum {
     PURC_K_ALGO_CRC32Q,
 } purc_crc32_algo_t;
 
+struct pcutils_crc32_ctxt;
+
+/* The engine updates the CRC register by the bytes and returns the new one;
+   selected by pcutils_crc32_begin() according to the algorithm and the
+   features of the CPU. */
+typedef uint32_t (*pcutils_crc32_engine_f)(const struct pcutils_crc32_ctxt *,
+        uint32_t crc32, const uint8_t *buf, size_t sz);
+
 typedef struct pcutils_crc32_ctxt {
     uint32_t    poly;
     uint32_t    init;
@@ -173,8 +181,17 @@ typedef struct pcutils_crc32_ctxt {
         const uint32_t *table_static;
         uint32_t       *table_alloc;
     };
+
+    /* the tables for slicing-by-16, NULL if not available */
+    const uint32_t (*slices)[256];
+    pcutils_crc32_engine_f engine;
 } pcutils_crc32_ctxt;
 
+/* Returns the name of the engine used by the context, e.g., "slice-by-16",
+   "sse4.2", or "pclmulqdq"; for debugging and testing. */
+const char *
+pcutils_crc32_engine_name(const pcutils_crc32_ctxt *ctxt);
+
 void
 pcutils_crc32_begin(pcutils_crc32_ctxt *ctxt, purc_crc32_algo_t algo);
 
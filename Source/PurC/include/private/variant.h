@@ -34,6 +34,7 @@
 #include "private/debug.h"
 #include "private/map.h"
 #include "private/mpops.h"
+#include "private/slab.h"
 
 PCA_EXTERN_C_BEGIN
 
@@ -41,6 +42,9 @@ PCA_EXTERN_C_BEGIN
 #define PCVRNT_FLAG_NOFREE          PCVRNT_FLAG_CONSTANT
 #define PCVRNT_FLAG_EXTRA_SIZE      (0x01 << 1)  // when use extra space
 #define PCVRNT_FLAG_STATIC_DATA     (0x01 << 2)  // make_string_static
+#define PCVRNT_FLAG_RELEASE_HOOK    (0x01 << 3)  // bsequence with release hook
+#define PCVRNT_FLAG_IN_BATCH        (0x01 << 4)  // container in a batch
+#define PCVRNT_FLAG_SLAB_DATA       (0x01 << 5)  // extra bytes in the slab
 
 #define PVT(t)          (PURC_VARIANT_TYPE##t)
 
@@ -294,6 +298,18 @@ struct pcvariant_heap {
 
     // use linked loop list for other reserved variants.
     struct list_head    v_reserved;
+
+    // the slab for variants and the nodes of containers.
+    struct pcutils_slab *slab;
+
+    // the containers in batches of mutations (struct pcvar_batch).
+    struct list_head    batches;
+    // the arguments of the coalesced event being fired.
+    purc_variant_t     *batched_argv;
+
+    // the counter of the running coroutine, which is charged for the bytes
+    // of the variants allocated and released; NULL if no coroutine is running.
+    int64_t            *mem_charged;
 };
 
 // internal interfaces for moving variant.
@@ -321,6 +337,10 @@ purc_variant *pcvariant_alloc(bool scalar) WTF_INTERNAL;
 purc_variant *pcvariant_alloc_0(bool scalar) WTF_INTERNAL;
 void pcvariant_free(purc_variant *v) WTF_INTERNAL;
 
+/* Allocate or free a zeroed node of containers in the slab of the heap. */
+void *pcvariant_node_alloc0(size_t size) WTF_INTERNAL;
+void pcvariant_node_free(size_t size, void *node) WTF_INTERNAL;
+
 purc_variant *
 pcvariant_make_bigint_from_limbs(const bi_limb_t *tab, size_t len)
     WTF_INTERNAL;
@@ -418,6 +438,38 @@ int pcvariant_array_sort(purc_variant_t value, void *ud,
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud));
 
+/* Reorder the members: the member at `order[i]` moves to the index `i`. */
+int pcvariant_array_permute(purc_variant_t value, const size_t *order);
+int pcvariant_set_permute(purc_variant_t value, const size_t *order);
+
+/*
+ * Returns the value of the `key_idx`-th sort key of a member,
+ * or PURC_VARIANT_INVALID if the member does not have the key.
+ */
+typedef purc_variant_t (*pcvariant_sort_key_f)(purc_variant_t member,
+        size_t key_idx, void *ud);
+
+struct pcvariant_sort_spec {
+    size_t                  nr_keys;
+    /* compare the key as number or as string for each key */
+    const bool             *by_number;
+    bool                    ascendingly;
+    bool                    casesensitively;
+
+    /* NULL for using the member itself as the only key. */
+    pcvariant_sort_key_f    get_key;
+    void                   *ud;
+};
+
+/*
+ * Sorts the members of an array or a set by the typed keys, which are
+ * extracted from every member only once (decorate-sort-undecorate).
+ * A missing key is treated as 0 if it is compared as number, or
+ * less than any string if it is compared as string.
+ */
+int pcvariant_sort_by_keys(purc_variant_t value,
+        const struct pcvariant_sort_spec *spec);
+
 int pcvariant_diff(purc_variant_t l, purc_variant_t r);
 int pcvariant_diff_ex(purc_variant_t l, purc_variant_t r,
         enum pcvrnt_compare_method opt);
@@ -491,6 +543,9 @@ void pcvariant_on_post_fired(
         purc_variant_t *argv    // the array of all relevant child variants.
         );
 
+// releases the batches left uncommitted in the heap.
+void pcvariant_release_batches(struct pcvariant_heap *heap) WTF_INTERNAL;
+
 purc_variant_t pcvariant_set_find (purc_variant_t set, purc_variant_t value);
 
 static inline bool
@@ -547,6 +602,12 @@ bool
 pcvariant_container_remove(purc_variant_t dst,
         purc_variant_t src, bool silently);
 
+/* Removes the members of @arr at the positions marked in @marked, which
+   has @nr_marked (the size of the array) entries, in one pass. */
+bool
+pcvariant_array_remove_marked(purc_variant_t arr, const bool *marked,
+        size_t nr_marked);
+
 bool
 pcvariant_array_append_another(purc_variant_t array,
         purc_variant_t another, bool silently);
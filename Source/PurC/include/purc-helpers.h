@@ -428,6 +428,8 @@ char *purc_load_file_contents(const char *file, size_t *length);
 
 #define PURC_ENVV_LOG_ENABLE        "PURC_LOG_ENABLE"
 #define PURC_ENVV_LOG_SYSLOG        "PURC_LOG_SYSLOG"
+#define PURC_ENVV_LOG_ASYNC         "PURC_LOG_ASYNC"
+#define PURC_ENVV_LOG_JSON          "PURC_LOG_JSON"
 
 #define PURC_LOG_FILE_PATH_FORMAT   "/var/tmp/purc-%s-%s.log"
 
@@ -509,6 +511,54 @@ purc_enable_log_ex(unsigned levels, purc_log_facility_k facility);
 PCA_EXPORT unsigned
 purc_get_log_levels(void);
 
+/* Write the log records in a background thread. */
+#define PURC_LOG_OPT_ASYNC      0x0001
+/* Write the log records as JSON lines. */
+#define PURC_LOG_OPT_JSON       0x0002
+
+/**
+ * Sets the options of the log facility for the current PurC instance.
+ *
+ * @param options: The log options, a bitwise OR'd combination of
+ *  %PURC_LOG_OPT_ASYNC and %PURC_LOG_OPT_JSON.
+ *
+ * When %PURC_LOG_OPT_ASYNC is set, the log records are put in a ring buffer
+ * of the instance and written out in batch by a background thread; a record
+ * will be dropped if the ring buffer is full. When %PURC_LOG_OPT_JSON is
+ * set, every record is written as a JSON object in a line. The options do
+ * not change the records sent to syslog, except that they will be sent by
+ * the background thread.
+ *
+ * Returns: @true for success, otherwise @false. This function fails with
+ *  %PURC_ERROR_NOT_SUPPORTED if the asynchronous log is not supported on
+ *  the platform.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT bool
+purc_set_log_options(unsigned options);
+
+/**
+ * Gets the options of the log facility for the current PurC instance.
+ *
+ * Returns: The log options.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT unsigned
+purc_get_log_options(void);
+
+/**
+ * Gets the number of the log records dropped because the ring buffer
+ * of the asynchronous log was full.
+ *
+ * Returns: The number of the dropped log records.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT size_t
+purc_get_log_nr_dropped(void);
+
 /**
  * Enable or disable the log facility for the current PurC instance.
  *
@@ -554,6 +604,24 @@ purc_log_with_tag(purc_log_level_k level, const char* tag,
         const char *msg, va_list ap)
     PCA_ATTRIBUTE_PRINTF(3, 0);
 
+/**
+ * Log a message with a specified tag and the source location.
+ *
+ * @param tag: the tag of the message; @NULL for the tag of the level.
+ * @param file: the source file name, which should be a static string,
+ *  e.g., `__FILE__`; @NULL for none.
+ * @param line: the line number in the source file.
+ * @param msg: the message or the format string.
+ *
+ * Returns: none.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT void
+purc_log_with_location(purc_log_level_k level, const char* tag,
+        const char *file, int line, const char *msg, va_list ap)
+    PCA_ATTRIBUTE_PRINTF(5, 0);
+
 /**
  * Log a message with a specified tag.
  *
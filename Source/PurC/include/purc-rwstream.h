@@ -101,6 +101,35 @@ purc_rwstream_new_from_file (const char* file, const char* mode);
  */
 PCA_EXPORT purc_rwstream_t purc_rwstream_new_from_fp (FILE* fp);
 
+/**
+ * Creates a new read-only purc_rwstream_t by mapping the given file into
+ * memory (private and read-only). The stream behaves like a memory stream
+ * created by purc_rwstream_new_from_mem(), so the whole content can be
+ * fetched by calling purc_rwstream_get_mem_buffer() without copying.
+ * The mapping is released when the stream is destroyed.
+ *
+ * The stream is a snapshot of the file at the time it is opened: the
+ * data appended to the file later is not visible, and truncating the file
+ * while it is mapped results in SIGBUS on access. Therefore, use it only
+ * to read a whole file at once, e.g. for parsing; do not use it for
+ * long-lived streams or files which may be changed by others (logs).
+ *
+ * Only regular files can be mapped; the caller should clear the error
+ * and fall back to purc_rwstream_new_from_file() if this function fails.
+ *
+ * @param file: the file will be mapped
+ *
+ * @return A purc_rwstream_t on success, @NULL on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_BAD_SYSTEM_CALL: Bad system call
+ *  - @PURC_ERROR_NOT_SUPPORTED: Not a regular file
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *  - @PURC_ERROR_NOT_IMPLEMENTED: Not implemented
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT purc_rwstream_t purc_rwstream_new_from_mmap (const char* file);
+
 /**
  * Creates a new purc_rwstream_t for the given file descriptor (Unix && GLIB).
  * The fd must be in blocking mode, otherwise the fd will be set in blocking
@@ -324,6 +353,50 @@ purc_rwstream_write (purc_rwstream_t rws, const void* buf, size_t count);
 PCA_EXPORT int
 purc_rwstream_ungetc (purc_rwstream_t rws,  const char* utf8ch, int len);
 
+/**
+ * Peeks the data in a purc_rwstream_t without consuming them.
+ *
+ * @param rws: purc_rwstream_t
+ * @param buf: the pointer to receive the address of the data
+ * @param min_len: the minimal number of bytes wanted; zero is taken as one.
+ *
+ * A memory-based stream returns all data left in place. Other streams
+ * read ahead a chunk of data into the internal buffer, so that the caller
+ * can scan the data (e.g., by using memchr()) without a call per byte.
+ * Call @purc_rwstream_consume to skip the bytes scanned.
+ *
+ * The data returned are valid until the next operation on the stream.
+ *
+ * @return The number of contiguous bytes available at @buf, which is less
+ *  than @min_len only if the stream reaches the end; 0 at the end of the
+ *  stream; -1 on failure and the error code is set to indicate the error:
+ *  - @PURC_ERROR_INVALID_VALUE: Invalid value
+ *  - @PURC_ERROR_NOT_SUPPORTED: The stream can not be read
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *  - Other errors set by @purc_rwstream_read
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT ssize_t
+purc_rwstream_peek (purc_rwstream_t rws, const void **buf, size_t min_len);
+
+/**
+ * Consumes the data returned by @purc_rwstream_peek.
+ *
+ * @param rws: purc_rwstream_t
+ * @param count: the number of bytes to consume, which must not be larger
+ *  than the number of bytes returned by the last call of
+ *  @purc_rwstream_peek.
+ *
+ * @return The number of bytes consumed, or -1 on failure and the error code
+ *  is set to indicate the error:
+ *  - @PURC_ERROR_INVALID_VALUE: Invalid value
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT ssize_t
+purc_rwstream_consume (purc_rwstream_t rws, size_t count);
+
 
 /**
  * Flushes the write buffer for the purc_rwstream_t.
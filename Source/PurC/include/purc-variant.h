@@ -640,6 +640,33 @@ purc_variant_make_byte_sequence(const void* bytes, size_t nr_bytes);
 PCA_EXPORT purc_variant_t
 purc_variant_make_byte_sequence_static(const void* bytes, size_t nr_bytes);
 
+typedef void (*pcvrnt_bsequence_release_cb)(void *ctxt);
+
+/**
+ * purc_variant_make_byte_sequence_external:
+ *
+ * @bytes: The pointer to a byte sequence owned by the caller.
+ * @nr_bytes: The number of bytes in the sequence.
+ * @release: The callback to call when the variant is released.
+ * @ctxt: The context passed to @release.
+ *
+ * Creates a read-only bsequence variant which refers to the bytes managed
+ * by an external owner, for example, a buffer exported by a foreign runtime.
+ * The bytes will not be copied; @release will be called with @ctxt when the
+ * variant is released, and the caller should keep the bytes valid until then.
+ * Like a static bsequence, the bytes can not be changed by the bsequence
+ * manipulation functions.
+ *
+ * Returns: A bsequence variant if success,
+ *      or %PURC_VARIANT_INVALID on failure; in the latter case, @release
+ *      will not be called.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_byte_sequence_external(const void* bytes, size_t nr_bytes,
+        pcvrnt_bsequence_release_cb release, void *ctxt);
+
 /**
  * purc_variant_make_byte_sequence_reuse_buff:
  *
@@ -1100,6 +1127,27 @@ purc_variant_make_array_0(void)
 PCA_EXPORT bool
 purc_variant_array_append(purc_variant_t array, purc_variant_t value);
 
+/**
+ * purc_variant_array_append_many:
+ *
+ * @array: An array variant.
+ * @nr_values: The number of variants to be appended.
+ * @values: The array of the variants to be appended.
+ *
+ * Appends @nr_values variants at the tail of @array in one operation.
+ * The storage of the array is expanded only once, and the post listeners
+ * on @array will be notified by a single coalesced %PCVAR_OPERATION_INFLATED
+ * event (see purc_variant_container_begin_batch()).
+ *
+ * Returns: %true on success, otherwise %false. On failure, @array keeps
+ *  unchanged.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT bool
+purc_variant_array_append_many(purc_variant_t array,
+        size_t nr_values, purc_variant_t *values);
+
 /**
  * purc_variant_array_prepend:
  *
@@ -1401,6 +1449,27 @@ PCA_EXPORT bool
 purc_variant_object_set(purc_variant_t obj,
         purc_variant_t key, purc_variant_t value);
 
+/**
+ * purc_variant_object_set_many:
+ *
+ * @obj: An object variant.
+ * @nr_kvs: The number of the key-value pairs.
+ * @keys: The array of the keys; every key must be a string variant.
+ * @values: The array of the values.
+ *
+ * Sets @nr_kvs properties of @obj in one batch. The post listeners on
+ * @obj will be notified by at most one coalesced event per operation
+ * (see purc_variant_container_begin_batch()).
+ *
+ * Returns: %true on success, otherwise %false. On failure, the properties
+ *  set before the failed one are kept.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT bool
+purc_variant_object_set_many(purc_variant_t obj, size_t nr_kvs,
+        purc_variant_t *keys, purc_variant_t *values);
+
 /**
  * purc_variant_object_set_by_static_ckey:
  *
@@ -1962,6 +2031,28 @@ PCA_EXPORT ssize_t
 purc_variant_set_add(purc_variant_t set, purc_variant_t value,
         pcvrnt_cr_method_k cr_method);
 
+/**
+ * purc_variant_set_add_many:
+ *
+ * @set: The variant of set.
+ * @nr_values: The number of variants to be added.
+ * @values: The array of the variants to be added.
+ * @cr_method: The method to resolve the conflict; see purc_variant_set_add().
+ *
+ * Adds @nr_values values to the set in one batch. The storage of the set
+ * is expanded only once, and the post listeners on @set will be notified
+ * by at most one coalesced event per operation
+ * (see purc_variant_container_begin_batch()).
+ *
+ * Returns: The number of new members or changed members in the set,
+ * -1 for error.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT ssize_t
+purc_variant_set_add_many(purc_variant_t set, size_t nr_values,
+        purc_variant_t *values, pcvrnt_cr_method_k cr_method);
+
 /**
  * purc_variant_set_remove:
  *
@@ -2722,6 +2813,75 @@ purc_variant_load_from_json_file(const char* file);
 PCA_EXPORT purc_variant_t
 purc_variant_load_from_json_stream(purc_rwstream_t stream);
 
+typedef enum {
+    /* A top-level array if the data starts with `[`, otherwise a
+       sequence of values. */
+    PCVRNT_JSON_RECORDS_AUTO = 0,
+    /* The elements of a top-level array. */
+    PCVRNT_JSON_RECORDS_ARRAY,
+    /* A sequence of values, such as JSON lines. */
+    PCVRNT_JSON_RECORDS_LINES,
+} pcvrnt_json_records_k;
+
+struct pcvrnt_json_reader;
+typedef struct pcvrnt_json_reader *pcvrnt_json_reader_t;
+
+/**
+ * purc_variant_json_reader_new:
+ *
+ * @stream: A purc_rwstream_t stream.
+ * @records: The layout of the records in the stream, one of
+ *      the values of #pcvrnt_json_records_k.
+ *
+ * Creates a reader which reads the JSON data in @stream record by record.
+ * A record is an element of the top-level array, or a top-level value
+ * in a sequence of values (e.g., a line of JSON lines).
+ *
+ * The reader only keeps the record being read in memory, so the memory
+ * used is bounded by the largest record, not the whole data. The reader
+ * scans the data in the read buffer of @stream and consumes only the bytes
+ * of the records, so @stream can be read by others between two calls of
+ * purc_variant_json_reader_next().
+ *
+ * Returns: A new reader on success, or %NULL on failure.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT pcvrnt_json_reader_t
+purc_variant_json_reader_new(purc_rwstream_t stream,
+        pcvrnt_json_records_k records);
+
+/**
+ * purc_variant_json_reader_next:
+ *
+ * @reader: The JSON reader.
+ *
+ * Reads and parses the next record.
+ *
+ * Returns: A variant for the record on success, or %PURC_VARIANT_INVALID
+ *      on failure. The error code will be %PURC_ERROR_NO_DATA if there is
+ *      no more record, %PURC_ERROR_AGAIN if the stream is not ready for
+ *      read (the next call continues the partially read record), or
+ *      an error of the eJSON parser if the record is malformed (the
+ *      next call goes on with the following record).
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_json_reader_next(pcvrnt_json_reader_t reader);
+
+/**
+ * purc_variant_json_reader_delete:
+ *
+ * @reader: The JSON reader.
+ *
+ * Deletes the reader. The stream is not destroyed.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT void
+purc_variant_json_reader_delete(pcvrnt_json_reader_t reader);
+
 /**
  * purc_variant_cast_to_int32:
  *
@@ -3045,6 +3205,15 @@ purc_variant_compare_ex(purc_variant_t v1, purc_variant_t v2,
  */
 #define PCVRNT_SERIALIZE_OPT_BIGINT_HEX              0x00004000
 
+/**
+ * A flag for the purc_variant_serialize() function which causes
+ * the output to use the shortest form which can recover the original
+ * value for real numbers when there is no custom format.
+ *
+ * Since: 0.9.26
+ */
+#define PCVRNT_SERIALIZE_OPT_REAL_SHORTEST           0x00008000
+
 /**
  * A flag for the purc_variant_serialize() function which causes
  * the function ignores the output errors.
@@ -3577,6 +3746,10 @@ struct purc_variant_stat {
     size_t sz_total_mem;
     size_t nr_reserved_scalar, nr_reserved_vector;            // Since 0.9.26
     size_t nr_max_reserved_scalar, nr_max_reserved_vector;    // Since 0.9.26
+    /* the slab chunks used by the variants and the nodes of containers */
+    size_t nr_slab_chunks, sz_slab_chunks;                    // Since 0.9.26
+    /* the slab blocks in use and the free ones cached in the slab */
+    size_t nr_slab_used, nr_slab_free;                        // Since 0.9.26
 };
 
 /**
@@ -3835,6 +4008,91 @@ PCA_EXPORT bool
 purc_variant_revoke_listener(purc_variant_t v,
         struct pcvar_listener *listener);
 
+/**
+ * purc_variant_container_begin_batch:
+ *
+ * @ctnr: The container variant.
+ *
+ * Begins a batch of mutations on @ctnr. Until the matched call of
+ * purc_variant_container_commit_batch(), the post listeners on @ctnr will
+ * not be called for %PCVAR_OPERATION_INFLATED, %PCVAR_OPERATION_DEFLATED,
+ * and %PCVAR_OPERATION_MODIFIED; the arguments of the operations are
+ * collected instead. The pre listeners are still called for every
+ * operation, so they can veto any of them.
+ *
+ * The batches can be nested; only the outermost commit fires the events.
+ *
+ * Returns: a boolean that indicates if the operation succeeds or not.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT bool
+purc_variant_container_begin_batch(purc_variant_t ctnr);
+
+/**
+ * purc_variant_container_commit_batch:
+ *
+ * @ctnr: The container variant.
+ *
+ * Commits the batch of mutations on @ctnr begun by
+ * purc_variant_container_begin_batch(). If this is the outermost batch,
+ * the post listeners on @ctnr will be called once for every run of
+ * consecutive operations of the same kind happened in the batch, in order.
+ * For the coalesced event, every argument is an array which contains
+ * the corresponding arguments of all the operations in the run in order.
+ * For example, for an array, the arguments of a coalesced
+ * %PCVAR_OPERATION_INFLATED event are the array of the positions and
+ * the array of the new members. A listener which handles the operations
+ * one by one can use purc_variant_unbatch_event().
+ *
+ * Note that %PCVAR_OPERATION_RELEASING is never coalesced.
+ *
+ * Returns: a boolean that indicates if the operation succeeds or not.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT bool
+purc_variant_container_commit_batch(purc_variant_t ctnr);
+
+/**
+ * purc_variant_is_batched_event:
+ *
+ * @nr_args: The number of the arguments passed to the listener.
+ * @argv: The arguments passed to the listener.
+ *
+ * Checks whether the arguments passed to a post listener come from
+ * a coalesced event fired by purc_variant_container_commit_batch().
+ *
+ * Returns: %true for a coalesced event, otherwise %false.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT bool
+purc_variant_is_batched_event(size_t nr_args, purc_variant_t *argv);
+
+/**
+ * purc_variant_unbatch_event:
+ *
+ * @source: The source variant passed to the listener.
+ * @op: The operation passed to the listener.
+ * @ctxt: The context passed to the listener.
+ * @nr_args: The number of the arguments passed to the listener.
+ * @argv: The arguments passed to the listener.
+ * @handler: The handler for a single operation.
+ *
+ * Calls @handler once for every operation in a coalesced event with
+ * the arguments of the operation, or once with @argv if the event
+ * is not a coalesced one.
+ *
+ * Returns: %false if any call of @handler returned %false.
+ *
+ * Since: 0.9.26
+ */
+PCA_EXPORT bool
+purc_variant_unbatch_event(purc_variant_t source, pcvar_op_t op,
+        void *ctxt, size_t nr_args, purc_variant_t *argv,
+        pcvar_op_handler handler);
+
 /**
  * purc_variant_container_clone:
  *
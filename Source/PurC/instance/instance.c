@@ -43,6 +43,7 @@
 #include "private/pcrdr.h"
 #include "private/msg-queue.h"
 #include "private/runners.h"
+#include "private/regex.h"
 #include "purc-runloop.h"
 
 #include "../interpreter/internal.h"
@@ -417,6 +418,19 @@ static void enable_log_on_demand(void)
 
     purc_enable_log_ex(log_mask,
             use_syslog ? PURC_LOG_FACILITY_SYSLOG : PURC_LOG_FACILITY_STDERR);
+
+    unsigned log_options = 0;
+    if ((env_value = getenv(PURC_ENVV_LOG_ASYNC)) &&
+            (*env_value == '1' || strcasecmp(env_value, "true") == 0)) {
+        log_options |= PURC_LOG_OPT_ASYNC;
+    }
+    if ((env_value = getenv(PURC_ENVV_LOG_JSON)) &&
+            (*env_value == '1' || strcasecmp(env_value, "true") == 0)) {
+        log_options |= PURC_LOG_OPT_JSON;
+    }
+
+    if (log_options)
+        purc_set_log_options(log_options);
 }
 
 static int init_modules(struct pcinst *curr_inst,
@@ -474,6 +488,7 @@ static void cleanup_instance(struct pcinst *curr_inst)
         curr_inst->local_data_map = NULL;
     }
 
+    pcinst_stop_async_log(curr_inst);
     if (curr_inst->fp_log && curr_inst->fp_log != LOG_FILE_SYSLOG
             && curr_inst->fp_log != stdout && curr_inst->fp_log != stderr) {
         fclose(curr_inst->fp_log);
@@ -485,6 +500,8 @@ static void cleanup_instance(struct pcinst *curr_inst)
         curr_inst->bt = NULL;
     }
 
+    pcregex_cache_delete(curr_inst);
+
     purc_atom_remove_string_ex(PURC_ATOM_BUCKET_DEF,
             curr_inst->endpoint_name);
 
@@ -33,13 +33,19 @@
 #endif /* HAVE_SYSLOG_H */
 
 #include "private/instance.h"
+#include "private/interpreter.h"
 #include "private/ports.h"
 
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 static unsigned global_log_levels = PURC_LOG_MASK_DEFAULT;
 static FILE *global_log_fp = NULL;
 
+static bool start_async_log(struct pcinst *inst);
+
 unsigned purc_get_log_levels(void)
 {
     struct pcinst* inst = pcinst_current();
@@ -78,6 +84,9 @@ bool purc_enable_log_ex(unsigned levels, purc_log_facility_k facility)
         return true;
     }
 
+    /* the writer thread should not be using the FILE object any more */
+    pcinst_stop_async_log(inst);
+
     if (inst->fp_log &&
             (inst->fp_log != LOG_FILE_SYSLOG &&
              inst->fp_log != stdout && inst->fp_log != stderr)) {
@@ -131,6 +140,9 @@ bool purc_enable_log_ex(unsigned levels, purc_log_facility_k facility)
         inst->fp_log = NULL;
     }
 
+    if ((inst->log_options & PURC_LOG_OPT_ASYNC) && inst->fp_log)
+        return start_async_log(inst);
+
     return true;
 }
 
@@ -157,8 +169,486 @@ _COMPILE_TIME_ASSERT(levels,
 
 #undef _COMPILE_TIME_ASSERT
 
-void purc_log_with_tag(purc_log_level_k level, const char *tag,
+/* the sizes of the message and the tag kept in a record; a longer one is
+   allocated */
+#define SZ_LOG_INLINE_MSG       256
+#define SZ_LOG_INLINE_TAG       32
+
+struct log_record {
+    struct timespec     wall;
+    struct timespec     mono;
+    purc_log_level_k    level;
+    int                 line;
+    const char         *file;   // a static string, e.g., __FILE__
+    char                tag[SZ_LOG_INLINE_TAG];
+    char                crtn[CRTN_TOKEN_LEN + 1];
+    char               *long_tag;
+    char               *long_msg;
+    char                msg[SZ_LOG_INLINE_MSG];
+};
+
+static void
+fill_record(struct log_record *rec, struct pcinst *inst,
+        purc_log_level_k level, const char *tag, const char *file, int line,
         const char *msg, va_list ap)
+{
+    clock_gettime(CLOCK_REALTIME, &rec->wall);
+    clock_gettime(CLOCK_MONOTONIC, &rec->mono);
+    rec->level = level;
+    rec->file = file;
+    rec->line = line;
+    if (tag == NULL)
+        tag = level_info[level].tag;
+
+    rec->long_tag = NULL;
+    size_t len = strlen(tag);
+    if (len < sizeof(rec->tag)) {
+        memcpy(rec->tag, tag, len + 1);
+    }
+    else {
+        /* keep the tag truncated if failed to allocate */
+        rec->long_tag = strdup(tag);
+        strncpy(rec->tag, tag, sizeof(rec->tag) - 1);
+        rec->tag[sizeof(rec->tag) - 1] = 0;
+    }
+
+    rec->crtn[0] = 0;
+    if (inst && inst->intr_heap && inst->intr_heap->running_coroutine) {
+        strcpy(rec->crtn, inst->intr_heap->running_coroutine->token);
+    }
+
+    va_list ap_long;
+    va_copy(ap_long, ap);
+    int n = vsnprintf(rec->msg, sizeof(rec->msg), msg, ap);
+    rec->long_msg = NULL;
+    if (n < 0) {
+        rec->msg[0] = 0;
+    }
+    else if ((size_t)n >= sizeof(rec->msg)) {
+        rec->long_msg = malloc(n + 1);
+        if (rec->long_msg)
+            vsnprintf(rec->long_msg, n + 1, msg, ap_long);
+    }
+    va_end(ap_long);
+}
+
+static inline const char *
+record_message(const struct log_record *rec)
+{
+    return rec->long_msg ? rec->long_msg : rec->msg;
+}
+
+static inline const char *
+record_tag(const struct log_record *rec)
+{
+    return rec->long_tag ? rec->long_tag : rec->tag;
+}
+
+static inline void
+release_record(struct log_record *rec)
+{
+    free(rec->long_tag);
+    rec->long_tag = NULL;
+    free(rec->long_msg);
+    rec->long_msg = NULL;
+}
+
+static void
+append_json_string(struct pcutils_mystring *out, const char *str)
+{
+    size_t len = strlen(str);
+
+    /* the trailing newline of a message is not a part of the record */
+    if (len > 0 && str[len - 1] == '\n')
+        len--;
+
+    pcutils_mystring_append_char(out, '"');
+    while (len > 0) {
+        size_t n = 0;
+        while (n < len && (unsigned char)str[n] >= 0x20 &&
+                str[n] != '"' && str[n] != '\\')
+            n++;
+
+        if (n > 0) {
+            pcutils_mystring_append_mchar(out, (const unsigned char *)str, n);
+            str += n;
+            len -= n;
+            continue;
+        }
+
+        char esc[8];
+        unsigned char c = *str;
+        if (c == '"' || c == '\\')
+            snprintf(esc, sizeof(esc), "\\%c", c);
+        else if (c == '\n')
+            strcpy(esc, "\\n");
+        else if (c == '\t')
+            strcpy(esc, "\\t");
+        else
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+        pcutils_mystring_append_string(out, esc);
+        str++;
+        len--;
+    }
+    pcutils_mystring_append_char(out, '"');
+}
+
+static void
+format_record(struct pcutils_mystring *out, const struct log_record *rec,
+        const char *runner, bool json)
+{
+    char buf[128];
+    struct tm tm;
+
+    gmtime_r(&rec->wall.tv_sec, &tm);
+    size_t n = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    n += snprintf(buf + n, sizeof(buf) - n, ".%06ldZ",
+            rec->wall.tv_nsec / 1000);
+
+    if (json) {
+        pcutils_mystring_append_string(out, "{\"time\":\"");
+        pcutils_mystring_append_mchar(out, (const unsigned char *)buf, n);
+        snprintf(buf, sizeof(buf), "\",\"mono\":%lld.%06ld,\"tag\":",
+                (long long)rec->mono.tv_sec, rec->mono.tv_nsec / 1000);
+        pcutils_mystring_append_string(out, buf);
+        append_json_string(out, record_tag(rec));
+        pcutils_mystring_append_string(out, ",\"runner\":");
+        append_json_string(out, runner);
+        if (rec->crtn[0]) {
+            pcutils_mystring_append_string(out, ",\"crtn\":");
+            append_json_string(out, rec->crtn);
+        }
+        if (rec->file) {
+            pcutils_mystring_append_string(out, ",\"file\":");
+            append_json_string(out, pcutils_basename(rec->file));
+            snprintf(buf, sizeof(buf), ",\"line\":%d", rec->line);
+            pcutils_mystring_append_string(out, buf);
+        }
+        pcutils_mystring_append_string(out, ",\"msg\":");
+        append_json_string(out, record_message(rec));
+        pcutils_mystring_append_string(out, "}\n");
+        return;
+    }
+
+    pcutils_mystring_append_mchar(out, (const unsigned char *)buf, n);
+    snprintf(buf, sizeof(buf), " %lld.%06ld edpt://.../%-10s %-15s ",
+            (long long)rec->mono.tv_sec, rec->mono.tv_nsec / 1000,
+            runner, rec->crtn[0] ? rec->crtn : "-");
+    pcutils_mystring_append_string(out, buf);
+    pcutils_mystring_append_string(out, record_tag(rec));
+    if (rec->file) {
+        snprintf(buf, sizeof(buf), " %s:%d", pcutils_basename(rec->file),
+                rec->line);
+        pcutils_mystring_append_string(out, buf);
+    }
+    pcutils_mystring_append_string(out, " >> ");
+    pcutils_mystring_append_string(out, record_message(rec));
+}
+
+static void
+write_out(FILE *fp, struct pcutils_mystring *out)
+{
+    if (out->nr_bytes > 0) {
+        fwrite(out->buff, 1, out->nr_bytes, fp);
+        if (fp != stderr)
+            fflush(fp);
+        out->nr_bytes = 0;
+    }
+}
+
+#if HAVE(STDATOMIC_H) && USE(PTHREADS)    /* { */
+
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* the number of records in the ring buffer of an instance */
+#define NR_LOG_RECORDS          512
+
+/* the interval to write the records out if the buffer is not half full */
+#define LOG_WRITE_INTERVAL_MS   50
+
+/*
+ * The ring buffer has only one producer (the thread of the instance) and
+ * one consumer (the writer thread), so the records are passed without lock.
+ * The producer wakes up the writer only when the buffer is half full or
+ * an error is logged; otherwise the writer writes the records out in batch
+ * periodically.
+ */
+struct pclog_async {
+    FILE               *fp;
+    const char         *ident;
+    char               *runner;
+    bool                json;
+
+    /* the number of the dropped records which have been reported */
+    size_t              nr_reported;
+
+    pthread_t           thread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    atomic_bool         stopping;
+
+    atomic_size_t       head;   // written by the producer only
+    atomic_size_t       tail;   // written by the writer only
+
+    struct log_record   records[NR_LOG_RECORDS];
+};
+
+static void
+write_records(struct pclog_async *async, size_t tail, size_t head,
+        struct pcutils_mystring *out)
+{
+    for (; tail != head; tail++) {
+        struct log_record *rec = async->records + tail % NR_LOG_RECORDS;
+
+        if (async->fp == LOG_FILE_SYSLOG) {
+#if HAVE(VSYSLOG)
+            syslog(LOG_INFO | level_info[rec->level].sys_level, "%s",
+                    record_message(rec));
+#endif
+        }
+        else {
+            format_record(out, rec, async->runner, async->json);
+        }
+
+        release_record(rec);
+    }
+
+    if (async->fp != LOG_FILE_SYSLOG)
+        write_out(async->fp, out);
+}
+
+static void *
+log_writer(void *arg)
+{
+    struct pclog_async *async = arg;
+    struct pcutils_mystring out;
+    pcutils_mystring_init(&out);
+
+#if HAVE(VSYSLOG)
+    if (async->fp == LOG_FILE_SYSLOG)
+        openlog(async->ident, LOG_PID, LOG_USER);
+#endif
+
+    for (;;) {
+        /* load the flag before head, so the last records will be written */
+        bool stopping = atomic_load(&async->stopping);
+        size_t tail = atomic_load_explicit(&async->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&async->head, memory_order_acquire);
+
+        if (tail != head) {
+            write_records(async, tail, head, &out);
+            atomic_store_explicit(&async->tail, head, memory_order_release);
+        }
+
+        if (stopping)
+            break;
+
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += LOG_WRITE_INTERVAL_MS * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&async->lock);
+        if (!atomic_load(&async->stopping))
+            pthread_cond_timedwait(&async->cond, &async->lock, &ts);
+        pthread_mutex_unlock(&async->lock);
+    }
+
+#if HAVE(VSYSLOG)
+    if (async->fp == LOG_FILE_SYSLOG)
+        closelog();
+#endif
+
+    pcutils_mystring_free(&out);
+    return NULL;
+}
+
+static bool
+start_async_log(struct pcinst *inst)
+{
+    struct pclog_async *async = calloc(1, sizeof(*async));
+    if (async == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    async->fp = inst->fp_log;
+    async->ident = "edpt://[unknown]/[unknown]";
+    if (inst->endpoint_atom)
+        async->ident = purc_atom_to_string(inst->endpoint_atom);
+    async->runner = strdup(inst->runner_name ? inst->runner_name :
+            "[unknown]");
+    async->json = (inst->log_options & PURC_LOG_OPT_JSON) != 0;
+    async->nr_reported = inst->nr_log_dropped;
+    atomic_init(&async->stopping, false);
+    atomic_init(&async->head, 0);
+    atomic_init(&async->tail, 0);
+    pthread_mutex_init(&async->lock, NULL);
+    pthread_cond_init(&async->cond, NULL);
+
+    if (async->runner == NULL ||
+            pthread_create(&async->thread, NULL, log_writer, async)) {
+        pthread_cond_destroy(&async->cond);
+        pthread_mutex_destroy(&async->lock);
+        free(async->runner);
+        free(async);
+        purc_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+        return false;
+    }
+
+    inst->log_async = async;
+    return true;
+}
+
+void pcinst_stop_async_log(struct pcinst *inst)
+{
+    struct pclog_async *async = inst->log_async;
+    if (async == NULL)
+        return;
+
+    inst->log_async = NULL;
+
+    pthread_mutex_lock(&async->lock);
+    atomic_store(&async->stopping, true);
+    pthread_cond_signal(&async->cond);
+    pthread_mutex_unlock(&async->lock);
+    pthread_join(async->thread, NULL);
+
+    pthread_cond_destroy(&async->cond);
+    pthread_mutex_destroy(&async->lock);
+    free(async->runner);
+    free(async);
+}
+
+static struct log_record *
+reserve_record(struct pclog_async *async)
+{
+    size_t head = atomic_load_explicit(&async->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&async->tail, memory_order_acquire);
+
+    if (head - tail >= NR_LOG_RECORDS)
+        return NULL;
+    return async->records + head % NR_LOG_RECORDS;
+}
+
+static void
+commit_record(struct pclog_async *async, purc_log_level_k level)
+{
+    size_t head = atomic_load_explicit(&async->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&async->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&async->head, head + 1, memory_order_release);
+    if (level <= PURC_LOG_ERR || head + 1 - tail >= NR_LOG_RECORDS / 2)
+        pthread_cond_signal(&async->cond);
+}
+
+static PCA_ATTRIBUTE_PRINTF(6, 7) void
+put_record(struct pcinst *inst, purc_log_level_k level, const char *tag,
+        const char *file, int line, const char *msg, ...)
+{
+    va_list ap;
+    va_start(ap, msg);
+
+    struct log_record *rec = reserve_record(inst->log_async);
+    if (rec) {
+        fill_record(rec, inst, level, tag, file, line, msg, ap);
+        commit_record(inst->log_async, level);
+    }
+    else {
+        inst->nr_log_dropped++;
+    }
+
+    va_end(ap);
+}
+
+static void
+enqueue_record(struct pcinst *inst, purc_log_level_k level, const char *tag,
+        const char *file, int line, const char *msg, va_list ap)
+{
+    struct pclog_async *async = inst->log_async;
+    struct log_record *rec = reserve_record(async);
+
+    if (rec && async->nr_reported < inst->nr_log_dropped) {
+        size_t nr = inst->nr_log_dropped - async->nr_reported;
+        async->nr_reported = inst->nr_log_dropped;
+        put_record(inst, PURC_LOG_WARNING, NULL, __FILE__, __LINE__,
+                "%zu log records dropped\n", nr);
+        rec = reserve_record(async);
+    }
+
+    if (rec == NULL) {
+        inst->nr_log_dropped++;
+        return;
+    }
+
+    fill_record(rec, inst, level, tag, file, line, msg, ap);
+    commit_record(async, level);
+}
+
+#else   /* HAVE(STDATOMIC_H) && USE(PTHREADS) */
+
+static bool
+start_async_log(struct pcinst *inst)
+{
+    UNUSED_PARAM(inst);
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return false;
+}
+
+void pcinst_stop_async_log(struct pcinst *inst)
+{
+    UNUSED_PARAM(inst);
+}
+
+static void
+enqueue_record(struct pcinst *inst, purc_log_level_k level, const char *tag,
+        const char *file, int line, const char *msg, va_list ap)
+{
+    UNUSED_PARAM(inst);
+    UNUSED_PARAM(level);
+    UNUSED_PARAM(tag);
+    UNUSED_PARAM(file);
+    UNUSED_PARAM(line);
+    UNUSED_PARAM(msg);
+    UNUSED_PARAM(ap);
+}
+
+#endif  /* !(HAVE(STDATOMIC_H) && USE(PTHREADS)) */
+
+bool purc_set_log_options(unsigned options)
+{
+    struct pcinst* inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return false;
+    }
+
+    pcinst_stop_async_log(inst);
+    inst->log_options = options;
+    if ((options & PURC_LOG_OPT_ASYNC) && inst->log_levels && inst->fp_log)
+        return start_async_log(inst);
+
+    return true;
+}
+
+unsigned purc_get_log_options(void)
+{
+    struct pcinst* inst = pcinst_current();
+    return inst ? inst->log_options : 0;
+}
+
+size_t purc_get_log_nr_dropped(void)
+{
+    struct pcinst* inst = pcinst_current();
+    return inst ? inst->nr_log_dropped : 0;
+}
+
+void purc_log_with_location(purc_log_level_k level, const char *tag,
+        const char *file, int line, const char *msg, va_list ap)
 {
     FILE *fp;
     struct pcinst* inst = pcinst_current();
@@ -168,6 +658,11 @@ void purc_log_with_tag(purc_log_level_k level, const char *tag,
                 (inst->log_levels & (0x01U << level)) == 0) {
             return;
         }
+
+        if (inst->log_async) {
+            enqueue_record(inst, level, tag, file, line, msg, ap);
+            return;
+        }
         fp = inst->fp_log;
     }
     else {
@@ -194,19 +689,38 @@ void purc_log_with_tag(purc_log_level_k level, const char *tag,
 #endif
     }
 
-    const char *ident = "[unknown]";
+    const char *runner = "[unknown]";
     if (inst && inst->runner_name)
-        ident = inst->runner_name;
+        runner = inst->runner_name;
+
+    if (inst && (inst->log_options & PURC_LOG_OPT_JSON)) {
+        struct log_record rec;
+        struct pcutils_mystring out;
+        pcutils_mystring_init(&out);
+
+        fill_record(&rec, inst, level, tag, file, line, msg, ap);
+        format_record(&out, &rec, runner, true);
+        write_out(fp, &out);
+
+        release_record(&rec);
+        pcutils_mystring_free(&out);
+        return;
+    }
 
     fprintf(fp, "edpt://.../%-10s %s >> ",
-            ident, tag ? tag : level_info[level].tag);
+            runner, tag ? tag : level_info[level].tag);
     vfprintf(fp, msg, ap);
     if (fp != stderr)
         fflush(fp);
 }
 
+void purc_log_with_tag(purc_log_level_k level, const char *tag,
+        const char *msg, va_list ap)
+{
+    purc_log_with_location(level, tag, NULL, 0, msg, ap);
+}
+
 void purc_log_with_level(purc_log_level_k level, const char *msg, va_list ap)
 {
     purc_log_with_tag(level, level_info[level].tag, msg, ap);
 }
-
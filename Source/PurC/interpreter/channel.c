@@ -36,10 +36,6 @@
 #include <errno.h>
 #include <unistd.h> // for access()
 
-#define MSG_TYPE_SENDABLE       "sendable"
-#define MSG_TYPE_RECEIVABLE     "receivable"
-#define MSG_TYPE_CLOSED         "closed"
-
 #define KEY_FLAG                "__chan_observe"
 #define KEY_NAME                "name"
 
@@ -83,9 +79,9 @@ failed:
     return PURC_VARIANT_INVALID;
 }
 
-static int
-post_event(pcchan_t chan, const char *type, const char *sub_type,
-        purc_variant_t data)
+int
+pcchan_post_event(const char *chan_name, const char *type,
+        const char *sub_type, purc_variant_t data)
 {
     int ret = -1;
     struct pcinst* inst = pcinst_current();
@@ -95,7 +91,7 @@ post_event(pcchan_t chan, const char *type, const char *sub_type,
         goto out;
     }
 
-    purc_variant_t source = build_event_observed(chan->name);
+    purc_variant_t source = build_event_observed(chan_name);
     if (!source) {
         purc_variant_unref(source_uri);
         goto out;
@@ -398,7 +394,8 @@ send_getter(void *native_entity, const char *property_name,
             chan->sendx = 0;
         chan->qcount++;
 
-        post_event(chan, MSG_TYPE_RECEIVABLE, NULL, PURC_VARIANT_INVALID);
+        pcchan_post_event(chan->name, MSG_TYPE_RECEIVABLE, NULL,
+                PURC_VARIANT_INVALID);
 
         // if there is any coroutine waiting to receive, resume the first one.
         if (!list_empty(&chan->recv_crtns)) {
@@ -472,7 +469,8 @@ recv_getter(void *native_entity, const char *property_name,
             chan->recvx = 0;
         chan->qcount--;
 
-        post_event(chan, MSG_TYPE_SENDABLE, NULL, PURC_VARIANT_INVALID);
+        pcchan_post_event(chan->name, MSG_TYPE_SENDABLE, NULL,
+                PURC_VARIANT_INVALID);
 
         // if there is any coroutine waiting to send, resume the first one.
         if (!list_empty(&chan->send_crtns)) {
@@ -691,27 +689,32 @@ did_matched(void *native_entity, purc_variant_t val)
         return false;
     }
     else if (purc_variant_is_object(val)) {
-        purc_variant_t flag =
-            purc_variant_object_get_by_ckey_ex(val, KEY_FLAG, true);
-        if (!flag) {
-            return false;
-        }
-
-        purc_variant_t name_val =
-            purc_variant_object_get_by_ckey_ex(val, KEY_NAME, true);
-        if (!name_val) {
-            return false;
-        }
-
         pcchan_t chan = native_entity;
-        if (strcmp(chan->name, purc_variant_get_string_const(name_val)) == 0) {
-            return true;
-        }
+        return pcchan_is_observed(val, chan->name);
     }
 
     return false;
 }
 
+bool
+pcchan_is_observed(purc_variant_t val, const char *chan_name)
+{
+    purc_variant_t flag =
+        purc_variant_object_get_by_ckey_ex(val, KEY_FLAG, true);
+    if (!flag) {
+        return false;
+    }
+
+    purc_variant_t name_val =
+        purc_variant_object_get_by_ckey_ex(val, KEY_NAME, true);
+    if (!name_val) {
+        return false;
+    }
+
+    const char *name = purc_variant_get_string_const(name_val);
+    return name && strcmp(chan_name, name) == 0;
+}
+
 purc_variant_t
 pcchan_make_entity(pcchan_t chan)
 {
@@ -31,6 +31,7 @@
 #include "private/interpreter.h"
 #include "private/vdom.h"
 #include "private/instance.h"
+#include "private/msg-queue.h"
 #include "private/regex.h"
 #include "internal.h"
 
@@ -421,6 +422,47 @@ pcintr_coroutine_is_rdr_attached(pcintr_coroutine_t cor)
     return false;
 }
 
+static size_t
+count_list(struct list_head *list)
+{
+    size_t nr = 0;
+    struct list_head *p;
+    list_for_each(p, list) {
+        nr++;
+    }
+    return nr;
+}
+
+uint64_t
+pcintr_coroutine_get_usage(pcintr_coroutine_t cor,
+        enum pcintr_coroutine_resource res)
+{
+    pcintr_stack_t stack = &cor->stack;
+
+    switch (res) {
+    case CO_RESOURCE_CPU_TIME:
+        return (uint64_t)stack->time_executed.tv_sec * 1000000000 +
+            stack->time_executed.tv_nsec;
+
+    case CO_RESOURCE_MEMORY:
+        /* the variant allocator charges the coroutine which is running;
+           a coroutine may release the variants created by others */
+        return stack->mem_use > 0 ? (uint64_t)stack->mem_use : 0;
+
+    case CO_RESOURCE_MESSAGES:
+        return cor->mq ? pcinst_msg_queue_count(cor->mq) : 0;
+
+    case CO_RESOURCE_OBSERVERS:
+        return count_list(&stack->intr_observers) +
+            count_list(&stack->hvml_observers);
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
 pcintr_coroutine_t
 pcintr_get_first_crtn(struct pcinst *inst)
 {
@@ -1125,6 +1125,8 @@ on_popping_internal_rule(struct ctxt_for_iterate *ctxt, pcintr_stack_t stack,
 
     purc_exec_ops_t ops = ctxt->ops.internal_ops;
 
+    /* always pass the rule, so that the executor re-evaluates the input
+       which may be changed in the body; the parsed rule is cached */
     it = ops->it_next(exec_inst, it, rule);
 
     ctxt->it = it;
@@ -98,7 +98,14 @@ bool base_variant_msg_listener(purc_variant_t source, pcvar_op_t msg_type,
     UNUSED_PARAM(argv);
 
     assert(nr_args);
-    purc_variant_t data = purc_variant_make_array(1, argv[0]);
+    purc_variant_t data;
+    if (purc_variant_is_batched_event(nr_args, argv)) {
+        /* the coalesced event carries all positions or keys in argv[0] */
+        data = purc_variant_ref(argv[0]);
+    }
+    else {
+        data = purc_variant_make_array(1, argv[0]);
+    }
     if (!data) {
         return false;
     }
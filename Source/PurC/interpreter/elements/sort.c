@@ -291,102 +291,54 @@ split_key(const char *key)
     return keys;
 }
 
-static int
-comp_number(double l, double r, bool ascendingly)
-{
-    if (ascendingly) {
-        return (l > r) ? 1 : (l < r ? -1 : 0);
-    }
-    return (l > r) ? -1 : (l < r ? 1 : 0);
-}
-
-static int
-comp_string(const char *l, const char *r, bool ascendingly, bool casesensitively)
-{
-    if (!l || !r) {
-        return 0;
-    }
-    int ret = casesensitively ? strcmp(l, r) : strcasecmp(l, r);
-    return ascendingly ? ret : -ret;
-}
-
-static char *
-variant_to_string(purc_variant_t v)
+static purc_variant_t
+sort_key_getter(purc_variant_t member, size_t key_idx, void *ud)
 {
-    if (!v) {
-        return NULL;
-    }
+    struct ctxt_for_sort *ctxt = ud;
+    struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, key_idx);
 
-    char *buf = NULL;
-    int total = purc_variant_stringify_alloc(&buf, v);
-    if (total < 0) {
-        return NULL;
+    if (key->key == NULL) {
+        return member;
     }
-    return buf;
-}
 
-static int
-comp_raw(purc_variant_t l, purc_variant_t r, bool by_number,
-        bool ascendingly, bool casesensitively)
-{
-    if (by_number) {
-        double dl = l ? purc_variant_numerify(l) : 0.0f;
-        double dr = r ? purc_variant_numerify(r) : 0.0f;
-        return comp_number(dl, dr, ascendingly);
+    if (purc_variant_is_object(member)) {
+        return purc_variant_object_get_by_ckey_ex(member, key->key, true);
     }
 
-    char *buf_l = variant_to_string(l);
-    char *buf_r = variant_to_string(r);
-    int ret = comp_string(buf_l, buf_r, ascendingly, casesensitively);
-
-    if (buf_l) {
-        free(buf_l);
-    }
-    if (buf_r) {
-        free(buf_r);
-    }
-
-    return ret;
+    return PURC_VARIANT_INVALID;
 }
 
 static int
-comp_by_key(purc_variant_t l, purc_variant_t r, const char *key, bool by_number,
-        bool ascendingly, bool casesensitively)
+sort_by_keys(struct ctxt_for_sort *ctxt, purc_variant_t val)
 {
-    purc_variant_t lv = PURC_VARIANT_INVALID;
-    purc_variant_t rv = PURC_VARIANT_INVALID;
-    if (purc_variant_is_object(l)) {
-        lv = purc_variant_object_get_by_ckey_ex(l, key, true);
+    size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
+    if (nr_keys == 0) {
+        return 0;
     }
 
-    if (purc_variant_is_object(r)) {
-        rv = purc_variant_object_get_by_ckey_ex(r, key, true);
+    bool *by_number = malloc(sizeof(bool) * nr_keys);
+    if (by_number == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
     }
 
-    return comp_raw(lv, rv, by_number, ascendingly, casesensitively);
-}
-
-static int
-sort_cmp(purc_variant_t l, purc_variant_t r, void *data)
-{
-    struct ctxt_for_sort *ctxt = data;
-    size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
     for (size_t i = 0; i < nr_keys; i++) {
         struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, i);
-        int ret = 0;
-        if (key->key == NULL) {
-            ret = comp_raw(l, r, key->by_number, ctxt->ascendingly,
-                    ctxt->casesensitively);
-        }
-        else {
-            ret = comp_by_key(l, r, key->key, key->by_number,
-                    ctxt->ascendingly, ctxt->casesensitively);
-        }
-        if (ret != 0) {
-            return ret;
-        }
+        by_number[i] = key->by_number;
     }
-    return 0;
+
+    struct pcvariant_sort_spec spec = {
+        .nr_keys            = nr_keys,
+        .by_number          = by_number,
+        .ascendingly        = ctxt->ascendingly,
+        .casesensitively    = ctxt->casesensitively,
+        .get_key            = sort_key_getter,
+        .ud                 = ctxt,
+    };
+
+    int r = pcvariant_sort_by_keys(val, &spec);
+    free(by_number);
+    return r;
 }
 
 static bool
@@ -405,13 +357,13 @@ sort_as_number(purc_variant_t val)
     }
 }
 
-static void
+static int
 sort_array(struct ctxt_for_sort *ctxt, purc_variant_t array,
         purc_variant_t against)
 {
     ssize_t nr = purc_variant_array_get_size(array);
     if (nr <= 1) {
-        return;
+        return 0;
     }
 
     if (against && purc_variant_is_string(against)) {
@@ -422,14 +374,14 @@ sort_array(struct ctxt_for_sort *ctxt, purc_variant_t array,
         struct pcutils_arrlist *keys = pcutils_arrlist_new(sort_key_free_fn);
         if (keys == NULL) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            return;
+            return -1;
         }
         ctxt->keys = keys;
         struct sort_key *key = (struct sort_key*)calloc(1,
                 sizeof(struct sort_key));
         if (key == NULL) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            return;
+            return -1;
         }
 
         purc_variant_t val = purc_variant_array_get(array, 0);
@@ -456,16 +408,16 @@ sort_array(struct ctxt_for_sort *ctxt, purc_variant_t array,
             }
         }
     }
-    pcvariant_array_sort(array, ctxt, sort_cmp);
+    return sort_by_keys(ctxt, array);
 }
 
 
-static void
+static int
 sort_set(struct ctxt_for_sort *ctxt, purc_variant_t set, purc_variant_t against)
 {
     ssize_t nr = purc_variant_set_get_size(set);
     if (nr <= 1) {
-        return;
+        return 0;
     }
 
     if (against && purc_variant_is_string(against)) {
@@ -476,14 +428,14 @@ sort_set(struct ctxt_for_sort *ctxt, purc_variant_t set, purc_variant_t against)
         struct pcutils_arrlist *keys = pcutils_arrlist_new(sort_key_free_fn);
         if (keys == NULL) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            return;
+            return -1;
         }
         ctxt->keys = keys;
         struct sort_key *key = (struct sort_key*)calloc(1,
                 sizeof(struct sort_key));
         if (key == NULL) {
             purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            return;
+            return -1;
         }
 
         purc_variant_t val = purc_variant_set_get_by_index(set, 0);
@@ -510,7 +462,7 @@ sort_set(struct ctxt_for_sort *ctxt, purc_variant_t set, purc_variant_t against)
             }
         }
     }
-    pcvariant_set_sort(set, ctxt, sort_cmp);
+    return sort_by_keys(ctxt, set);
 }
 
 static int
@@ -525,12 +477,10 @@ sort_val(pcintr_stack_t stack, purc_variant_t val)
     enum purc_variant_type type = purc_variant_get_type(val);
     switch (type) {
         case PURC_VARIANT_TYPE_ARRAY:
-            sort_array(ctxt, val, ctxt->against);
-            break;
+            return sort_array(ctxt, val, ctxt->against);
 
         case PURC_VARIANT_TYPE_SET:
-            sort_set(ctxt, val, ctxt->against);
-            break;
+            return sort_set(ctxt, val, ctxt->against);
 
         default:
             purc_set_error(PURC_ERROR_INVALID_VALUE);
@@ -261,7 +261,11 @@ purc_load_hvml_from_file(const char* file)
     vdom = find_vdom_in_cache(md5);
     if (vdom == NULL) {
         purc_rwstream_t in;
-        in = purc_rwstream_new_from_file(file, "r");
+        in = purc_rwstream_new_from_mmap(file);
+        if (!in) {
+            purc_clr_error();
+            in = purc_rwstream_new_from_file(file, "r");
+        }
         if (!in) {
             goto failed;
         }
@@ -383,6 +383,16 @@ coroutine_release(pcintr_coroutine_t co)
         struct pcintr_heap *heap = pcintr_get_heap();
         PC_ASSERT(heap && co->owner == heap);
 
+        /* the variants of the coroutine released here are charged to
+           itself instead of the coroutine which is running */
+        struct pcvariant_heap *vrt_heap = pcinst_current()->org_vrt_heap;
+        int64_t *mem_charged = NULL;
+        if (vrt_heap) {
+            mem_charged = vrt_heap->mem_charged;
+            vrt_heap->mem_charged = &co->stack.mem_use;
+        }
+
+        pcchan_shared_on_coroutine_gone(co);
         stack_release(&co->stack);
         pcvdom_document_unref(co->vdom);
 
@@ -483,6 +493,12 @@ coroutine_release(pcintr_coroutine_t co)
             list_del(&p->ln);
             free(p);
         }
+
+        /* do not leave a pointer to the coroutine being destroyed */
+        if (vrt_heap) {
+            vrt_heap->mem_charged = (mem_charged == &co->stack.mem_use) ?
+                NULL : mem_charged;
+        }
     }
 }
 
@@ -530,6 +546,8 @@ static void _cleanup_instance(struct pcinst* inst)
         coroutine_destroy(pco);
     }
 
+    pcchan_shared_close_owned(inst->endpoint_atom);
+
     if (heap->move_buff) {
         size_t n = purc_inst_destroy_move_buffer();
         PC_DEBUG("Instance is quiting, %u messages discarded\n", (unsigned)n);
@@ -641,6 +659,9 @@ static int _init_once(void)
 {
     init_ops();
 
+    if (pcchan_shared_init_once())
+        return -1;
+
     return pcintr_init_loader_once();
 }
 
@@ -701,6 +722,11 @@ coroutine_set_current_with_location(struct pcintr_coroutine *co,
     }
 
     heap->running_coroutine = co;
+
+    /* the variant allocator charges the running coroutine */
+    struct pcinst *inst = pcinst_current();
+    if (inst->org_vrt_heap)
+        inst->org_vrt_heap->mem_charged = co ? &co->stack.mem_use : NULL;
 }
 
 #define coroutine_set_current(co) \
@@ -27,6 +27,7 @@
 
 #include "internal.h"
 #include "ops.h"
+#include "private/channel.h"
 #include "private/instance.h"
 #include "private/msg-queue.h"
 #include "private/interpreter.h"
@@ -767,6 +768,27 @@ on_session_event(struct pcinst *inst, pcrdr_conn *conn, const pcrdr_msg *msg,
     }
 }
 
+/* a coroutine blocked on a shared channel may send or receive now */
+static void
+on_chan_state_event(const pcrdr_msg *msg, const char *sub_type)
+{
+    const char *chan_uri = NULL;
+    uint64_t cid = 0;
+
+    if (msg->sourceURI)
+        chan_uri = purc_variant_get_string_const(msg->sourceURI);
+    if (msg->elementValue)
+        purc_variant_cast_to_ulongint(msg->elementValue, &cid, false);
+
+    if (chan_uri == NULL || cid == 0 || sub_type == NULL) {
+        PC_WARN("Bad chanState event\n");
+        return;
+    }
+
+    pcchan_shared_on_wakeup(chan_uri, (purc_atom_t)cid,
+            strcmp(sub_type, MSG_SUB_TYPE_SENDABLE) == 0);
+}
+
 void
 pcintr_conn_event_handler(pcrdr_conn *conn, const pcrdr_msg *msg)
 {
@@ -798,7 +820,12 @@ pcintr_conn_event_handler(pcrdr_conn *conn, const pcrdr_msg *msg)
         goto out;
     }
     else if (msg->target == PCRDR_MSG_TARGET_INSTANCE) {
-        dispatch_inst_event_from_move_buffer(inst, msg);
+        if (type && strcmp(type, MSG_TYPE_CHAN_STATE) == 0) {
+            on_chan_state_event(msg, sub_type);
+        }
+        else {
+            dispatch_inst_event_from_move_buffer(inst, msg);
+        }
         goto out;
     }
 
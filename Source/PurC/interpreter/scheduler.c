@@ -48,6 +48,12 @@
 #define TIME_SLIECE             0.005           // s
 #define FULL_SPEED_TIME_SLIECE  0.010           // s
 
+#ifdef CLOCK_THREAD_CPUTIME_ID
+#define CLOCK_STEP_TIME         CLOCK_THREAD_CPUTIME_ID
+#else
+#define CLOCK_STEP_TIME         CLOCK_MONOTONIC
+#endif
+
 #define BUILTIN_VAR_CRTN        PURC_PREDEF_VARNAME_CRTN
 
 #define YIELD_EVENT_HANDLER     "_yield_event_handler"
@@ -583,6 +589,94 @@ pcintr_check_after_execution_full(struct pcinst *inst, pcintr_coroutine_t co)
     }
 }
 
+static void
+account_step(pcintr_coroutine_t co, const struct timespec *begin)
+{
+    pcintr_stack_t stack = &co->stack;
+    struct timespec end, step;
+
+    clock_gettime(CLOCK_STEP_TIME, &end);
+    step.tv_sec = end.tv_sec - begin->tv_sec;
+    step.tv_nsec = end.tv_nsec - begin->tv_nsec;
+    if (step.tv_nsec < 0) {
+        step.tv_sec--;
+        step.tv_nsec += 1000000000;
+    }
+
+    stack->time_executed.tv_sec += step.tv_sec;
+    stack->time_executed.tv_nsec += step.tv_nsec;
+    if (stack->time_executed.tv_nsec >= 1000000000) {
+        stack->time_executed.tv_sec++;
+        stack->time_executed.tv_nsec -= 1000000000;
+    }
+
+    if (step.tv_sec > stack->time_max_step.tv_sec ||
+            (step.tv_sec == stack->time_max_step.tv_sec &&
+             step.tv_nsec > stack->time_max_step.tv_nsec)) {
+        stack->time_max_step = step;
+    }
+
+    stack->nr_steps++;
+
+    /* the variant bytes are charged by the allocator while the coroutine
+       is running; this is the peak seen after the steps of the coroutine */
+    if (stack->mem_use > 0 && (size_t)stack->mem_use > stack->peak_mem_use)
+        stack->peak_mem_use = (size_t)stack->mem_use;
+}
+
+static const struct {
+    const char *name;
+    int         errcode;
+} co_resources[CO_RESOURCE_NR] = {
+    { "CPU time",           PURC_ERROR_TIMEOUT },
+    { "variant memory",     PURC_ERROR_OUT_OF_MEMORY },
+    { "queued messages",    PURC_ERROR_TOO_MANY },
+    { "observers",          PURC_ERROR_TOO_MANY },
+};
+
+/* Raises an exception once a soft limit is exceeded, and terminates
+   the coroutine if a hard limit is exceeded. */
+static void
+check_resource_limits(pcintr_coroutine_t co)
+{
+    if (co->stack.exited)
+        return;
+
+    for (int res = 0; res < CO_RESOURCE_NR; res++) {
+        const struct pcintr_coroutine_limit *limit = co->limits + res;
+        if (limit->soft == 0 && limit->hard == 0)
+            continue;
+
+        uint64_t usage = pcintr_coroutine_get_usage(co, res);
+        if (limit->hard && usage > limit->hard) {
+            PC_WARN("Coroutine %s is terminated: %s exceeds the hard limit "
+                    "(%llu > %llu)\n", co->token, co_resources[res].name,
+                    (unsigned long long)usage,
+                    (unsigned long long)limit->hard);
+            purc_set_error_with_info(co_resources[res].errcode,
+                    "%s exceeds the hard limit", co_resources[res].name);
+
+            co->stack.exited = 1;
+            pcintr_notify_to_stop(co);
+            return;
+        }
+
+        uint32_t bit = 1U << res;
+        if (limit->soft && usage > limit->soft) {
+            if ((co->soft_limits_hit & bit) == 0) {
+                co->soft_limits_hit |= bit;
+                purc_set_error_with_info(co_resources[res].errcode,
+                        "%s exceeds the soft limit", co_resources[res].name);
+                return;
+            }
+        }
+        else {
+            /* report again when the usage exceeds the soft limit again */
+            co->soft_limits_hit &= ~bit;
+        }
+    }
+}
+
 static void
 execute_one_step_for_ready_co(struct pcinst *inst, pcintr_coroutine_t co)
 {
@@ -591,11 +685,19 @@ execute_one_step_for_ready_co(struct pcinst *inst, pcintr_coroutine_t co)
 
     pcintr_set_current_co(co);
 
+    struct timespec begin;
+    clock_gettime(CLOCK_STEP_TIME, &begin);
+
     pcintr_coroutine_set_state(co, CO_STATE_RUNNING);
     pcintr_execute_one_step_for_ready_co(co);
 
+    account_step(co, &begin);
+
     int err = purc_get_last_error();
     if (err != PURC_ERROR_AGAIN) {
+        /* a stopped coroutine will be checked when it runs again */
+        if (err == PURC_ERROR_OK && co->state != CO_STATE_STOPPED)
+            check_resource_limits(co);
         pcintr_check_after_execution_full(inst, co);
     }
     else {
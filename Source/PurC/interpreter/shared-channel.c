@@ -0,0 +1,928 @@
+/*
+ * @file shared-channel.c
+ * @brief The implementation of the channels shared by runners.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "purc-variant.h"
+#include "purc-helpers.h"
+#include "purc-ports.h"
+#include "private/channel.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "private/variant.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+/* a coroutine blocked in sending to or receiving from a shared channel */
+struct chan_waiter {
+    struct list_head    ln;
+    purc_atom_t         rid;
+    purc_atom_t         cid;
+};
+
+struct pcchan_shared {
+    /* the runner-qualified URI and the name of the channel */
+    char               *uri;
+    const char         *name;
+
+    /* the runner which owns the channel */
+    purc_atom_t         owner;
+
+    /* the node in the registry */
+    struct list_head    ln;
+
+    /* the lock protects all fields below */
+    struct purc_mutex   lock;
+
+    /* the registry and the channel entity variants referencing this channel */
+    unsigned int        refc;
+
+    /* size of the circular queue; zero if the channel was closed */
+    unsigned int        qsize;
+    /* total variants in the queue */
+    unsigned int        qcount;
+
+    /* indices to send and receive */
+    unsigned int        sendx;
+    unsigned int        recvx;
+
+    /* lists of the waiters to send and receive */
+    struct list_head    send_waiters;
+    struct list_head    recv_waiters;
+
+    /* the buffer for variants which live in the move heap. */
+    purc_variant_t     *data;
+};
+
+static struct {
+    struct purc_mutex   lock;
+    struct list_head    chans;
+} registry;
+
+static void cleanup_once(void)
+{
+    if (registry.lock.native_impl)
+        purc_mutex_clear(&registry.lock);
+}
+
+int pcchan_shared_init_once(void)
+{
+    list_head_init(&registry.chans);
+
+    purc_mutex_init(&registry.lock);
+    if (registry.lock.native_impl == NULL)
+        return -1;
+
+    if (atexit(cleanup_once)) {
+        purc_mutex_clear(&registry.lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Returns the length of the endpoint name in @uri, or 0 if it is invalid. */
+static size_t
+split_uri(const char *uri, char *endpoint)
+{
+    const char *sep = strrchr(uri, PCCHAN_URI_SEPARATOR);
+    if (sep == NULL || sep[1] == '\0' ||
+            strlen(sep + 1) > PCCHAN_MAX_LEN_NAME)
+        return 0;
+
+    size_t len = sep - uri;
+    if (len == 0 || len > PURC_LEN_ENDPOINT_NAME)
+        return 0;
+
+    memcpy(endpoint, uri, len);
+    endpoint[len] = '\0';
+    if (!purc_is_valid_endpoint_name(endpoint))
+        return 0;
+
+    return len;
+}
+
+static pcchan_shared_t
+find_channel(const char *uri)
+{
+    pcchan_shared_t chan;
+    list_for_each_entry(chan, &registry.chans, ln) {
+        if (strcmp(chan->uri, uri) == 0)
+            return chan;
+    }
+
+    return NULL;
+}
+
+static void
+destroy_channel(pcchan_shared_t chan)
+{
+    assert(chan->qcount == 0);
+    assert(list_empty(&chan->send_waiters));
+    assert(list_empty(&chan->recv_waiters));
+
+    purc_mutex_clear(&chan->lock);
+    free(chan->data);
+    free(chan->uri);
+    free(chan);
+}
+
+pcchan_shared_t
+pcchan_shared_open(const char *chan_uri, unsigned int cap)
+{
+    struct pcinst* inst = pcinst_current();
+    char endpoint[PURC_LEN_ENDPOINT_NAME + 1];
+    size_t len;
+
+    if (UNLIKELY(cap == 0 || (len = split_uri(chan_uri, endpoint)) == 0)) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    /* only the owner runner can open a shared channel */
+    if (strcmp(endpoint, inst->endpoint_name)) {
+        purc_set_error(PURC_ERROR_ACCESS_DENIED);
+        return NULL;
+    }
+
+    pcchan_shared_t chan = calloc(1, sizeof(*chan));
+    if (chan == NULL)
+        goto failed;
+
+    chan->data = calloc(cap, sizeof(purc_variant_t));
+    chan->uri = strdup(chan_uri);
+    if (chan->data == NULL || chan->uri == NULL)
+        goto failed;
+
+    purc_mutex_init(&chan->lock);
+    if (chan->lock.native_impl == NULL)
+        goto failed;
+
+    chan->name = chan->uri + len + 1;
+    chan->owner = inst->endpoint_atom;
+    /* one for the registry and one for the caller */
+    chan->refc = 2;
+    chan->qsize = cap;
+    list_head_init(&chan->send_waiters);
+    list_head_init(&chan->recv_waiters);
+
+    purc_mutex_lock(&registry.lock);
+    if (find_channel(chan_uri)) {
+        purc_mutex_unlock(&registry.lock);
+        chan->qsize = 0;
+        destroy_channel(chan);
+        purc_set_error(PURC_ERROR_EXISTS);
+        return NULL;
+    }
+    list_add_tail(&chan->ln, &registry.chans);
+    purc_mutex_unlock(&registry.lock);
+
+    return chan;
+
+failed:
+    if (chan) {
+        free(chan->data);
+        free(chan->uri);
+        free(chan);
+    }
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+}
+
+pcchan_shared_t
+pcchan_shared_retrieve(const char *chan_uri)
+{
+    purc_mutex_lock(&registry.lock);
+    pcchan_shared_t chan = find_channel(chan_uri);
+    if (chan) {
+        purc_mutex_lock(&chan->lock);
+        chan->refc++;
+        purc_mutex_unlock(&chan->lock);
+    }
+    purc_mutex_unlock(&registry.lock);
+
+    if (chan == NULL)
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+    return chan;
+}
+
+void
+pcchan_shared_unref(pcchan_shared_t chan)
+{
+    purc_mutex_lock(&chan->lock);
+    assert(chan->refc > 0);
+    unsigned int refc = --chan->refc;
+    purc_mutex_unlock(&chan->lock);
+
+    if (refc == 0)
+        destroy_channel(chan);
+}
+
+static void
+notify_waiter(pcchan_shared_t chan, purc_atom_t rid, purc_atom_t cid,
+        bool sending);
+
+/* Wakes up the first waiter to send or receive; returns false if none. */
+static bool
+wake_next(pcchan_shared_t chan, bool sending)
+{
+    purc_atom_t rid = 0, cid = 0;
+
+    purc_mutex_lock(&chan->lock);
+    struct list_head *waiters = sending ?
+        &chan->send_waiters : &chan->recv_waiters;
+    if (!list_empty(waiters)) {
+        struct chan_waiter *waiter;
+        waiter = list_first_entry(waiters, struct chan_waiter, ln);
+        list_del(&waiter->ln);
+        rid = waiter->rid;
+        cid = waiter->cid;
+        free(waiter);
+    }
+    purc_mutex_unlock(&chan->lock);
+
+    if (cid == 0)
+        return false;
+
+    notify_waiter(chan, rid, cid, sending);
+    return true;
+}
+
+/* Called when a coroutine stops waiting; releases the reference it held. */
+static void
+stop_waiting(pcintr_coroutine_t crtn)
+{
+    pcchan_shared_t chan = crtn->waiting_chan;
+    crtn->waiting_chan = NULL;
+    pcchan_shared_unref(chan);
+}
+
+/*
+ * Resumes the coroutine @cid if it is still waiting on @chan. A closed
+ * channel has no waiter left in its lists, so passing the chance on is
+ * a no-op for it.
+ */
+static void
+wake_coroutine(pcchan_shared_t chan, purc_atom_t cid, bool sending)
+{
+    pcintr_coroutine_t crtn = pcintr_coroutine_get_by_id(cid);
+
+    if (crtn && crtn->waiting_chan == chan) {
+        stop_waiting(crtn);
+        pcintr_resume_coroutine(crtn);
+    }
+    else {
+        /* the waiter has gone or given up; pass the chance on */
+        purc_clr_error();
+        wake_next(chan, sending);
+    }
+}
+
+static void
+notify_waiter(pcchan_shared_t chan, purc_atom_t rid, purc_atom_t cid,
+        bool sending)
+{
+    struct pcinst *inst = pcinst_current();
+    if (rid == inst->endpoint_atom) {
+        wake_coroutine(chan, cid, sending);
+        return;
+    }
+
+    int ret = -1;
+    purc_variant_t source_uri = purc_variant_make_string(chan->uri, false);
+    purc_variant_t element_value = purc_variant_make_ulongint(cid);
+    if (source_uri && element_value) {
+        ret = pcintr_post_event_by_ctype(rid, 0,
+                PCRDR_MSG_EVENT_REDUCE_OPT_KEEP, source_uri, element_value,
+                MSG_TYPE_CHAN_STATE,
+                sending ? MSG_SUB_TYPE_SENDABLE : MSG_SUB_TYPE_RECEIVABLE,
+                PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+    }
+
+    if (source_uri)
+        purc_variant_unref(source_uri);
+    if (element_value)
+        purc_variant_unref(element_value);
+
+    /* the runner may have exited */
+    if (ret)
+        wake_next(chan, sending);
+}
+
+void
+pcchan_shared_on_wakeup(const char *chan_uri, purc_atom_t cid, bool sending)
+{
+    /* the waiting coroutine keeps the channel alive even if it was closed
+       and removed from the registry */
+    pcintr_coroutine_t crtn = pcintr_coroutine_get_by_id(cid);
+    if (crtn && crtn->waiting_chan) {
+        pcchan_shared_t chan = crtn->waiting_chan;
+        if (strcmp(chan->uri, chan_uri) == 0) {
+            stop_waiting(crtn);
+            pcintr_resume_coroutine(crtn);
+            return;
+        }
+    }
+
+    /* the waiter has gone or given up; pass the chance on */
+    pcchan_shared_t chan = pcchan_shared_retrieve(chan_uri);
+    if (chan) {
+        wake_next(chan, sending);
+        pcchan_shared_unref(chan);
+    }
+    purc_clr_error();
+}
+
+void
+pcchan_shared_on_coroutine_gone(struct pcintr_coroutine *crtn)
+{
+    /* the waiter left in the channel is skipped when it is woken up */
+    if (crtn->waiting_chan)
+        stop_waiting(crtn);
+}
+
+/* Called with the lock held. */
+static int
+add_waiter(pcchan_shared_t chan, pcintr_coroutine_t crtn, bool sending)
+{
+    struct pcinst *inst = pcinst_current();
+    struct list_head *waiters = sending ?
+        &chan->send_waiters : &chan->recv_waiters;
+    struct chan_waiter *waiter;
+
+    /* a coroutine waits at most once on a channel */
+    list_for_each_entry(waiter, waiters, ln) {
+        if (waiter->cid == crtn->cid && waiter->rid == inst->endpoint_atom)
+            return 0;
+    }
+
+    waiter = malloc(sizeof(*waiter));
+    if (waiter == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    waiter->rid = inst->endpoint_atom;
+    waiter->cid = crtn->cid;
+    list_add_tail(&waiter->ln, waiters);
+    return 0;
+}
+
+static void
+give_up_waiting(pcchan_shared_t chan, pcintr_coroutine_t crtn, bool sending)
+{
+    if (crtn == NULL || crtn->waiting_chan != chan)
+        return;
+
+    struct pcinst *inst = pcinst_current();
+
+    purc_mutex_lock(&chan->lock);
+    struct list_head *waiters = sending ?
+        &chan->send_waiters : &chan->recv_waiters;
+    struct chan_waiter *waiter, *tmp;
+    list_for_each_entry_safe(waiter, tmp, waiters, ln) {
+        if (waiter->cid == crtn->cid && waiter->rid == inst->endpoint_atom) {
+            list_del(&waiter->ln);
+            free(waiter);
+            break;
+        }
+    }
+    purc_mutex_unlock(&chan->lock);
+
+    /* if the waiter has been woken up by another runner, the notification
+       is on the way; it is passed on by pcchan_shared_on_wakeup() then */
+    stop_waiting(crtn);
+}
+
+static void
+discard_data(purc_variant_t *data, unsigned int qsize,
+        unsigned int recvx, unsigned int qcount)
+{
+    if (qcount == 0)
+        return;
+
+    pcvariant_use_move_heap();
+    while (qcount > 0) {
+        purc_variant_unref(data[recvx]);
+        recvx++;
+        if (recvx == qsize)
+            recvx = 0;
+        qcount--;
+    }
+    pcvariant_use_norm_heap();
+}
+
+/* Closes a channel which has been removed from the registry. */
+static void
+close_channel(pcchan_shared_t chan)
+{
+    struct list_head send_waiters, recv_waiters;
+
+    purc_mutex_lock(&chan->lock);
+    purc_variant_t *data = chan->data;
+    unsigned int qsize = chan->qsize;
+    unsigned int qcount = chan->qcount;
+    unsigned int recvx = chan->recvx;
+
+    chan->data = NULL;
+    chan->qsize = 0;
+    chan->qcount = 0;
+    chan->sendx = 0;
+    chan->recvx = 0;
+
+    list_head_init(&send_waiters);
+    list_head_init(&recv_waiters);
+    list_splice_init(&chan->send_waiters, &send_waiters);
+    list_splice_init(&chan->recv_waiters, &recv_waiters);
+    purc_mutex_unlock(&chan->lock);
+
+    discard_data(data, qsize, recvx, qcount);
+    free(data);
+
+    /* wake up all waiters; they will get PURC_ERROR_ENTITY_GONE */
+    struct chan_waiter *waiter, *tmp;
+    list_for_each_entry_safe(waiter, tmp, &send_waiters, ln) {
+        notify_waiter(chan, waiter->rid, waiter->cid, true);
+        free(waiter);
+    }
+
+    list_for_each_entry_safe(waiter, tmp, &recv_waiters, ln) {
+        notify_waiter(chan, waiter->rid, waiter->cid, false);
+        free(waiter);
+    }
+
+    /* release the reference of the registry */
+    pcchan_shared_unref(chan);
+}
+
+void
+pcchan_shared_close_owned(purc_atom_t rid)
+{
+    struct list_head owned;
+    list_head_init(&owned);
+
+    purc_mutex_lock(&registry.lock);
+    pcchan_shared_t chan, tmp;
+    list_for_each_entry_safe(chan, tmp, &registry.chans, ln) {
+        if (chan->owner == rid) {
+            list_del(&chan->ln);
+            list_add_tail(&chan->ln, &owned);
+        }
+    }
+    purc_mutex_unlock(&registry.lock);
+
+    list_for_each_entry_safe(chan, tmp, &owned, ln) {
+        list_del(&chan->ln);
+        close_channel(chan);
+    }
+}
+
+bool
+pcchan_shared_ctrl(pcchan_shared_t chan, unsigned int new_cap)
+{
+    struct pcinst* inst = pcinst_current();
+
+    /* only the owner runner can resize or close a shared channel */
+    if (chan->owner != inst->endpoint_atom) {
+        purc_set_error(PURC_ERROR_ACCESS_DENIED);
+        return false;
+    }
+
+    if (new_cap == 0) {
+        purc_mutex_lock(&registry.lock);
+        bool found = (find_channel(chan->uri) == chan);
+        if (found)
+            list_del(&chan->ln);
+        purc_mutex_unlock(&registry.lock);
+
+        if (found)
+            close_channel(chan);
+        return true;
+    }
+
+    unsigned int nr_new_slots = 0;
+
+    purc_mutex_lock(&chan->lock);
+    if (chan->qsize == 0) {
+        purc_mutex_unlock(&chan->lock);
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        return false;
+    }
+
+    if (new_cap > chan->qcount) {
+        purc_variant_t *newdata = malloc(sizeof(purc_variant_t) * new_cap);
+        if (newdata == NULL) {
+            purc_mutex_unlock(&chan->lock);
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        // copy the data in order
+        unsigned int i = 0;
+        while (chan->qcount > 0) {
+            newdata[i] = chan->data[chan->recvx];
+            chan->recvx++;
+            if (chan->recvx == chan->qsize)
+                chan->recvx = 0;
+            chan->qcount--;
+            i++;
+        }
+
+        if (new_cap > chan->qsize)
+            nr_new_slots = new_cap - chan->qsize;
+
+        chan->qsize = new_cap;
+        chan->qcount = i;
+        chan->recvx = 0;
+        chan->sendx = i;
+
+        free(chan->data);
+        chan->data = newdata;
+    }
+    purc_mutex_unlock(&chan->lock);
+
+    while (nr_new_slots > 0 && wake_next(chan, true))
+        nr_new_slots--;
+
+    return true;
+}
+
+static purc_variant_t
+send_getter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+
+    pcchan_shared_t chan = native_entity;
+    pcintr_coroutine_t crtn = pcintr_get_coroutine();
+
+    if (call_flags & PCVRT_CALL_FLAG_AGAIN &&
+            call_flags & PCVRT_CALL_FLAG_TIMEOUT) {
+        give_up_waiting(chan, crtn, true);
+        purc_set_error(PURC_ERROR_TIMEOUT);
+        goto failed;
+    }
+
+    if (nr_args < 1) {
+        purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
+        goto failed;
+    }
+
+    if (purc_variant_is_undefined(argv[0])) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        goto failed;
+    }
+
+    purc_mutex_lock(&chan->lock);
+    if (chan->qsize == 0) {
+        purc_mutex_unlock(&chan->lock);
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    if (chan->qcount == chan->qsize) {
+        if (crtn && add_waiter(chan, crtn, true)) {
+            purc_mutex_unlock(&chan->lock);
+            goto failed;
+        }
+        if (crtn && crtn->waiting_chan == NULL) {
+            /* the waiting coroutine holds a reference */
+            chan->refc++;
+            crtn->waiting_chan = chan;
+        }
+        purc_mutex_unlock(&chan->lock);
+
+        if (crtn) {
+            // stop the current coroutine
+            pcintr_stop_coroutine(crtn, &crtn->timeout);
+        }
+
+        purc_set_error(PURC_ERROR_AGAIN);
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* the lock of the move heap is always taken after the channel's */
+    purc_variant_t vrt = pcvariant_move_heap_in(purc_variant_ref(argv[0]));
+    if (vrt == PURC_VARIANT_INVALID) {
+        purc_mutex_unlock(&chan->lock);
+        goto failed;
+    }
+
+    chan->data[chan->sendx] = vrt;
+    chan->sendx++;
+    if (chan->sendx == chan->qsize)
+        chan->sendx = 0;
+    chan->qcount++;
+    purc_mutex_unlock(&chan->lock);
+
+    pcchan_post_event(chan->uri, MSG_TYPE_RECEIVABLE, NULL,
+            PURC_VARIANT_INVALID);
+    wake_next(chan, false);
+
+    return purc_variant_make_boolean(true);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+recv_getter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcchan_shared_t chan = native_entity;
+    pcintr_coroutine_t crtn = pcintr_get_coroutine();
+
+    if (call_flags & PCVRT_CALL_FLAG_AGAIN &&
+            call_flags & PCVRT_CALL_FLAG_TIMEOUT) {
+        give_up_waiting(chan, crtn, false);
+        purc_set_error(PURC_ERROR_TIMEOUT);
+        goto failed;
+    }
+
+    purc_mutex_lock(&chan->lock);
+    if (chan->qsize == 0) {
+        purc_mutex_unlock(&chan->lock);
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    if (chan->qcount == 0) {
+        if (crtn && add_waiter(chan, crtn, false)) {
+            purc_mutex_unlock(&chan->lock);
+            goto failed;
+        }
+        if (crtn && crtn->waiting_chan == NULL) {
+            /* the waiting coroutine holds a reference */
+            chan->refc++;
+            crtn->waiting_chan = chan;
+        }
+        purc_mutex_unlock(&chan->lock);
+
+        if (crtn) {
+            // stop the current coroutine
+            pcintr_stop_coroutine(crtn, &crtn->timeout);
+        }
+
+        purc_set_error(PURC_ERROR_AGAIN);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t vrt = chan->data[chan->recvx];
+    chan->data[chan->recvx] = PURC_VARIANT_INVALID;
+    chan->recvx++;
+    if (chan->recvx == chan->qsize)
+        chan->recvx = 0;
+    chan->qcount--;
+    purc_mutex_unlock(&chan->lock);
+
+    vrt = pcvariant_move_heap_out(vrt);
+
+    pcchan_post_event(chan->uri, MSG_TYPE_SENDABLE, NULL,
+            PURC_VARIANT_INVALID);
+    wake_next(chan, true);
+
+    return vrt;
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_undefined();
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+cap_getter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcchan_shared_t chan = native_entity;
+    purc_mutex_lock(&chan->lock);
+    unsigned int qsize = chan->qsize;
+    purc_mutex_unlock(&chan->lock);
+
+    if (qsize == 0) {
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    return purc_variant_make_ulongint(qsize);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t
+len_getter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+    UNUSED_PARAM(nr_args);
+    UNUSED_PARAM(argv);
+
+    pcchan_shared_t chan = native_entity;
+    purc_mutex_lock(&chan->lock);
+    unsigned int qsize = chan->qsize;
+    unsigned int qcount = chan->qcount;
+    purc_mutex_unlock(&chan->lock);
+
+    if (qsize == 0) {
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        goto failed;
+    }
+
+    return purc_variant_make_ulongint(qcount);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_nvariant_method
+property_getter(void *entity, const char *name)
+{
+    UNUSED_PARAM(entity);
+    if (name == NULL) {
+        goto failed;
+    }
+
+    switch (name[0]) {
+    case 's':
+        if (strcmp(name, "send") == 0) {
+            return send_getter;
+        }
+        break;
+
+    case 'r':
+        if (strcmp(name, "recv") == 0) {
+            return recv_getter;
+        }
+        break;
+
+    case 'c':
+        if (strcmp(name, "cap") == 0) {
+            return cap_getter;
+        }
+        break;
+
+    case 'l':
+        if (strcmp(name, "len") == 0) {
+            return len_getter;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+failed:
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+}
+
+static purc_variant_t
+cap_setter(void *native_entity, const char *property_name,
+        size_t nr_args, purc_variant_t *argv, unsigned call_flags)
+{
+    UNUSED_PARAM(property_name);
+
+    pcchan_shared_t chan = native_entity;
+
+    uint32_t cap = 1;
+    if (nr_args > 0) {
+        if (!purc_variant_cast_to_uint32(argv[0], &cap, false)) {
+            pcinst_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+            goto failed;
+        }
+    }
+
+    if (!pcchan_shared_ctrl(chan, cap)) {
+        // error set by pcchan_shared_ctrl()
+        goto failed;
+    }
+
+    return purc_variant_make_boolean(true);
+
+failed:
+    if (call_flags & PCVRT_CALL_FLAG_SILENTLY)
+        return purc_variant_make_boolean(false);
+
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_nvariant_method
+property_setter(void *entity, const char *name)
+{
+    UNUSED_PARAM(entity);
+    if (name == NULL) {
+        goto failed;
+    }
+
+    if (strcmp(name, "cap") == 0) {
+        return cap_setter;
+    }
+
+failed:
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return NULL;
+}
+
+static void
+on_release(void *native_entity)
+{
+    pcchan_shared_unref(native_entity);
+}
+
+static bool
+on_observe(void *native_entity,
+        const char *event_name, const char *event_subname)
+{
+    UNUSED_PARAM(native_entity);
+    UNUSED_PARAM(event_name);
+    UNUSED_PARAM(event_subname);
+    return true;
+}
+
+static bool
+did_matched(void *native_entity, purc_variant_t val)
+{
+    if (purc_variant_is_native(val)) {
+        void *comp = purc_variant_native_get_entity(val);
+        if (comp == native_entity) {
+            return true;
+        }
+
+        purc_clr_error();
+        return false;
+    }
+    else if (purc_variant_is_object(val)) {
+        pcchan_shared_t chan = native_entity;
+        return pcchan_is_observed(val, chan->uri);
+    }
+
+    return false;
+}
+
+purc_variant_t
+pcchan_shared_make_entity(pcchan_shared_t chan)
+{
+    static struct purc_native_ops ops = {
+        .property_getter = property_getter,
+        .property_setter = property_setter,
+        .did_matched = did_matched,
+        .on_observe = on_observe,
+        .on_forget = NULL,
+        .on_release = on_release,
+    };
+
+    purc_mutex_lock(&chan->lock);
+    if (chan->qsize == 0) {
+        purc_mutex_unlock(&chan->lock);
+        purc_set_error(PURC_ERROR_ENTITY_GONE);
+        return PURC_VARIANT_INVALID;
+    }
+    chan->refc++;
+    purc_mutex_unlock(&chan->lock);
+
+    purc_variant_t retv = purc_variant_make_native(chan, &ops);
+    if (retv == PURC_VARIANT_INVALID) {
+        pcchan_shared_unref(chan);
+    }
+
+    return retv;
+}
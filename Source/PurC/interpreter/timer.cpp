@@ -484,7 +484,7 @@ timers_set_change(purc_variant_t source, pcvar_op_t msg_type,
 }
 
 static bool
-timers_set_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
+timers_set_op_handler(purc_variant_t source, pcvar_op_t msg_type,
         void *ctxt, size_t nr_args, purc_variant_t *argv)
 {
     switch (msg_type) {
@@ -503,6 +503,15 @@ timers_set_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
     return true;
 }
 
+static bool
+timers_set_listener_handler(purc_variant_t source, pcvar_op_t msg_type,
+        void *ctxt, size_t nr_args, purc_variant_t *argv)
+{
+    /* the timers are handled one by one for a coalesced event */
+    return purc_variant_unbatch_event(source, msg_type, ctxt, nr_args, argv,
+            timers_set_op_handler);
+}
+
 static bool
 timers_set_pre_grow(purc_variant_t source, pcvar_op_t msg_type,
         void *ctxt, size_t nr_args, purc_variant_t *argv)
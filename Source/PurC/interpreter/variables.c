@@ -59,6 +59,22 @@ post_event(purc_variant_t source, purc_variant_t key, purc_variant_t value)
     purc_variant_unref(source_uri);
 }
 
+static void
+post_events(purc_variant_t source, size_t nr_args, purc_variant_t *argv)
+{
+    if (!purc_variant_is_batched_event(nr_args, argv)) {
+        post_event(source, argv[0], argv[1]);
+        return;
+    }
+
+    size_t sz = 0;
+    purc_variant_array_size(argv[0], &sz);
+    for (size_t i = 0; i < sz; i++) {
+        post_event(source, purc_variant_array_get(argv[0], i),
+                purc_variant_array_get(argv[1], i));
+    }
+}
+
 static bool
 myobj_grow_handler(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
         size_t nr_args, purc_variant_t *argv)
@@ -69,7 +85,7 @@ myobj_grow_handler(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
 
-    post_event(source, argv[0], argv[1]);
+    post_events(source, nr_args, argv);
 
     return true;
 }
@@ -83,7 +99,7 @@ myobj_change_handler(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
     UNUSED_PARAM(ctxt);
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
-    post_event(source, argv[0], argv[1]);
+    post_events(source, nr_args, argv);
     return true;
 }
 
@@ -96,7 +112,7 @@ myobj_shrink_handler(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
     UNUSED_PARAM(ctxt);
     UNUSED_PARAM(nr_args);
     UNUSED_PARAM(argv);
-    post_event(source, argv[0], argv[1]);
+    post_events(source, nr_args, argv);
     return true;
 }
 
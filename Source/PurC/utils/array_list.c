@@ -57,6 +57,14 @@ pcutils_array_list_reset(struct pcutils_array_list *al)
     }
 }
 
+void
+pcutils_array_list_clear(struct pcutils_array_list *al)
+{
+    al->nr = 0;
+    INIT_LIST_HEAD(&al->list);
+    pcutils_array_list_reset(al);
+}
+
 int
 pcutils_array_list_expand(struct pcutils_array_list *al, size_t capacity)
 {
@@ -261,3 +269,25 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
     }
 }
 
+int
+pcutils_array_list_permute(struct pcutils_array_list *al,
+        const size_t *order)
+{
+    size_t nr = al->nr;
+    struct pcutils_array_list_node **nodes;
+
+    nodes = malloc(sizeof(*nodes) * nr);
+    if (!nodes)
+        return -1;
+
+    for (size_t i = 0; i < nr; ++i) {
+        nodes[i] = al->nodes[order[i]];
+        nodes[i]->idx = i;
+    }
+
+    memcpy(al->nodes, nodes, sizeof(*nodes) * nr);
+    free(nodes);
+
+    return 0;
+}
+
@@ -28,6 +28,13 @@
 #include "private/utils.h"
 #include "private/debug.h"
 
+#include <string.h>
+#include <pthread.h>
+
+#if defined __GNUC__ && defined __x86_64__
+#include <immintrin.h>
+#endif
+
 /*
 
 // program to generate the crc32_table.
@@ -471,6 +478,342 @@ static const uint32_t crc32_table_000000af[] =
   0x00006494, 0x0000643b, 0x000065ca, 0x00006565
 };
 
+/*
+ * The engines.
+ *
+ * The byte-wise engine is the reference one. The slicing-by-16 engines
+ * process 16 bytes per iteration with 16 derived tables, where
+ * slices[k][i] is the CRC register of the byte `i` followed by `k` zero
+ * bytes. On x86-64, CRC-32C uses the CRC32 instruction of SSE4.2, and
+ * the reflected CRC-32 (and CRC-32/JAMCRC) folds the data by using
+ * PCLMULQDQ; both are selected at runtime according to the features of
+ * the CPU. All engines work on the raw register: `init` is applied by
+ * pcutils_crc32_begin() and `xorout` by pcutils_crc32_end().
+ */
+
+#define NR_SLICES                   16
+#define NR_STATIC_TABLES            6
+
+static const uint32_t *static_tables[NR_STATIC_TABLES] = {
+    crc32_table_04c11db7_reflected,
+    crc32_table_04c11db7,
+    crc32_table_1edc6f41_reflected,
+    crc32_table_a833982b_reflected,
+    crc32_table_814141ab,
+    crc32_table_000000af,
+};
+
+static const bool static_tables_reflected[NR_STATIC_TABLES] = {
+    true, false, true, true, false, false,
+};
+
+static uint32_t static_slices[NR_STATIC_TABLES][NR_SLICES][256];
+
+#if defined __GNUC__ && defined __x86_64__
+#   define HAVE_X86_CRC32_ENGINES   1
+#else
+#   define HAVE_X86_CRC32_ENGINES   0
+#endif
+
+static bool cpu_has_sse42;
+static bool cpu_has_pclmul;
+
+static void calc_crc32_slices(uint32_t (*slices)[256], const uint32_t *table,
+        bool reflected)
+{
+    memcpy(slices[0], table, sizeof(slices[0]));
+    for (int k = 1; k < NR_SLICES; k++) {
+        for (int i = 0; i < 256; i++) {
+            uint32_t c = slices[k - 1][i];
+            if (reflected)
+                slices[k][i] = (c >> 8) ^ table[c & 0xFF];
+            else
+                slices[k][i] = (c << 8) ^ table[c >> 24];
+        }
+    }
+}
+
+static void init_engines_once(void)
+{
+    for (int i = 0; i < NR_STATIC_TABLES; i++) {
+        calc_crc32_slices(static_slices[i], static_tables[i],
+                static_tables_reflected[i]);
+    }
+
+#if HAVE_X86_CRC32_ENGINES
+    __builtin_cpu_init();
+    cpu_has_sse42 = __builtin_cpu_supports("sse4.2");
+    cpu_has_pclmul = __builtin_cpu_supports("pclmul") &&
+        __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+static uint32_t
+engine_bytewise(const pcutils_crc32_ctxt *ctxt, uint32_t crc,
+        const uint8_t *buf, size_t n)
+{
+    const uint32_t *table = ctxt->table_static;
+
+    if (ctxt->refout) {
+        while (n--) {
+            crc = (crc >> 8) ^ table[(crc ^ *buf++) & 0xFF];
+        }
+    }
+    else {
+        while (n--) {
+            crc = (crc << 8) ^ table[((crc >> 24) ^ *buf++) & 0xFF];
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t
+engine_slice16_reflected(const pcutils_crc32_ctxt *ctxt, uint32_t crc,
+        const uint8_t *buf, size_t n)
+{
+    const uint32_t (*t)[256] = ctxt->slices;
+
+    while (n >= NR_SLICES) {
+        uint32_t c = crc ^ ((uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+                ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24));
+
+        crc = t[15][c & 0xFF] ^ t[14][(c >> 8) & 0xFF] ^
+            t[13][(c >> 16) & 0xFF] ^ t[12][c >> 24] ^
+            t[11][buf[4]] ^ t[10][buf[5]] ^ t[9][buf[6]] ^ t[8][buf[7]] ^
+            t[7][buf[8]] ^ t[6][buf[9]] ^ t[5][buf[10]] ^ t[4][buf[11]] ^
+            t[3][buf[12]] ^ t[2][buf[13]] ^ t[1][buf[14]] ^ t[0][buf[15]];
+
+        buf += NR_SLICES;
+        n -= NR_SLICES;
+    }
+
+    while (n--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *buf++) & 0xFF];
+    }
+
+    return crc;
+}
+
+static uint32_t
+engine_slice16_normal(const pcutils_crc32_ctxt *ctxt, uint32_t crc,
+        const uint8_t *buf, size_t n)
+{
+    const uint32_t (*t)[256] = ctxt->slices;
+
+    while (n >= NR_SLICES) {
+        uint32_t c = crc ^ (((uint32_t)buf[0] << 24) |
+                ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) |
+                (uint32_t)buf[3]);
+
+        crc = t[15][c >> 24] ^ t[14][(c >> 16) & 0xFF] ^
+            t[13][(c >> 8) & 0xFF] ^ t[12][c & 0xFF] ^
+            t[11][buf[4]] ^ t[10][buf[5]] ^ t[9][buf[6]] ^ t[8][buf[7]] ^
+            t[7][buf[8]] ^ t[6][buf[9]] ^ t[5][buf[10]] ^ t[4][buf[11]] ^
+            t[3][buf[12]] ^ t[2][buf[13]] ^ t[1][buf[14]] ^ t[0][buf[15]];
+
+        buf += NR_SLICES;
+        n -= NR_SLICES;
+    }
+
+    while (n--) {
+        crc = (crc << 8) ^ t[0][((crc >> 24) ^ *buf++) & 0xFF];
+    }
+
+    return crc;
+}
+
+#if HAVE_X86_CRC32_ENGINES
+__attribute__((target("sse4.2")))
+static uint32_t
+engine_sse42_crc32c(const pcutils_crc32_ctxt *ctxt, uint32_t crc,
+        const uint8_t *buf, size_t n)
+{
+    UNUSED_PARAM(ctxt);
+
+    uint64_t crc64 = crc;
+
+    /* align the buffer to 8 bytes for the quad-word instruction */
+    while (n > 0 && ((uintptr_t)buf & 0x07)) {
+        crc64 = _mm_crc32_u8((uint32_t)crc64, *buf++);
+        n--;
+    }
+
+    while (n >= sizeof(uint64_t)) {
+        uint64_t u64;
+        memcpy(&u64, buf, sizeof(u64));
+        crc64 = _mm_crc32_u64(crc64, u64);
+        buf += sizeof(u64);
+        n -= sizeof(u64);
+    }
+
+    crc = (uint32_t)crc64;
+    while (n--) {
+        crc = _mm_crc32_u8(crc, *buf++);
+    }
+
+    return crc;
+}
+
+/*
+ * Folds the data by 64 bytes with four 128-bit accumulators, then reduces
+ * them to one, and finally uses the Barrett reduction to get the 32-bit
+ * register. The constants are for the bit-reflected polynomial 0x04C11DB7;
+ * see "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction" by Intel.
+ */
+#define MIN_SIZE_PCLMUL             64
+
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t
+pclmul_crc32_fold(uint32_t crc, const uint8_t *buf, size_t n)
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    buf += 64;
+    n -= 64;
+
+    x0 = k1k2;
+    while (n >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                _mm_loadu_si128((const __m128i *)(buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                _mm_loadu_si128((const __m128i *)(buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                _mm_loadu_si128((const __m128i *)(buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                _mm_loadu_si128((const __m128i *)(buf + 0x30)));
+
+        buf += 64;
+        n -= 64;
+    }
+
+    /* fold the four accumulators into one */
+    x0 = k3k4;
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* the remaining 16-byte blocks */
+    while (n >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                _mm_loadu_si128((const __m128i *)buf));
+        buf += 16;
+        n -= 16;
+    }
+
+    /* 128 bits to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x0 = k5k0;
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x0 = poly;
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+static uint32_t
+engine_pclmul_crc32(const pcutils_crc32_ctxt *ctxt, uint32_t crc,
+        const uint8_t *buf, size_t n)
+{
+    if (n >= MIN_SIZE_PCLMUL) {
+        size_t folded = n & ~(size_t)0x0F;
+        crc = pclmul_crc32_fold(crc, buf, folded);
+        buf += folded;
+        n -= folded;
+    }
+
+    return engine_slice16_reflected(ctxt, crc, buf, n);
+}
+#endif /* HAVE_X86_CRC32_ENGINES */
+
+static void select_engine(pcutils_crc32_ctxt *ctxt)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, init_engines_once);
+
+    ctxt->slices = NULL;
+    ctxt->engine = engine_bytewise;
+    for (int i = 0; i < NR_STATIC_TABLES; i++) {
+        if (ctxt->table_static != static_tables[i])
+            continue;
+
+        /* the direction of the tables must match the one of update */
+        if (static_tables_reflected[i] != ctxt->refout)
+            break;
+
+        ctxt->slices = (const uint32_t (*)[256])static_slices[i];
+        ctxt->engine = ctxt->refout ?
+            engine_slice16_reflected : engine_slice16_normal;
+
+#if HAVE_X86_CRC32_ENGINES
+        if (ctxt->table_static == crc32_table_1edc6f41_reflected &&
+                cpu_has_sse42)
+            ctxt->engine = engine_sse42_crc32c;
+        else if (ctxt->table_static == crc32_table_04c11db7_reflected &&
+                cpu_has_pclmul)
+            ctxt->engine = engine_pclmul_crc32;
+#endif
+        break;
+    }
+}
+
+const char *
+pcutils_crc32_engine_name(const pcutils_crc32_ctxt *ctxt)
+{
+    if (ctxt->engine == engine_slice16_reflected ||
+            ctxt->engine == engine_slice16_normal)
+        return "slice-by-16";
+#if HAVE_X86_CRC32_ENGINES
+    if (ctxt->engine == engine_sse42_crc32c)
+        return "sse4.2";
+    if (ctxt->engine == engine_pclmul_crc32)
+        return "pclmulqdq";
+#endif
+    return "byte-wise";
+}
+
 /* For the parameters of different CRC32 algorithms, see
    <https://crccalc.com/> */
 void pcutils_crc32_begin(pcutils_crc32_ctxt *ctxt, purc_crc32_algo_t algo)
@@ -566,26 +909,13 @@ void pcutils_crc32_begin(pcutils_crc32_ctxt *ctxt, purc_crc32_algo_t algo)
     }
 
     ctxt->crc32 = ctxt->init;
+    select_engine(ctxt);
 }
 
 void pcutils_crc32_update(pcutils_crc32_ctxt *ctxt,
         const void *data, size_t n)
 {
-    const uint8_t *buf = data;
-
-    while (n--) {
-        uint8_t ch;
-        ch = *buf;
-
-        if (ctxt->refout)
-            ctxt->crc32 = (((ctxt->crc32) >> 8) ^
-                    ctxt->table_static[((ctxt->crc32) ^ (ch)) & 0xFF]);
-        else
-            ctxt->crc32 = (ctxt->crc32 << 8) ^
-                ctxt->table_static[((ctxt->crc32 >> 24) ^ ch) & 0xFF];
-
-        buf++;
-    }
+    ctxt->crc32 = ctxt->engine(ctxt, ctxt->crc32, data, n);
 }
 
 void pcutils_crc32_end(pcutils_crc32_ctxt *ctxt, uint32_t* crc32)
@@ -678,6 +1008,8 @@ pcutils_crc32_begin_custom(uint32_t poly, uint32_t init, uint32_t xorout,
         ctxt->xorout = xorout;
         ctxt->refin = true;
         ctxt->refout = refout;
+        ctxt->slices = NULL;
+        ctxt->engine = engine_bytewise;
         if (refin) {
             calc_crc32_table(ctxt->table_alloc, poly, refin);
         }
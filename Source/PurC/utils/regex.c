@@ -32,11 +32,115 @@
 #include "purc-errors.h"
 #include "private/errors.h"
 #include "private/regex.h"
+#include "private/instance.h"
+#include "private/list.h"
+#include "private/hashtable.h"
 
 #if HAVE(GLIB)
 #include <glib.h>
 #endif
 
+/* the number of compiled patterns cached for an instance */
+#define NR_CACHED_PATTERNS      32
+
+struct cached_pattern {
+    struct list_head            ln;
+    uint32_t                    hash;
+    enum pcregex_compile_flags  compile_options;
+    char                       *pattern;
+    void                       *compiled;
+};
+
+struct pcregex_cache {
+    /* the most recently used pattern first */
+    struct list_head            lru;
+    struct pcregex_cache_stat   stat;
+};
+
+static inline bool
+is_regex_metachar(char c)
+{
+    return strchr("\\^$.|?*+()[]{}", c) != NULL;
+}
+
+static inline bool
+match_tail(const char *str, size_t str_len, const char *core, size_t len,
+        bool head)
+{
+    if (head)
+        return str_len == len && memcmp(str, core, len) == 0;
+    return str_len >= len && memcmp(str + str_len - len, core, len) == 0;
+}
+
+/*
+ * Matches the pattern without the regex engine if it is a plain literal
+ * with optional anchors, or `.*`. Returns 1 for matched, 0 for not
+ * matched, or -1 if the pattern is not so simple.
+ */
+static int
+match_simple_pattern(const char *pattern, const char *str)
+{
+    if (strcmp(pattern, ".*") == 0)
+        return 1;
+
+    bool head = false, tail = false;
+    const char *core = pattern;
+    if (*core == '^') {
+        head = true;
+        core++;
+    }
+
+    size_t len = strlen(core);
+    if (len > 0 && core[len - 1] == '$') {
+        tail = true;
+        len--;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        if (is_regex_metachar(core[i]))
+            return -1;
+    }
+
+    size_t str_len = strlen(str);
+    if (tail) {
+        if (match_tail(str, str_len, core, len, head))
+            return 1;
+
+        /* like PCRE, `$` also matches before the newline at the end */
+        if (str_len > 0 && str[str_len - 1] == '\n' &&
+                match_tail(str, str_len - 1, core, len, head))
+            return 1;
+        return 0;
+    }
+
+    if (head)
+        return (str_len >= len && memcmp(str, core, len) == 0) ? 1 : 0;
+
+    return strstr(str, core) ? 1 : 0;
+}
+
+static struct pcregex_cache *
+get_cache(struct pcinst *inst)
+{
+    if (inst->regex_cache == NULL) {
+        inst->regex_cache = calloc(1, sizeof(struct pcregex_cache));
+        if (inst->regex_cache == NULL)
+            return NULL;
+        list_head_init(&inst->regex_cache->lru);
+    }
+
+    return inst->regex_cache;
+}
+
+void pcregex_cache_get_stat(struct pcregex_cache_stat *stat)
+{
+    struct pcinst *inst = pcinst_current();
+
+    memset(stat, 0, sizeof(*stat));
+    if (inst && inst->regex_cache)
+        *stat = inst->regex_cache->stat;
+}
+
 #if HAVE(GLIB)
 
 struct pcregex {
@@ -237,6 +341,76 @@ set_error_code_from_gerror(GError *err)
     g_error_free(err);
 }
 
+static void
+free_cached_pattern(struct cached_pattern *entry)
+{
+    list_del(&entry->ln);
+    g_regex_unref((GRegex *)entry->compiled);
+    free(entry->pattern);
+    free(entry);
+}
+
+void pcregex_cache_delete(struct pcinst *inst)
+{
+    struct pcregex_cache *cache = inst->regex_cache;
+    if (cache == NULL)
+        return;
+
+    struct cached_pattern *p, *n;
+    list_for_each_entry_safe(p, n, &cache->lru, ln) {
+        free_cached_pattern(p);
+    }
+
+    free(cache);
+    inst->regex_cache = NULL;
+}
+
+static GRegex *
+get_compiled_pattern(struct pcregex_cache *cache, const char *pattern,
+        enum pcregex_compile_flags compile_options)
+{
+    uint32_t hash = pchash_fnv1a_str_hash(pattern);
+
+    struct cached_pattern *entry;
+    list_for_each_entry(entry, &cache->lru, ln) {
+        if (entry->hash == hash && entry->compile_options == compile_options
+                && strcmp(entry->pattern, pattern) == 0) {
+            cache->stat.nr_hits++;
+            list_move(&entry->ln, &cache->lru);
+            return (GRegex *)entry->compiled;
+        }
+    }
+
+    cache->stat.nr_misses++;
+
+    GRegex *g_regex = g_regex_new(pattern,
+            to_g_regex_compile_flags(compile_options), 0, NULL);
+    if (g_regex == NULL)
+        return NULL;
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL || (entry->pattern = strdup(pattern)) == NULL) {
+        free(entry);
+        g_regex_unref(g_regex);
+        return NULL;
+    }
+
+    entry->hash = hash;
+    entry->compile_options = compile_options;
+    entry->compiled = g_regex;
+
+    if (cache->stat.nr_entries >= NR_CACHED_PATTERNS) {
+        free_cached_pattern(list_last_entry(&cache->lru,
+                    struct cached_pattern, ln));
+        cache->stat.nr_entries--;
+        cache->stat.nr_evictions++;
+    }
+
+    list_add(&entry->ln, &cache->lru);
+    cache->stat.nr_entries++;
+    return g_regex;
+}
+
 bool pcregex_is_match_ex(const char *pattern, const char *str,
         enum pcregex_compile_flags compile_options,
         enum pcregex_match_flags match_options)
@@ -244,9 +418,31 @@ bool pcregex_is_match_ex(const char *pattern, const char *str,
     if (!pattern || !pattern[0] || !str || !str[0]) {
         return false;
     }
-    return g_regex_match_simple(pattern, str,
-            to_g_regex_compile_flags(compile_options),
-            to_g_regex_match_flags(match_options));
+
+    struct pcinst *inst = pcinst_current();
+    struct pcregex_cache *cache = inst ? get_cache(inst) : NULL;
+
+    if (compile_options == 0 && match_options == 0) {
+        int ret = match_simple_pattern(pattern, str);
+        if (ret >= 0) {
+            if (cache)
+                cache->stat.nr_simple++;
+            return ret;
+        }
+    }
+
+    GRegex *g_regex;
+    if (cache == NULL ||
+            (g_regex = get_compiled_pattern(cache, pattern,
+                compile_options)) == NULL) {
+        /* not cached, or reports the bad pattern */
+        return g_regex_match_simple(pattern, str,
+                to_g_regex_compile_flags(compile_options),
+                to_g_regex_match_flags(match_options));
+    }
+
+    return g_regex_match(g_regex, str,
+            to_g_regex_match_flags(match_options), NULL);
 }
 
 bool pcregex_is_match(const char *pattern, const char *str)
@@ -389,14 +585,30 @@ void pcregex_match_info_destroy(struct pcregex_match_info *match_info)
 
 #else /* HAVA(GLIB) */
 
+void pcregex_cache_delete(struct pcinst *inst)
+{
+    free(inst->regex_cache);
+    inst->regex_cache = NULL;
+}
+
 bool pcregex_is_match_ex(const char *pattern, const char *str,
         enum pcregex_compile_flags compile_options,
         enum pcregex_match_flags match_options)
 {
-    UNUSED_PARAM(pattern);
-    UNUSED_PARAM(str);
-    UNUSED_PARAM(compile_options);
-    UNUSED_PARAM(match_options);
+    if (!pattern || !pattern[0] || !str || !str[0]) {
+        return false;
+    }
+
+    if (compile_options == 0 && match_options == 0) {
+        int ret = match_simple_pattern(pattern, str);
+        if (ret >= 0) {
+            struct pcinst *inst = pcinst_current();
+            struct pcregex_cache *cache = inst ? get_cache(inst) : NULL;
+            if (cache)
+                cache->stat.nr_simple++;
+            return ret;
+        }
+    }
 
     purc_set_error(PURC_ERROR_NOT_IMPLEMENTED);
     return false;
@@ -38,6 +38,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #endif // 0S(UNIX)
 
 #include "rwstream_err_msgs.inc"
@@ -47,6 +49,9 @@
 #define READ_BUFFER_MIN_SIZE    32
 #define READ_BUFFER_MAX_SIZE    1024*1024
 
+/* the size to read ahead when peeking a stream without a memory backend */
+#define READ_AHEAD_SIZE         BUFFER_SIZE
+
 /* Make sure the number of error messages matches the number of error codes */
 #define _COMPILE_TIME_ASSERT(name, x)               \
        typedef int _dummy_ ## name[(x) * 2 - 1]
@@ -87,6 +92,9 @@ typedef struct rwstream_funcs
     int     (*destroy) (purc_rwstream_t rws);
     void*   (*get_mem_buffer) (purc_rwstream_t rws, size_t *sz_content,
             size_t *sz_buffer, bool res_buff);
+    /* for the memory-based streams, the data can be peeked in place */
+    const void* (*peek) (purc_rwstream_t rws, size_t *len);
+    ssize_t (*consume) (purc_rwstream_t rws, size_t count);
 } rwstream_funcs;
 
 struct purc_rwstream
@@ -101,6 +109,13 @@ struct purc_rwstream
     size_t rcnt;
     /* valid data start index (for ring buffer optimization) */
     size_t rstart;
+    /* the bytes at the tail of read buffer which were read ahead */
+    size_t rahead;
+    /* the size to read ahead; zero to read the bytes needed only */
+    size_t sz_read_ahead;
+    /* a pipe, a socket, or a tty: the data read have nothing to do with
+       the data written, and the bytes read ahead can not be given back */
+    bool unseekable;
 
     off_t logical_pos;
 };
@@ -138,6 +153,14 @@ struct fd_rwstream
     purc_rwstream rwstream;
     int fd;
 };
+
+struct mmap_rwstream
+{
+    /* the mapped file is accessed through the mem backend */
+    struct mem_rwstream mem;
+    void*  addr;
+    size_t length;
+};
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
 static off_t stdio_seek (purc_rwstream_t rws, off_t offset, int whence);
@@ -154,6 +177,8 @@ static rwstream_funcs stdio_funcs = {
     stdio_write,
     stdio_flush,
     stdio_destroy,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -165,6 +190,8 @@ static ssize_t mem_flush (purc_rwstream_t rws);
 static int mem_destroy (purc_rwstream_t rws);
 static void* mem_get_mem_buffer (purc_rwstream_t rws,
         size_t *sz_content, size_t *sz_buffer, bool res_buff);
+static const void* mem_peek (purc_rwstream_t rws, size_t *len);
+static ssize_t mem_consume (purc_rwstream_t rws, size_t count);
 
 static rwstream_funcs mem_funcs = {
     mem_seek,
@@ -173,7 +200,9 @@ static rwstream_funcs mem_funcs = {
     mem_write,
     mem_flush,
     mem_destroy,
-    mem_get_mem_buffer
+    mem_get_mem_buffer,
+    mem_peek,
+    mem_consume
 };
 
 static off_t buffer_seek (purc_rwstream_t rws, off_t offset, int whence);
@@ -184,6 +213,8 @@ static ssize_t buffer_flush (purc_rwstream_t rws);
 static int buffer_destroy (purc_rwstream_t rws);
 static void* buffer_get_mem_buffer (purc_rwstream_t rws,
         size_t *sz_content, size_t *sz_buffer, bool res_buff);
+static const void* buffer_peek (purc_rwstream_t rws, size_t *len);
+static ssize_t buffer_consume (purc_rwstream_t rws, size_t count);
 
 static rwstream_funcs buffer_funcs = {
     buffer_seek,
@@ -192,7 +223,9 @@ static rwstream_funcs buffer_funcs = {
     buffer_write,
     buffer_flush,
     buffer_destroy,
-    buffer_get_mem_buffer
+    buffer_get_mem_buffer,
+    buffer_peek,
+    buffer_consume
 };
 
 
@@ -212,6 +245,22 @@ static rwstream_funcs fd_funcs = {
     NULL,           // flush
     fd_destroy,
     NULL,
+    NULL,
+    NULL,
+};
+
+static int mmap_destroy (purc_rwstream_t rws);
+
+static rwstream_funcs mmap_funcs = {
+    mem_seek,
+    mem_tell,
+    mem_read,
+    NULL,           // write: the mapping is read-only
+    mem_flush,
+    mmap_destroy,
+    mem_get_mem_buffer,
+    mem_peek,
+    mem_consume
 };
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
@@ -236,6 +285,8 @@ static int read_buffer_init(purc_rwstream_t rws)
     rws->rcap = READ_BUFFER_MIN_SIZE;
     rws->rcnt = 0;
     rws->rstart = 0;
+    rws->rahead = 0;
+    rws->sz_read_ahead = READ_AHEAD_SIZE;
     rws->logical_pos = 0;
     return 0;
 }
@@ -252,10 +303,55 @@ static int read_buffer_destroy(purc_rwstream_t rws)
 static int read_buffer_clear(purc_rwstream_t rws)
 {
     rws->rcnt = 0;
+    rws->rstart = 0;
+    rws->rahead = 0;
+    return 0;
+}
+
+/* Moves the data in the read buffer to the beginning of the buffer. */
+static int read_buffer_linearize(purc_rwstream_t rws)
+{
+    if (rws->rstart == 0)
+        return 0;
+
+    if (rws->rstart + rws->rcnt <= rws->rcap) {
+        memmove(rws->rbuf, rws->rbuf + rws->rstart, rws->rcnt);
+    }
+    else {
+        size_t tail = rws->rcap - rws->rstart;
+        size_t head = rws->rcnt - tail;
+        uint8_t *tmp = (uint8_t *)malloc(tail);
+        if (tmp == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+
+        memcpy(tmp, rws->rbuf + rws->rstart, tail);
+        memmove(rws->rbuf + tail, rws->rbuf, head);
+        memcpy(rws->rbuf, tmp, tail);
+        free(tmp);
+    }
+
     rws->rstart = 0;
     return 0;
 }
 
+/* Removes @n bytes from the head of the read buffer. */
+static void read_buffer_drop(purc_rwstream_t rws, size_t n)
+{
+    rws->rstart += n;
+    if (rws->rstart >= rws->rcap)
+        rws->rstart -= rws->rcap;
+    rws->rcnt -= n;
+    if (rws->rcnt == 0)
+        rws->rstart = 0;
+
+    /* the bytes pushed back by ungetc() are consumed first */
+    if (rws->rahead > rws->rcnt)
+        rws->rahead = rws->rcnt;
+    rws->logical_pos += n;
+}
+
 static int read_buffer_expand(purc_rwstream_t stream, size_t size)
 {
     if (stream->rcap >= size || stream->rcap >= READ_BUFFER_MAX_SIZE) {
@@ -411,6 +507,16 @@ purc_rwstream_t purc_rwstream_new_from_fp (FILE* fp)
 
     rws->rwstream.funcs = &stdio_funcs;
     rws->fp = fp;
+
+#if OS(UNIX)
+    /* fread() blocks until the count of bytes is got from a pipe or a tty;
+       the stdio buffer serves the small reads in these cases anyway. */
+    struct stat st;
+    if (fstat(fileno(fp), &st) || !S_ISREG(st.st_mode))
+        rws->rwstream.sz_read_ahead = 0;
+    rws->rwstream.unseekable = (lseek(fileno(fp), 0, SEEK_CUR) == -1);
+#endif
+
     return (purc_rwstream_t)rws;
 }
 
@@ -431,6 +537,7 @@ purc_rwstream_t purc_rwstream_new_from_unix_fd (int fd)
 
     fd_rws->rwstream.funcs = &fd_funcs;
     fd_rws->fd = fd;
+    fd_rws->rwstream.unseekable = (lseek(fd, 0, SEEK_CUR) == -1);
     return (purc_rwstream_t)fd_rws;
 #else
     UNUSED_PARAM(fd);
@@ -439,6 +546,80 @@ purc_rwstream_t purc_rwstream_new_from_unix_fd (int fd)
 #endif
 }
 
+purc_rwstream_t purc_rwstream_new_from_mmap (const char* file)
+{
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    struct stat st;
+    void* addr = NULL;
+    size_t length = 0;
+
+    int fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        pcinst_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+        return NULL;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        pcinst_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+        return NULL;
+    }
+
+    /* pipes, devices and pseudo files (e.g. /proc) can not be mapped */
+    if (!S_ISREG(st.st_mode) || (uintmax_t)st.st_size > SIZE_MAX) {
+        close(fd);
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return NULL;
+    }
+
+    length = (size_t)st.st_size;
+    if (length > 0) {
+        addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            pcinst_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+            return NULL;
+        }
+
+        /* the consumers (parsers and fetchers) scan the file only once */
+        madvise(addr, length, MADV_SEQUENTIAL);
+        madvise(addr, length, MADV_WILLNEED);
+    }
+
+    /* the mapping stays valid after the file descriptor is closed */
+    close(fd);
+
+    struct mmap_rwstream* rws = (struct mmap_rwstream*) calloc(
+            1, sizeof(struct mmap_rwstream));
+    if (rws == NULL) {
+        if (addr)
+            munmap(addr, length);
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    if (read_buffer_init((purc_rwstream_t)rws) != 0) {
+        if (addr)
+            munmap(addr, length);
+        free(rws);
+        return NULL;
+    }
+
+    rws->mem.rwstream.funcs = &mmap_funcs;
+    rws->mem.base = addr;
+    rws->mem.here = rws->mem.base;
+    rws->mem.stop = rws->mem.base + length;
+    rws->addr = addr;
+    rws->length = length;
+
+    return (purc_rwstream_t)rws;
+#else
+    UNUSED_PARAM(file);
+    pcinst_set_error(PURC_ERROR_NOT_IMPLEMENTED);
+    return NULL;
+#endif
+}
+
 purc_rwstream_t purc_rwstream_new_from_win32_socket (int socket, size_t sz_buf)
 {
     UNUSED_PARAM(socket);
@@ -479,6 +660,8 @@ static rwstream_funcs wo_funcs = {
     wo_write,
     NULL,
     NULL,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -543,6 +726,8 @@ static rwstream_funcs ro_funcs = {
     NULL,
     NULL,
     NULL,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -597,6 +782,9 @@ off_t purc_rwstream_seek (purc_rwstream_t rws, off_t offset, int whence)
     }
 
     if (rws->funcs->seek) {
+        /* the backend is ahead of the bytes read ahead */
+        if (whence == SEEK_CUR)
+            offset -= (off_t)rws->rahead;
         read_buffer_clear(rws);
         off_t new_pos = rws->funcs->seek(rws, offset, whence);
         if (new_pos != -1) {
@@ -616,11 +804,18 @@ off_t purc_rwstream_tell (purc_rwstream_t rws)
         return -1;
     }
 
-    if (rws->rcnt) {
+    if (rws->rcnt > rws->rahead) {
+        /* there are bytes pushed back */
         return rws->logical_pos;
     }
     else if (rws->funcs->tell) {
-        return rws->funcs->tell(rws);
+        off_t pos = rws->funcs->tell(rws);
+        if (pos >= 0)
+            pos -= (off_t)rws->rahead;
+        return pos;
+    }
+    else if (rws->rcnt) {
+        return rws->logical_pos;
     }
 
     pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
@@ -651,16 +846,17 @@ ssize_t purc_rwstream_read (purc_rwstream_t rws, void* buf, size_t count)
         if (contiguous < n) {
             size_t remaining = n - contiguous;
             memcpy(dest + contiguous, rws->rbuf, remaining);
-            rws->rstart = remaining;
-        } else {
-            rws->rstart += contiguous;
         }
 
-        rws->rcnt -= n;
+        read_buffer_drop(rws, n);
         dest += n;
         size -= n;
         total_read += n;
-        rws->logical_pos += n;
+
+        /* like read(2), do not block on a pipe or a socket for the rest
+           once the buffered bytes have been returned */
+        if (rws->unseekable)
+            return total_read;
     }
 
     if (size > 0) {
@@ -674,7 +870,8 @@ ssize_t purc_rwstream_read (purc_rwstream_t rws, void* buf, size_t count)
                 rws->logical_pos += n;
                 return total_read;
             }
-            return -1;
+            /* the buffered bytes copied are consumed already */
+            return total_read > 0 ? total_read : -1;
         }
         else {
             pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
@@ -715,15 +912,17 @@ int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
         return -1;
     }
 
-    ssize_t ret =  purc_rwstream_read (rws, buf_utf8, 1);
-    if (ret != 1) {
-        return ret;
+    const uint8_t *p;
+    ssize_t avail = purc_rwstream_peek(rws, (const void **)&p, 1);
+    if (avail <= 0) {
+        return avail;
     }
 
     int n = 1;
     int ch_len = 0;
-    uint8_t c = buf_utf8[0];
+    uint8_t c = p[0];
     if (c > 0xFD) {
+        purc_rwstream_consume(rws, 1);
         pcinst_set_error(PCRWSTREAM_ERROR_IO);
         return -1;
     }
@@ -733,6 +932,7 @@ int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
             n++;
 
         if (n < 2) {
+            purc_rwstream_consume(rws, 1);
             pcinst_set_error(PURC_ERROR_BAD_ENCODING);
             return -1;
         }
@@ -742,22 +942,29 @@ int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
         ch_len = 1;
     }
 
-    int read_len = ch_len - 1;
-    char* p = buf_utf8 + 1;
-    while (read_len > 0) {
-        ret =  purc_rwstream_read (rws, p, 1);
-        if (ret != 1)
-        {
-            pcinst_set_error(PCRWSTREAM_ERROR_IO);
+    if (avail < ch_len) {
+        avail = purc_rwstream_peek(rws, (const void **)&p, ch_len);
+        if (avail < 0) {
             return -1;
         }
-        c = *p;
-        if ((c & 0xC0) != 0x80) {
-            pcinst_set_error(PCRWSTREAM_ERROR_IO);
-            return -1;
+    }
+
+    /* like reading byte by byte, a bad continuation byte is consumed */
+    int i;
+    bool bad = false;
+    for (i = 1; i < ch_len && i < avail; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            bad = true;
+            i++;
+            break;
         }
-        p++;
-        read_len--;
+    }
+
+    memcpy(buf_utf8, p, i);
+    purc_rwstream_consume(rws, i);
+    if (bad || i < ch_len) {
+        pcinst_set_error(PCRWSTREAM_ERROR_IO);
+        return -1;
     }
 
     uint32_t uc = -1;
@@ -779,6 +986,94 @@ int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
     return ch_len;
 }
 
+ssize_t purc_rwstream_peek (purc_rwstream_t rws, const void **buf,
+        size_t min_len)
+{
+    if (rws == NULL || buf == NULL) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (min_len == 0) {
+        min_len = 1;
+    }
+    else if (min_len > READ_BUFFER_MAX_SIZE) {
+        min_len = READ_BUFFER_MAX_SIZE;
+    }
+
+    /* all the data left in a memory-based stream are contiguous */
+    if (rws->rcnt == 0 && rws->funcs->peek) {
+        size_t len;
+        *buf = rws->funcs->peek(rws, &len);
+        return (ssize_t)len;
+    }
+
+    if (rws->rbuf == NULL || rws->funcs->read == NULL) {
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
+    if ((rws->rcnt < min_len || rws->rstart + rws->rcnt > rws->rcap) &&
+            read_buffer_linearize(rws)) {
+        return -1;
+    }
+
+    if (rws->rcnt < min_len) {
+        size_t sz = rws->rcnt + rws->sz_read_ahead;
+        if (sz < min_len)
+            sz = min_len;
+        if (rws->rcap < sz && read_buffer_expand(rws, sz)) {
+            return -1;
+        }
+
+        if (sz > rws->rcap)
+            sz = rws->rcap;
+
+        while (rws->rcnt < min_len) {
+            ssize_t n = rws->funcs->read(rws, rws->rbuf + rws->rcnt,
+                    sz - rws->rcnt);
+            if (n < 0) {
+                if (rws->rcnt == 0)
+                    return -1;
+                break;
+            }
+            else if (n == 0) {  // EOF
+                break;
+            }
+
+            rws->rcnt += n;
+            rws->rahead += n;
+        }
+    }
+
+    *buf = rws->rbuf + rws->rstart;
+    return (ssize_t)rws->rcnt;
+}
+
+ssize_t purc_rwstream_consume (purc_rwstream_t rws, size_t count)
+{
+    if (rws == NULL) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (rws->rcnt == 0 && rws->funcs->consume) {
+        ssize_t n = rws->funcs->consume(rws, count);
+        if (n > 0)
+            rws->logical_pos += n;
+        return n;
+    }
+
+    if (count > rws->rcnt) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (count > 0)
+        read_buffer_drop(rws, count);
+    return (ssize_t)count;
+}
+
 int purc_rwstream_ungetc(purc_rwstream_t rws, const char* utf8ch, int len)
 {
     if (rws == NULL || utf8ch == NULL || len <= 0) {
@@ -830,7 +1125,14 @@ ssize_t purc_rwstream_write (purc_rwstream_t rws, const void* buf, size_t count)
         return -1;
     }
 
-    read_buffer_clear(rws);
+    /* give back the bytes read ahead, so that the data are written at the
+       position of reading; the stream shared by reading and writing over
+       a pipe or a socket keeps the bytes read for the later reads */
+    if (!rws->unseekable) {
+        if (rws->rahead && rws->funcs->seek)
+            rws->funcs->seek(rws, -(off_t)rws->rahead, SEEK_CUR);
+        read_buffer_clear(rws);
+    }
 
     if (rws->funcs->write) {
         ssize_t written_bytes = rws->funcs->write(rws, buf, count);
@@ -1067,13 +1369,31 @@ static void* mem_get_mem_buffer (purc_rwstream_t rws,
     }
 
     if (sz_buffer) {
-        *sz_content = mem->stop - mem->base;
+        *sz_buffer = mem->stop - mem->base;
     }
 
     UNUSED_PARAM(res_buff);
     return mem->base;
 }
 
+static const void* mem_peek (purc_rwstream_t rws, size_t *len)
+{
+    struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    *len = mem->stop - mem->here;
+    return mem->here;
+}
+
+static ssize_t mem_consume (purc_rwstream_t rws, size_t count)
+{
+    struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    if (count > (size_t)(mem->stop - mem->here)) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+    mem->here += count;
+    return count;
+}
+
 /* buffer rwstream functions */
 static int buffer_extend (struct buffer_rwstream* buffer, size_t size)
 {
@@ -1221,6 +1541,24 @@ static void* buffer_get_mem_buffer (purc_rwstream_t rws,
     return buffer->base;
 }
 
+static const void* buffer_peek (purc_rwstream_t rws, size_t *len)
+{
+    struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    *len = buffer->stop - buffer->here;
+    return buffer->here;
+}
+
+static ssize_t buffer_consume (purc_rwstream_t rws, size_t count)
+{
+    struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    if (count > (size_t)(buffer->stop - buffer->here)) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+    buffer->here += count;
+    return count;
+}
+
 #if OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
 static off_t fd_seek (purc_rwstream_t rws, off_t offset, int whence)
@@ -1269,4 +1607,15 @@ static int fd_destroy (purc_rwstream_t rws)
     return 0;
 }
 
+
+/* mmap rwstream functions */
+static int mmap_destroy (purc_rwstream_t rws)
+{
+    struct mmap_rwstream* mmap_rws = (struct mmap_rwstream *)rws;
+    if (mmap_rws->addr) {
+        munmap(mmap_rws->addr, mmap_rws->length);
+    }
+    free(rws);
+    return 0;
+}
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
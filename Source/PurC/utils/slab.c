@@ -0,0 +1,348 @@
+/*
+ * @file slab.c
+ * @brief The implementation of the size-classed slab allocator.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+#include "private/slab.h"
+#include "private/debug.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if HAVE(STDATOMIC_H)
+
+#include <stdatomic.h>
+
+#define SLAB_ALIGN          16
+#define NR_SIZE_CLASSES     (PCUTILS_SLAB_MAX_SIZE / SLAB_ALIGN)
+
+/* the chunks are aligned to their size, so that the header of the chunk
+   can be located from the address of any block in it. */
+#define SZ_CHUNK            (64 * 1024)
+
+struct slab_block {
+    struct slab_block      *next;
+};
+
+struct slab_chunk {
+    struct pcutils_slab    *slab;
+    struct slab_chunk      *next;
+    unsigned int            cls;
+};
+
+#define SZ_CHUNK_HEADER     \
+    ((sizeof(struct slab_chunk) + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1))
+
+struct slab_class {
+    struct slab_block      *free_list;
+    size_t                  nr_free;
+
+    /* the blocks not carved out yet in the newest chunk */
+    char                   *bump;
+    char                   *bump_end;
+};
+
+struct pcutils_slab {
+    struct slab_class       classes[NR_SIZE_CLASSES];
+
+    struct slab_chunk      *chunks;
+    size_t                  nr_chunks;
+
+    /* the blocks allocated minus the blocks freed by the owner */
+    size_t                  nr_allocated;
+
+    /* the blocks freed by other threads */
+    _Atomic(struct slab_block *)    remote_frees;
+    atomic_size_t                   nr_remote_frees;
+
+    atomic_bool             orphaned;
+    atomic_flag             released;
+};
+
+static inline unsigned int
+size_to_class(size_t size)
+{
+    if (size == 0)
+        size = 1;
+    return (unsigned int)((size + SLAB_ALIGN - 1) / SLAB_ALIGN - 1);
+}
+
+static inline size_t
+class_to_size(unsigned int cls)
+{
+    return (cls + 1) * SLAB_ALIGN;
+}
+
+static inline struct slab_chunk *
+chunk_of(void *p)
+{
+    return (struct slab_chunk *)((uintptr_t)p & ~((uintptr_t)SZ_CHUNK - 1));
+}
+
+pcutils_slab *
+pcutils_slab_new(void)
+{
+    pcutils_slab *slab = calloc(1, sizeof(*slab));
+    if (slab) {
+        atomic_init(&slab->remote_frees, NULL);
+        atomic_init(&slab->nr_remote_frees, 0);
+        atomic_init(&slab->orphaned, false);
+        atomic_flag_clear(&slab->released);
+    }
+
+    return slab;
+}
+
+static void
+slab_release(pcutils_slab *slab)
+{
+    if (atomic_flag_test_and_set(&slab->released))
+        return;
+
+    struct slab_chunk *chunk = slab->chunks;
+    while (chunk) {
+        struct slab_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(slab);
+}
+
+void
+pcutils_slab_delete(pcutils_slab *slab)
+{
+    if (slab == NULL)
+        return;
+
+    atomic_store(&slab->orphaned, true);
+    if (atomic_load(&slab->nr_remote_frees) == slab->nr_allocated)
+        slab_release(slab);
+}
+
+static bool
+collect_remote_frees(pcutils_slab *slab)
+{
+    struct slab_block *block;
+    block = atomic_exchange(&slab->remote_frees, NULL);
+    if (block == NULL)
+        return false;
+
+    while (block) {
+        struct slab_block *next = block->next;
+        struct slab_class *c = slab->classes + chunk_of(block)->cls;
+
+        block->next = c->free_list;
+        c->free_list = block;
+        c->nr_free++;
+        block = next;
+    }
+
+    return true;
+}
+
+static bool
+new_chunk(pcutils_slab *slab, unsigned int cls)
+{
+    void *mem;
+    if (posix_memalign(&mem, SZ_CHUNK, SZ_CHUNK))
+        return false;
+
+    struct slab_chunk *chunk = mem;
+    chunk->slab = slab;
+    chunk->cls = cls;
+    chunk->next = slab->chunks;
+    slab->chunks = chunk;
+    slab->nr_chunks++;
+
+    struct slab_class *c = slab->classes + cls;
+    size_t sz_block = class_to_size(cls);
+    c->bump = (char *)mem + SZ_CHUNK_HEADER;
+    c->bump_end = c->bump +
+        (SZ_CHUNK - SZ_CHUNK_HEADER) / sz_block * sz_block;
+    return true;
+}
+
+/*
+ * The slab for the callers having no slab of their own, for example, the
+ * variants made before purc_init_ex() or on a thread without instance.
+ * The blocks can not be served by calloc() because they are freed as the
+ * other blocks, so they come from this slab, which is shared by threads,
+ * guarded by a spin lock (it is used rarely), and never deleted.
+ */
+static pcutils_slab *shared_slab;
+static atomic_flag shared_slab_lock = ATOMIC_FLAG_INIT;
+
+static void *
+alloc_from_shared_slab(size_t size)
+{
+    void *p = NULL;
+
+    while (atomic_flag_test_and_set_explicit(&shared_slab_lock,
+                memory_order_acquire))
+        ;
+
+    if (shared_slab == NULL)
+        shared_slab = pcutils_slab_new();
+    if (shared_slab)
+        p = pcutils_slab_alloc0(shared_slab, size);
+
+    atomic_flag_clear_explicit(&shared_slab_lock, memory_order_release);
+    return p;
+}
+
+void *
+pcutils_slab_alloc0(pcutils_slab *slab, size_t size)
+{
+    if (size > PCUTILS_SLAB_MAX_SIZE)
+        return calloc(1, size);
+
+    if (slab == NULL)
+        return alloc_from_shared_slab(size);
+
+    unsigned int cls = size_to_class(size);
+    struct slab_class *c = slab->classes + cls;
+    void *p;
+
+    if (c->free_list == NULL && c->bump == c->bump_end &&
+            !(collect_remote_frees(slab) && c->free_list) &&
+            !new_chunk(slab, cls)) {
+        return NULL;
+    }
+
+    if (c->free_list) {
+        p = c->free_list;
+        c->free_list = c->free_list->next;
+        c->nr_free--;
+    }
+    else {
+        p = c->bump;
+        c->bump += class_to_size(cls);
+    }
+
+    slab->nr_allocated++;
+    memset(p, 0, size);
+    return p;
+}
+
+void
+pcutils_slab_free(pcutils_slab *slab, size_t size, void *p)
+{
+    if (p == NULL)
+        return;
+
+    if (size > PCUTILS_SLAB_MAX_SIZE) {
+        free(p);
+        return;
+    }
+
+    struct slab_chunk *chunk = chunk_of(p);
+    struct slab_block *block = p;
+    pcutils_slab *owner = chunk->slab;
+    PC_ASSERT(chunk->cls == size_to_class(size));
+
+    if (owner == slab) {
+        struct slab_class *c = slab->classes + chunk->cls;
+        block->next = c->free_list;
+        c->free_list = block;
+        c->nr_free++;
+        slab->nr_allocated--;
+        return;
+    }
+
+    /* freed by another thread */
+    struct slab_block *head = atomic_load(&owner->remote_frees);
+    do {
+        block->next = head;
+    } while (!atomic_compare_exchange_weak(&owner->remote_frees,
+                &head, block));
+
+    size_t nr = atomic_fetch_add(&owner->nr_remote_frees, 1) + 1;
+    if (atomic_load(&owner->orphaned) && nr == owner->nr_allocated)
+        slab_release(owner);
+}
+
+void
+pcutils_slab_get_stat(pcutils_slab *slab, struct pcutils_slab_stat *stat)
+{
+    memset(stat, 0, sizeof(*stat));
+    if (slab == NULL)
+        return;
+
+    stat->nr_chunks = slab->nr_chunks;
+    stat->sz_chunks = slab->nr_chunks * SZ_CHUNK;
+    stat->nr_used = slab->nr_allocated - atomic_load(&slab->nr_remote_frees);
+    for (unsigned int i = 0; i < NR_SIZE_CLASSES; i++) {
+        struct slab_class *c = slab->classes + i;
+        stat->nr_free += c->nr_free;
+        stat->nr_free += (c->bump_end - c->bump) / class_to_size(i);
+    }
+}
+
+#else /* HAVE(STDATOMIC_H) */
+
+/* fall back to malloc() and free() */
+struct pcutils_slab {
+    size_t                  nr_used;
+};
+
+pcutils_slab *
+pcutils_slab_new(void)
+{
+    return calloc(1, sizeof(struct pcutils_slab));
+}
+
+void
+pcutils_slab_delete(pcutils_slab *slab)
+{
+    free(slab);
+}
+
+void *
+pcutils_slab_alloc0(pcutils_slab *slab, size_t size)
+{
+    void *p = calloc(1, size);
+    if (p && slab)
+        slab->nr_used++;
+    return p;
+}
+
+void
+pcutils_slab_free(pcutils_slab *slab, size_t size, void *p)
+{
+    UNUSED_PARAM(size);
+    if (p && slab && slab->nr_used)
+        slab->nr_used--;
+    free(p);
+}
+
+void
+pcutils_slab_get_stat(pcutils_slab *slab, struct pcutils_slab_stat *stat)
+{
+    memset(stat, 0, sizeof(*stat));
+    if (slab)
+        stat->nr_used = slab->nr_used;
+}
+
+#endif /* !HAVE(STDATOMIC_H) */
@@ -32,6 +32,7 @@
 #include "private/tls.h"
 #include "private/variant.h"
 #include "private/utf8.h"
+#include "private/hashtable.h"
 
 #include "variant-internals.h"
 
@@ -198,6 +199,59 @@ void pcvariant_longdouble_release(purc_variant_t val)
     free(val->ld);
 }
 
+void *pcvariant_alloc_extra_bytes(purc_variant_t value, size_t sz)
+{
+    void *bytes;
+
+    if (sz <= MAX_SZ_SLAB_DATA) {
+        struct pcvariant_slab_data *data;
+        data = pcvariant_node_alloc0(SZ_SLAB_DATA_HEADER + sz);
+        if (data == NULL)
+            return NULL;
+
+        bytes = data->bytes;
+        value->flags = PCVRNT_FLAG_EXTRA_SIZE | PCVRNT_FLAG_SLAB_DATA;
+    }
+    else {
+        bytes = calloc(1, sz);
+        if (bytes == NULL)
+            return NULL;
+
+        value->flags = PCVRNT_FLAG_EXTRA_SIZE;
+    }
+
+    value->ptr2 = bytes;
+    pcvariant_stat_set_extra_size(value, sz);
+    return bytes;
+}
+
+void pcvariant_free_extra_bytes(purc_variant_t value)
+{
+    if (value->flags & PCVRNT_FLAG_SLAB_DATA) {
+        pcvariant_node_free(SZ_SLAB_DATA_HEADER + value->extra_size,
+                pcvariant_slab_data(value));
+    }
+    else {
+        free(value->ptr2);
+    }
+
+    pcvariant_stat_set_extra_size(value, 0);
+}
+
+uint32_t pcvariant_string_hash(purc_variant_t value)
+{
+    const char *str = purc_variant_get_string_const(value);
+
+    if (value->flags & PCVRNT_FLAG_SLAB_DATA) {
+        struct pcvariant_slab_data *data = pcvariant_slab_data(value);
+        if (data->hash == 0)
+            data->hash = pchash_fnv1a_str_hash(str);
+        return data->hash;
+    }
+
+    return pchash_fnv1a_str_hash(str);
+}
+
 purc_variant_t
 purc_variant_make_string(const char* str_utf8, bool check_encoding)
 {
@@ -244,19 +298,15 @@ purc_variant_make_string_ex(const char* str_utf8, size_t len,
     }
     else {
         char* new_buf;
-        new_buf = malloc(len + 1);
+        new_buf = pcvariant_alloc_extra_bytes(value, len + 1);
         if (new_buf == NULL) {
             pcvariant_put(value);
             pcinst_set_error (PURC_ERROR_OUT_OF_MEMORY);
             return PURC_VARIANT_INVALID;
         }
 
-        value->flags = PCVRNT_FLAG_EXTRA_SIZE;
         value->len = len + 1;
-        value->ptr2 = new_buf;
         memcpy(new_buf, str_utf8, len);
-        new_buf[len] = '\0';
-        pcvariant_stat_set_extra_size(value, len + 1);
     }
 
     return value;
@@ -431,8 +481,7 @@ void pcvariant_string_release(purc_variant_t string)
 
     if (IS_TYPE(string, PURC_VARIANT_TYPE_STRING)) {
         if (string->flags & PCVRNT_FLAG_EXTRA_SIZE) {
-            free(string->ptr2);
-            pcvariant_stat_set_extra_size(string, 0);
+            pcvariant_free_extra_bytes(string);
         }
     }
     else
@@ -573,9 +622,7 @@ purc_variant_t purc_variant_make_byte_sequence(const void* bytes,
         memcpy(value->bytes, bytes, nr_bytes);
     }
     else {
-        value->flags = PCVRNT_FLAG_EXTRA_SIZE;
-        value->ptr2 = malloc(nr_bytes);
-        if (value->ptr2 == NULL) {
+        if (pcvariant_alloc_extra_bytes(value, nr_bytes) == NULL) {
             pcvariant_put(value);
             pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return PURC_VARIANT_INVALID;
@@ -583,7 +630,6 @@ purc_variant_t purc_variant_make_byte_sequence(const void* bytes,
 
         value->len = nr_bytes;
         memcpy(value->ptr2, bytes, nr_bytes);
-        pcvariant_stat_set_extra_size(value, nr_bytes);
     }
 
     return value;
@@ -612,6 +658,44 @@ purc_variant_t purc_variant_make_byte_sequence_static(const void* bytes,
     return value;
 }
 
+struct bsequence_release_hook {
+    pcvrnt_bsequence_release_cb release;
+    void                       *ctxt;
+};
+
+/* Since 0.9.26 */
+purc_variant_t purc_variant_make_byte_sequence_external(const void* bytes,
+        size_t nr_bytes, pcvrnt_bsequence_release_cb release, void *ctxt)
+{
+    PCVRNT_CHECK_FAIL_RET((bytes != NULL && nr_bytes > 0 && release != NULL),
+        PURC_VARIANT_INVALID);
+
+    struct bsequence_release_hook *hook = malloc(sizeof(*hook));
+    if (hook == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t value = pcvariant_get(PURC_VARIANT_TYPE_BSEQUENCE);
+    if (value == NULL) {
+        free(hook);
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    hook->release = release;
+    hook->ctxt = ctxt;
+
+    value->type = PURC_VARIANT_TYPE_BSEQUENCE;
+    value->flags = PCVRNT_FLAG_STATIC_DATA | PCVRNT_FLAG_RELEASE_HOOK;
+    value->refc = 1;
+    value->len = nr_bytes;
+    value->ptr2 = (void *)bytes;
+    value->extra_data = hook;
+
+    return value;
+}
+
 purc_variant_t purc_variant_make_byte_sequence_reuse_buff(void* bytes,
         size_t nr_bytes, size_t sz_buff)
 {
@@ -679,16 +763,13 @@ purc_variant_t purc_variant_make_byte_sequence_empty_ex(size_t sz_buf)
     value->refc = 1;
 
     if (sz_buf > sz_in_space) {
-        void *buf = calloc(1, sz_buf);
-        if (buf == NULL) {
+        if (pcvariant_alloc_extra_bytes(value, sz_buf) == NULL) {
+            pcvariant_put(value);
             pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             return PURC_VARIANT_INVALID;
         }
 
-        value->flags = PCVRNT_FLAG_EXTRA_SIZE;
         value->len = 0;
-        value->ptr2 = buf;
-        pcvariant_stat_set_extra_size(value, sz_buf);
     }
     else {
         value->flags = 0;
@@ -932,8 +1013,13 @@ void pcvariant_sequence_release(purc_variant_t sequence)
 
     if (IS_TYPE(sequence, PURC_VARIANT_TYPE_BSEQUENCE)) {
         if (sequence->flags & PCVRNT_FLAG_EXTRA_SIZE) {
-            free(sequence->ptr2);
-            pcvariant_stat_set_extra_size(sequence, 0);
+            pcvariant_free_extra_bytes(sequence);
+        }
+        else if (sequence->flags & PCVRNT_FLAG_RELEASE_HOOK) {
+            struct bsequence_release_hook *hook = sequence->extra_data;
+            hook->release(hook->ctxt);
+            free(hook);
+            sequence->extra_data = NULL;
         }
     }
     else
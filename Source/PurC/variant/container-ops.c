@@ -28,9 +28,11 @@
 #include "variant-internals.h"
 #include "purc-errors.h"
 #include "purc-utils.h"
+#include "private/hashtable.h"
 
-
+#include <float.h>
 #include <limits.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
@@ -283,6 +285,364 @@ end:
     return ret;
 }
 
+/*
+ * Removing the members of a source container from an array by scanning
+ * the array for every member is O(n*m). When the source has no less than
+ * MIN_MEMBERS_TO_INDEX members, we build a temporary index of the array
+ * which is consistent with PCVRNT_COMPARE_METHOD_AUTO instead:
+ *
+ *  - a member which is a number (number, longint, ulongint, longdouble, or
+ *    bigint) is compared with others by its numerified value, so such
+ *    members are sorted by the values and looked up by binary search in
+ *    the range of the values equal to the given one;
+ *  - other members are compared with others by the stringified values,
+ *    so they are hashed by the stringified values.
+ *
+ * The candidates found by the index are always confirmed by
+ * purc_variant_compare_ex().
+ */
+#define MIN_MEMBERS_TO_INDEX    8
+
+#define NO_ENTRY                ((size_t)-1)
+
+struct member_entry {
+    char           *str;        // the stringified member; NULL for numbers
+    double          d;          // the numerified value of a number
+    size_t          pos;        // the position in the sorted numbers
+    size_t          next;       // the next entry in the same bucket
+    uint32_t        hash;
+    bool            removed;
+};
+
+struct member_index {
+    purc_variant_t          array;
+    struct member_entry    *entries;    // one entry per member in order
+    size_t                  nr_entries;
+
+    size_t                 *buckets;
+    size_t                  nr_buckets; // always a power of 2
+    size_t                  nr_strings;
+
+    size_t                 *numbers;    // indices of numbers sorted by value
+    size_t                 *group_ends; // ends of the groups of equal values
+    size_t                 *alive;      // the next position not removed
+    size_t                  nr_numbers;
+};
+
+static inline bool
+is_number_member(purc_variant_t v)
+{
+    switch (v->type) {
+    case PURC_VARIANT_TYPE_NUMBER:
+    case PURC_VARIANT_TYPE_LONGINT:
+    case PURC_VARIANT_TYPE_ULONGINT:
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+    case PURC_VARIANT_TYPE_BIGINT:
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+struct sorted_number {
+    double          d;
+    size_t          idx;
+};
+
+/* NaNs are placed after all other values. */
+static inline int
+compare_values(double a, double b)
+{
+    if (isnan(a) || isnan(b))
+        return isnan(a) - isnan(b);
+    return (a > b) - (a < b);
+}
+
+static int
+compare_sorted_numbers(const void *a, const void *b)
+{
+    const struct sorted_number *na = a;
+    const struct sorted_number *nb = b;
+
+    int ret = compare_values(na->d, nb->d);
+    if (ret == 0)
+        ret = (na->idx > nb->idx) - (na->idx < nb->idx);
+    return ret;
+}
+
+static void
+member_index_release(struct member_index *mi)
+{
+    if (mi->entries) {
+        for (size_t i = 0; i < mi->nr_entries; i++)
+            free(mi->entries[i].str);
+        free(mi->entries);
+    }
+    free(mi->buckets);
+    free(mi->numbers);
+}
+
+static int
+sort_numbers(struct member_index *mi)
+{
+    struct sorted_number *sorted;
+    size_t n = mi->nr_numbers;
+
+    sorted = malloc(sizeof(*sorted) * n);
+    if (sorted == NULL)
+        return -1;
+
+    for (size_t i = 0; i < n; i++) {
+        sorted[i].idx = mi->numbers[i];
+        sorted[i].d = mi->entries[sorted[i].idx].d;
+    }
+    qsort(sorted, n, sizeof(*sorted), compare_sorted_numbers);
+
+    for (size_t i = n; i > 0; i--) {
+        size_t pos = i - 1;
+        mi->numbers[pos] = sorted[pos].idx;
+        mi->entries[sorted[pos].idx].pos = pos;
+        if (i < n && compare_values(sorted[pos].d, sorted[i].d) == 0)
+            mi->group_ends[pos] = mi->group_ends[i];
+        else
+            mi->group_ends[pos] = i;
+        mi->alive[pos] = pos;
+    }
+    mi->alive[n] = n;
+
+    free(sorted);
+    return 0;
+}
+
+static int
+member_index_init(struct member_index *mi, purc_variant_t array)
+{
+    size_t nr = purc_variant_array_get_size(array);
+
+    memset(mi, 0, sizeof(*mi));
+    mi->array = array;
+    mi->nr_entries = nr;
+
+    mi->nr_buckets = 16;
+    while (mi->nr_buckets < nr * 2)
+        mi->nr_buckets <<= 1;
+
+    mi->entries = calloc(nr ? nr : 1, sizeof(*mi->entries));
+    mi->buckets = malloc(sizeof(*mi->buckets) * mi->nr_buckets);
+    /* numbers, group_ends, and alive share the same block. */
+    mi->numbers = malloc(sizeof(*mi->numbers) * (nr * 3 + 1));
+    if (mi->entries == NULL || mi->buckets == NULL || mi->numbers == NULL)
+        goto failed;
+
+    mi->group_ends = mi->numbers + nr;
+    mi->alive = mi->group_ends + nr;
+    for (size_t i = 0; i < mi->nr_buckets; i++)
+        mi->buckets[i] = NO_ENTRY;
+
+    /* insert in reverse order so that every bucket is in ascending order */
+    for (size_t i = nr; i > 0; i--) {
+        size_t idx = i - 1;
+        struct member_entry *e = mi->entries + idx;
+        purc_variant_t v = purc_variant_array_get(array, idx);
+
+        if (is_number_member(v)) {
+            e->d = purc_variant_numerify(v);
+            mi->numbers[mi->nr_numbers++] = idx;
+        }
+        else {
+            if (purc_variant_stringify_alloc(&e->str, v) < 0) {
+                e->str = NULL;
+                goto failed;
+            }
+
+            if (purc_variant_is_string(v))
+                e->hash = pcvariant_string_hash(v);
+            else
+                e->hash = pchash_fnv1a_str_hash(e->str);
+            size_t *bucket = mi->buckets + (e->hash & (mi->nr_buckets - 1));
+            e->next = *bucket;
+            *bucket = idx;
+            mi->nr_strings++;
+        }
+    }
+
+    if (mi->nr_numbers > 0 && sort_numbers(mi))
+        goto failed;
+
+    return 0;
+
+failed:
+    member_index_release(mi);
+    pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return -1;
+}
+
+static inline bool
+is_same_member(struct member_index *mi, size_t idx, purc_variant_t v)
+{
+    purc_variant_t val = purc_variant_array_get(mi->array, idx);
+    return purc_variant_compare_ex(val, v, PCVRNT_COMPARE_METHOD_AUTO) == 0;
+}
+
+static size_t
+lookup_string(struct member_index *mi, purc_variant_t v, const char *str)
+{
+    uint32_t hash = purc_variant_is_string(v) ?
+        pcvariant_string_hash(v) : pchash_fnv1a_str_hash(str);
+    size_t *link = mi->buckets + (hash & (mi->nr_buckets - 1));
+
+    while (*link != NO_ENTRY) {
+        struct member_entry *e = mi->entries + *link;
+        if (e->removed) {
+            /* unlink the removed entry */
+            *link = e->next;
+            continue;
+        }
+
+        if (e->hash == hash && strcmp(e->str, str) == 0 &&
+                is_same_member(mi, *link, v))
+            return *link;
+
+        link = &e->next;
+    }
+
+    return NO_ENTRY;
+}
+
+static size_t
+next_alive(struct member_index *mi, size_t pos)
+{
+    while (mi->alive[pos] != pos) {
+        mi->alive[pos] = mi->alive[mi->alive[pos]];
+        pos = mi->alive[pos];
+    }
+    return pos;
+}
+
+static size_t
+lookup_number(struct member_index *mi, purc_variant_t v)
+{
+    double x = purc_variant_numerify(v);
+    double lo = x, hi = x;
+
+    /* the values equal to x in pcutils_equal_doubles() */
+    if (isfinite(x)) {
+        double delta = 2 * DBL_EPSILON * fabs(x);
+        lo = x - delta;
+        hi = x + delta;
+    }
+
+    size_t first = 0, last = mi->nr_numbers;
+    while (first < last) {
+        size_t mid = first + (last - first) / 2;
+        if (compare_values(mi->entries[mi->numbers[mid]].d, lo) < 0)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    /*
+     * The members of a group have the same numerified value, but they may
+     * not all equal to v (e.g., two longints differing only beyond the
+     * precision of double); the members of a group are in ascending order
+     * of index, so the first matched one in a group has the smallest index.
+     */
+    size_t found = NO_ENTRY;
+    size_t pos = next_alive(mi, first);
+    while (pos < mi->nr_numbers) {
+        size_t idx = mi->numbers[pos];
+        double d = mi->entries[idx].d;
+
+        if (isnan(x) ? !isnan(d) : compare_values(d, hi) > 0)
+            break;
+
+        size_t end = mi->group_ends[pos];
+        for (; pos < end; pos = next_alive(mi, pos + 1)) {
+            idx = mi->numbers[pos];
+            if (idx >= found)
+                break;
+            if (is_same_member(mi, idx, v)) {
+                found = idx;
+                break;
+            }
+        }
+
+        pos = next_alive(mi, end);
+    }
+
+    return found;
+}
+
+static int
+member_index_match(struct member_index *mi, purc_variant_t v, size_t *idx)
+{
+    size_t found = NO_ENTRY;
+
+    if (v->type == PURC_VARIANT_TYPE_BIGINT) {
+        /* a bigint may equal to a string: do not use the index */
+        for (size_t i = 0; i < mi->nr_entries; i++) {
+            if (!mi->entries[i].removed && is_same_member(mi, i, v)) {
+                found = i;
+                break;
+            }
+        }
+    }
+    else {
+        if (mi->nr_strings > 0 && purc_variant_is_string(v)) {
+            /* no need to stringify a string */
+            found = lookup_string(mi, v, purc_variant_get_string_const(v));
+        }
+        else if (mi->nr_strings > 0) {
+            char *str;
+            if (purc_variant_stringify_alloc(&str, v) < 0) {
+                pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+                return -1;
+            }
+
+            found = lookup_string(mi, v, str);
+            free(str);
+        }
+
+        if (mi->nr_numbers > 0) {
+            size_t n = lookup_number(mi, v);
+            if (n < found)
+                found = n;
+        }
+    }
+
+    *idx = found;
+    return 0;
+}
+
+static void
+member_index_remove(struct member_index *mi, size_t idx)
+{
+    struct member_entry *e = mi->entries + idx;
+
+    e->removed = true;
+    if (e->str == NULL)
+        mi->alive[e->pos] = e->pos + 1;
+}
+
+static bool
+match_array_member(void* ctxt, purc_variant_t member,
+        purc_variant_t member_extra, bool silently)
+{
+    UNUSED_PARAM(member_extra);
+    UNUSED_PARAM(silently);
+    struct member_index *mi = ctxt;
+    size_t idx;
+
+    if (member_index_match(mi, member, &idx))
+        return false;
+
+    if (idx != NO_ENTRY)
+        member_index_remove(mi, idx);
+    return true;
+}
+
 static purc_variant_t
 clone_if_necessary(purc_variant_t val)
 {
@@ -484,6 +844,48 @@ end:
     return ret;
 }
 
+static bool
+array_remove_indexed(purc_variant_t dst, purc_variant_t src,
+        enum purc_variant_type type, bool silently)
+{
+    struct member_index mi;
+    bool ret;
+
+    if (member_index_init(&mi, dst))
+        return false;
+
+    /* match the members first, then remove them from the end */
+    if (type == PURC_VARIANT_TYPE_ARRAY) {
+        ret = array_foreach(src, match_array_member, &mi, silently);
+    }
+    else if (type == PURC_VARIANT_TYPE_SET) {
+        ret = set_foreach(src, match_array_member, &mi, silently);
+    }
+    else {
+        ret = tuple_foreach(src, match_array_member, &mi, silently);
+    }
+
+    /* compact the array in one pass instead of removing one by one */
+    bool *marked = NULL;
+    if (ret && mi.nr_entries > 0) {
+        marked = malloc(sizeof(*marked) * mi.nr_entries);
+        if (marked == NULL) {
+            SET_SILENT_ERROR(PURC_ERROR_OUT_OF_MEMORY);
+            ret = false;
+        }
+    }
+
+    if (marked) {
+        for (size_t i = 0; i < mi.nr_entries; i++)
+            marked[i] = mi.entries[i].removed;
+        ret = pcvariant_array_remove_marked(dst, marked, mi.nr_entries);
+        free(marked);
+    }
+
+    member_index_release(&mi);
+    return ret;
+}
+
 static bool
 array_remove(purc_variant_t dst, purc_variant_t src, bool silently)
 {
@@ -497,14 +899,17 @@ array_remove(purc_variant_t dst, purc_variant_t src, bool silently)
         goto end;
     }
 
-    if (type == PURC_VARIANT_TYPE_ARRAY) {
+    if (purc_variant_linear_container_get_size(src) >= MIN_MEMBERS_TO_INDEX) {
+        ret = array_remove_indexed(dst, src, type, silently);
+    }
+    else if (type == PURC_VARIANT_TYPE_ARRAY) {
         ret = array_foreach(src, remove_array_member, dst, silently);
     }
     else if (type == PURC_VARIANT_TYPE_SET) {
         ret = set_foreach(src, remove_array_member, dst, silently);
     }
     else {
-        ret = tuple_foreach(src, append_array_member, dst, silently);
+        ret = tuple_foreach(src, remove_array_member, dst, silently);
     }
 
 end:
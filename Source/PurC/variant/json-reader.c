@@ -0,0 +1,379 @@
+/**
+ * @file json-reader.c
+ * @brief Reading the records of JSON data in a stream one by one.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "purc-variant.h"
+#include "purc-rwstream.h"
+#include "purc-errors.h"
+#include "private/errors.h"
+#include "private/debug.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The reader does not parse the data by itself. It scans the stream to
+ * find the extent of a record by tracking the nesting of the brackets and
+ * the strings only, and then parses the record with the eJSON parser.
+ *
+ * The data are scanned in the read buffer of the stream via
+ * purc_rwstream_peek(), and only the bytes of the records are consumed,
+ * so nothing is read ahead behind the back of the other readers.
+ */
+
+#define SZ_MIN_RECORD           256
+
+enum reader_state {
+    RS_START = 0,       // before the first record
+    RS_BETWEEN,         // between two records
+    RS_IN_RECORD,       // in a record
+    RS_DONE,            // no more record
+};
+
+struct pcvrnt_json_reader {
+    purc_rwstream_t         stream;
+    pcvrnt_json_records_k   records;
+    enum reader_state       state;
+    bool                    in_array;   // in the top-level array
+
+    /* the current record */
+    char                   *rec;
+    size_t                  nr_rec;
+    size_t                  sz_rec;
+    size_t                  depth;      // the depth of nested containers
+    char                    quote;      // the quote of the current string
+    unsigned                nr_quotes;  // the number of successive quotes
+    bool                    triple;     // in a triple-quoted string
+    bool                    escaped;    // after a backslash in a string
+    bool                    bare;       // a number, true, false, or null
+};
+
+/* a null character is taken as a space, e.g., at the end of a string */
+static inline bool
+is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0';
+}
+
+/* the characters end a bare value */
+static inline bool
+is_delimiter(char c)
+{
+    return is_space(c) || c == ',' || c == ']' || c == '}' ||
+        c == '[' || c == '{' || c == '"' || c == '\'';
+}
+
+pcvrnt_json_reader_t
+purc_variant_json_reader_new(purc_rwstream_t stream,
+        pcvrnt_json_records_k records)
+{
+    if (stream == NULL || records > PCVRNT_JSON_RECORDS_LINES) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    struct pcvrnt_json_reader *reader = calloc(1, sizeof(*reader));
+    if (reader == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    reader->stream = stream;
+    reader->records = records;
+    reader->state = RS_START;
+    return reader;
+}
+
+void
+purc_variant_json_reader_delete(pcvrnt_json_reader_t reader)
+{
+    if (reader == NULL)
+        return;
+
+    free(reader->rec);
+    free(reader);
+}
+
+static int
+append_record(struct pcvrnt_json_reader *reader, const char *data, size_t n)
+{
+    if (reader->nr_rec + n > reader->sz_rec) {
+        size_t sz = reader->sz_rec ? reader->sz_rec * 2 : SZ_MIN_RECORD;
+        while (sz < reader->nr_rec + n)
+            sz *= 2;
+
+        char *rec = realloc(reader->rec, sz);
+        if (rec == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+
+        reader->rec = rec;
+        reader->sz_rec = sz;
+    }
+
+    memcpy(reader->rec + reader->nr_rec, data, n);
+    reader->nr_rec += n;
+    return 0;
+}
+
+static void
+begin_record(struct pcvrnt_json_reader *reader, char first)
+{
+    reader->nr_rec = 0;
+    reader->depth = 0;
+    reader->quote = 0;
+    reader->nr_quotes = 0;
+    reader->triple = false;
+    reader->escaped = false;
+    reader->bare = !(first == '{' || first == '[' ||
+            first == '"' || first == '\'');
+    reader->state = RS_IN_RECORD;
+}
+
+/*
+ * Gives the partially read record back to the stream, so that the stream
+ * can be read by others; the record will be scanned again by the next call.
+ */
+static void
+give_back_record(struct pcvrnt_json_reader *reader)
+{
+    if (reader->state == RS_IN_RECORD && reader->nr_rec > 0 &&
+            purc_rwstream_ungetc(reader->stream, reader->rec,
+                (int)reader->nr_rec) == (int)reader->nr_rec) {
+        reader->nr_rec = 0;
+        reader->state = RS_BETWEEN;
+    }
+}
+
+/*
+ * Scans the data for the end of the current record; returns true if
+ * the record ends in the data. @end returns the position scanned to.
+ *
+ * Like eJSON, a string can be enclosed in triple quotes (''' or """),
+ * in which a backslash or a single quote has no special meaning.
+ */
+static bool
+scan_record(struct pcvrnt_json_reader *reader, const char *data, size_t len,
+        size_t *end)
+{
+    size_t pos = 0;
+    bool done = false;
+
+    while (pos < len && !done) {
+        char c = data[pos];
+
+        if (reader->bare) {
+            /* the delimiter does not belong to the record */
+            if (reader->nr_rec + pos > 0 && is_delimiter(c)) {
+                done = true;
+                break;
+            }
+        }
+        else if (reader->quote && !reader->triple && reader->nr_quotes > 0) {
+            /* one or two quotes are seen at the beginning of a string */
+            if (c == reader->quote) {
+                if (++reader->nr_quotes == 3) {
+                    reader->nr_quotes = 0;
+                    reader->triple = true;
+                }
+            }
+            else if (reader->nr_quotes == 2) {
+                /* an empty string; scan the character again */
+                reader->nr_quotes = 0;
+                reader->quote = 0;
+                if (reader->depth == 0)
+                    done = true;
+                continue;
+            }
+            else {
+                /* an ordinary string; scan the character again */
+                reader->nr_quotes = 0;
+                continue;
+            }
+        }
+        else if (reader->triple) {
+            if (c != reader->quote) {
+                reader->nr_quotes = 0;
+            }
+            else if (++reader->nr_quotes == 3) {
+                reader->nr_quotes = 0;
+                reader->triple = false;
+                reader->quote = 0;
+                done = (reader->depth == 0);
+            }
+        }
+        else if (reader->quote) {
+            if (reader->escaped)
+                reader->escaped = false;
+            else if (c == '\\')
+                reader->escaped = true;
+            else if (c == reader->quote) {
+                reader->quote = 0;
+                done = (reader->depth == 0);
+            }
+        }
+        else if (c == '"' || c == '\'') {
+            reader->quote = c;
+            reader->nr_quotes = 1;
+        }
+        else if (c == '{' || c == '[') {
+            reader->depth++;
+        }
+        else if (c == '}' || c == ']') {
+            if (--reader->depth == 0)
+                done = true;
+        }
+
+        pos++;
+    }
+
+    *end = pos;
+    return done;
+}
+
+/* Returns true if the current record is complete at the end of data. */
+static inline bool
+is_record_complete(struct pcvrnt_json_reader *reader)
+{
+    /* a bare value, or an empty string at the top level */
+    return reader->bare || (reader->quote && !reader->triple &&
+            reader->nr_quotes == 2 && reader->depth == 0);
+}
+
+static purc_variant_t
+parse_record(struct pcvrnt_json_reader *reader)
+{
+    reader->state = RS_BETWEEN;
+    return purc_variant_make_from_json_string(reader->rec, reader->nr_rec);
+}
+
+static purc_variant_t
+no_more_records(struct pcvrnt_json_reader *reader, bool truncated)
+{
+    reader->state = RS_DONE;
+    if (truncated) {
+        PC_WARN("The JSON data is truncated.\n");
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+    }
+    else
+        purc_set_error(PURC_ERROR_NO_DATA);
+    return PURC_VARIANT_INVALID;
+}
+
+purc_variant_t
+purc_variant_json_reader_next(pcvrnt_json_reader_t reader)
+{
+    if (reader == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    while (reader->state != RS_DONE) {
+        const char *data;
+        ssize_t len;
+
+        errno = 0;
+        len = purc_rwstream_peek(reader->stream, (const void **)&data, 1);
+        if (len < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                purc_set_error(PURC_ERROR_AGAIN);
+            else if (errno != 0)
+                purc_set_error(PURC_ERROR_IO_FAILURE);
+            give_back_record(reader);
+            return PURC_VARIANT_INVALID;
+        }
+
+        if (len == 0) {
+            if (reader->state == RS_IN_RECORD) {
+                if (is_record_complete(reader))
+                    return parse_record(reader);
+                return no_more_records(reader, true);
+            }
+            return no_more_records(reader, reader->in_array);
+        }
+
+        size_t pos = 0;
+        switch (reader->state) {
+        case RS_START:
+            while (pos < (size_t)len && is_space(data[pos]))
+                pos++;
+            if (pos == (size_t)len)
+                break;
+
+            if (reader->records == PCVRNT_JSON_RECORDS_ARRAY ||
+                    (reader->records == PCVRNT_JSON_RECORDS_AUTO &&
+                     data[pos] == '[')) {
+                if (data[pos] != '[') {
+                    PC_WARN("The JSON data is not an array.\n");
+                    purc_rwstream_consume(reader->stream, pos);
+                    reader->state = RS_DONE;
+                    purc_set_error(PURC_ERROR_INVALID_VALUE);
+                    return PURC_VARIANT_INVALID;
+                }
+
+                reader->in_array = true;
+                pos++;
+            }
+            reader->state = RS_BETWEEN;
+            break;
+
+        case RS_BETWEEN:
+            while (pos < (size_t)len && (is_space(data[pos]) ||
+                        (reader->in_array && data[pos] == ',')))
+                pos++;
+            if (pos == (size_t)len)
+                break;
+
+            if (reader->in_array && data[pos] == ']') {
+                purc_rwstream_consume(reader->stream, pos + 1);
+                return no_more_records(reader, false);
+            }
+
+            begin_record(reader, data[pos]);
+            break;
+
+        case RS_IN_RECORD: {
+            bool done = scan_record(reader, data, len, &pos);
+            if (append_record(reader, data, pos))
+                return PURC_VARIANT_INVALID;
+
+            if (done) {
+                purc_rwstream_consume(reader->stream, pos);
+                return parse_record(reader);
+            }
+            break;
+        }
+
+        case RS_DONE:
+        default:
+            break;
+        }
+
+        if (pos > 0)
+            purc_rwstream_consume(reader->stream, pos);
+    }
+
+    purc_set_error(PURC_ERROR_NO_DATA);
+    return PURC_VARIANT_INVALID;
+}
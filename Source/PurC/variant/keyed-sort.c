@@ -0,0 +1,329 @@
+/**
+ * @file keyed-sort.c
+ * @brief Sorting linear containers by precomputed typed keys.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "private/variant.h"
+#include "private/errors.h"
+#include "private/utils.h"
+#include "variant-internals.h"
+#include "purc-errors.h"
+#include "purc-utils.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the length of runs sorted by insertion sort before merging */
+#define NR_INSERTION_RUN    16
+
+#define RADIX_BITS          8
+#define RADIX_BUCKETS       (1 << RADIX_BITS)
+#define RADIX_MASK          (RADIX_BUCKETS - 1)
+
+/* the minimal number of members sorted by radix sort */
+#define RADIX_SORT_MIN_MEMBERS  64
+
+struct sort_key {
+    double          d;      // for number
+    const char     *str;    // for string; NULL if the key is missing.
+    char           *buf;    // the buffer allocated for `str` if not NULL.
+};
+
+struct keyed_sort {
+    const struct pcvariant_sort_spec *spec;
+    struct sort_key *keys;  // nr_members * nr_keys keys
+};
+
+static int
+extract_string(purc_variant_t v, bool casesensitively, struct sort_key *key)
+{
+    const char *str;
+    char *buf = NULL;
+
+    if (v == PURC_VARIANT_INVALID)
+        return 0;
+
+    if (purc_variant_is_string(v)) {
+        str = purc_variant_get_string_const(v);
+    }
+    else {
+        if (purc_variant_stringify_alloc(&buf, v) < 0)
+            return -1;
+        str = buf;
+    }
+
+    if (!casesensitively) {
+        char *folded = pcutils_strtolower(str, -1, NULL);
+        free(buf);
+        if (folded == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        str = buf = folded;
+    }
+
+    key->str = str;
+    key->buf = buf;
+    return 0;
+}
+
+static int
+decorate(struct keyed_sort *ks, purc_variant_t member, size_t idx)
+{
+    const struct pcvariant_sort_spec *spec = ks->spec;
+    struct sort_key *keys = ks->keys + idx * spec->nr_keys;
+
+    for (size_t i = 0; i < spec->nr_keys; i++) {
+        purc_variant_t v = member;
+        if (spec->get_key)
+            v = spec->get_key(member, i, spec->ud);
+
+        if (spec->by_number[i]) {
+            keys[i].d = v ? purc_variant_numerify(v) : 0.0;
+        }
+        else if (extract_string(v, spec->casesensitively, keys + i)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* NaNs are placed after all other numbers. */
+static inline int
+compare_numbers(double a, double b)
+{
+    if (isnan(a) || isnan(b))
+        return isnan(a) - isnan(b);
+    return (a > b) - (a < b);
+}
+
+static int
+compare_members(const struct keyed_sort *ks, size_t l, size_t r)
+{
+    const struct pcvariant_sort_spec *spec = ks->spec;
+    const struct sort_key *lk = ks->keys + l * spec->nr_keys;
+    const struct sort_key *rk = ks->keys + r * spec->nr_keys;
+
+    for (size_t i = 0; i < spec->nr_keys; i++) {
+        int ret;
+        if (spec->by_number[i]) {
+            ret = compare_numbers(lk[i].d, rk[i].d);
+        }
+        else if (lk[i].str == NULL || rk[i].str == NULL) {
+            ret = (lk[i].str != NULL) - (rk[i].str != NULL);
+        }
+        else {
+            ret = strcmp(lk[i].str, rk[i].str);
+        }
+
+        if (ret)
+            return spec->ascendingly ? ret : -ret;
+    }
+
+    return 0;
+}
+
+/* A stable bottom-up merge sort on the indices of members. */
+static void
+merge_sort(const struct keyed_sort *ks, size_t *order, size_t *tmp,
+        size_t nr)
+{
+    for (size_t lo = 0; lo < nr; lo += NR_INSERTION_RUN) {
+        size_t hi = MIN(lo + NR_INSERTION_RUN, nr);
+        for (size_t i = lo + 1; i < hi; i++) {
+            size_t v = order[i];
+            size_t j = i;
+            while (j > lo && compare_members(ks, order[j - 1], v) > 0) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = v;
+        }
+    }
+
+    size_t *src = order, *dst = tmp;
+    for (size_t width = NR_INSERTION_RUN; width < nr; width *= 2) {
+        for (size_t lo = 0; lo < nr; lo += width * 2) {
+            size_t mid = MIN(lo + width, nr);
+            size_t hi = MIN(lo + width * 2, nr);
+            size_t i = lo, j = mid, k = lo;
+
+            while (i < mid && j < hi) {
+                if (compare_members(ks, src[j], src[i]) < 0)
+                    dst[k++] = src[j++];
+                else
+                    dst[k++] = src[i++];
+            }
+            while (i < mid)
+                dst[k++] = src[i++];
+            while (j < hi)
+                dst[k++] = src[j++];
+        }
+
+        size_t *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != order)
+        memcpy(order, src, sizeof(*order) * nr);
+}
+
+/*
+ * Maps a double to an unsigned integer keeping the order of
+ * compare_numbers(): all NaNs are mapped to the greatest value.
+ */
+static inline uint64_t
+ordered_bits(double d, bool ascendingly)
+{
+    union {
+        double      d;
+        uint64_t    u;
+    } v;
+
+    if (isnan(d))
+        return ascendingly ? UINT64_MAX : 0;
+
+    v.d = (d == 0) ? 0.0 : d;   /* -0.0 equals 0.0 */
+    if (v.u & 0x8000000000000000ULL)
+        v.u = ~v.u;
+    else
+        v.u |= 0x8000000000000000ULL;
+
+    return ascendingly ? v.u : ~v.u;
+}
+
+/* A stable LSD radix sort for the members having a single numeric key. */
+static int
+radix_sort(const struct keyed_sort *ks, size_t *order, size_t *tmp,
+        size_t nr)
+{
+    uint64_t *bits = malloc(sizeof(*bits) * nr * 2);
+    if (bits == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        bits[i] = ordered_bits(ks->keys[i].d, ks->spec->ascendingly);
+        order[i] = i;
+    }
+
+    uint64_t *src_bits = bits, *dst_bits = bits + nr;
+    size_t *src = order, *dst = tmp;
+    for (unsigned shift = 0; shift < 64; shift += RADIX_BITS) {
+        size_t counts[RADIX_BUCKETS] = { 0 };
+
+        for (size_t i = 0; i < nr; i++)
+            counts[(src_bits[i] >> shift) & RADIX_MASK]++;
+
+        /* all keys fall into the same bucket; skip this pass */
+        if (counts[(src_bits[0] >> shift) & RADIX_MASK] == nr)
+            continue;
+
+        size_t pos = 0;
+        for (size_t b = 0; b < RADIX_BUCKETS; b++) {
+            size_t n = counts[b];
+            counts[b] = pos;
+            pos += n;
+        }
+
+        for (size_t i = 0; i < nr; i++) {
+            size_t p = counts[(src_bits[i] >> shift) & RADIX_MASK]++;
+            dst_bits[p] = src_bits[i];
+            dst[p] = src[i];
+        }
+
+        uint64_t *tb = src_bits;
+        src_bits = dst_bits;
+        dst_bits = tb;
+
+        size_t *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != order)
+        memcpy(order, src, sizeof(*order) * nr);
+
+    free(bits);
+    return 0;
+}
+
+int pcvariant_sort_by_keys(purc_variant_t value,
+        const struct pcvariant_sort_spec *spec)
+{
+    struct keyed_sort ks = { spec, NULL };
+    size_t *order = NULL;
+    size_t nr, nr_decorated = 0;
+    int ret = -1;
+
+    bool is_array = purc_variant_is_array(value);
+    if (!is_array && !purc_variant_is_set(value)) {
+        pcinst_set_error(PURC_ERROR_WRONG_DATA_TYPE);
+        return -1;
+    }
+
+    if (spec->nr_keys == 0)
+        return 0;
+
+    if (!purc_variant_linear_container_size(value, &nr) || nr < 2)
+        return 0;
+
+    ks.keys = calloc(nr * spec->nr_keys, sizeof(*ks.keys));
+    order = malloc(sizeof(*order) * nr * 2);
+    if (ks.keys == NULL || order == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t member = purc_variant_linear_container_get(value, i);
+        nr_decorated++;
+        if (decorate(&ks, member, i))
+            goto out;
+    }
+
+    if (spec->nr_keys == 1 && spec->by_number[0] &&
+            nr >= RADIX_SORT_MIN_MEMBERS) {
+        if (radix_sort(&ks, order, order + nr, nr))
+            goto out;
+    }
+    else {
+        for (size_t i = 0; i < nr; i++)
+            order[i] = i;
+        merge_sort(&ks, order, order + nr, nr);
+    }
+
+    ret = is_array ? pcvariant_array_permute(value, order) :
+        pcvariant_set_permute(value, order);
+
+out:
+    if (ks.keys) {
+        for (size_t i = 0; i < nr_decorated * spec->nr_keys; i++)
+            free(ks.keys[i].buf);
+        free(ks.keys);
+    }
+    free(order);
+    return ret;
+}
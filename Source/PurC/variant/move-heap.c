@@ -67,6 +67,9 @@ static void mvheap_cleanup_once(void)
 
     PC_ASSERT(stat->nr_total_values == 4);
     PC_ASSERT(stat->sz_total_mem == 4 * sizeof(purc_variant_scalar));
+
+    pcutils_slab_delete(move_heap.slab);
+    move_heap.slab = NULL;
 }
 
 static int mvheap_init_once(void)
@@ -105,10 +108,15 @@ static int mvheap_init_once(void)
     stat->nr_max_reserved_vector = 0;  // for move heap.
 
     INIT_LIST_HEAD(&move_heap.v_reserved);
+    INIT_LIST_HEAD(&move_heap.batches);
+
+    move_heap.slab = pcutils_slab_new();
+    if (move_heap.slab == NULL)
+        return -1;
 
     purc_mutex_init(&mh_lock);
     if (mh_lock.native_impl == NULL)
-        return -1;
+        goto fail_mutex;
 
     int r;
     r = atexit(mvheap_cleanup_once);
@@ -120,6 +128,9 @@ static int mvheap_init_once(void)
 fail_atexit:
     purc_mutex_clear(&mh_lock);
 
+fail_mutex:
+    pcutils_slab_delete(move_heap.slab);
+    move_heap.slab = NULL;
     return -1;
 }
 
@@ -197,7 +208,9 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
         v->refc--;
         retv->refc++;
     }
-    else if (v->refc == 1) {
+    else if (v->refc == 1 && !(v->flags & PCVRNT_FLAG_RELEASE_HOOK)) {
+        /* a bsequence with release hook is always cloned, so that
+           the hook is called by the thread which installed it */
         PC_NONE("Move in variant type %s (%u): %s\n",
                 purc_variant_typename(v->type),
                 (unsigned)move_heap.stat.nr_values[v->type],
@@ -239,6 +252,19 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
             sz_extra = v->extra_size;
             retv->ptr2 = malloc(sz_extra);
             memcpy(retv->ptr2, v->ptr2, sz_extra);
+            /* the slab of the move heap is not used for the copy */
+            retv->flags &= ~PCVRNT_FLAG_SLAB_DATA;
+        }
+        else if (v->type == PURC_VARIANT_TYPE_BSEQUENCE &&
+                (v->flags & PCVRNT_FLAG_RELEASE_HOOK)) {
+            /* the hook belongs to the original; own a copy of the bytes */
+            sz_extra = v->len;
+            retv->ptr2 = malloc(sz_extra);
+            memcpy(retv->ptr2, v->ptr2, sz_extra);
+            retv->extra_size = sz_extra;
+            retv->flags &= ~(PCVRNT_FLAG_STATIC_DATA |
+                    PCVRNT_FLAG_RELEASE_HOOK);
+            retv->flags |= PCVRNT_FLAG_EXTRA_SIZE;
         }
 
         if (sz_extra) {
@@ -25,6 +25,7 @@
 #include "purc-errors.h"
 #include "private/debug.h"
 #include "private/errors.h"
+#include "private/instance.h"
 #include "purc-variant.h"
 #include "variant-internals.h"
 
@@ -165,16 +166,35 @@ bool pcvariant_on_pre_fired(
     return true;
 }
 
-void pcvariant_on_post_fired(
-        purc_variant_t source,  // the source variant.
-        pcvar_op_t op,          // the operation identifier.
-        size_t nr_args,         // the number of the relevant child variants.
-        purc_variant_t *argv    // the array of all relevant child variants.
-        )
+/* the operations whose post events can be coalesced in a batch */
+#define BATCHED_OPS     (PCVAR_OPERATION_INFLATED | \
+        PCVAR_OPERATION_DEFLATED | PCVAR_OPERATION_MODIFIED)
+
+#define MAX_BATCHED_ARGS    4
+
+/* a run of consecutive operations of the same kind */
+struct pcvar_batch_run {
+    pcvar_op_t          op;
+    size_t              nr_args;
+    /* the collected arguments of the operations */
+    purc_variant_t      args[MAX_BATCHED_ARGS];
+};
+
+struct pcvar_batch {
+    struct list_head    list_node;
+    purc_variant_t      ctnr;
+    unsigned int        depth;
+
+    /* the runs of the operations happened in the batch, in order */
+    struct pcvar_batch_run *runs;
+    size_t              nr_runs;
+    size_t              sz_runs;
+};
+
+static void
+fire_post_listeners(purc_variant_t source, pcvar_op_t op,
+        size_t nr_args, purc_variant_t *argv)
 {
-    op &= PCVAR_OPERATION_ALL;
-    PC_ASSERT(op != PCVAR_OPERATION_ALL);
-
     struct list_head *listeners;
     listeners = &source->listeners;
 
@@ -193,6 +213,271 @@ void pcvariant_on_post_fired(
     }
 }
 
+static inline struct pcvariant_heap *
+batch_heap(void)
+{
+    /* use the original heap; the heap will be switched when moving */
+    struct pcinst *inst = pcinst_current();
+    return inst ? inst->org_vrt_heap : NULL;
+}
+
+static struct pcvar_batch *
+find_batch(struct pcvariant_heap *heap, purc_variant_t ctnr)
+{
+    struct pcvar_batch *p;
+    list_for_each_entry(p, &heap->batches, list_node) {
+        if (p->ctnr == ctnr)
+            return p;
+    }
+
+    return NULL;
+}
+
+static void
+batch_destroy(struct pcvar_batch *batch)
+{
+    for (size_t i = 0; i < batch->nr_runs; i++) {
+        for (size_t j = 0; j < batch->runs[i].nr_args; j++)
+            PURC_VARIANT_SAFE_CLEAR(batch->runs[i].args[j]);
+    }
+    free(batch->runs);
+
+    batch->ctnr->flags &= ~PCVRNT_FLAG_IN_BATCH;
+    purc_variant_unref(batch->ctnr);
+    free(batch);
+}
+
+static struct pcvar_batch_run *
+batch_new_run(struct pcvar_batch *batch, pcvar_op_t op, size_t nr_args)
+{
+    if (batch->nr_runs == batch->sz_runs) {
+        size_t sz = batch->sz_runs ? batch->sz_runs * 2 : 4;
+        struct pcvar_batch_run *runs;
+        runs = realloc(batch->runs, sizeof(*runs) * sz);
+        if (runs == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
+        batch->runs = runs;
+        batch->sz_runs = sz;
+    }
+
+    struct pcvar_batch_run *run = batch->runs + batch->nr_runs;
+    for (size_t j = 0; j < nr_args; j++) {
+        run->args[j] = purc_variant_make_array_0();
+        if (run->args[j] == PURC_VARIANT_INVALID) {
+            while (j > 0)
+                PURC_VARIANT_SAFE_CLEAR(run->args[--j]);
+            return NULL;
+        }
+    }
+
+    run->op = op;
+    run->nr_args = nr_args;
+    batch->nr_runs++;
+    return run;
+}
+
+/* fires the events collected so far */
+static void
+batch_flush(struct pcvariant_heap *heap, struct pcvar_batch *batch)
+{
+    /* the listeners may mutate the container and append new runs */
+    for (size_t i = 0; i < batch->nr_runs; i++) {
+        struct pcvar_batch_run run = batch->runs[i];
+        purc_variant_t *saved = heap->batched_argv;
+        heap->batched_argv = run.args;
+        fire_post_listeners(batch->ctnr, run.op, run.nr_args, run.args);
+        heap->batched_argv = saved;
+
+        for (size_t j = 0; j < run.nr_args; j++)
+            purc_variant_unref(run.args[j]);
+    }
+
+    batch->nr_runs = 0;
+}
+
+/* only consecutive operations of the same kind are coalesced,
+   so that the listeners see the operations in order */
+static int
+batch_collect(struct pcvar_batch *batch, pcvar_op_t op,
+        size_t nr_args, purc_variant_t *argv)
+{
+    if (nr_args == 0 || nr_args > MAX_BATCHED_ARGS) {
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
+    for (size_t j = 0; j < nr_args; j++) {
+        /* an array can not hold undefined */
+        if (argv[j] == PURC_VARIANT_INVALID ||
+                purc_variant_is_undefined(argv[j])) {
+            pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+            return -1;
+        }
+    }
+
+    struct pcvar_batch_run *run = NULL;
+    if (batch->nr_runs > 0) {
+        run = batch->runs + batch->nr_runs - 1;
+        if (run->op != op || run->nr_args != nr_args)
+            run = NULL;
+    }
+
+    if (run == NULL && (run = batch_new_run(batch, op, nr_args)) == NULL)
+        return -1;
+
+    for (size_t j = 0; j < nr_args; j++) {
+        if (!purc_variant_array_append(run->args[j], argv[j])) {
+            /* keep the arguments aligned */
+            while (j > 0) {
+                size_t sz;
+                purc_variant_array_size(run->args[--j], &sz);
+                purc_variant_array_remove(run->args[j], sz - 1);
+            }
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+bool
+purc_variant_container_begin_batch(purc_variant_t ctnr)
+{
+    if (ctnr == PURC_VARIANT_INVALID) {
+        pcinst_set_error(PCVRNT_ERROR_WRONG_ARGS);
+        return false;
+    }
+
+    if (!IS_CONTAINER(ctnr->type)) {
+        pcinst_set_error(PCVRNT_ERROR_NOT_SUPPORTED);
+        return false;
+    }
+
+    struct pcvariant_heap *heap = batch_heap();
+    struct pcvar_batch *batch = NULL;
+    if (ctnr->flags & PCVRNT_FLAG_IN_BATCH)
+        batch = find_batch(heap, ctnr);
+
+    if (batch == NULL) {
+        batch = calloc(1, sizeof(*batch));
+        if (batch == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        batch->ctnr = purc_variant_ref(ctnr);
+        ctnr->flags |= PCVRNT_FLAG_IN_BATCH;
+        list_add(&batch->list_node, &heap->batches);
+    }
+
+    batch->depth++;
+    return true;
+}
+
+bool
+purc_variant_container_commit_batch(purc_variant_t ctnr)
+{
+    if (ctnr == PURC_VARIANT_INVALID) {
+        pcinst_set_error(PCVRNT_ERROR_WRONG_ARGS);
+        return false;
+    }
+
+    struct pcvariant_heap *heap = batch_heap();
+    struct pcvar_batch *batch = NULL;
+    if (ctnr->flags & PCVRNT_FLAG_IN_BATCH)
+        batch = find_batch(heap, ctnr);
+
+    if (batch == NULL) {
+        pcinst_set_error(PCVRNT_ERROR_WRONG_ARGS);
+        return false;
+    }
+
+    if (--batch->depth > 0)
+        return true;
+
+    /* detach the batch first, so that the listeners can mutate the
+       container or begin another batch on it */
+    list_del(&batch->list_node);
+    ctnr->flags &= ~PCVRNT_FLAG_IN_BATCH;
+
+    batch_flush(heap, batch);
+
+    batch_destroy(batch);
+    return true;
+}
+
+bool
+purc_variant_is_batched_event(size_t nr_args, purc_variant_t *argv)
+{
+    struct pcvariant_heap *heap = batch_heap();
+    return nr_args > 0 && heap && heap->batched_argv == argv;
+}
+
+bool
+purc_variant_unbatch_event(purc_variant_t source, pcvar_op_t op,
+        void *ctxt, size_t nr_args, purc_variant_t *argv,
+        pcvar_op_handler handler)
+{
+    if (!purc_variant_is_batched_event(nr_args, argv))
+        return handler(source, op, ctxt, nr_args, argv);
+
+    size_t nr_ops = 0;
+    purc_variant_array_size(argv[0], &nr_ops);
+
+    bool ok = true;
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t args[MAX_BATCHED_ARGS];
+        for (size_t j = 0; j < nr_args; j++)
+            args[j] = purc_variant_array_get(argv[j], i);
+
+        if (!handler(source, op, ctxt, nr_args, args))
+            ok = false;
+    }
+
+    return ok;
+}
+
+void
+pcvariant_release_batches(struct pcvariant_heap *heap)
+{
+    struct pcvar_batch *p, *n;
+    list_for_each_entry_safe(p, n, &heap->batches, list_node) {
+        list_del(&p->list_node);
+        batch_destroy(p);
+    }
+}
+
+void pcvariant_on_post_fired(
+        purc_variant_t source,  // the source variant.
+        pcvar_op_t op,          // the operation identifier.
+        size_t nr_args,         // the number of the relevant child variants.
+        purc_variant_t *argv    // the array of all relevant child variants.
+        )
+{
+    op &= PCVAR_OPERATION_ALL;
+    PC_ASSERT(op != PCVAR_OPERATION_ALL);
+
+    if (list_empty(&source->listeners))
+        return;
+
+    if ((source->flags & PCVRNT_FLAG_IN_BATCH) && (op & BATCHED_OPS)) {
+        struct pcvariant_heap *heap = batch_heap();
+        struct pcvar_batch *batch = find_batch(heap, source);
+        if (batch) {
+            if (batch_collect(batch, op, nr_args, argv) == 0)
+                return;
+
+            /* fall back to fire the event if failed to collect the
+               arguments; fire the collected ones first to keep the order */
+            batch_flush(heap, batch);
+        }
+    }
+
+    fire_post_listeners(source, op, nr_args, argv);
+}
+
 void
 pcvar_break_rue_downward(purc_variant_t val)
 {
@@ -46,6 +46,7 @@
 #include "private/instance.h"
 #include "private/errors.h"
 #include "private/debug.h"
+#include "private/utils.h"
 
 #include "variant/variant-internals.h"
 
@@ -56,138 +57,297 @@
 #include <float.h>
 #include <assert.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 static const char *hex_chars = "0123456789abcdefABCDEF";
 
-#define MY_WRITE(rws, buff, count)                                      \
-    do {                                                                \
-        const char* _buff = buff;                                       \
-        ssize_t n;                                                      \
-        size_t nr_left = (count);                                       \
-        if (len_expected)                                               \
-            *len_expected += (count);                                   \
-        while (1) {                                                     \
-            n = purc_rwstream_write((rws), _buff, nr_left);             \
-            if (n <= 0) {                                               \
-                if (flags & PCVRNT_SERIALIZE_OPT_IGNORE_ERRORS)      \
-                    break;                                              \
-                else                                                    \
-                    goto failed;                                        \
-            }                                                           \
-            else if ((size_t)n < nr_left) {                             \
-                nr_written += n;                                        \
-                _buff += n;                                             \
-                continue;                                               \
-            }                                                           \
-            else {                                                      \
-                nr_written += n;                                        \
-                break;                                                  \
-            }                                                           \
-        }                                                               \
-    } while (0)
-
-#define MY_CHECK(n)                                                     \
-    do {                                                                \
-        if ((n) < 0 &&                                                  \
-                !(flags & PCVRNT_SERIALIZE_OPT_IGNORE_ERRORS)) {     \
-            goto failed;                                                \
-        }                                                               \
-        else {                                                          \
-            nr_written += (n);                                          \
-        }                                                               \
-    } while (0)
-
-static ssize_t
-serialize_string(purc_rwstream_t rws, const char* str,
-        size_t len, unsigned int flags, size_t *len_expected)
+/* the size of the output buffer allocated on the stack */
+#define SZ_INLINE_BUFF          1024
+
+/* the buffer is flushed to the stream once it would grow over this size */
+#define SZ_FLUSH_THRESHOLD      (64 * 1024)
+
+/* the number of frames for nested containers allocated on the stack */
+#define NR_INLINE_FRAMES        16
+
+struct serialize_frame {
+    purc_variant_t          container;
+    int                     level;
+    size_t                  nr_members;     // the members serialized so far
+    union {
+        struct rb_node     *node;           // next node of object or set
+        size_t              idx;            // next index of array or tuple
+    };
+};
+
+struct serializer {
+    /* NULL when serializing to a memory buffer */
+    purc_rwstream_t         rws;
+    unsigned int            flags;
+
+    const char             *format_double;
+    const char             *format_long_double;
+
+    char                   *buf;
+    size_t                  len;
+    size_t                  sz_buf;
+
+    /* the length of the whole serialized data */
+    size_t                  nr_total;
+    /* the number of bytes written to the stream actually */
+    ssize_t                 nr_written;
+
+    struct serialize_frame *frames;
+    size_t                  nr_frames;
+    size_t                  sz_frames;
+
+    char                    inline_buf[SZ_INLINE_BUFF];
+    struct serialize_frame  inline_frames[NR_INLINE_FRAMES];
+};
+
+static void
+serializer_init(struct serializer *ser, purc_rwstream_t rws,
+        unsigned int flags)
 {
-    int nr_written = 0;
-    size_t pos = 0, start_offset = 0;
-    unsigned char c;
-    char buff[3];
-
-    while (len--) {
-        c = str[pos];
-        switch (c) {
-        case '\b':
-        case '\n':
-        case '\r':
-        case '\t':
-        case '\f':
-        case '"':
-        case '\\':
-        case '/':
-            if ((flags & PCVRNT_SERIALIZE_OPT_NOSLASHESCAPE) && c == '/') {
-                pos++;
+    ser->rws = rws;
+    ser->flags = flags;
+
+    ser->format_double = NULL;
+    ser->format_long_double = NULL;
+    purc_get_local_data(PURC_LDNAME_FORMAT_DOUBLE,
+            (uintptr_t *)&ser->format_double, NULL);
+    purc_get_local_data(PURC_LDNAME_FORMAT_LDOUBLE,
+            (uintptr_t *)&ser->format_long_double, NULL);
+
+    ser->buf = ser->inline_buf;
+    ser->len = 0;
+    ser->sz_buf = sizeof(ser->inline_buf);
+    ser->nr_total = 0;
+    ser->nr_written = 0;
+
+    ser->frames = ser->inline_frames;
+    ser->nr_frames = 0;
+    ser->sz_frames = PCA_TABLESIZE(ser->inline_frames);
+}
+
+static void
+serializer_release(struct serializer *ser)
+{
+    if (ser->buf != ser->inline_buf)
+        free(ser->buf);
+    if (ser->frames != ser->inline_frames)
+        free(ser->frames);
+}
+
+static int
+write_through(struct serializer *ser, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = purc_rwstream_write(ser->rws, data, len);
+        if (n <= 0) {
+            if (ser->flags & PCVRNT_SERIALIZE_OPT_IGNORE_ERRORS)
                 break;
-            }
+            return -1;
+        }
 
-            if (pos - start_offset > 0)
-                MY_WRITE(rws, str + start_offset, pos - start_offset);
+        ser->nr_written += n;
+        data += n;
+        len -= n;
+    }
 
-            buff[0] = 0;
-            if (c == '\b') {
-                buff[0] = '\\';
-                buff[1] = 'b';
-            }
-            else if (c == '\n') {
-                buff[0] = '\\';
-                buff[1] = 'n';
-            }
-            else if (c == '\r') {
-                buff[0] = '\\';
-                buff[1] = 'r';
-            }
-            else if (c == '\t') {
-                buff[0] = '\\';
-                buff[1] = 't';
-            }
-            else if (c == '\f') {
-                buff[0] = '\\';
-                buff[1] = 'f';
-            }
-            else if (c == '"') {
-                buff[0] = '\\';
-                buff[1] = '\"';
-            }
-            else if (c == '\\') {
-                buff[0] = '\\';
-                buff[1] = '\\';
-            }
-            else if (c == '/') {
-                buff[0] = '\\';
-                buff[1] = '/';
-            }
+    return 0;
+}
 
-            if (buff[0])
-                MY_WRITE(rws, buff, 2);
+static int
+flush_buffer(struct serializer *ser)
+{
+    int ret = 0;
 
-            start_offset = ++pos;
-            break;
+    if (ser->rws && ser->len > 0) {
+        ret = write_through(ser, ser->buf, ser->len);
+        ser->len = 0;
+    }
 
-        default:
-            if (c < ' ') {
-                char sbuf[7];
-                if (pos - start_offset > 0)
-                    MY_WRITE(rws, str + start_offset, pos - start_offset);
+    return ret;
+}
 
-                if (snprintf(sbuf, sizeof(sbuf), "\\u00%c%c",
-                            hex_chars[c >> 4], hex_chars[c & 0xf]) < 0)
-                    goto failed;
+/* Makes sure there is room for @n more bytes and returns the position. */
+static char *
+reserve_space(struct serializer *ser, size_t n)
+{
+    size_t needed = ser->len + n;
+    if (LIKELY(needed <= ser->sz_buf))
+        return ser->buf + ser->len;
+
+    if (ser->rws && ser->sz_buf >= SZ_FLUSH_THRESHOLD) {
+        if (flush_buffer(ser))
+            return NULL;
+        needed = n;
+        if (needed <= ser->sz_buf)
+            return ser->buf;
+    }
 
-                MY_WRITE(rws, sbuf, sizeof(sbuf) - 1);
-                start_offset = ++pos;
-            }
-            else
-                pos++;
+    size_t sz_buf = ser->sz_buf * 2;
+    while (sz_buf < needed)
+        sz_buf *= 2;
+
+    char *buf;
+    if (ser->buf == ser->inline_buf) {
+        buf = malloc(sz_buf);
+        if (buf)
+            memcpy(buf, ser->buf, ser->len);
+    }
+    else {
+        buf = realloc(ser->buf, sz_buf);
+    }
+
+    if (buf == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    ser->buf = buf;
+    ser->sz_buf = sz_buf;
+    return ser->buf + ser->len;
+}
+
+static inline void
+commit_space(struct serializer *ser, size_t n)
+{
+    ser->len += n;
+    ser->nr_total += n;
+}
+
+static int
+write_bytes(struct serializer *ser, const void *data, size_t n)
+{
+    if (ser->rws && n >= SZ_FLUSH_THRESHOLD) {
+        /* large chunks go to the stream directly */
+        ser->nr_total += n;
+        if (flush_buffer(ser) || write_through(ser, data, n))
+            return -1;
+        return 0;
+    }
+
+    char *p = reserve_space(ser, n);
+    if (p == NULL)
+        return -1;
+
+    memcpy(p, data, n);
+    commit_space(ser, n);
+    return 0;
+}
+
+static inline int
+write_char(struct serializer *ser, char c)
+{
+    char *p = reserve_space(ser, 1);
+    if (p == NULL)
+        return -1;
+
+    *p = c;
+    commit_space(ser, 1);
+    return 0;
+}
+
+#define write_literal(ser, literal)   \
+    write_bytes(ser, literal, sizeof(literal) - 1)
+
+/* The escape characters following the backslash; 'u' for \u00XX. */
+static const char escape_chars[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',     /* 0x00 - 0x07 */
+    'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',     /* 0x08 - 0x0F */
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',     /* 0x10 - 0x17 */
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',     /* 0x18 - 0x1F */
+    ['"'] = '"',
+    ['/'] = '/',
+    ['\\'] = '\\',
+};
+
+/* Returns the index of the first character needing escape in @str. */
+static inline size_t
+find_char_to_escape(const unsigned char *str, size_t len, bool slash)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    /* compare with the quote again if not escaping the slashes */
+    const __m128i solidus = _mm_set1_epi8(slash ? '/' : '"');
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(str + i));
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(x, quote),
+                _mm_cmpeq_epi8(x, backslash));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(x, solidus));
+        /* x <= 0x1F if and only if min(x, 0x1F) == x */
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(x, ctrl), x));
+
+        int mask = _mm_movemask_epi8(m);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+
+    for (; i < len; i++) {
+        unsigned char c = str[i];
+        if (escape_chars[c] && (slash || c != '/'))
+            return i;
+    }
+
+    return len;
+}
+
+static int
+serialize_string(struct serializer *ser, const char* str, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)str;
+    bool slash = !(ser->flags & PCVRNT_SERIALIZE_OPT_NOSLASHESCAPE);
+
+    while (len > 0) {
+        size_t n = find_char_to_escape(p, len, slash);
+        if (n > 0 && write_bytes(ser, p, n))
+            return -1;
+
+        if (n == len)
+            break;
+
+        unsigned char c = p[n];
+        char *buf = reserve_space(ser, 6);
+        if (buf == NULL)
+            return -1;
+
+        buf[0] = '\\';
+        buf[1] = escape_chars[c];
+        if (buf[1] == 'u') {
+            buf[2] = '0';
+            buf[3] = '0';
+            buf[4] = hex_chars[c >> 4];
+            buf[5] = hex_chars[c & 0x0f];
+            commit_space(ser, 6);
         }
+        else {
+            commit_space(ser, 2);
+        }
+
+        p += n + 1;
+        len -= n + 1;
     }
-    if (pos - start_offset > 0)
-        MY_WRITE(rws, str + start_offset, pos - start_offset);
 
-    return nr_written;
+    return 0;
+}
 
-failed:
-    return -1;
+static inline int
+serialize_quoted_string(struct serializer *ser, const char* str, size_t len)
+{
+    if (write_char(ser, '"') || serialize_string(ser, str, len) ||
+            write_char(ser, '"'))
+        return -1;
+    return 0;
 }
 
 static const char base64_chars[] =
@@ -257,15 +417,14 @@ static const char base64_pad = '=';
        characters followed by one "=" padding character.
    */
 
-static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
-        const void *_src, size_t srclength,
-        unsigned int flags, size_t *len_expected)
+static int
+serialize_bsequence_base64(struct serializer *ser,
+        const void *_src, size_t srclength)
 {
     const unsigned char *src = _src;
-    ssize_t nr_written = 0;
     uint8_t input[3] = {0};
     uint8_t output[4];
-    char buff[4];
+    char *buff;
     size_t i;
 
     while (2 < srclength) {
@@ -279,12 +438,14 @@ static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
         output[2] = ((input[1] & 0x0f) << 2) + (input[2] >> 6);
         output[3] = input[2] & 0x3f;
 
+        if ((buff = reserve_space(ser, 4)) == NULL)
+            return -1;
+
         buff[0] = base64_chars[output[0]];
         buff[1] = base64_chars[output[1]];
         buff[2] = base64_chars[output[2]];
         buff[3] = base64_chars[output[3]];
-
-        MY_WRITE(rws, buff, 4);
+        commit_space(ser, 4);
     }
 
     /* Now we worry about padding. */
@@ -298,6 +459,9 @@ static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
         output[1] = ((input[0] & 0x03) << 4) + (input[1] >> 4);
         output[2] = ((input[1] & 0x0f) << 2) + (input[2] >> 6);
 
+        if ((buff = reserve_space(ser, 4)) == NULL)
+            return -1;
+
         buff[0] = base64_chars[output[0]];
         buff[1] = base64_chars[output[1]];
         if (srclength == 1)
@@ -305,54 +469,73 @@ static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
         else
             buff[2] = base64_chars[output[2]];
         buff[3] = base64_pad;
-
-        MY_WRITE(rws, buff, 4);
+        commit_space(ser, 4);
     }
 
-    return nr_written;
+    return 0;
+}
 
-failed:
-    return -1;
+/* the number of bytes converted to hexadecimal digits at a time */
+#define NR_HEX_BYTES_PER_CHUNK  256
+
+static int
+serialize_bsequence_hex(struct serializer *ser,
+        const unsigned char *content, size_t sz_content)
+{
+    while (sz_content > 0) {
+        size_t n = MIN(sz_content, NR_HEX_BYTES_PER_CHUNK);
+        char *buff = reserve_space(ser, n * 2);
+        if (buff == NULL)
+            return -1;
+
+        for (size_t i = 0; i < n; i++) {
+            buff[i * 2] = hex_chars[(content[i] >> 4) & 0x0f];
+            buff[i * 2 + 1] = hex_chars[content[i] & 0x0f];
+        }
+        commit_space(ser, n * 2);
+
+        content += n;
+        sz_content -= n;
+    }
+
+    return 0;
 }
 
-static ssize_t
-serialize_bsequence(purc_rwstream_t rws, const char* content,
-        size_t sz_content, unsigned int flags, size_t *len_expected)
+static int
+serialize_bsequence(struct serializer *ser, const char* content,
+        size_t sz_content)
 {
-    ssize_t nr_written = 0, n;
+    unsigned int flags = ser->flags;
+    const unsigned char *bytes = (const unsigned char *)content;
     size_t i;
 
     switch (flags & PCVRNT_SERIALIZE_OPT_BSEQUENCE_MASK) {
         case PCVRNT_SERIALIZE_OPT_BSEQUENCE_HEX_STRING:
-            MY_WRITE(rws, "\"", 1);
-            for (i = 0; i < sz_content; i++) {
-                unsigned char byte = (unsigned char)content[i];
-                char buff[2];
-                buff [0] = hex_chars[(byte >> 4) & 0x0f];
-                buff [1] = hex_chars[byte & 0x0f];
-                MY_WRITE(rws, buff, 2);
-            }
-            MY_WRITE(rws, "\"", 1);
+            if (write_char(ser, '"') ||
+                    serialize_bsequence_hex(ser, bytes, sz_content) ||
+                    write_char(ser, '"'))
+                return -1;
             break;
 
         case PCVRNT_SERIALIZE_OPT_BSEQUENCE_HEX:
-            MY_WRITE(rws, "bx", 2);
-            for (i = 0; i < sz_content; i++) {
-                unsigned char byte = (unsigned char)content[i];
-                char buff[2];
-                buff [0] = hex_chars[(byte >> 4) & 0x0f];
-                buff [1] = hex_chars[byte & 0x0f];
-                MY_WRITE(rws, buff, 2);
-            }
+            if (write_literal(ser, "bx") ||
+                    serialize_bsequence_hex(ser, bytes, sz_content))
+                return -1;
             break;
 
         case PCVRNT_SERIALIZE_OPT_BSEQUENCE_BIN:
         case PCVRNT_SERIALIZE_OPT_BSEQUENCE_BIN_DOT:
-            MY_WRITE(rws, "bb", 2);
+            if (write_literal(ser, "bb"))
+                return -1;
+
             for (i = 0; i < sz_content; i++) {
-                unsigned char byte = (unsigned char)content[i];
-                char buff[10];
+                unsigned char byte = bytes[i];
+                char *buff = reserve_space(ser, 10);
                 size_t k = 0;
+
+                if (buff == NULL)
+                    return -1;
+
                 for (int j = 0; j < 8; j++) {
                     if (byte & 0x80 >> j)
                         buff[k] = '1';
@@ -368,92 +551,114 @@ serialize_bsequence(purc_rwstream_t rws, const char* content,
                     }
                 }
 
-                MY_WRITE(rws, buff, k);
+                commit_space(ser, k);
             }
             break;
 
         case PCVRNT_SERIALIZE_OPT_BSEQUENCE_BASE64:
         default:
-            MY_WRITE(rws, "b64", 3);
-            n = serialize_bsequence_base64(rws, content, sz_content,
-                    flags, len_expected);
-            MY_CHECK(n);
+            if (write_literal(ser, "b64") ||
+                    serialize_bsequence_base64(ser, content, sz_content))
+                return -1;
             break;
     }
 
-    return nr_written;
-
-failed:
-    return -1;
+    return 0;
 }
 
-/* strlen of character literals resolved at compile time */
-#define static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
 
-static ssize_t
-serialize_number(purc_rwstream_t rws, double d, size_t *len_expected)
+/* Converts @u to decimal digits without the null terminator. */
+static size_t
+u64_to_decimal(char *buf, uint64_t u)
 {
-    char buf[128];
-    int size;
-
-    /* Although JSON RFC does not support
-     * NaN or Infinity as numeric values
-     * ECMA 262 section 9.8.1 defines
-     * how to handle these cases as strings
-     */
-    if (isnan(d)) {
-        strcpy(buf, "NaN");
-        size = static_strlen("NaN");
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+
+    while (u >= 100) {
+        unsigned r = (unsigned)(u % 100);
+        u /= 100;
+        p -= 2;
+        memcpy(p, digit_pairs + r * 2, 2);
     }
-    else if (isinf(d)) {
-        if (d > 0) {
-            strcpy(buf, "Infinity");
-            size = static_strlen("Infinity");
-        }
-        else {
-            strcpy(buf, "-Infinity");
-            size = static_strlen("-Infinity");
-        }
+
+    if (u >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + u * 2, 2);
     }
     else {
-        double test;
+        *--p = '0' + (char)u;
+    }
 
-        /* try to format the double without decimals */
-        size = snprintf(buf, sizeof(buf), "%.0f", d);
-        if (size < 0 || size >= (int)sizeof(buf)) {
-            pcinst_set_error(PURC_ERROR_TOO_SMALL_BUFF);
-            return -1;
-        }
+    size_t n = tmp + sizeof(tmp) - p;
+    memcpy(buf, p, n);
+    return n;
+}
+
+static int
+serialize_integer(struct serializer *ser, bool negative, uint64_t u,
+        const char *postfix)
+{
+    /* sign, 20 digits, and the postfix */
+    char *buf = reserve_space(ser, 24);
+    size_t n = 0;
+
+    if (buf == NULL)
+        return -1;
+
+    if (negative)
+        buf[n++] = '-';
+    n += u64_to_decimal(buf + n, u);
+
+    if (postfix) {
+        while (*postfix)
+            buf[n++] = *postfix++;
+    }
+
+    commit_space(ser, n);
+    return 0;
+}
 
-        /* Check whether the original double can be recovered */
-        if ((sscanf(buf, "%lg", &test) != 1) ||
-                !pcutils_equal_doubles(test, d)) {
-            /* If not, return 0 and call serialize_double */
-            return 0;
+/*
+ * Formats a double by using the standard format "%.17g", or the shortest
+ * one of "%.15g", "%.16g", and "%.17g" which can be used to recover
+ * the original double if @shortest is true.
+ */
+static int
+format_double_std(char *buf, size_t sz_buf, double d, bool shortest)
+{
+    if (shortest) {
+        for (int prec = DBL_DIG; prec < 17; prec++) {
+            int size = snprintf(buf, sz_buf, "%.*g", prec, d);
+            if (size > 0 && strtod(buf, NULL) == d)
+                return size;
         }
     }
 
-    if (len_expected)
-        *len_expected += size;
-    return purc_rwstream_write(rws, buf, size);
+    return snprintf(buf, sz_buf, "%.17g", d);
 }
 
-static ssize_t
-serialize_double(purc_rwstream_t rws, double d, int flags,
-        const char *format, size_t *len_expected)
+static int
+serialize_double(struct serializer *ser, double d)
 {
     char buf[128], *p, *q;
     int size;
 
-    static const char *std_format = "%.17g";
+    const char *format = ser->format_double;
     int format_drops_decimals = 0;
     int looks_numeric = 0;
 
-    if (!format) {
-        format = std_format;
+    if (format) {
+        size = snprintf(buf, sizeof(buf), format, d);
+    }
+    else {
+        size = format_double_std(buf, sizeof(buf), d,
+                ser->flags & PCVRNT_SERIALIZE_OPT_REAL_SHORTEST);
     }
 
-    size = snprintf(buf, sizeof(buf), format, d);
     // although unlikely, snprintf might fail
     if (UNLIKELY(size < 0)) {
         pcinst_set_error(PURC_ERROR_OUTPUT);
@@ -466,7 +671,7 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
     else
         p = strchr(buf, '.');
 
-    if (format == std_format || strstr(format, ".0f") == NULL)
+    if (format == NULL || strstr(format, ".0f") == NULL)
         format_drops_decimals = 1;
 
     looks_numeric = /* Looks like *some* kind of number */
@@ -483,7 +688,7 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
         size += 2;
     }
 
-    if (p && (flags & PCVRNT_SERIALIZE_OPT_NOZERO)) {
+    if (p && (ser->flags & PCVRNT_SERIALIZE_OPT_NOZERO)) {
         /* last useful digit, always keep 1 zero */
         p++;
         for (q = p; *q; q++) {
@@ -501,17 +706,58 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
         // but if a custom one happens to do so, just silently truncate.
         size = sizeof(buf) - 1;
 
-    if (len_expected)
-        *len_expected += size;
-    return purc_rwstream_write(rws, buf, size);
+    return write_bytes(ser, buf, size);
 }
 
-static ssize_t
-serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
-        const char *format, size_t *len_expected)
+/* All doubles not less than 2^63 in magnitude are integral. */
+#define MIN_LARGE_INTEGRAL_DOUBLE   9223372036854775808.0
+
+static int
+serialize_number(struct serializer *ser, double d)
+{
+    /* Although JSON RFC does not support
+     * NaN or Infinity as numeric values
+     * ECMA 262 section 9.8.1 defines
+     * how to handle these cases as strings
+     */
+    if (isnan(d)) {
+        return write_literal(ser, "NaN");
+    }
+    else if (isinf(d)) {
+        if (d > 0)
+            return write_literal(ser, "Infinity");
+        return write_literal(ser, "-Infinity");
+    }
+    else if (fabs(d) < MIN_LARGE_INTEGRAL_DOUBLE) {
+        /* This equals to formatting the double without decimals
+           and checking whether the original double can be recovered. */
+        double r = nearbyint(d);
+        if (!pcutils_equal_doubles(r, d))
+            return serialize_double(ser, d);
+
+        return serialize_integer(ser, signbit(r), (uint64_t)fabs(r), NULL);
+    }
+    else {
+        char buf[128];
+        int size = snprintf(buf, sizeof(buf), "%.0f", d);
+        if (size < 0 || size >= (int)sizeof(buf)) {
+            pcinst_set_error(PURC_ERROR_TOO_SMALL_BUFF);
+            return -1;
+        }
+
+        return write_bytes(ser, buf, size);
+    }
+}
+
+/* strlen of character literals resolved at compile time */
+#define static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
+
+static int
+serialize_long_double(struct serializer *ser, long double ld)
 {
     char buf[256], *p, *q;
     int size;
+    const char *format = ser->format_long_double;
 
     if (isnan(ld)) {
         strcpy(buf, "NaN");
@@ -552,7 +798,7 @@ serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
         else
             p = strchr(buf, '.');
 
-        if (p && (flags & PCVRNT_SERIALIZE_OPT_NOZERO)) {
+        if (p && (ser->flags & PCVRNT_SERIALIZE_OPT_NOZERO)) {
             /* last useful digit, always keep 1 zero */
             p++;
             for (q = p; *q; q++) {
@@ -566,238 +812,145 @@ serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
         }
 
         // append FL postfix
-        if (flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON) {
+        if (ser->flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON) {
             strcat(buf, "FL");
             size += 2;
         }
     }
 
-    if (len_expected)
-        *len_expected += size;
-    return purc_rwstream_write(rws, buf, size);
+    return write_bytes(ser, buf, size);
 }
 
-static ssize_t
-print_newline(purc_rwstream_t rws, unsigned int flags, size_t *len_expected)
+static inline int
+print_newline(struct serializer *ser)
 {
-    ssize_t nr_written = 0;
+    if (ser->flags & PCVRNT_SERIALIZE_OPT_PRETTY)
+        return write_char(ser, '\n');
 
-    if (flags & PCVRNT_SERIALIZE_OPT_PRETTY) {
-        if (len_expected)
-            *len_expected += 1;
-        nr_written = purc_rwstream_write(rws, "\n", 1);
-    }
-
-    return nr_written;
+    return 0;
 }
 
-static ssize_t
-print_indent(purc_rwstream_t rws, int level, unsigned int flags,
-        size_t *len_expected)
+static int
+print_indent(struct serializer *ser, int level)
 {
     size_t n;
-    char buff[MAX_EMBEDDED_LEVELS * 2];
+    char *buff;
 
     if (level <= 0 || level > MAX_EMBEDDED_LEVELS)
         return 0;
 
-    if (flags & PCVRNT_SERIALIZE_OPT_PRETTY) {
-        if (flags & PCVRNT_SERIALIZE_OPT_PRETTY_TAB) {
-            n = level;
-            memset(buff, '\t', n);
-        }
-        else {
-            n = level * 2;
-            memset(buff, ' ', n);
-        }
+    if (ser->flags & PCVRNT_SERIALIZE_OPT_PRETTY) {
+        bool tab = ser->flags & PCVRNT_SERIALIZE_OPT_PRETTY_TAB;
+
+        n = tab ? (size_t)level : (size_t)level * 2;
+        if ((buff = reserve_space(ser, n)) == NULL)
+            return -1;
 
-        if (len_expected)
-            *len_expected += n;
-        return purc_rwstream_write(rws, buff, n);
+        memset(buff, tab ? '\t' : ' ', n);
+        commit_space(ser, n);
     }
 
     return 0;
 }
 
-static inline ssize_t
-print_space(purc_rwstream_t rws, unsigned int flags, size_t* len_expected)
+static inline int
+print_space(struct serializer *ser)
 {
-    ssize_t nr_written = 0;
+    if (ser->flags & PCVRNT_SERIALIZE_OPT_SPACED)
+        return write_char(ser, ' ');
 
-    if (flags & PCVRNT_SERIALIZE_OPT_SPACED) {
-        if (len_expected)
-            *len_expected += 1;
-        nr_written = purc_rwstream_write(rws, " ", 1);
-    }
-
-    return nr_written;
+    return 0;
 }
 
-static inline ssize_t print_space_no_pretty(purc_rwstream_t rws,
-        unsigned int flags, size_t *len_expected)
+static inline int
+print_space_no_pretty(struct serializer *ser)
 {
-    ssize_t nr_written = 0;
-
-    if (flags & PCVRNT_SERIALIZE_OPT_SPACED &&
-            !(flags & PCVRNT_SERIALIZE_OPT_PRETTY)) {
-        if (len_expected)
-            *len_expected += 1;
-        nr_written = purc_rwstream_write(rws, " ", 1);
-    }
+    if (ser->flags & PCVRNT_SERIALIZE_OPT_SPACED &&
+            !(ser->flags & PCVRNT_SERIALIZE_OPT_PRETTY))
+        return write_char(ser, ' ');
 
-    return nr_written;
+    return 0;
 }
 
 static int stringify_cb_bigint(const void *s, size_t len, void *ctxt)
 {
-    purc_rwstream_t rws = ctxt;
+    return write_bytes((struct serializer *)ctxt, s, len);
+}
 
-    ssize_t written = purc_rwstream_write(rws, s, len);
-    if (written < 0 || (size_t)written < len)
+static int
+serialize_bigint(struct serializer *ser, purc_variant_t value)
+{
+    bool quoted = !(ser->flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON);
+    ssize_t n;
+
+    if (quoted && write_char(ser, '"'))
+        return -1;
+
+    if (ser->flags & PCVRNT_SERIALIZE_OPT_BIGINT_HEX) {
+        if (write_literal(ser, "0x"))
+            return -1;
+        n = bigint_stringify(value, 16, ser, stringify_cb_bigint);
+    }
+    else {
+        n = bigint_stringify(value, 10, ser, stringify_cb_bigint);
+    }
+
+    if (n < 0)
+        return -1;
+
+    if (write_char(ser, 'N'))  // postfix
+        return -1;
+
+    if (quoted && write_char(ser, '"'))
         return -1;
 
     return 0;
 }
 
-ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
-        int level, unsigned int flags, size_t *len_expected)
+static int
+serialize_scalar(struct serializer *ser, purc_variant_t value)
 {
-    ssize_t nr_written = 0, n;
-    const char* content = NULL;
-    size_t sz_content = 0;
-    size_t i, idx;
-    char buff [256];
-    purc_variant_t member = NULL;
-    purc_variant_t key;
-    char* format_double = NULL;
-    char* format_long_double = NULL;
-    variant_set_t data;
-
-    purc_get_local_data(PURC_LDNAME_FORMAT_DOUBLE,
-            (uintptr_t *)&format_double, NULL);
-    purc_get_local_data(PURC_LDNAME_FORMAT_LDOUBLE,
-            (uintptr_t *)&format_long_double, NULL);
-
-    PC_ASSERT(value);
+    unsigned int flags = ser->flags;
+    const char* content;
+    size_t sz_content;
 
     switch (value->type) {
         case PURC_VARIANT_TYPE_UNDEFINED:
             if (flags & PCVRNT_SERIALIZE_OPT_RUNTIME_STRING)
-                content = "\"<undefined>\"";
-            else
-                content = "null";
-            break;
+                return write_literal(ser, "\"<undefined>\"");
+            return write_literal(ser, "null");
 
         case PURC_VARIANT_TYPE_NULL:
-            content = "null";
-            break;
+            return write_literal(ser, "null");
 
         case PURC_VARIANT_TYPE_BOOLEAN:
-            if (value->b) {
-                content = "true";
-            }
-            else {
-                content = "false";
-            }
-            break;
+            if (value->b)
+                return write_literal(ser, "true");
+            return write_literal(ser, "false");
 
         case PURC_VARIANT_TYPE_EXCEPTION:
+        case PURC_VARIANT_TYPE_ATOMSTRING:
             content = purc_atom_to_string(value->atom);
-            sz_content = strlen(content);
-            MY_WRITE(rws, "\"", 1);
-            n = serialize_string(rws, content, sz_content,
-                        flags, len_expected);
-            MY_CHECK(n);
-            MY_WRITE(rws, "\"", 1);
-
-            content = NULL;
-            break;
+            return serialize_quoted_string(ser, content, strlen(content));
 
         case PURC_VARIANT_TYPE_NUMBER:
-            /* try to serialize the number as an integer first */
-            n = serialize_number(rws, value->d, len_expected);
-            if (n < 0)
-                goto failed;
-            if (n == 0) {
-                n = serialize_double(rws, value->d, flags,
-                        format_double, len_expected);
-                if (n < 0)
-                    goto failed;
-            }
-            nr_written += n;
-
-            content = NULL;
-            break;
+            return serialize_number(ser, value->d);
 
         case PURC_VARIANT_TYPE_LONGINT:
-        {
-            const char *format;
-            if (flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON)
-                format = "%lldL";
-            else
-                format = "%lld";
-
-            if (snprintf(buff, sizeof(buff), format,
-                        (long long int)value->i64) < 0)
-                goto failed;
-            content = buff;
-            // sz_content = strlen(buff);
-            break;
-        }
+            return serialize_integer(ser, value->i64 < 0,
+                    value->i64 < 0 ? 0 - (uint64_t)value->i64 :
+                        (uint64_t)value->i64,
+                    (flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON) ? "L" : NULL);
 
         case PURC_VARIANT_TYPE_ULONGINT:
-        {
-            const char *format;
-            if (flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON)
-                format = "%lluUL";
-            else
-                format = "%llu";
-
-            if (snprintf(buff, sizeof(buff), format,
-                        (long long unsigned)value->u64) < 0)
-                goto failed;
-            content = buff;
-            // sz_content = strlen(buff);
-            break;
-        }
+            return serialize_integer(ser, false, value->u64,
+                    (flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON) ? "UL" : NULL);
 
         case PURC_VARIANT_TYPE_BIGINT:
-            if (!(flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON))
-                MY_WRITE(rws, "\"", 1);
-            if (flags & PCVRNT_SERIALIZE_OPT_BIGINT_HEX) {
-                MY_WRITE(rws, "0x", 2);
-                n = bigint_stringify(value, 16, rws, stringify_cb_bigint);
-            }
-            else {
-                n = bigint_stringify(value, 10, rws, stringify_cb_bigint);
-            }
-            MY_WRITE(rws, "N", 1);  // postfix
-            if (!(flags & PCVRNT_SERIALIZE_OPT_REAL_EJSON))
-                MY_WRITE(rws, "\"", 1);
-            MY_CHECK(n);
-
-            content = NULL;
-            break;
+            return serialize_bigint(ser, value);
 
         case PURC_VARIANT_TYPE_LONGDOUBLE:
-            n = serialize_long_double(rws, *value->ld, flags,
-                    format_long_double, len_expected);
-            MY_CHECK(n);
-
-            content = NULL;
-            break;
-
-        case PURC_VARIANT_TYPE_ATOMSTRING:
-            content = purc_atom_to_string(value->atom);
-            sz_content = strlen(content);
-            MY_WRITE(rws, "\"", 1);
-            n = serialize_string(rws, content, sz_content,
-                        flags, len_expected);
-            MY_CHECK(n);
-            MY_WRITE(rws, "\"", 1);
-
-            content = NULL;
-            break;
+            return serialize_long_double(ser, *value->ld);
 
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
@@ -813,276 +966,308 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
                 content = (const char*)value->bytes;
                 sz_content = value->size;
             }
-            if (value->type == PURC_VARIANT_TYPE_STRING) {
-                MY_WRITE(rws, "\"", 1);
-                n = serialize_string(rws, content, sz_content - 1,
-                            flags, len_expected);
-                MY_WRITE(rws, "\"", 1);
-            }
-            else
-                n = serialize_bsequence(rws, content, sz_content,
-                            flags, len_expected);
-            MY_CHECK(n);
 
-            content = NULL;
-            break;
+            if (value->type == PURC_VARIANT_TYPE_STRING)
+                return serialize_quoted_string(ser, content, sz_content - 1);
+            return serialize_bsequence(ser, content, sz_content);
 
         case PURC_VARIANT_TYPE_DYNAMIC:
             if (flags & PCVRNT_SERIALIZE_OPT_RUNTIME_STRING)
-                content = "\"<dynamic>\"";
-            else
-                content = "null";
-            break;
+                return write_literal(ser, "\"<dynamic>\"");
+            return write_literal(ser, "null");
 
         case PURC_VARIANT_TYPE_NATIVE:
             if (flags & PCVRNT_SERIALIZE_OPT_RUNTIME_STRING)
-                content = "\"<native>\"";
-            else
-                content = "null";
-            break;
-
-        case PURC_VARIANT_TYPE_OBJECT:
-            content = NULL;
-
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
+                return write_literal(ser, "\"<native>\"");
+            return write_literal(ser, "null");
 
-            MY_WRITE(rws, "{", 1);
-            n = print_newline(rws, flags, len_expected);
-            MY_CHECK(n);
-
-            i = 0;
-            foreach_key_value_in_variant_object(value, key, member)
-                if (i > 0) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
-                    MY_CHECK(n);
-                }
-
-                n = print_space_no_pretty(rws, flags, len_expected);
-                MY_CHECK(n);
+        default:
+            break;
+    }
 
-                n = print_indent(rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+    return 0;
+}
 
-                // key
-                MY_WRITE(rws, "\"", 1);
-                size_t len;
-                const char *ks = purc_variant_get_string_const_ex(key, &len);
-                assert(ks != NULL);
-                n = serialize_string(rws, ks, len, flags, len_expected);
-                MY_CHECK(n);
-                MY_WRITE(rws, "\"", 1);
+static inline bool
+is_container(purc_variant_t value)
+{
+    return value->type == PURC_VARIANT_TYPE_OBJECT ||
+        value->type == PURC_VARIANT_TYPE_ARRAY ||
+        value->type == PURC_VARIANT_TYPE_SET ||
+        value->type == PURC_VARIANT_TYPE_TUPLE;
+}
 
-                MY_WRITE(rws, ":", 1);
-                n = print_space(rws, flags, len_expected);
-                MY_CHECK(n);
+static struct serialize_frame *
+push_frame(struct serializer *ser)
+{
+    if (ser->nr_frames == ser->sz_frames) {
+        size_t sz_frames = ser->sz_frames * 2;
+        struct serialize_frame *frames;
+
+        if (ser->frames == ser->inline_frames) {
+            frames = malloc(sizeof(*frames) * sz_frames);
+            if (frames)
+                memcpy(frames, ser->frames, sizeof(*frames) * ser->nr_frames);
+        }
+        else {
+            frames = realloc(ser->frames, sizeof(*frames) * sz_frames);
+        }
 
-                // value
-                n = purc_variant_serialize(member,
-                        rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+        if (frames == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return NULL;
+        }
 
-                i++;
-            end_foreach;
+        ser->frames = frames;
+        ser->sz_frames = sz_frames;
+    }
 
-            if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
-                MY_CHECK(n);
-            }
+    return ser->frames + ser->nr_frames++;
+}
 
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
+static int
+open_container(struct serializer *ser, purc_variant_t container, int level)
+{
+    unsigned int flags = ser->flags;
+    struct serialize_frame *frame;
+    int ret;
 
-            n = print_space_no_pretty(rws, flags, len_expected);
-            MY_CHECK(n);
+    if (print_indent(ser, level))
+        return -1;
 
-            MY_WRITE(rws, "}", 1);
+    switch (container->type) {
+        case PURC_VARIANT_TYPE_OBJECT:
+            ret = write_char(ser, '{');
             break;
 
-        case PURC_VARIANT_TYPE_ARRAY:
-            content = NULL;
-
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
-
-            MY_WRITE(rws, "[", 1);
-            n = print_newline(rws, flags, len_expected);
-            MY_CHECK(n);
-
-            i = 0;
-            foreach_value_in_variant_array(value, member, idx)
-                (void)idx;
-                if (i > 0) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
-                    MY_CHECK(n);
-                }
-
-                n = print_space_no_pretty(rws, flags, len_expected);
-                MY_CHECK(n);
+        case PURC_VARIANT_TYPE_SET:
+            if (flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS)
+                ret = write_literal(ser, "[!");
+            else
+                ret = write_char(ser, '[');
+            break;
 
-                n = print_indent(rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+        case PURC_VARIANT_TYPE_TUPLE:
+            /* TODO: might use '(' in the future. */
+            if (flags & PCVRNT_SERIALIZE_OPT_TUPLE_EJSON)
+                ret = write_literal(ser, "[!");
+            else
+                ret = write_char(ser, '[');
+            break;
 
-                // member
-                n = purc_variant_serialize(member,
-                        rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+        default:
+            ret = write_char(ser, '[');
+            break;
+    }
 
-                i++;
-            end_foreach;
+    if (ret || print_newline(ser))
+        return -1;
 
-            if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
-                MY_CHECK(n);
+    if (container->type == PURC_VARIANT_TYPE_SET &&
+            (flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS)) {
+        variant_set_t data = pcvar_set_get_data(container);
+        if (data->keynames) {
+            for (size_t i = 0; i < data->nr_keynames; ++i) {
+                const char *sk = data->keynames[i];
+                if (i > 0 && write_char(ser, ' '))
+                    return -1;
+                if (write_bytes(ser, sk, strlen(sk)))
+                    return -1;
             }
+        }
+    }
 
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
-
-            n = print_space_no_pretty(rws, flags, len_expected);
-            MY_CHECK(n);
+    if ((frame = push_frame(ser)) == NULL)
+        return -1;
 
-            MY_WRITE(rws, "]", 1);
-            break;
+    frame->container = container;
+    frame->level = level;
+    frame->nr_members = 0;
 
-        case PURC_VARIANT_TYPE_SET:
-            content = NULL;
+    if (container->type == PURC_VARIANT_TYPE_OBJECT) {
+        variant_obj_t data = (variant_obj_t)container->ptr2;
+        frame->node = pcutils_rbtree_first(&data->kvs);
+    }
+    else if (container->type == PURC_VARIANT_TYPE_SET) {
+        variant_set_t data = pcvar_set_get_data(container);
+        frame->node = pcutils_rbtree_first(&data->elems);
+    }
+    else {
+        frame->idx = 0;
+    }
 
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
+    return 0;
+}
 
-            if (flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS)
-                MY_WRITE(rws, "[!", 2);
-            else
-                MY_WRITE(rws, "[", 1);
-
-            n = print_newline(rws, flags, len_expected);
-            MY_CHECK(n);
-
-            if (flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS) {
-                data = pcvar_set_get_data(value);
-                if (data->keynames) {
-                    for (size_t i=0; i<data->nr_keynames; ++i) {
-                        const char *sk = data->keynames[i];
-                        if (i>0)
-                            MY_WRITE(rws, " ", 1);
-                        MY_WRITE(rws, sk, strlen(sk));
-                    }
-                }
-            }
+static bool
+next_member(struct serialize_frame *frame,
+        purc_variant_t *key, purc_variant_t *member)
+{
+    purc_variant_t container = frame->container;
 
-            i = 0;
-            foreach_value_in_variant_set_order(value, member)
-                if (i > 0 || flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
-                    MY_CHECK(n);
-                }
+    switch (container->type) {
+        case PURC_VARIANT_TYPE_OBJECT:
+        {
+            if (frame->node == NULL)
+                return false;
+
+            struct obj_node *node;
+            node = container_of(frame->node, struct obj_node, node);
+            *key = node->key;
+            *member = node->val;
+            frame->node = pcutils_rbtree_next(frame->node);
+            return true;
+        }
 
-                n = print_space_no_pretty(rws, flags, len_expected);
-                MY_CHECK(n);
+        case PURC_VARIANT_TYPE_SET:
+        {
+            if (frame->node == NULL)
+                return false;
+
+            struct set_node *node;
+            node = container_of(frame->node, struct set_node, rbnode);
+            *member = node->val;
+            frame->node = pcutils_rbtree_next(frame->node);
+            return true;
+        }
 
-                n = print_indent(rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+        case PURC_VARIANT_TYPE_ARRAY:
+        {
+            struct pcutils_array_list *al = variant_array_get_data(container);
+            if (frame->idx >= pcutils_array_list_length(al))
+                return false;
+
+            struct arr_node *node;
+            node = container_of(pcutils_array_list_get(al, frame->idx),
+                    struct arr_node, node);
+            *member = node->val;
+            frame->idx++;
+            return true;
+        }
 
-                // member
-                n = purc_variant_serialize(member,
-                        rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+        case PURC_VARIANT_TYPE_TUPLE:
+        {
+            size_t sz;
+            purc_variant_t *members = tuple_members(container, &sz);
+            assert(members);
 
-                i++;
-            end_foreach;
+            if (frame->idx >= sz)
+                return false;
 
-            if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
-                MY_CHECK(n);
-            }
+            *member = members[frame->idx++];
+            return true;
+        }
 
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
+        default:
+            break;
+    }
 
-            n = print_space_no_pretty(rws, flags, len_expected);
-            MY_CHECK(n);
+    return false;
+}
 
-            MY_WRITE(rws, "]", 1);
-            break;
+static int
+begin_member(struct serializer *ser, struct serialize_frame *frame,
+        purc_variant_t key)
+{
+    if (frame->nr_members > 0 ||
+            (frame->container->type == PURC_VARIANT_TYPE_SET &&
+             (ser->flags & PCVRNT_SERIALIZE_OPT_UNIQKEYS))) {
+        if (write_char(ser, ',') || print_newline(ser))
+            return -1;
+    }
 
-        case PURC_VARIANT_TYPE_TUPLE:
-        {
-            content = NULL;
+    if (print_space_no_pretty(ser) || print_indent(ser, frame->level + 1))
+        return -1;
 
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
+    if (key) {
+        size_t len;
+        const char *ks = purc_variant_get_string_const_ex(key, &len);
+        assert(ks != NULL);
 
-            /* TODO: might use '(' in the future. */
-            if (flags & PCVRNT_SERIALIZE_OPT_TUPLE_EJSON)
-                MY_WRITE(rws, "[!", 2);
-            else
-                MY_WRITE(rws, "[", 1);
+        if (serialize_quoted_string(ser, ks, len) ||
+                write_char(ser, ':') || print_space(ser))
+            return -1;
+    }
 
-            n = print_newline(rws, flags, len_expected);
-            MY_CHECK(n);
+    return 0;
+}
 
-            i = 0;
+static int
+close_container(struct serializer *ser, struct serialize_frame *frame)
+{
+    if (frame->nr_members > 0 && print_newline(ser))
+        return -1;
 
-            purc_variant_t *members;
-            size_t sz;
-            members = tuple_members(value, &sz);
-            assert(members);
+    if (print_indent(ser, frame->level) || print_space_no_pretty(ser))
+        return -1;
 
-            for (idx = 0; idx < sz; idx++) {
+    /* TODO: might use ')' for tuple in the future. */
+    if (frame->container->type == PURC_VARIANT_TYPE_OBJECT)
+        return write_char(ser, '}');
+    return write_char(ser, ']');
+}
 
-                if (i > 0) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
-                    MY_CHECK(n);
-                }
+/*
+ * Serializes a value by using an explicit stack of the containers being
+ * serialized instead of recursion, so deeply nested data do not
+ * exhaust the C stack.
+ */
+static int
+serialize_value(struct serializer *ser, purc_variant_t value, int level)
+{
+    if (!is_container(value))
+        return serialize_scalar(ser, value);
 
-                n = print_space_no_pretty(rws, flags, len_expected);
-                MY_CHECK(n);
+    if (open_container(ser, value, level))
+        return -1;
 
-                n = print_indent(rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+    while (ser->nr_frames > 0) {
+        struct serialize_frame *frame = ser->frames + ser->nr_frames - 1;
+        purc_variant_t key = PURC_VARIANT_INVALID;
+        purc_variant_t member;
 
-                // member
-                n = purc_variant_serialize(members[idx],
-                        rws, level + 1, flags, len_expected);
-                MY_CHECK(n);
+        if (!next_member(frame, &key, &member)) {
+            if (close_container(ser, frame))
+                return -1;
+            ser->nr_frames--;
+            continue;
+        }
 
-                i++;
-            }
+        if (begin_member(ser, frame, key))
+            return -1;
+        frame->nr_members++;
 
-            if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
-                MY_CHECK(n);
-            }
+        /* the frame might be moved when pushing a new one */
+        int member_level = frame->level + 1;
+        if (is_container(member)) {
+            if (open_container(ser, member, member_level))
+                return -1;
+        }
+        else if (serialize_scalar(ser, member)) {
+            return -1;
+        }
+    }
 
-            n = print_indent(rws, level, flags, len_expected);
-            MY_CHECK(n);
+    return 0;
+}
 
-            n = print_space_no_pretty(rws, flags, len_expected);
-            MY_CHECK(n);
+ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
+        int level, unsigned int flags, size_t *len_expected)
+{
+    struct serializer ser;
+    ssize_t nr_written = -1;
 
-            /* TODO: might use ']' in the future. */
-            MY_WRITE(rws, "]", 1);
-            break;
-        }
+    PC_ASSERT(value);
 
-        default:
-            break;
-    }
+    serializer_init(&ser, rws, flags);
+    if (serialize_value(&ser, value, level) == 0 && flush_buffer(&ser) == 0)
+        nr_written = ser.nr_written;
 
-    if (content) {
-        // for simple types
-        MY_WRITE(rws, content, strlen (content));
-    }
+    if (len_expected)
+        *len_expected += ser.nr_total;
 
+    serializer_release(&ser);
     return nr_written;
-
-failed:
-    return -1;
 }
 
 char *
@@ -1090,35 +1275,38 @@ purc_variant_serialize_alloc(purc_variant_t value,
         int indent_level, unsigned flags,
         size_t *sz_content, size_t *sz_buffer)
 {
-    int ec = PURC_ERROR_OK;
-    purc_rwstream_t output;
-
-    output = purc_rwstream_new_buffer(64, -1);
-    if (output == NULL) {
-        ec = PURC_ERROR_OUT_OF_MEMORY;
-        goto failed;
-    }
+    struct serializer ser;
+    char *buf = NULL;
 
-    ssize_t n;
-    n = purc_variant_serialize(value, output, indent_level, flags, NULL);
-    if (n == -1)
-        goto failed;
+    PC_ASSERT(value);
 
-    if (purc_rwstream_write(output, "\0", 1) < 1)
+    /* serialize into the buffer directly instead of a memory stream */
+    serializer_init(&ser, NULL, flags);
+    if (serialize_value(&ser, value, indent_level) ||
+            write_char(&ser, '\0'))
         goto failed;
 
-    char *buf = NULL;
-    buf = purc_rwstream_get_mem_buffer_ex(output, sz_content, sz_buffer, true);
-    purc_rwstream_destroy(output);
-    return buf;
+    if (ser.buf == ser.inline_buf) {
+        buf = malloc(ser.len);
+        if (buf == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto failed;
+        }
 
-failed:
-    if (output)
-        purc_rwstream_destroy(output);
+        memcpy(buf, ser.buf, ser.len);
+        ser.sz_buf = ser.len;
+    }
+    else {
+        buf = ser.buf;
+        ser.buf = ser.inline_buf;
+    }
 
-    if (ec)
-        purc_set_error(ec);
+    if (sz_content)
+        *sz_content = ser.len;
+    if (sz_buffer)
+        *sz_buffer = ser.sz_buf;
 
-    return NULL;
+failed:
+    serializer_release(&ser);
+    return buf;
 }
-
@@ -173,7 +173,7 @@ arr_node_destroy(purc_variant_t arr, struct arr_node *node)
         return;
 
     arr_node_release(arr, node);
-    free(node);
+    pcvariant_node_free(sizeof(*node), node);
 }
 
 static purc_variant_t
@@ -190,11 +190,9 @@ static struct arr_node*
 arr_node_create(purc_variant_t val)
 {
     struct arr_node *node;
-    node = (struct arr_node*)calloc(1, sizeof(*node));
-    if (!node) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    node = (struct arr_node*)pcvariant_node_alloc0(sizeof(*node));
+    if (!node)
         return NULL;
-    }
 
     node->node.idx = (size_t)-1;
 
@@ -226,9 +224,8 @@ build_rev_update_chain(purc_variant_t arr, struct arr_node *node)
 }
 
 static int
-check_grow(purc_variant_t arr, size_t idx, purc_variant_t val)
+check_grow_many(purc_variant_t arr, size_t nr_values, purc_variant_t *values)
 {
-    UNUSED_PARAM(idx);
     if (!pcvar_container_belongs_to_set(arr))
         return 0;
 
@@ -251,7 +248,14 @@ check_grow(purc_variant_t arr, size_t idx, purc_variant_t val)
         if (r)
             break;
 
-        r = pcvar_arr_append(_new, val);
+        for (size_t j = 0; j < nr_values; j++) {
+            /* undefined is never appended to an array */
+            if (purc_variant_is_undefined(values[j]))
+                continue;
+            r = pcvar_arr_append(_new, values[j]);
+            if (r)
+                break;
+        }
         if (r)
             break;
 
@@ -268,6 +272,13 @@ check_grow(purc_variant_t arr, size_t idx, purc_variant_t val)
     return -1;
 }
 
+static inline int
+check_grow(purc_variant_t arr, size_t idx, purc_variant_t val)
+{
+    UNUSED_PARAM(idx);
+    return check_grow_many(arr, 1, &val);
+}
+
 static int
 variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
         bool check)
@@ -361,6 +372,98 @@ variant_arr_append(purc_variant_t arr, purc_variant_t val,
     return r ? -1 : 0;
 }
 
+/* Appends the values as a whole: the storage is expanded once, the set
+   owning the array is checked and adjusted once, and the post listeners
+   get a single coalesced event. */
+static int
+variant_arr_append_many(purc_variant_t arr, size_t nr_values,
+        purc_variant_t *values)
+{
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    struct pcutils_array_list *al = &data->al;
+    size_t nr_orig = pcutils_array_list_length(al);
+    struct arr_node **nodes = NULL;
+    size_t nr_nodes = 0;
+    bool batched = false;
+    int ret = -1;
+
+    nodes = malloc(sizeof(*nodes) * nr_values);
+    if (nodes == NULL ||
+            pcutils_array_list_expand(al, nr_orig + nr_values)) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto out;
+    }
+
+    /* the pre listeners are called for every new member */
+    for (size_t i = 0; i < nr_values; i++) {
+        if (purc_variant_is_undefined(values[i]))
+            continue;
+
+        if (!list_empty(&arr->listeners)) {
+            purc_variant_t pos;
+            pos = purc_variant_make_longint(nr_orig + nr_nodes);
+            if (pos == PURC_VARIANT_INVALID)
+                goto out;
+
+            bool ok = grow(arr, pos, values[i], true);
+            purc_variant_unref(pos);
+            if (!ok)
+                goto out;
+        }
+
+        nodes[nr_nodes] = arr_node_create(values[i]);
+        if (nodes[nr_nodes] == NULL)
+            goto out;
+        nr_nodes++;
+    }
+
+    if (nr_nodes == 0) {
+        ret = 0;
+        goto out;
+    }
+
+    if (check_grow_many(arr, nr_values, values))
+        goto out;
+
+    for (size_t i = 0; i < nr_nodes; i++) {
+        /* never fails since the storage has been expanded */
+        int r = pcutils_array_list_append(al, &nodes[i]->node);
+        PC_ASSERT(r == 0);
+        (void)r;
+    }
+
+    for (size_t i = 0; i < nr_nodes; i++) {
+        if (build_rev_update_chain(arr, nodes[i]))
+            goto out;
+    }
+
+    pcvar_adjust_set_by_descendant(arr);
+
+    if (!list_empty(&arr->listeners)) {
+        batched = purc_variant_container_begin_batch(arr);
+        for (size_t i = 0; i < nr_nodes; i++) {
+            purc_variant_t pos = purc_variant_make_longint(nr_orig + i);
+            if (pos == PURC_VARIANT_INVALID)
+                continue;
+            grown(arr, pos, nodes[i]->val, true);
+            purc_variant_unref(pos);
+        }
+        if (batched)
+            purc_variant_container_commit_batch(arr);
+    }
+
+    nr_nodes = 0;
+    ret = 0;
+
+out:
+    /* remove the nodes from the tail if failed */
+    while (nr_nodes > 0)
+        arr_node_destroy(arr, nodes[--nr_nodes]);
+    free(nodes);
+    refresh_extra(arr);
+    return ret;
+}
+
 static int
 variant_arr_prepend(purc_variant_t arr, purc_variant_t val,
         bool check)
@@ -603,6 +706,127 @@ variant_arr_remove(purc_variant_t arr, size_t idx,
     return -1;
 }
 
+static int
+check_shrink_marked(purc_variant_t arr, const bool *marked)
+{
+    if (!pcvar_container_belongs_to_set(arr))
+        return 0;
+
+    purc_variant_t _new = pcvar_make_arr();
+    if (_new == PURC_VARIANT_INVALID)
+        return -1;
+
+    int r = 0;
+    size_t i;
+    purc_variant_t v;
+    foreach_value_in_variant_array(arr, v, i) {
+        if (marked[i])
+            continue;
+        r = pcvar_arr_append(_new, v);
+        if (r)
+            break;
+    } end_foreach;
+
+    if (r == 0)
+        r = pcvar_reverse_check(arr, _new);
+
+    PURC_VARIANT_SAFE_CLEAR(_new);
+    return r ? -1 : 0;
+}
+
+/* Removes the marked members in one pass: the set owning the array is
+   checked and adjusted once, and the post listeners get a single coalesced
+   event, in which the members are in the descending order of positions as
+   if they were removed one by one from the end. */
+static int
+variant_arr_remove_marked(purc_variant_t arr, const bool *marked)
+{
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    struct pcutils_array_list *al = &data->al;
+    size_t nr = pcutils_array_list_length(al);
+    bool listened = !list_empty(&arr->listeners);
+    struct arr_node **removed;
+    size_t nr_removed = 0;
+
+    /* the pre listeners are called for every member to remove */
+    for (size_t i = nr; i > 0; i--) {
+        if (!marked[i - 1])
+            continue;
+        nr_removed++;
+
+        if (listened) {
+            struct arr_node *node;
+            node = container_of(al->nodes[i - 1], struct arr_node, node);
+
+            purc_variant_t pos = purc_variant_make_longint(i - 1);
+            if (pos == PURC_VARIANT_INVALID)
+                return -1;
+
+            bool ok = shrink(arr, pos, node->val, true);
+            purc_variant_unref(pos);
+            if (!ok)
+                return -1;
+        }
+    }
+
+    if (nr_removed == 0)
+        return 0;
+
+    if (check_shrink_marked(arr, marked))
+        return -1;
+
+    removed = malloc(sizeof(*removed) * nr_removed);
+    if (removed == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    /* compact the storage */
+    size_t nr_left = 0, k = 0;
+    for (size_t i = 0; i < nr; i++) {
+        struct arr_node *node;
+        node = container_of(al->nodes[i], struct arr_node, node);
+
+        if (marked[i]) {
+            break_rev_update_chain(arr, node);
+            list_del(&node->node.node);
+            node->node.idx = (size_t)-1;
+            removed[k++] = node;
+        }
+        else {
+            node->node.idx = nr_left;
+            al->nodes[nr_left++] = &node->node;
+        }
+    }
+
+    for (size_t i = nr_left; i < nr; i++)
+        al->nodes[i] = NULL;
+    al->nr = nr_left;
+
+    pcvar_adjust_set_by_descendant(arr);
+
+    if (listened) {
+        bool batched = purc_variant_container_begin_batch(arr);
+        for (size_t i = nr; i > 0; i--) {
+            if (!marked[i - 1])
+                continue;
+
+            purc_variant_t pos = purc_variant_make_longint(i - 1);
+            if (pos == PURC_VARIANT_INVALID)
+                continue;
+            shrunk(arr, pos, removed[--k]->val, true);
+            purc_variant_unref(pos);
+        }
+        if (batched)
+            purc_variant_container_commit_batch(arr);
+    }
+
+    for (size_t i = 0; i < nr_removed; i++)
+        arr_node_destroy(arr, removed[i]);
+    free(removed);
+    return 0;
+}
+
 static inline void
 array_release (purc_variant_t arr)
 {
@@ -610,13 +834,17 @@ array_release (purc_variant_t arr)
     if (!data)
         return;
 
+    /* free the nodes in bulk instead of removing them one by one */
     struct pcutils_array_list *al = &data->al;
-    struct arr_node *p, *n;
-    array_list_for_each_entry_reverse_safe(al, p, n, node) {
-        arr_node_destroy(arr, p);
-    };
+    for (size_t i = pcutils_array_list_length(al); i > 0; i--) {
+        struct arr_node *node;
+        node = container_of(al->nodes[i - 1], struct arr_node, node);
+        break_rev_update_chain(arr, node);
+        PURC_VARIANT_SAFE_CLEAR(node->val);
+        pcvariant_node_free(sizeof(*node), node);
+    }
 
-    pcutils_array_list_reset(al);
+    pcutils_array_list_clear(al);
 
     if (data->rev_update_chain) {
         pcvar_destroy_rev_update_chain(data->rev_update_chain);
@@ -793,6 +1021,23 @@ bool purc_variant_array_append (purc_variant_t arr, purc_variant_t value)
     return r ? false : true;
 }
 
+bool purc_variant_array_append_many(purc_variant_t arr,
+        size_t nr_values, purc_variant_t *values)
+{
+    PCVRNT_CHECK_FAIL_RET(arr && arr->type==PVT(_ARRAY) && arr->ptr2 &&
+        (nr_values == 0 || values),
+        false);
+
+    for (size_t i = 0; i < nr_values; i++) {
+        PCVRNT_CHECK_FAIL_RET(values[i], false);
+    }
+
+    if (nr_values == 0)
+        return true;
+
+    return variant_arr_append_many(arr, nr_values, values) ? false : true;
+}
+
 bool purc_variant_array_prepend (purc_variant_t arr, purc_variant_t value)
 {
     PCVRNT_CHECK_FAIL_RET(arr && arr->type==PVT(_ARRAY) && value,
@@ -848,6 +1093,20 @@ bool purc_variant_array_remove (purc_variant_t arr, int idx)
     return r ? false : true;
 }
 
+bool
+pcvariant_array_remove_marked(purc_variant_t arr, const bool *marked,
+        size_t nr_marked)
+{
+    PCVRNT_CHECK_FAIL_RET(arr && arr->type==PVT(_ARRAY) && arr->ptr2 &&
+        marked, false);
+    PCVRNT_CHECK_FAIL_RET(nr_marked ==
+        variant_arr_length(pcvar_arr_get_data(arr)), false);
+
+    int r = variant_arr_remove_marked(arr, marked);
+    refresh_extra(arr);
+    return r ? false : true;
+}
+
 bool purc_variant_array_insert_before (purc_variant_t arr, int idx,
         purc_variant_t value)
 {
@@ -919,6 +1178,20 @@ int pcvariant_array_sort(purc_variant_t arr, void *ud,
     return 0;
 }
 
+int pcvariant_array_permute(purc_variant_t arr, const size_t *order)
+{
+    if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
+        return -1;
+
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    if (pcutils_array_list_permute(&data->al, order)) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    return 0;
+}
+
 purc_variant_t
 pcvariant_array_clone(purc_variant_t arr, bool recursively)
 {
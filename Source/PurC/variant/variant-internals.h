@@ -59,6 +59,44 @@ void pcvariant_stat_set_extra_size(purc_variant_t v, size_t sz) WTF_INTERNAL;
 void pcvariant_stat_inc_extra_size(purc_variant_t v, size_t sz) WTF_INTERNAL;
 void pcvariant_stat_dec_extra_size(purc_variant_t v, size_t sz) WTF_INTERNAL;
 
+/*
+ * Since 0.9.26, the bytes of a medium string or byte sequence are allocated
+ * from the slab of the variant heap along with a small header, so that they
+ * need neither malloc() nor free(). Such a variant has both the flags
+ * PCVRNT_FLAG_EXTRA_SIZE and PCVRNT_FLAG_SLAB_DATA, and `ptr2` points to
+ * the bytes following the header.
+ */
+struct pcvariant_slab_data {
+    uint32_t    hash;       // the cached hash of the string; 0 if unknown
+    uint32_t    reserved;
+    char        bytes[0];
+};
+
+#define SZ_SLAB_DATA_HEADER     sizeof(struct pcvariant_slab_data)
+#define MAX_SZ_SLAB_DATA        (PCUTILS_SLAB_MAX_SIZE - SZ_SLAB_DATA_HEADER)
+
+static inline struct pcvariant_slab_data *
+pcvariant_slab_data(purc_variant_t v)
+{
+    return (struct pcvariant_slab_data *)((char *)v->ptr2 -
+            SZ_SLAB_DATA_HEADER);
+}
+
+/*
+ * Allocate the extra space of @sz bytes for a string or byte sequence,
+ * set `flags`, `ptr2`, and the extra size of @v. The space is zeroed.
+ */
+void *pcvariant_alloc_extra_bytes(purc_variant_t v, size_t sz) WTF_INTERNAL;
+
+/* Free the extra space allocated by pcvariant_alloc_extra_bytes(). */
+void pcvariant_free_extra_bytes(purc_variant_t v) WTF_INTERNAL;
+
+/*
+ * Return the FNV-1a hash of a string variant; the hash is cached for
+ * the strings having PCVRNT_FLAG_SLAB_DATA.
+ */
+uint32_t pcvariant_string_hash(purc_variant_t v) WTF_INTERNAL;
+
 /* Allocate a variant for the specific type. */
 purc_variant_t pcvariant_get(enum purc_variant_type type) WTF_INTERNAL;
 
@@ -200,7 +200,7 @@ obj_node_destroy(purc_variant_t obj, struct obj_node *node)
 
     obj_node_release(obj, node);
 
-    free(node);
+    pcvariant_node_free(sizeof(*node), node);
 }
 
 static struct obj_node*
@@ -212,11 +212,9 @@ obj_node_create(purc_variant_t k, purc_variant_t v)
     }
 
     struct obj_node *node;
-    node = (struct obj_node*)calloc(1, sizeof(*node));
-    if (!node) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    node = (struct obj_node*)pcvariant_node_alloc0(sizeof(*node));
+    if (!node)
         return NULL;
-    }
 
     node->key = purc_variant_ref(k);
     node->val = purc_variant_ref(v);
@@ -750,15 +748,36 @@ void pcvariant_object_release (purc_variant_t value)
 
     variant_obj_t data = pcvar_obj_get_data(value);
 
-    struct rb_root *root = &data->kvs;
+    /* free the nodes in post-order instead of erasing them one by one */
+    struct rb_node *p = data->kvs.rb_node;
+    while (p) {
+        if (p->rb_left) {
+            p = p->rb_left;
+            continue;
+        }
+        if (p->rb_right) {
+            p = p->rb_right;
+            continue;
+        }
 
-    struct rb_node *p, *n;
-    pcutils_rbtree_for_each_safe(pcutils_rbtree_first(root), p, n) {
-        struct obj_node *node;
-        node = container_of(p, struct obj_node, node);
+        struct rb_node *parent = pcutils_rbtree_parent(p);
+        if (parent) {
+            if (parent->rb_left == p)
+                parent->rb_left = NULL;
+            else
+                parent->rb_right = NULL;
+        }
+
+        struct obj_node *node = container_of(p, struct obj_node, node);
+        break_rev_update_chain(value, node);
+        PURC_VARIANT_SAFE_CLEAR(node->key);
+        PURC_VARIANT_SAFE_CLEAR(node->val);
+        pcvariant_node_free(sizeof(*node), node);
 
-        obj_node_destroy(value, node);
+        p = parent;
     }
+    data->kvs.rb_node = NULL;
+    data->size = 0;
 
     if (data->rev_update_chain) {
         pcvar_destroy_rev_update_chain(data->rev_update_chain);
@@ -852,6 +871,33 @@ bool purc_variant_object_set (purc_variant_t obj,
     return r ? false : true;
 }
 
+bool purc_variant_object_set_many(purc_variant_t obj, size_t nr_kvs,
+        purc_variant_t *keys, purc_variant_t *values)
+{
+    PCVRNT_CHECK_FAIL_RET(obj && obj->type==PVT(_OBJECT) &&
+        obj->ptr2 && (nr_kvs == 0 || (keys && values)),
+        false);
+
+    bool batched = purc_variant_container_begin_batch(obj);
+
+    bool check = true;
+    size_t i;
+    for (i = 0; i < nr_kvs; i++) {
+        if (!keys[i] || keys[i]->type != PVT(_STRING) || !values[i]) {
+            pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+            break;
+        }
+
+        if (v_object_set(obj, keys[i], values[i], check))
+            break;
+    }
+
+    if (batched)
+        purc_variant_container_commit_batch(obj);
+
+    return i < nr_kvs ? false : true;
+}
+
 bool
 purc_variant_object_remove_by_ckey(purc_variant_t obj, const char* key,
         bool silently)
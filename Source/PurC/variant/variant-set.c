@@ -615,7 +615,7 @@ elem_node_destroy(purc_variant_t set, struct set_node *node)
         return;
 
     elem_node_release(set, node);
-    free(node);
+    pcvariant_node_free(sizeof(*node), node);
 }
 
 static int
@@ -645,19 +645,18 @@ elem_node_replace(purc_variant_t set, struct set_node *node,
 static void
 variant_set_release_elems(purc_variant_t set, variant_set_t data)
 {
+    /* free the nodes in bulk instead of removing them one by one */
     struct pcutils_array_list *al = &data->al;
-    struct pcutils_array_list_node *p, *n;
-    for (p = pcutils_array_list_get_last(al);
-            ({ n = p ? pcutils_array_list_get(al,  p->idx-1) : NULL;
-             p; });
-            p = n)
-    {
+    for (size_t i = pcutils_array_list_length(al); i > 0; i--) {
         struct set_node *sn;
-        sn = container_of(p, struct set_node, alnode);
-        elem_node_destroy(set, sn);
+        sn = container_of(al->nodes[i - 1], struct set_node, alnode);
+        elem_node_revoke_constraints(set, sn);
+        PURC_VARIANT_SAFE_CLEAR(sn->val);
+        pcvariant_node_free(sizeof(*sn), sn);
     }
 
-    pcutils_array_list_reset(&data->al);
+    data->elems = RB_ROOT;
+    pcutils_array_list_clear(al);
 }
 
 static void
@@ -721,11 +720,10 @@ variant_set_create_elem_node(purc_variant_t set, purc_variant_t val)
     variant_set_t data = pcvar_set_get_data(set);
     PC_ASSERT(data);
 
-    struct set_node *_new = (struct set_node*)calloc(1, sizeof(*_new));
-    if (!_new) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    struct set_node *_new;
+    _new = (struct set_node*)pcvariant_node_alloc0(sizeof(*_new));
+    if (!_new)
         return NULL;
-    }
 
     pcvariant_md5_by_set(_new->md5, val, set);
 
@@ -1195,6 +1193,56 @@ purc_variant_set_add(purc_variant_t set, purc_variant_t value,
     return r;
 }
 
+ssize_t
+purc_variant_set_add_many(purc_variant_t set, size_t nr_values,
+        purc_variant_t *values, pcvrnt_cr_method_k cr_method)
+{
+    if (!(set && set->type==PVT(_SET) && (nr_values == 0 || values))) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    purc_clr_error();
+
+    variant_set_t data = pcvar_set_get_data(set);
+    PC_ASSERT(data);
+
+    if (nr_values == 0)
+        return 0;
+
+    struct pcutils_array_list *al = &data->al;
+    if (pcutils_array_list_expand(al,
+                pcutils_array_list_length(al) + nr_values)) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    bool batched = purc_variant_container_begin_batch(set);
+
+    ssize_t nr_changed = 0;
+    for (size_t i = 0; i < nr_values; i++) {
+        ssize_t r = -1;
+        if (values[i])
+            r = variant_set_add_val(set, data, values[i], cr_method, true);
+        else
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+
+        if (r < 0) {
+            nr_changed = -1;
+            break;
+        }
+        nr_changed += r;
+    }
+
+    if (batched)
+        purc_variant_container_commit_batch(set);
+
+    size_t extra = variant_set_get_extra_size(data);
+    pcvariant_stat_set_extra_size(set, extra);
+
+    return nr_changed;
+}
+
 ssize_t
 purc_variant_set_remove(purc_variant_t set, purc_variant_t value,
         pcvrnt_nr_method_k nr_method)
@@ -1661,6 +1709,19 @@ int pcvariant_set_sort(purc_variant_t value, void *ud,
     return 0;
 }
 
+int pcvariant_set_permute(purc_variant_t value, const size_t *order)
+{
+    PC_ASSERT(value != PURC_VARIANT_INVALID);
+
+    variant_set_t data = pcvar_set_get_data(value);
+    if (pcutils_array_list_permute(&data->al, order)) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    return 0;
+}
+
 purc_variant_t
 pcvariant_set_find(purc_variant_t set, purc_variant_t value)
 {
@@ -2219,33 +2280,20 @@ out:
     return ret;
 }
 
-static bool
-is_in_array(purc_variant_t array, purc_variant_t v, int* idx)
-{
-    bool ret = false;
-    purc_variant_t val;
-    size_t curr;
-    UNUSED_VARIABLE(val);
-    foreach_value_in_variant_array_safe(array, val, curr)
-        if (val == v) {
-            if (idx) {
-                *idx = curr;
-            }
-            ret = true;
-            goto end;
-        }
-    end_foreach;
-
-end:
-    return ret;
+static int
+compare_pointers(const void *a, const void *b)
+{
+    uintptr_t pa = (uintptr_t)*(const purc_variant_t *)a;
+    uintptr_t pb = (uintptr_t)*(const purc_variant_t *)b;
+    return (pa > pb) - (pa < pb);
 }
 
-
 ssize_t
 purc_variant_set_intersect(purc_variant_t set, purc_variant_t value)
 {
     ssize_t ret = -1;
-    purc_variant_t tmp = PURC_VARIANT_INVALID;
+    purc_variant_t *found = NULL;
+    size_t nr_found = 0;
     if (set == PURC_VARIANT_INVALID || value == PURC_VARIANT_INVALID) {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
         goto out;
@@ -2261,12 +2309,13 @@ purc_variant_set_intersect(purc_variant_t set, purc_variant_t value)
         goto out;
     }
 
-    tmp = purc_variant_make_array(0, PURC_VARIANT_INVALID);
-    if (tmp == PURC_VARIANT_INVALID) {
+    ssize_t sz = purc_variant_linear_container_get_size(value);
+    found = malloc(sizeof(*found) * (sz > 0 ? sz : 1));
+    if (found == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
         goto out;
     }
 
-    ssize_t sz = purc_variant_linear_container_get_size(value);
     for (ssize_t i = 0; i < sz; i++) {
         purc_variant_t v = purc_variant_linear_container_get(value, i);
         if (!v) {
@@ -2278,15 +2327,16 @@ purc_variant_set_intersect(purc_variant_t set, purc_variant_t value)
             continue;
         }
 
-        if (!purc_variant_array_append(tmp, vf)) {
-            ret = -1;
-            goto out;
-        }
+        found[nr_found++] = vf;
     }
 
+    /* sort the members found to check them by binary search */
+    qsort(found, nr_found, sizeof(*found), compare_pointers);
+
     purc_variant_t v;
     foreach_value_in_variant_set_safe(set, v)
-        if (is_in_array(tmp, v, NULL)) {
+        if (nr_found > 0 && bsearch(&v, found, nr_found, sizeof(*found),
+                    compare_pointers)) {
             continue;
         }
 
@@ -2298,9 +2348,7 @@ purc_variant_set_intersect(purc_variant_t set, purc_variant_t value)
 
     ret = purc_variant_set_get_size(set);
 out:
-    if (tmp) {
-        purc_variant_unref(tmp);
-    }
+    free(found);
     return ret;
 }
 
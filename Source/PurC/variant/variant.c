@@ -44,10 +44,6 @@
     #include <dlfcn.h>
 #endif
 
-#if HAVE(GLIB)
-    #include <gmodule.h>
-#endif
-
 #include "variant_err_msgs.inc"
 
 static pcvariant_release_fn variant_releasers[PURC_VARIANT_TYPE_NR] = {
@@ -90,47 +86,40 @@ static struct err_msg_seg _variant_err_msgs_seg = {
     variant_err_msgs
 };
 
-#if HAVE(GLIB)
+static inline struct pcutils_slab *
+current_slab(void)
+{
+    struct pcinst *inst = pcinst_current();
+    return (inst && inst->variant_heap) ? inst->variant_heap->slab : NULL;
+}
+
 purc_variant *pcvariant_alloc(bool scalar) {
-    if (scalar)
-        return (purc_variant *)(void *)g_slice_alloc(sizeof(purc_variant_scalar));
-    return (purc_variant *)g_slice_alloc(sizeof(purc_variant));
+    return pcvariant_alloc_0(scalar);
 }
 
 purc_variant *pcvariant_alloc_0(bool scalar) {
-    if (scalar) {
-        return (purc_variant *)(void *)g_slice_alloc0(sizeof(purc_variant_scalar));
-    }
-    return (purc_variant *)g_slice_alloc0(sizeof(purc_variant));
+    size_t size = scalar ? sizeof(purc_variant_scalar) : sizeof(purc_variant);
+    return (purc_variant *)pcutils_slab_alloc0(current_slab(), size);
 }
 
 void pcvariant_free(purc_variant *v) {
-    if (is_variant_scalar(v)) {
-        g_slice_free1(sizeof(purc_variant_scalar), (gpointer)v);
-    }
-    else {
-        g_slice_free1(sizeof(purc_variant), (gpointer)v);
-    }
-}
-#else
-purc_variant *pcvariant_alloc(bool scalar) {
-    if (scalar)
-        return (purc_variant *)(void *)malloc(sizeof(purc_variant_scalar));
-
-    return (purc_variant *)malloc(sizeof(purc_variant));
+    size_t size = is_variant_scalar(v) ?
+        sizeof(purc_variant_scalar) : sizeof(purc_variant);
+    pcutils_slab_free(current_slab(), size, v);
 }
 
-purc_variant *pcvariant_alloc_0(void) {
-    if (scalar)
-        return (purc_variant *)(void *)calloc(1, sizeof(purc_variant_scalar));
-
-    return (purc_variant *)calloc(1, sizeof(purc_variant));
+void *pcvariant_node_alloc0(size_t size)
+{
+    void *node = pcutils_slab_alloc0(current_slab(), size);
+    if (node == NULL)
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return node;
 }
 
-void pcvariant_free(purc_variant *v) {
-    return free(v);
+void pcvariant_node_free(size_t size, void *node)
+{
+    pcutils_slab_free(current_slab(), size, node);
 }
-#endif
 
 static int _init_once(void)
 {
@@ -171,6 +160,8 @@ static void _cleanup_instance(struct pcinst *inst)
     heap->headpos = 0;
     heap->tailpos = 0;
 
+    pcvariant_release_batches(heap);
+
     struct list_head *p, *n;
     list_for_each_safe(p, n, &heap->v_reserved) {
         purc_variant_t v = list_entry(p, struct purc_variant, reserved);
@@ -179,6 +170,9 @@ static void _cleanup_instance(struct pcinst *inst)
         pcvariant_free(v);
     }
 
+    pcutils_slab_delete(heap->slab);
+    heap->slab = NULL;
+
     assert(heap->v_undefined.refc == 0);
     assert(heap->v_null.refc == 0);
     assert(heap->v_true.refc == 0);
@@ -203,6 +197,14 @@ static int _init_instance(struct pcinst *curr_inst,
 
     inst->org_vrt_heap = inst->variant_heap;
 
+    inst->variant_heap->slab = pcutils_slab_new();
+    if (inst->variant_heap->slab == NULL) {
+        free(inst->variant_heap);
+        inst->variant_heap = NULL;
+        inst->org_vrt_heap = NULL;
+        return PURC_ERROR_OUT_OF_MEMORY;
+    }
+
     // initialize const values in instance
     inst->variant_heap->v_undefined.type = PURC_VARIANT_TYPE_UNDEFINED;
     inst->variant_heap->v_undefined.refc = 0;
@@ -239,6 +241,7 @@ static int _init_instance(struct pcinst *curr_inst,
     stat->nr_max_reserved_vector = MAX_RESERVED_VARIANTS;
 
     INIT_LIST_HEAD(&inst->variant_heap->v_reserved);
+    INIT_LIST_HEAD(&inst->variant_heap->batches);
 
     return PURC_ERROR_OK;
 }
@@ -410,9 +413,25 @@ const struct purc_variant_stat *purc_variant_usage_stat(void)
     value = (purc_variant_t)&(inst->variant_heap->v_false);
     inst->variant_heap->stat.nr_values[PURC_VARIANT_TYPE_BOOLEAN] += value->refc;
 
+    struct pcutils_slab_stat slab_stat;
+    pcutils_slab_get_stat(inst->variant_heap->slab, &slab_stat);
+    inst->variant_heap->stat.nr_slab_chunks = slab_stat.nr_chunks;
+    inst->variant_heap->stat.sz_slab_chunks = slab_stat.sz_chunks;
+    inst->variant_heap->stat.nr_slab_used = slab_stat.nr_used;
+    inst->variant_heap->stat.nr_slab_free = slab_stat.nr_free;
+
     return &inst->variant_heap->stat;
 }
 
+/* charges the bytes allocated (delta > 0) or released (delta < 0) to
+   the running coroutine */
+static inline void
+charge_running_coroutine(struct pcvariant_heap *heap, int64_t delta)
+{
+    if (heap->mem_charged)
+        *heap->mem_charged += delta;
+}
+
 void pcvariant_stat_set_extra_size(purc_variant_t value, size_t extra_size)
 {
     struct pcinst *instance = pcinst_current();
@@ -424,6 +443,9 @@ void pcvariant_stat_set_extra_size(purc_variant_t value, size_t extra_size)
     int type = value->type;
 
     if (value->flags & PCVRNT_FLAG_EXTRA_SIZE) {
+        charge_running_coroutine(instance->variant_heap,
+                (int64_t)extra_size - (int64_t)value->extra_size);
+
         stat->sz_mem[type] -= value->extra_size;
         stat->sz_total_mem -= value->extra_size;
 
@@ -446,6 +468,7 @@ void pcvariant_stat_inc_extra_size(purc_variant_t value, size_t extra_size)
 
     stat->sz_mem[type] += extra_size;
     stat->sz_total_mem += extra_size;
+    charge_running_coroutine(instance->variant_heap, (int64_t)extra_size);
 }
 
 void pcvariant_stat_dec_extra_size(purc_variant_t value, size_t extra_size)
@@ -463,6 +486,7 @@ void pcvariant_stat_dec_extra_size(purc_variant_t value, size_t extra_size)
 
     stat->sz_mem[type] -= extra_size;
     stat->sz_total_mem -= extra_size;
+    charge_running_coroutine(instance->variant_heap, -(int64_t)extra_size);
 }
 
 purc_variant_t pcvariant_get(enum purc_variant_type type)
@@ -520,6 +544,11 @@ purc_variant_t pcvariant_get(enum purc_variant_type type)
     stat->nr_values[type]++;
     stat->nr_total_values++;
 
+    /* a reserved variant is charged as well: it is alive again */
+    charge_running_coroutine(heap, is_type_scalar(type) ?
+            (int64_t)sizeof(purc_variant_scalar) :
+            (int64_t)sizeof(purc_variant));
+
     return value;
 }
 
@@ -538,6 +567,10 @@ void pcvariant_put(purc_variant_t value)
     stat->nr_values[value->type]--;
     stat->nr_total_values--;
 
+    charge_running_coroutine(heap, is_variant_scalar(value) ?
+            -(int64_t)sizeof(purc_variant_scalar) :
+            -(int64_t)sizeof(purc_variant));
+
     if (is_variant_scalar(value)) {
         if (stat->nr_reserved_scalar == stat->nr_max_reserved_scalar) {
             stat->sz_mem[value->type] -= sizeof(purc_variant_scalar);
@@ -732,7 +765,19 @@ bool purc_variant_is_equal_to(purc_variant_t v1, purc_variant_t v2)
                 len2 = v2->size;
             }
 
-            return (len1 == len2 && memcmp(str1, str2, len1) == 0);
+            if (len1 != len2)
+                return false;
+
+            /* compare the cached hash values of strings first */
+            if ((v1->flags & v2->flags & PCVRNT_FLAG_SLAB_DATA) &&
+                    v1->type == PURC_VARIANT_TYPE_STRING) {
+                uint32_t h1 = pcvariant_slab_data(v1)->hash;
+                uint32_t h2 = pcvariant_slab_data(v2)->hash;
+                if (h1 && h2 && h1 != h2)
+                    return false;
+            }
+
+            return memcmp(str1, str2, len1) == 0;
 
         case PURC_VARIANT_TYPE_DYNAMIC:
         case PURC_VARIANT_TYPE_NATIVE:
@@ -2064,7 +2109,11 @@ purc_variant_t purc_variant_make_from_json_string(const char* json, size_t sz)
 purc_variant_t purc_variant_load_from_json_file(const char* file)
 {
     purc_variant_t value;
-    purc_rwstream_t rwstream = purc_rwstream_new_from_file(file, "r");
+    purc_rwstream_t rwstream = purc_rwstream_new_from_mmap(file);
+    if (rwstream == NULL) {
+        purc_clr_error();
+        rwstream = purc_rwstream_new_from_file(file, "r");
+    }
     if (rwstream == NULL)
         return PURC_VARIANT_INVALID;
 
@@ -3380,7 +3429,11 @@ struct purc_ejson_parsing_tree *
 purc_variant_ejson_parse_file(const char *fname)
 {
     struct purc_ejson_parsing_tree *ptree;
-    purc_rwstream_t rwstream = purc_rwstream_new_from_file(fname, "r");
+    purc_rwstream_t rwstream = purc_rwstream_new_from_mmap(fname);
+    if (rwstream == NULL) {
+        purc_clr_error();
+        rwstream = purc_rwstream_new_from_file(fname, "r");
+    }
     if (rwstream == NULL)
         return NULL;
 
@@ -4526,6 +4579,12 @@ void pcvariant_move_sequence(purc_variant_t to, purc_variant_t from)
         to->extra_size = from->extra_size;
         to->ptr2 = from->ptr2;
     }
+    else if (from->flags & PCVRNT_FLAG_STATIC_DATA) {
+        to->len = from->len;
+        to->ptr2 = from->ptr2;
+        /* the release hook (if any) is taken over by `to` */
+        to->extra_data = from->extra_data;
+    }
     else {
         memcpy(to->bytes, from->bytes, to->size);
     }
@@ -139,6 +139,12 @@ pcvcm_node_typename(enum pcvcm_node_type type)
     return typenames[type];
 }
 
+/*
+ * The nodes are not allocated from the variant slab: they are made only by
+ * the parsers, so they are off the hot path of evaluation, and a vCM tree
+ * lives as long as its vDOM, which may be scheduled in other runners and
+ * outlive the instance parsed it, keeping the slab of that instance alive.
+ */
 static struct pcvcm_node *
 pcvcm_node_new(enum pcvcm_node_type type, bool closed)
 {
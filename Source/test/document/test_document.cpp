@@ -774,3 +774,138 @@ TEST(document, serialize_fragment_to_stream)
 
     free(buf);
 }
+
+static void
+check_children(purc_document_t doc, pcdoc_element_t elem,
+        size_t nr_elements, size_t nr_text_nodes)
+{
+    size_t nr_elems, nr_texts, nr_datas;
+    int ret = pcdoc_element_children_count(doc, elem,
+            &nr_elems, &nr_texts, &nr_datas);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(nr_elems, nr_elements);
+    ASSERT_EQ(nr_texts, nr_text_nodes);
+}
+
+TEST(document, new_content)
+{
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    pcdoc_element_t body = purc_document_body(doc);
+    ASSERT_NE(body, nullptr);
+
+    pcdoc_element_t div = pcdoc_element_new_element(doc, body,
+            PCDOC_OP_APPEND, "div", false);
+    ASSERT_NE(div, nullptr);
+
+    /* plain text */
+    pcdoc_node node = pcdoc_element_new_content(doc, div,
+            PCDOC_OP_APPEND, "plain text", 0);
+    ASSERT_NE(node.elem, nullptr);
+    check_children(doc, div, 0, 1);
+
+    /* simple elements */
+    node = pcdoc_element_new_content(doc, div, PCDOC_OP_DISPLACE,
+            "<SPAN id=fast class='a b' class=\"c\">Hello, <b>world</b></span>"
+            "<br/>text<img src=\"foo.png\">", 0);
+    ASSERT_NE(node.elem, nullptr);
+    check_children(doc, div, 3, 1);
+
+    pcdoc_element_t span = pcdoc_element_get_child_element(doc, div, 0);
+    ASSERT_EQ(span, node.elem);
+    check_children(doc, span, 1, 1);
+
+    const char *local_name;
+    size_t local_len;
+    int ret = pcdoc_element_get_tag_name(doc, span, &local_name, &local_len,
+            NULL, NULL, NULL, NULL);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(local_len, 4);
+    ASSERT_EQ(strncmp(local_name, "span", 4), 0);
+
+    const char *val;
+    size_t len;
+    ret = pcdoc_element_get_attribute(doc, span, "class", &val, &len);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(len, 3);
+    ASSERT_EQ(strncmp(val, "a b", 3), 0);
+
+    pcdoc_element_t elem = pcdoc_get_element_by_id_in_descendants(doc,
+            div, "fast");
+    ASSERT_EQ(elem, span);
+
+    /* the fragments handled by the parser */
+    node = pcdoc_element_new_content(doc, div, PCDOC_OP_DISPLACE,
+            "<ul><li>one<li>two</ul>", 0);
+    ASSERT_NE(node.elem, nullptr);
+    check_children(doc, div, 1, 0);
+    check_children(doc, (pcdoc_element_t)node.elem, 2, 0);
+
+    node = pcdoc_element_new_content(doc, div, PCDOC_OP_DISPLACE,
+            "a &amp; b", 0);
+    ASSERT_NE(node.elem, nullptr);
+    check_children(doc, div, 0, 1);
+
+    const char *text;
+    pcdoc_text_node_t text_node = pcdoc_element_get_child_text_node(doc,
+            div, 0);
+    ASSERT_NE(text_node, nullptr);
+    ret = pcdoc_text_content_get_text(doc, text_node, &text, &len);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(len, 5);
+    ASSERT_EQ(strncmp(text, "a & b", 5), 0);
+
+    node = pcdoc_element_new_content(doc, div, PCDOC_OP_APPEND,
+            "<span>not closed", 0);
+    ASSERT_NE(node.elem, nullptr);
+    check_children(doc, div, 1, 1);
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
+
+TEST(document, get_child_by_index)
+{
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    pcdoc_element_t body = purc_document_body(doc);
+    pcdoc_element_t ul = pcdoc_element_new_element(doc, body,
+            PCDOC_OP_APPEND, "ul", false);
+    ASSERT_NE(ul, nullptr);
+
+    const size_t nr_items = 100;
+    pcdoc_element_t items[nr_items];
+    for (size_t i = 0; i < nr_items; i++) {
+        pcdoc_element_new_text_content(doc, ul, PCDOC_OP_APPEND, " ", 1);
+        items[i] = pcdoc_element_new_element(doc, ul,
+                PCDOC_OP_APPEND, "li", false);
+        ASSERT_NE(items[i], nullptr);
+    }
+    check_children(doc, ul, nr_items, nr_items);
+
+    for (size_t i = 0; i < nr_items; i++) {
+        ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, i), items[i]);
+    }
+    for (size_t i = nr_items; i > 0; i--) {
+        ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, i - 1),
+                items[i - 1]);
+    }
+    ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, 3), items[3]);
+    ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, 90), items[90]);
+    ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, nr_items), nullptr);
+    ASSERT_NE(pcdoc_element_get_child_text_node(doc, ul, 50), nullptr);
+    ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, 50), items[50]);
+
+    /* the caches are invalidated by the changes */
+    pcdoc_element_erase(doc, items[0]);
+    check_children(doc, ul, nr_items - 1, nr_items);
+    ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, 50), items[51]);
+    ASSERT_EQ(pcdoc_element_get_child_element(doc, ul, 0), items[1]);
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
@@ -724,6 +724,46 @@ TEST(dvobjs, sort)
         { "[\"3\",\"02\",1]",
             "$DATA.serialize($DATA.sort([1, '02', '3'], 'desc', 'auto'))",
             sort, sort_vrtcmp, 0 },
+        { "[-3.5,-1,0,2.5,10]",
+            "$DATA.serialize($DATA.sort([2.5, -1, 0, -3.5, 10]))",
+            sort, sort_vrtcmp, 0 },
+        { "[\"A\",\"b\",\"C\"]",
+            "$DATA.serialize($DATA.sort(['b', 'C', 'A'], 'asc', 'caseless'))",
+            sort, sort_vrtcmp, 0 },
+        { "[\"A\",\"C\",\"b\"]",
+            "$DATA.serialize($DATA.sort(['b', 'C', 'A']))",
+            sort, sort_vrtcmp, 0 },
+        { "[1,3,NaN]",
+            "$DATA.serialize($DATA.sort([3, NaN, 1]))",
+            sort, sort_vrtcmp, 0 },
+        { "[NaN,3,1]",
+            "$DATA.serialize($DATA.sort([3, NaN, 1], 'desc'))",
+            sort, sort_vrtcmp, 0 },
+        /* sorted by radix sort */
+        { "["
+            "0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,"
+            "24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,"
+            "45,46,47,48,49,50,51,52,53,54,55,56,57,58,59,60,61,62,63,NaN"
+            "]",
+            "$DATA.serialize($DATA.sort(["
+            "63, 62, 61, 60, 59, 58, 57, 56, 55, 54, NaN, 53, 52, 51, 50, "
+            "49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, "
+            "33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, "
+            "17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0"
+            "]))",
+            sort, sort_vrtcmp, 0 },
+        { "["
+            "NaN,63,62,61,60,59,58,57,56,55,54,53,52,51,50,49,48,47,46,45,44,"
+            "43,42,41,40,39,38,37,36,35,34,33,32,31,30,29,28,27,26,25,24,23,"
+            "22,21,20,19,18,17,16,15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0"
+            "]",
+            "$DATA.serialize($DATA.sort(["
+            "63, 62, 61, 60, 59, 58, 57, 56, 55, 54, NaN, 53, 52, 51, 50, "
+            "49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, "
+            "33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, "
+            "17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0"
+            "], 'desc'))",
+            sort, sort_vrtcmp, 0 },
     };
 
     run_testcases(test_cases, PCA_TABLESIZE(test_cases));
@@ -21,6 +21,7 @@
 
 #include "purc/purc-executor.h"
 
+#include "private/executor.h"
 #include "private/utils.h"
 
 #include <gtest/gtest.h>
@@ -59,6 +60,58 @@ TEST(exe_filter, basic)
     ASSERT_EQ(cleanup, true);
 }
 
+TEST(exe_filter, rule_cache)
+{
+    purc_instance_extra_info info = {};
+
+    int ret = purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hvml.test",
+            "exe_filter", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_exec_ops_t ops;
+    ASSERT_TRUE(purc_get_executor("FILTER", &ops));
+
+    purc_variant_t input = purc_variant_make_from_json_string(
+            "[1, 20, 40, 60]", 15);
+    ASSERT_NE(input, nullptr);
+
+    purc_exec_inst_t inst1 = ops->create(PURC_EXEC_TYPE_CHOOSE, input, true);
+    purc_exec_inst_t inst2 = ops->create(PURC_EXEC_TYPE_ITERATE, input, true);
+    ASSERT_NE(inst1, nullptr);
+    ASSERT_NE(inst2, nullptr);
+
+    const char *rule = "FILTER: GT 30";
+    purc_variant_t v = ops->choose(inst1, rule);
+    ASSERT_NE(v, nullptr);
+    ASSERT_EQ(purc_variant_array_get_size(v), 2);
+    purc_variant_unref(v);
+
+    // the second instance shares the parsed rule of the first one
+    purc_exec_iter_t it = ops->it_begin(inst2, rule);
+    ASSERT_NE(it, nullptr);
+    ASSERT_NE(inst1->parsed_rule, nullptr);
+    ASSERT_EQ(inst1->parsed_rule, inst2->parsed_rule);
+    ASSERT_EQ(inst1->parsed_rule->refc, 2U);
+
+    size_t count = 1;
+    while ((it = ops->it_next(inst2, it, rule)))
+        count++;
+    ASSERT_EQ(count, 2U);
+
+    // a bad rule is reported on every use
+    for (int i = 0; i < 2; i++) {
+        v = ops->choose(inst1, "FILTER: GT");
+        ASSERT_EQ(v, nullptr);
+        ASSERT_NE(inst1->err_msg, nullptr);
+    }
+
+    ops->destroy(inst1);
+    ops->destroy(inst2);
+    purc_variant_unref(input);
+
+    ASSERT_TRUE(purc_cleanup());
+}
+
 static inline bool
 parse(const char *rule, char *err_msg, size_t sz_err_msg)
 {
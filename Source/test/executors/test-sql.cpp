@@ -30,6 +30,8 @@
 #include "../helpers.h"
 
 extern "C" {
+#include "pcexe-helper.h"
+#include "exe_sql.h"
 #include "exe_sql.tab.h"
 }
 
@@ -68,9 +70,8 @@ parse(const char *rule, char *err_msg, size_t sz_err_msg)
     r = exe_sql_parse(rule, strlen(rule), &param) == 0;
     if (param.err_msg) {
         snprintf(err_msg, sz_err_msg, "%s", param.err_msg);
-        free(param.err_msg);
-        param.err_msg = NULL;
     }
+    exe_sql_param_reset(&param);
 
     return r;
 }
@@ -105,3 +106,99 @@ TEST(exe_sql, files)
     ASSERT_TRUE(ok);
 }
 
+
+static purc_variant_t
+make_rows(size_t nr_rows)
+{
+    static const char *locales[] = { "zh_CN", "zh_TW", "en_US", "en_UK" };
+
+    purc_variant_t rows = purc_variant_make_array_0();
+    for (size_t i = 0; i < nr_rows; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "n%zu", i);
+
+        // some ranks are strings, which are compared as numbers
+        purc_variant_t rank;
+        if (i % 10 == 3) {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%zu", i % 17);
+            rank = purc_variant_make_string(buf, false);
+        }
+        else {
+            rank = purc_variant_make_ulongint(i % 17);
+        }
+
+        purc_variant_t v_name = purc_variant_make_string(name, false);
+        purc_variant_t v_locale = purc_variant_make_string_static(
+                locales[i % PCA_TABLESIZE(locales)], false);
+        purc_variant_t row = purc_variant_make_object_by_static_ckey(3,
+                "name", v_name, "rank", rank, "locale", v_locale);
+        purc_variant_unref(v_name);
+        purc_variant_unref(rank);
+        purc_variant_unref(v_locale);
+
+        purc_variant_array_append(rows, row);
+        purc_variant_unref(row);
+    }
+
+    return rows;
+}
+
+static purc_variant_t
+choose(purc_exec_ops_t ops, purc_variant_t input, const char *rule)
+{
+    purc_exec_inst_t inst = ops->create(PURC_EXEC_TYPE_CHOOSE, input, true);
+    if (inst == NULL)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t v = ops->choose(inst, rule);
+    ops->destroy(inst);
+    return v;
+}
+
+TEST(exe_sql, index_vs_scan)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hvml.test",
+            "exe_sql", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_exec_ops_t ops;
+    ASSERT_TRUE(purc_get_executor("SQL", &ops));
+
+    static const char *rules[] = {
+        "SQL: SELECT name WHERE rank = 5",
+        "SQL: SELECT name WHERE rank = '5'",
+        "SQL: SELECT name, rank WHERE rank IN (1, '3', 16)",
+        "SQL: SELECT name WHERE rank >= 4 AND rank < 7",
+        "SQL: SELECT name, rank WHERE rank > 10 AND locale = 'en_US'",
+        "SQL: SELECT name, rank ORDER BY rank DESC LIMIT 20",
+        "SQL: SELECT name ORDER BY rank LIMIT 15 OFFSET 30",
+        "SQL: SELECT rank, COUNT(*) AS n GROUP BY rank ORDER BY n DESC",
+    };
+
+    // more rows than the default threshold to build the indexes
+    purc_variant_t input = make_rows(200);
+    ASSERT_NE(input, nullptr);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(rules); i++) {
+        size_t old = sql_index_set_min_rows(0);
+        purc_variant_t indexed = choose(ops, input, rules[i]);
+        ASSERT_NE(indexed, nullptr) << rules[i];
+
+        // the same query on the same rows, but without the indexes
+        sql_index_set_min_rows(SIZE_MAX);
+        purc_variant_t scanned = choose(ops, input, rules[i]);
+        sql_index_set_min_rows(old);
+        ASSERT_NE(scanned, nullptr) << rules[i];
+
+        EXPECT_EQ(purc_variant_compare_ex(indexed, scanned,
+                    PCVRNT_COMPARE_METHOD_AUTO), 0) << rules[i];
+
+        purc_variant_unref(indexed);
+        purc_variant_unref(scanned);
+    }
+
+    purc_variant_unref(input);
+    ASSERT_TRUE(purc_cleanup());
+}
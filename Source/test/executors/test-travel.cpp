@@ -30,6 +30,8 @@
 #include "../helpers.h"
 
 extern "C" {
+#include "pcexe-helper.h"
+#include "exe_travel.h"
 #include "exe_travel.tab.h"
 }
 
@@ -69,9 +71,8 @@ parse(const char *rule, char *err_msg, size_t sz_err_msg)
     r = exe_travel_parse(rule, strlen(rule), &param) == 0;
     if (param.err_msg) {
         snprintf(err_msg, sz_err_msg, "%s", param.err_msg);
-        free(param.err_msg);
-        param.err_msg = NULL;
     }
+    exe_travel_param_reset(&param);
 
     return r;
 }
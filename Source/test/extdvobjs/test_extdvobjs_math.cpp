@@ -1017,6 +1017,139 @@ TEST(dvobjs, dvobjs_math_samples)
     purc_cleanup ();
 }
 
+struct test_array_sample {
+    const char      *expr;
+    const char      *data;
+    const char      *result;
+};
+
+TEST(dvobjs, dvobjs_math_eval_array)
+{
+    struct test_array_sample samples[] = {
+        {"x + 1", "[{\"x\":1}, {\"x\":2}, {\"x\":3}]", "[2,3,4]"},
+        {"x * y", "{\"x\":[1,2,3], \"y\":[4,5,6]}", "[4,10,18]"},
+        {"x * y", "{\"x\":[1,2,3], \"y\":2}", "[2,4,6]"},
+        {"x * y", "{\"x\":1, \"y\":2}", "[2]"},
+        {"x", "[]", "[]"},
+        {"(3 + 7) * 2", "[{}, {}]", "[20,20]"},
+        {"x / y", "{\"x\":[1,2], \"y\":[1,0]}", NULL},
+        {"x + y", "{\"x\":[1,2], \"y\":[1,2,3]}", NULL},
+        {"x + y", "[{\"x\":1, \"y\":1}, {\"x\":1}]", NULL},
+        {"x", "[1, 2]", NULL},
+    };
+    purc_variant_t param[MAX_PARAM_NR];
+    size_t sz_total_mem_before = 0;
+    size_t sz_total_values_before = 0;
+    size_t nr_reserved_scalar_before = 0;
+    size_t nr_reserved_vector_before = 0;
+    size_t sz_total_mem_after = 0;
+    size_t sz_total_values_after = 0;
+    size_t nr_reserved_scalar_after = 0;
+    size_t nr_reserved_vector_after = 0;
+
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    get_variant_total_info (&sz_total_mem_before, &sz_total_values_before,
+            &nr_reserved_scalar_before, &nr_reserved_vector_before);
+
+    setenv(PURC_ENVV_DVOBJS_PATH, SOPATH, 1);
+    purc_variant_t math = purc_variant_load_dvobj_from_so (NULL, "MATH");
+    ASSERT_NE(math, nullptr);
+    ASSERT_EQ(purc_variant_is_object (math), true);
+
+    purc_variant_t dynamic = purc_variant_object_get_by_ckey_ex (math,
+            "eval_array", true);
+    ASSERT_NE(dynamic, nullptr);
+    ASSERT_EQ(purc_variant_is_dynamic (dynamic), true);
+
+    purc_dvariant_method func = NULL;
+    func = purc_variant_dynamic_get_getter (dynamic);
+    ASSERT_NE(func, nullptr);
+
+    char buf[4096];
+    purc_rwstream_t ws = purc_rwstream_new_from_mem(buf, sizeof(buf)-1);
+    for (size_t i=0; i<sizeof(samples)/sizeof(samples[0]); ++i) {
+        purc_rwstream_seek(ws, 0, SEEK_SET);
+        buf[0] = '\0';
+        buf[sizeof(buf)-1] = '\0';
+
+        const char *expr= samples[i].expr;
+        param[0] = purc_variant_make_string(expr, false);
+        param[1] = purc_variant_make_from_json_string(samples[i].data,
+                strlen(samples[i].data));
+        ASSERT_NE(param[1], nullptr);
+
+        // evaluate twice to hit the cache of the compiled expression
+        for (int j = 0; j < 2; j++) {
+            purc_variant_t ret_var = func(NULL, 2, param, false);
+            if (samples[i].result == NULL) {
+                EXPECT_EQ(ret_var, nullptr) << "eval_array should fail: ["
+                    << expr << "]" << std::endl;
+                if (ret_var)
+                    purc_variant_unref(ret_var);
+                continue;
+            }
+
+            if (!ret_var) {
+                EXPECT_NE(ret_var, nullptr) << "eval_array failed: ["
+                    << expr << "]" << std::endl;
+                continue;
+            }
+
+            purc_rwstream_seek(ws, 0, SEEK_SET);
+            ssize_t nr = purc_variant_serialize(ret_var, ws,
+                            0, 0, NULL);
+            EXPECT_GE(nr, 0) << "cast failed: ["
+                << expr << "]" << std::endl;
+            if (nr>=0)
+                buf[nr] = '\0';
+            EXPECT_STREQ(buf, samples[i].result) << "eval_array failed: ["
+                    << expr << "]" << std::endl;
+            purc_variant_unref(ret_var);
+        }
+
+        purc_variant_unref(param[0]);
+        purc_variant_unref(param[1]);
+    }
+
+    purc_rwstream_destroy(ws);
+
+    dynamic = purc_variant_object_get_by_ckey_ex (math, "eval_array_l", true);
+    ASSERT_NE(dynamic, nullptr);
+    func = purc_variant_dynamic_get_getter (dynamic);
+    ASSERT_NE(func, nullptr);
+
+    param[0] = purc_variant_make_string("x * 2", false);
+    param[1] = purc_variant_make_from_json_string("{\"x\":[1,2]}", 11);
+    purc_variant_t ret_var = func(NULL, 2, param, false);
+    ASSERT_NE(ret_var, nullptr);
+    ASSERT_EQ(purc_variant_array_get_size(ret_var), 2);
+    long double numberl = 0;
+    purc_variant_t item = purc_variant_array_get(ret_var, 1);
+    ASSERT_EQ(purc_variant_is_type (item, PURC_VARIANT_TYPE_LONGDOUBLE),
+            true);
+    purc_variant_cast_to_longdouble (item, &numberl, false);
+    ASSERT_EQ(numberl, 4.0L);
+    purc_variant_unref(ret_var);
+    purc_variant_unref(param[0]);
+    purc_variant_unref(param[1]);
+
+    purc_variant_unload_dvobj (math);
+
+    get_variant_total_info (&sz_total_mem_after,
+            &sz_total_values_after, &nr_reserved_scalar_after, &nr_reserved_vector_after);
+    ASSERT_EQ(sz_total_values_before, sz_total_values_after);
+    ASSERT_EQ(sz_total_mem_after,
+            sz_total_mem_before +
+            (nr_reserved_scalar_after - nr_reserved_scalar_before) * sizeof(purc_variant_scalar) +
+            (nr_reserved_vector_after - nr_reserved_vector_before) * sizeof(purc_variant));
+
+    purc_cleanup ();
+}
+
 static void
 _trim_tail_spaces(char *dest, size_t n)
 {
@@ -22,6 +22,10 @@
 #include "TestExtDVObj.h"
 #include "../helpers.h"
 
+#include <atomic>
+#include <pthread.h>
+#include <unistd.h>
+
 TEST(dvobjs, basic)
 {
     purc_instance_extra_info info = {};
@@ -45,3 +49,171 @@ TEST(dvobjs, hee)
     tester.run_testcases_in_file("py");
 }
 
+static purc_variant_t get_py(void *ctxt, const char *name)
+{
+    if (strcmp(name, "PY") == 0)
+        return (purc_variant_t)ctxt;
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t eval_with_py(purc_variant_t py, const char *ejson)
+{
+    struct purc_ejson_parsing_tree *ptree;
+    ptree = purc_variant_ejson_parse_string(ejson, strlen(ejson));
+    if (ptree == NULL)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t result = purc_ejson_parsing_tree_evalute(ptree,
+            get_py, py, false);
+    purc_ejson_parsing_tree_destroy(ptree);
+    return result;
+}
+
+/* makes a byte sequence referring to the buffer of a Python `bytes` */
+static purc_variant_t make_pybytes(purc_variant_t py, size_t nr_bytes)
+{
+    char ejson[256];
+    snprintf(ejson, sizeof(ejson),
+            "{{ $PY.run('def hvml_bytes(n):\\n\\treturn b\"x\" * n\\n\\n', "
+            "'source') ; $PY.global.hvml_bytes(%zuL) }}", nr_bytes);
+    return eval_with_py(py, ejson);
+}
+
+static bool is_filled_with_x(purc_variant_t bs, size_t nr_expected)
+{
+    size_t nr_bytes = 0;
+    const unsigned char *bytes = purc_variant_get_bytes_const(bs, &nr_bytes);
+    if (bytes == NULL || nr_bytes != nr_expected)
+        return false;
+
+    for (size_t i = 0; i < nr_bytes; i++) {
+        if (bytes[i] != 'x')
+            return false;
+    }
+    return true;
+}
+
+TEST(dvobjs, py_bsequence_after_unload)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    setenv(PURC_ENVV_DVOBJS_PATH, SOPATH, 1);
+
+    purc_variant_t py = purc_variant_load_dvobj_from_so("PY", "PY");
+    ASSERT_NE(py, nullptr);
+
+    purc_variant_t bs = make_pybytes(py, 8192);
+    ASSERT_NE(bs, nullptr);
+    ASSERT_TRUE(purc_variant_is_bsequence(bs));
+
+    // the bytes are still there after $PY is unloaded
+    ASSERT_TRUE(purc_variant_unload_dvobj(py));
+    ASSERT_TRUE(is_filled_with_x(bs, 8192));
+    purc_variant_unref(bs);
+
+    // the interpreter kept for the byte sequence is used again
+    py = purc_variant_load_dvobj_from_so("PY", "PY");
+    ASSERT_NE(py, nullptr);
+
+    bs = make_pybytes(py, 8192);
+    ASSERT_NE(bs, nullptr);
+    ASSERT_TRUE(is_filled_with_x(bs, 8192));
+    purc_variant_unref(bs);
+
+    ASSERT_TRUE(purc_variant_unload_dvobj(py));
+    purc_cleanup();
+}
+
+/* the atom of the receiver, or RECEIVER_FAILED */
+#define RECEIVER_FAILED     ((purc_atom_t)-1)
+
+static std::atomic<purc_atom_t> receiver_inst;
+static std::atomic<bool> receiver_got_bytes;
+
+static void *receiver_entry(void *arg)
+{
+    (void)arg;
+
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "receiver", NULL);
+    if (ret != PURC_ERROR_OK) {
+        receiver_inst = RECEIVER_FAILED;
+        return NULL;
+    }
+
+    purc_atom_t atom = purc_inst_create_move_buffer(
+            PCINST_MOVE_BUFFER_BROADCAST, 16);
+    if (atom == 0) {
+        receiver_inst = RECEIVER_FAILED;
+        purc_cleanup();
+        return NULL;
+    }
+    receiver_inst = atom;
+
+    // wait for the message for 5 seconds at most
+    for (int i = 0; i < 500; i++) {
+        size_t n = 0;
+        if (purc_inst_holding_messages_count(&n) == 0 && n > 0) {
+            pcrdr_msg *msg = purc_inst_take_away_message(0);
+            receiver_got_bytes = msg->data &&
+                is_filled_with_x(msg->data, 8192);
+            // the copy is released in this thread without Python
+            pcrdr_release_message(msg);
+            break;
+        }
+        usleep(10000);
+    }
+
+    purc_inst_destroy_move_buffer();
+    purc_cleanup();
+    return NULL;
+}
+
+TEST(dvobjs, py_bsequence_moved)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hvml.test",
+            "dvobjs", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    setenv(PURC_ENVV_DVOBJS_PATH, SOPATH, 1);
+
+    purc_variant_t py = purc_variant_load_dvobj_from_so("PY", "PY");
+    ASSERT_NE(py, nullptr);
+
+    purc_variant_t bs = make_pybytes(py, 8192);
+    ASSERT_NE(bs, nullptr);
+
+    receiver_inst = 0;
+    receiver_got_bytes = false;
+
+    pthread_t th;
+    ASSERT_EQ(pthread_create(&th, NULL, receiver_entry, NULL), 0);
+    while (receiver_inst == 0)
+        usleep(10000);
+    ASSERT_NE(receiver_inst, RECEIVER_FAILED);
+
+    pcrdr_msg *event = pcrdr_make_event_message(
+            PCRDR_MSG_TARGET_INSTANCE, 1, "bytes", NULL,
+            PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+            PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+    ASSERT_NE(event, nullptr);
+    event->dataType = PCRDR_MSG_DATA_TYPE_JSON;
+    event->data = purc_variant_ref(bs);
+
+    // the receiver gets a copy of the bytes
+    ASSERT_EQ(purc_inst_move_message(receiver_inst, event), 1);
+    pcrdr_release_message(event);
+
+    pthread_join(th, NULL);
+    ASSERT_TRUE(receiver_got_bytes);
+
+    // the Python buffer is released in this thread
+    ASSERT_TRUE(is_filled_with_x(bs, 8192));
+    purc_variant_unref(bs);
+
+    ASSERT_TRUE(purc_variant_unload_dvobj(py));
+    purc_cleanup();
+}
+
@@ -21,6 +21,8 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <limits.h>
+#include <unistd.h>
 #include <gtest/gtest.h>
 
 #define ATOM_BITS_NR        (sizeof(purc_atom_t) << 3)
@@ -62,3 +64,65 @@ TEST(instance, mylog)
     purc_cleanup();
 }
 
+
+TEST(instance, async_log)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hvml.purc",
+            "async", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), PURC_LOG_FILE_PATH_FORMAT,
+            "cn.fmsoft.hvml.purc", "async");
+    unlink(path);
+
+    ASSERT_TRUE(purc_enable_log_ex(PURC_LOG_MASK_ALL,
+                PURC_LOG_FACILITY_FILE));
+    ASSERT_TRUE(purc_set_log_options(PURC_LOG_OPT_ASYNC | PURC_LOG_OPT_JSON));
+    ASSERT_EQ(purc_get_log_options(), PURC_LOG_OPT_ASYNC | PURC_LOG_OPT_JSON);
+
+    for (int i = 0; i < 10; i++)
+        purc_log_info("async message #%d\n", i);
+    purc_log_with_tag_f(PURC_LOG_INFO, "MINE", "a \"quoted\" message\n");
+    // a user tag longer than the one kept in a record
+    purc_log_with_tag_f(PURC_LOG_INFO, "user-tag-given-by-RUNNER.log-in-hvml",
+            "a long tag\n");
+
+    // disabling the log writes all records out
+    purc_enable_log_ex(0, PURC_LOG_FACILITY_FILE);
+    ASSERT_EQ(purc_get_log_nr_dropped(), 0);
+
+    FILE *fp = fopen(path, "r");
+    ASSERT_NE(fp, nullptr);
+
+    char line[1024];
+    int nr_lines = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        ASSERT_EQ(line[0], '{');
+        ASSERT_NE(strstr(line, "\"runner\":\"async\""), nullptr);
+        if (nr_lines < 10) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "\"msg\":\"async message #%d\"}\n",
+                    nr_lines);
+            ASSERT_NE(strstr(line, "\"tag\":\"INFO\""), nullptr);
+            ASSERT_NE(strstr(line, msg), nullptr);
+        }
+        else if (nr_lines == 10) {
+            ASSERT_NE(strstr(line, "\"tag\":\"MINE\""), nullptr);
+            ASSERT_NE(strstr(line, "\"msg\":\"a \\\"quoted\\\" message\"}"),
+                    nullptr);
+        }
+        else {
+            ASSERT_NE(strstr(line,
+                    "\"tag\":\"user-tag-given-by-RUNNER.log-in-hvml\""),
+                    nullptr);
+        }
+        nr_lines++;
+    }
+    fclose(fp);
+    unlink(path);
+
+    ASSERT_EQ(nr_lines, 12);
+
+    purc_cleanup();
+}
@@ -30,6 +30,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
 
 
 void create_temp_file(const char* file, const char* buf, size_t buf_len)
@@ -564,6 +567,155 @@ TEST(mem_rwstream, seek_read)
     ASSERT_EQ(ret, 0);
 }
 
+TEST(mem_rwstream, peek_consume)
+{
+    char buf[] = "This这 is 测。";
+    size_t buf_len = strlen(buf);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mem (buf, buf_len);
+    ASSERT_NE(rws, nullptr);
+
+    // the data of a memory stream are peeked in place
+    const void *data = NULL;
+    ssize_t n = purc_rwstream_peek (rws, &data, 1);
+    ASSERT_EQ(n, (ssize_t)buf_len);
+    ASSERT_EQ(data, (const void *)buf);
+
+    ASSERT_EQ(purc_rwstream_consume (rws, 4), 4);
+    ASSERT_EQ(purc_rwstream_tell (rws), 4);
+
+    char read_buf[100] = {0};
+    uint32_t wc = 0;
+    int read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_EQ(wc, 0x8FD9);
+
+    // the bytes put back are peeked before the rest of the stream
+    ASSERT_EQ(purc_rwstream_ungetc (rws, read_buf, read_len), read_len);
+    n = purc_rwstream_peek (rws, &data, 4);
+    ASSERT_GE(n, 4);
+    ASSERT_EQ(memcmp(data, buf + 4, 4), 0);
+
+    ASSERT_EQ(purc_rwstream_consume (rws, 3), 3);
+    ASSERT_EQ(purc_rwstream_tell (rws), 7);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+}
+
+/* test mmap rwstream */
+TEST(mmap_rwstream, new_destroy)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    char buf[] = "This is test file. 这是测试文件。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mmap (tmp_file);
+    ASSERT_NE(rws, nullptr);
+
+    size_t sz = 0;
+    char* mem_buffer = (char*)purc_rwstream_get_mem_buffer (rws, &sz);
+    ASSERT_NE(mem_buffer, nullptr);
+    ASSERT_EQ(sz, buf_len);
+    ASSERT_EQ(memcmp(mem_buffer, buf, buf_len), 0);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    remove_temp_file(tmp_file);
+}
+
+TEST(mmap_rwstream, empty_file)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    create_temp_file(tmp_file, "", 0);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mmap (tmp_file);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[16] = {0};
+    int read_len = purc_rwstream_read (rws, read_buf, sizeof(read_buf));
+    ASSERT_EQ(read_len, 0);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    remove_temp_file(tmp_file);
+}
+
+TEST(mmap_rwstream, not_regular_file)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_mmap ("/tmp");
+    ASSERT_EQ(rws, nullptr);
+
+    rws = purc_rwstream_new_from_mmap ("/tmp/not-existing-rwstream.txt");
+    ASSERT_EQ(rws, nullptr);
+}
+
+TEST(mmap_rwstream, read_write)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    char buf[] = "This is test file. 这是测试文件。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mmap (tmp_file);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[1024] = {0};
+    int read_len = purc_rwstream_read (rws, read_buf, sizeof(read_buf));
+    ASSERT_EQ(read_len, buf_len);
+    ASSERT_STREQ(read_buf, buf);
+
+    // the stream is read-only
+    ssize_t write_len = purc_rwstream_write (rws, buf, buf_len);
+    ASSERT_EQ(write_len, -1);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    remove_temp_file(tmp_file);
+}
+
+TEST(mmap_rwstream, seek_read)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    char buf[] = "This这 is 测。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mmap (tmp_file);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[100] = {0};
+    uint32_t wc = 0;
+    int read_len = 0;
+
+    off_t pos = purc_rwstream_seek (rws, 4, SEEK_SET);
+    ASSERT_EQ(pos, 4);
+
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_STREQ(read_buf, "这");
+
+    pos = purc_rwstream_seek (rws, -3, SEEK_END);
+    ASSERT_EQ(pos, buf_len - 3);
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_STREQ(read_buf, "。");
+
+    pos = purc_rwstream_tell (rws);
+    ASSERT_EQ(pos, buf_len);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    remove_temp_file(tmp_file);
+}
+
 /* test buffer rwstream */
 TEST(buffer_rwstream, new_destroy)
 {
@@ -1166,6 +1318,119 @@ TEST(gio_rwstream, seek_read)
 
     remove_temp_file(tmp_file);
 }
+
+TEST(gio_rwstream, peek_consume)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    char buf[] = "This这 is 测。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    int fd = open(tmp_file, O_RDWR, S_IRGRP | S_IWGRP | S_IRUSR
+            | S_IWUSR | S_IROTH);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd (fd);
+
+    const void *data = NULL;
+    ssize_t n = purc_rwstream_peek (rws, &data, 4);
+    ASSERT_EQ(n, (ssize_t)buf_len);
+    ASSERT_EQ(memcmp(data, buf, buf_len), 0);
+    ASSERT_EQ(purc_rwstream_tell (rws), 0);
+
+    ASSERT_EQ(purc_rwstream_consume (rws, 4), 4);
+    ASSERT_EQ(purc_rwstream_tell (rws), 4);
+
+    char read_buf[100] = {0};
+    uint32_t wc = 0;
+    int read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_EQ(wc, 0x8FD9);
+    ASSERT_EQ(purc_rwstream_tell (rws), 7);
+
+    off_t pos = purc_rwstream_seek (rws, 1, SEEK_CUR);
+    ASSERT_EQ(pos, 8);
+
+    n = purc_rwstream_peek (rws, &data, 1);
+    ASSERT_EQ(n, (ssize_t)(buf_len - 8));
+    ASSERT_EQ(memcmp(data, buf + 8, n), 0);
+
+    ASSERT_EQ(purc_rwstream_consume (rws, n + 1), -1);
+    ASSERT_EQ(purc_rwstream_consume (rws, n), n);
+
+    n = purc_rwstream_peek (rws, &data, 1);
+    ASSERT_EQ(n, 0);
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    remove_temp_file(tmp_file);
+}
+#endif
+
+#if OS(UNIX)
+TEST(fd_rwstream, write_keeps_read_ahead_on_socket)
+{
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    const char request[] = "first\nsecond\n";
+    ASSERT_EQ(write(fds[1], request, strlen(request)),
+            (ssize_t)strlen(request));
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd (fds[0]);
+    ASSERT_NE(rws, nullptr);
+
+    // the whole request is read ahead into the buffer
+    char read_buf[16] = {0};
+    ASSERT_EQ(purc_rwstream_read (rws, read_buf, 6), 6);
+    ASSERT_STREQ(read_buf, "first\n");
+
+    // writing the reply does not drop the rest of the request
+    ASSERT_EQ(purc_rwstream_write (rws, "ok\n", 3), 3);
+
+    memset(read_buf, 0, sizeof(read_buf));
+    ASSERT_EQ(purc_rwstream_read (rws, read_buf, 7), 7);
+    ASSERT_STREQ(read_buf, "second\n");
+
+    memset(read_buf, 0, sizeof(read_buf));
+    ASSERT_EQ(read(fds[1], read_buf, sizeof(read_buf)), 3);
+    ASSERT_STREQ(read_buf, "ok\n");
+
+    ASSERT_EQ(purc_rwstream_destroy (rws), 0);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(fd_rwstream, read_after_peek_on_socket)
+{
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    // fail instead of hanging if the read blocks for more bytes
+    struct timeval tv = { 1, 0 };
+    ASSERT_EQ(setsockopt(fds[0], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)), 0);
+
+    const char request[] = "hello";
+    ASSERT_EQ(write(fds[1], request, strlen(request)),
+            (ssize_t)strlen(request));
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd (fds[0]);
+    ASSERT_NE(rws, nullptr);
+
+    const void *data;
+    ssize_t n = purc_rwstream_peek (rws, &data, 2);
+    ASSERT_GE(n, 2);
+    ASSERT_EQ(memcmp(data, "he", 2), 0);
+
+    // only the bytes available are returned, without waiting for more
+    char read_buf[64] = {0};
+    ASSERT_EQ(purc_rwstream_read (rws, read_buf, sizeof(read_buf)), n);
+    ASSERT_EQ(memcmp(read_buf, request, n), 0);
+
+    ASSERT_EQ(purc_rwstream_destroy (rws), 0);
+    close(fds[0]);
+    close(fds[1]);
+}
 #endif
 
 
@@ -200,3 +200,54 @@ TEST(regex, match_info)
     pcregex_destroy(regex);
 }
 
+
+TEST(regex, cache)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    struct pcregex_cache_stat stat;
+    pcregex_cache_get_stat(&stat);
+    ASSERT_EQ(stat.nr_entries, 0);
+
+    /* the simple patterns */
+    ASSERT_EQ(pcregex_is_match("click", "click"), true);
+    ASSERT_EQ(pcregex_is_match("lick", "click"), true);
+    ASSERT_EQ(pcregex_is_match("^lick", "click"), false);
+    ASSERT_EQ(pcregex_is_match("^cli", "click"), true);
+    ASSERT_EQ(pcregex_is_match("ick$", "click"), true);
+    ASSERT_EQ(pcregex_is_match("ick$", "click\n"), true);
+    ASSERT_EQ(pcregex_is_match("^click$", "click\n"), true);
+    ASSERT_EQ(pcregex_is_match("^click$", "clicks"), false);
+    ASSERT_EQ(pcregex_is_match(".*", "change"), true);
+
+    pcregex_cache_get_stat(&stat);
+    ASSERT_EQ(stat.nr_simple, 9);
+    ASSERT_EQ(stat.nr_misses, 0);
+
+    /* the compiled patterns */
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(pcregex_is_match("^\\d*[@?!^:=%~<]$", "2!"), true);
+        ASSERT_EQ(pcregex_is_match("^\\d*[@?!^:=%~<]$", "2a"), false);
+    }
+
+    pcregex_cache_get_stat(&stat);
+    ASSERT_EQ(stat.nr_entries, 1);
+    ASSERT_EQ(stat.nr_misses, 1);
+    ASSERT_EQ(stat.nr_hits, 19);
+
+    /* the least recently used patterns are evicted */
+    char pattern[32];
+    for (int i = 0; i < 100; i++) {
+        snprintf(pattern, sizeof(pattern), "^a{%d}$", i + 1);
+        ASSERT_EQ(pcregex_is_match(pattern, "aaa"), i == 2);
+    }
+
+    pcregex_cache_get_stat(&stat);
+    ASSERT_GT(stat.nr_evictions, 0);
+    ASSERT_EQ(stat.nr_entries + stat.nr_evictions, 101);
+
+    purc_cleanup();
+}
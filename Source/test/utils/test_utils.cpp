@@ -28,6 +28,7 @@
 #include "private/atom-buckets.h"
 #include "private/sorted-array.h"
 #include "private/url.h"
+#include "private/utils.h"
 
 #include "../helpers.h"
 
@@ -2315,3 +2316,52 @@ TEST(valid_css_identifier, normal)
     r = purc_is_valid_css_identifier(id);
     ASSERT_EQ(r, false);
 }
+
+static uint32_t crc32_bytewise(purc_crc32_algo_t algo,
+        const uint8_t *buf, size_t n)
+{
+    pcutils_crc32_ctxt ctxt;
+    pcutils_crc32_begin(&ctxt, algo);
+
+    uint32_t crc = ctxt.crc32;
+    for (size_t i = 0; i < n; i++) {
+        if (ctxt.refout)
+            crc = (crc >> 8) ^ ctxt.table_static[(crc ^ buf[i]) & 0xFF];
+        else
+            crc = (crc << 8) ^ ctxt.table_static[((crc >> 24) ^ buf[i]) & 0xFF];
+    }
+
+    return crc ^ ctxt.xorout;
+}
+
+TEST(utils, crc32_engines)
+{
+    uint8_t buf[1024 + 8];
+    for (size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (uint8_t)(i * 131 + 7);
+
+    for (int algo = PURC_K_ALGO_CRC32; algo <= PURC_K_ALGO_CRC32Q; algo++) {
+        pcutils_crc32_ctxt ctxt;
+        pcutils_crc32_begin(&ctxt, (purc_crc32_algo_t)algo);
+        purc_log_info("CRC32 algorithm %d uses engine %s\n", algo,
+                pcutils_crc32_engine_name(&ctxt));
+
+        // different lengths, alignments, and sizes of the chunks.
+        for (size_t len = 0; len <= 1024; len += 17) {
+            for (size_t off = 0; off < 8; off += 3) {
+                for (size_t step = 1; step <= 257; step += 64) {
+                    pcutils_crc32_begin(&ctxt, (purc_crc32_algo_t)algo);
+                    for (size_t i = 0; i < len; i += step) {
+                        pcutils_crc32_update(&ctxt, buf + off + i,
+                                (len - i < step) ? (len - i) : step);
+                    }
+
+                    uint32_t crc32;
+                    pcutils_crc32_end(&ctxt, &crc32);
+                    ASSERT_EQ(crc32, crc32_bytewise((purc_crc32_algo_t)algo,
+                                buf + off, len));
+                }
+            }
+        }
+    }
+}
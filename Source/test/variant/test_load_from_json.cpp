@@ -326,3 +326,144 @@ std::vector<ejson_test_data> read_ejson_test_data()
 INSTANTIATE_TEST_SUITE_P(ejson, variant_load_from_json,
         testing::ValuesIn(read_ejson_test_data()));
 
+
+static void
+check_json_records(const char *json, pcvrnt_json_records_k records,
+        const char **expected, size_t nr_expected)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void*)json,
+            strlen(json));
+    ASSERT_NE(rws, nullptr);
+
+    pcvrnt_json_reader_t reader = purc_variant_json_reader_new(rws, records);
+    ASSERT_NE(reader, nullptr);
+
+    for (size_t i = 0; i < nr_expected; i++) {
+        purc_variant_t v = purc_variant_json_reader_next(reader);
+        ASSERT_NE(v, PURC_VARIANT_INVALID) << json << " #" << i;
+
+        char *buf = purc_variant_serialize_alloc(v, 0,
+                PCVRNT_SERIALIZE_OPT_PLAIN, NULL, NULL);
+        ASSERT_STREQ(buf, expected[i]) << json << " #" << i;
+        free(buf);
+        purc_variant_unref(v);
+    }
+
+    ASSERT_EQ(purc_variant_json_reader_next(reader), PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_NO_DATA);
+
+    purc_variant_json_reader_delete(reader);
+    purc_rwstream_destroy(rws);
+}
+
+TEST(variant, json_reader)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *elements[] = {
+        "1", "\"abc\"", "{\"a\":\"]\"}", "[2,3]", "true" };
+    check_json_records(" [1, \"abc\", {\"a\": \"]\"}, [2, 3], true] ",
+            PCVRNT_JSON_RECORDS_AUTO, elements, PCA_TABLESIZE(elements));
+    check_json_records("[]", PCVRNT_JSON_RECORDS_ARRAY, NULL, 0);
+
+    const char *lines[] = { "{\"id\":1}", "{\"id\":2}", "[1]", "3" };
+    check_json_records("{\"id\": 1}\n{\"id\": 2}\n[1]\n3\n",
+            PCVRNT_JSON_RECORDS_LINES, lines, PCA_TABLESIZE(lines));
+
+    // a record larger than the chunk read from the stream
+    std::string big = "[\"";
+    big.append(10000, 'x');
+    big += "\", 0]";
+    std::string expected = "\"";
+    expected.append(10000, 'x');
+    expected += "\"";
+    const char *bigs[] = { expected.c_str(), "0" };
+    check_json_records(big.c_str(), PCVRNT_JSON_RECORDS_AUTO,
+            bigs, PCA_TABLESIZE(bigs));
+
+    // a truncated array
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void*)"[1, 2", 5);
+    pcvrnt_json_reader_t reader = purc_variant_json_reader_new(rws,
+            PCVRNT_JSON_RECORDS_AUTO);
+    purc_variant_t v = purc_variant_json_reader_next(reader);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    purc_variant_unref(v);
+    v = purc_variant_json_reader_next(reader);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    purc_variant_unref(v);
+    ASSERT_EQ(purc_variant_json_reader_next(reader), PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_INVALID_VALUE);
+    purc_variant_json_reader_delete(reader);
+    purc_rwstream_destroy(rws);
+
+    // triple-quoted strings and empty strings
+    const char *quoted[] = { "\"a\\\"b\"", "\"c'd\"", "\"\"", "1" };
+    check_json_records("[\"\"\"a\"b\"\"\", '''c'd''', \"\", 1]",
+            PCVRNT_JSON_RECORDS_AUTO, quoted, PCA_TABLESIZE(quoted));
+
+    purc_cleanup();
+}
+
+static void
+check_interleaved_reads(purc_rwstream_t rws)
+{
+    pcvrnt_json_reader_t reader = purc_variant_json_reader_new(rws,
+            PCVRNT_JSON_RECORDS_LINES);
+    ASSERT_NE(reader, nullptr);
+
+    purc_variant_t v = purc_variant_json_reader_next(reader);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    char *buf = purc_variant_serialize_alloc(v, 0,
+            PCVRNT_SERIALIZE_OPT_PLAIN, NULL, NULL);
+    ASSERT_STREQ(buf, "{\"id\":1}");
+    free(buf);
+    purc_variant_unref(v);
+
+    // the bytes following the record are left in the stream
+    char line[8] = { };
+    ASSERT_EQ(purc_rwstream_read(rws, line, 7), 7);
+    ASSERT_STREQ(line, "\nhello\n");
+
+    v = purc_variant_json_reader_next(reader);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    buf = purc_variant_serialize_alloc(v, 0,
+            PCVRNT_SERIALIZE_OPT_PLAIN, NULL, NULL);
+    ASSERT_STREQ(buf, "{\"id\":2}");
+    free(buf);
+    purc_variant_unref(v);
+
+    ASSERT_EQ(purc_variant_json_reader_next(reader), PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_NO_DATA);
+    purc_variant_json_reader_delete(reader);
+}
+
+TEST(variant, json_reader_interleaved)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *data = "{\"id\": 1}\nhello\n{\"id\": 2}\n";
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void*)data,
+            strlen(data));
+    ASSERT_NE(rws, nullptr);
+    check_interleaved_reads(rws);
+    purc_rwstream_destroy(rws);
+
+    // a stream reading ahead into its buffer; the stream closes the file
+    FILE *fp = tmpfile();
+    ASSERT_NE(fp, nullptr);
+    ASSERT_EQ(fwrite(data, 1, strlen(data), fp), strlen(data));
+    rewind(fp);
+    rws = purc_rwstream_new_from_fp(fp);
+    ASSERT_NE(rws, nullptr);
+    check_interleaved_reads(rws);
+    purc_rwstream_destroy(rws);
+
+    purc_cleanup();
+}
@@ -995,3 +995,79 @@ TEST(variant, serialize_object_with_empty_key2)
 
     purc_cleanup ();
 }
+
+// to test: serialize real numbers in the shortest form
+TEST(variant, serialize_real_shortest)
+{
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    purc_variant_t my_variant = purc_variant_make_array_0();
+    ASSERT_NE(my_variant, PURC_VARIANT_INVALID);
+
+    const double numbers[] = { 0.1, 1.0 / 3, -2.5, 1e-7, 123.0 };
+    for (size_t i = 0; i < PCA_TABLESIZE(numbers); i++) {
+        purc_variant_t v = purc_variant_make_number(numbers[i]);
+        ASSERT_TRUE(purc_variant_array_append(my_variant, v));
+        purc_variant_unref(v);
+    }
+
+    char *str = purc_variant_serialize_alloc(my_variant, 0,
+            PCVRNT_SERIALIZE_OPT_REAL_SHORTEST, NULL, NULL);
+    ASSERT_STREQ(str, "[0.1,0.3333333333333333,-2.5,1e-07,123]");
+    free(str);
+
+    str = purc_variant_serialize_alloc(my_variant, 0,
+            PCVRNT_SERIALIZE_OPT_PLAIN, NULL, NULL);
+    ASSERT_STREQ(str,
+            "[0.10000000000000001,0.33333333333333331,-2.5,"
+            "9.9999999999999995e-08,123]");
+    free(str);
+
+    purc_variant_unref(my_variant);
+    purc_cleanup ();
+}
+
+// to test: serialize deeply nested containers
+TEST(variant, serialize_deeply_nested)
+{
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const size_t depth = 2000;
+    purc_variant_t my_variant = purc_variant_make_null();
+    for (size_t i = 0; i < depth; i++) {
+        purc_variant_t outer = purc_variant_make_array(1, my_variant);
+        ASSERT_NE(outer, PURC_VARIANT_INVALID);
+        purc_variant_unref(my_variant);
+        my_variant = outer;
+    }
+
+    size_t sz_content = 0;
+    char *str = purc_variant_serialize_alloc(my_variant, 0,
+            PCVRNT_SERIALIZE_OPT_PLAIN, &sz_content, NULL);
+    ASSERT_NE(str, nullptr);
+    ASSERT_EQ(sz_content, depth * 2 + sizeof("null"));
+    ASSERT_EQ(strspn(str, "["), depth);
+    ASSERT_EQ(strncmp(str + depth, "null", 4), 0);
+    ASSERT_EQ(strspn(str + depth + 4, "]"), depth);
+    free(str);
+
+    /* the length expected is reported even if the stream is too small */
+    char buf[16];
+    purc_rwstream_t my_rws = purc_rwstream_new_from_mem(buf, sizeof(buf) - 1);
+    ASSERT_NE(my_rws, nullptr);
+
+    size_t len_expected = 0;
+    ssize_t n = purc_variant_serialize(my_variant, my_rws, 0,
+            PCVRNT_SERIALIZE_OPT_PLAIN | PCVRNT_SERIALIZE_OPT_IGNORE_ERRORS,
+            &len_expected);
+    ASSERT_EQ(n, (ssize_t)sizeof(buf) - 1);
+    ASSERT_EQ(len_expected, depth * 2 + 4);
+
+    purc_rwstream_destroy(my_rws);
+    purc_variant_unref(my_variant);
+    purc_cleanup ();
+}
@@ -1611,6 +1611,49 @@ TEST(variant, reuse_buff)
     purc_cleanup ();
 }
 
+static void on_release_external_bytes(void *ctxt)
+{
+    int *nr_released = (int *)ctxt;
+    (*nr_released)++;
+}
+
+TEST(variant, bsequence_external)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    static const unsigned char bytes[] = "external bytes";
+    int nr_released = 0;
+
+    purc_variant_t v;
+    v = purc_variant_make_byte_sequence_external(bytes, sizeof(bytes),
+            on_release_external_bytes, &nr_released);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+
+    size_t nr_bytes;
+    const unsigned char *p = purc_variant_get_bytes_const(v, &nr_bytes);
+    ASSERT_EQ(p, bytes);
+    ASSERT_EQ(nr_bytes, sizeof(bytes));
+
+    /* read-only */
+    ASSERT_FALSE(purc_variant_bsequence_append(v, bytes, 1));
+
+    purc_variant_ref(v);
+    purc_variant_unref(v);
+    ASSERT_EQ(nr_released, 0);
+    purc_variant_unref(v);
+    ASSERT_EQ(nr_released, 1);
+
+    v = purc_variant_make_byte_sequence_external(NULL, 0,
+            on_release_external_bytes, &nr_released);
+    ASSERT_EQ(v, PURC_VARIANT_INVALID);
+    ASSERT_EQ(nr_released, 1);
+
+    purc_cleanup ();
+}
+
 // Test BigInt related APIs
 TEST(variant, pcvariant_bigint) {
     // Test case structure
@@ -1701,3 +1744,93 @@ TEST(variant, pcvariant_bigint) {
     purc_rwstream_destroy(rws);
     purc_cleanup();
 }
+
+TEST(variant, slab_stat)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const struct purc_variant_stat *stat = purc_variant_usage_stat();
+    ASSERT_NE(stat, nullptr);
+    size_t nr_used = stat->nr_slab_used;
+
+    const size_t nr_members = 1000;
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, nullptr);
+    for (size_t i = 0; i < nr_members; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    // the array, the members, and the nodes of the array
+    stat = purc_variant_usage_stat();
+    ASSERT_GE(stat->nr_slab_used, nr_used + nr_members * 2 + 1);
+    ASSERT_GT(stat->nr_slab_chunks, 0);
+    ASSERT_GE(stat->sz_slab_chunks, stat->nr_slab_used * sizeof(void *));
+
+    // the released variants may be kept in the reserved list
+    purc_variant_unref(arr);
+    stat = purc_variant_usage_stat();
+    ASSERT_LE(stat->nr_slab_used, nr_used + MAX_RESERVED_VARIANTS * 2);
+    ASSERT_GE(stat->nr_slab_free, nr_members);
+
+    purc_cleanup();
+}
+
+TEST(variant, medium_strings)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const struct purc_variant_stat *stat = purc_variant_usage_stat();
+    size_t nr_used = stat->nr_slab_used;
+
+    // longer than the space in the wrapper, but short enough for the slab
+    const char *ids[] = {
+        "org.example.module.identifier.one",
+        "org.example.module.identifier.two.with.a.longer.suffix",
+        "org.example.module.identifier.two.with.a.longer.suffiy",
+    };
+
+    purc_variant_t strs[PCA_TABLESIZE(ids)];
+    for (size_t i = 0; i < PCA_TABLESIZE(ids); i++) {
+        strs[i] = purc_variant_make_string(ids[i], false);
+        ASSERT_NE(strs[i], nullptr);
+
+        size_t len;
+        const char *str = purc_variant_get_string_const_ex(strs[i], &len);
+        ASSERT_STREQ(str, ids[i]);
+        ASSERT_EQ(len, strlen(ids[i]));
+    }
+
+    // the wrappers and the bytes of the strings
+    stat = purc_variant_usage_stat();
+    ASSERT_GE(stat->nr_slab_used, nr_used + PCA_TABLESIZE(ids) * 2);
+
+    purc_variant_t dup = purc_variant_make_string(ids[1], false);
+    ASSERT_TRUE(purc_variant_is_equal_to(dup, strs[1]));
+    ASSERT_FALSE(purc_variant_is_equal_to(dup, strs[2]));
+
+
+    unsigned char bytes[100];
+    for (size_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = (unsigned char)i;
+    purc_variant_t bs = purc_variant_make_byte_sequence(bytes, sizeof(bytes));
+    ASSERT_NE(bs, nullptr);
+    size_t nr_bytes;
+    const unsigned char *p = purc_variant_get_bytes_const(bs, &nr_bytes);
+    ASSERT_EQ(nr_bytes, sizeof(bytes));
+    ASSERT_EQ(memcmp(p, bytes, sizeof(bytes)), 0);
+
+    purc_variant_unref(bs);
+    purc_variant_unref(dup);
+    for (size_t i = 0; i < PCA_TABLESIZE(ids); i++)
+        purc_variant_unref(strs[i]);
+
+    purc_cleanup();
+}
@@ -533,3 +533,268 @@ TEST(variant_array, sort)
     ASSERT_STREQ(inbuf, outbuf);
 }
 
+
+struct batch_events {
+    size_t      nr_events;
+    size_t      nr_batched;
+    size_t      nr_members;
+};
+
+static bool
+on_array_grown(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    (void)source;
+    (void)msg_type;
+
+    struct batch_events *events = (struct batch_events *)ctxt;
+    events->nr_events++;
+
+    if (purc_variant_is_batched_event(nr_args, argv)) {
+        size_t sz = 0;
+        events->nr_batched++;
+        purc_variant_array_size(argv[0], &sz);
+        events->nr_members += sz;
+    }
+    else {
+        events->nr_members++;
+    }
+
+    return true;
+}
+
+TEST(variant_array, append_many)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_variant_t values[100];
+    for (size_t i = 0; i < PCA_TABLESIZE(values); i++) {
+        values[i] = purc_variant_make_ulongint(i);
+        ASSERT_NE(values[i], nullptr);
+    }
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, nullptr);
+
+    struct batch_events events = {};
+    struct pcvar_listener *listener;
+    listener = purc_variant_register_post_listener(arr,
+            PCVAR_OPERATION_INFLATED, on_array_grown, &events);
+    ASSERT_NE(listener, nullptr);
+
+    ASSERT_TRUE(purc_variant_array_append(arr, values[0]));
+    ASSERT_TRUE(purc_variant_array_append_many(arr,
+                PCA_TABLESIZE(values) - 1, values + 1));
+    ASSERT_EQ(events.nr_events, 2);
+    ASSERT_EQ(events.nr_batched, 1);
+    ASSERT_EQ(events.nr_members, PCA_TABLESIZE(values));
+
+    size_t sz = 0;
+    ASSERT_TRUE(purc_variant_array_size(arr, &sz));
+    ASSERT_EQ(sz, PCA_TABLESIZE(values));
+    for (size_t i = 0; i < sz; i++) {
+        ASSERT_EQ(purc_variant_array_get(arr, i), values[i]);
+    }
+
+    // nested batches fire the coalesced event only once
+    memset(&events, 0, sizeof(events));
+    ASSERT_TRUE(purc_variant_container_begin_batch(arr));
+    ASSERT_TRUE(purc_variant_array_append(arr, values[0]));
+    ASSERT_TRUE(purc_variant_container_begin_batch(arr));
+    ASSERT_TRUE(purc_variant_array_append_many(arr, 2, values + 1));
+    ASSERT_TRUE(purc_variant_container_commit_batch(arr));
+    ASSERT_EQ(events.nr_events, 0);
+    ASSERT_TRUE(purc_variant_container_commit_batch(arr));
+    ASSERT_EQ(events.nr_events, 1);
+    ASSERT_EQ(events.nr_batched, 1);
+    ASSERT_EQ(events.nr_members, 3);
+
+    ASSERT_FALSE(purc_variant_container_commit_batch(arr));
+
+    purc_variant_revoke_listener(arr, listener);
+    purc_variant_unref(arr);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(values); i++)
+        purc_variant_unref(values[i]);
+
+    ASSERT_TRUE(purc_cleanup());
+}
+
+struct op_events {
+    size_t      nr_ops;
+    pcvar_op_t  ops[8];
+    size_t      nr_calls;
+};
+
+static bool
+on_array_op(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    (void)source;
+    (void)msg_type;
+    (void)nr_args;
+    (void)argv;
+
+    struct op_events *events = (struct op_events *)ctxt;
+    events->nr_calls++;
+    return true;
+}
+
+static bool
+on_array_changed(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    struct op_events *events = (struct op_events *)ctxt;
+    if (events->nr_ops < PCA_TABLESIZE(events->ops))
+        events->ops[events->nr_ops++] = msg_type;
+
+    return purc_variant_unbatch_event(source, msg_type, ctxt, nr_args, argv,
+            on_array_op);
+}
+
+TEST(variant_array, batch_order)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_variant_t values[4];
+    for (size_t i = 0; i < PCA_TABLESIZE(values); i++) {
+        values[i] = purc_variant_make_ulongint(i);
+        ASSERT_NE(values[i], nullptr);
+    }
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, nullptr);
+
+    struct op_events events = {};
+    struct pcvar_listener *listener;
+    listener = purc_variant_register_post_listener(arr,
+            (pcvar_op_t)(PCVAR_OPERATION_INFLATED | PCVAR_OPERATION_DEFLATED),
+            on_array_changed, &events);
+    ASSERT_NE(listener, nullptr);
+
+    // the operations of different kinds are not reordered
+    ASSERT_TRUE(purc_variant_container_begin_batch(arr));
+    ASSERT_TRUE(purc_variant_array_append_many(arr, 2, values));
+    ASSERT_TRUE(purc_variant_array_remove(arr, 0));
+    ASSERT_TRUE(purc_variant_array_append(arr, values[2]));
+    ASSERT_TRUE(purc_variant_array_append(arr, values[3]));
+    ASSERT_TRUE(purc_variant_container_commit_batch(arr));
+
+    ASSERT_EQ(events.nr_ops, 3);
+    ASSERT_EQ(events.ops[0], PCVAR_OPERATION_INFLATED);
+    ASSERT_EQ(events.ops[1], PCVAR_OPERATION_DEFLATED);
+    ASSERT_EQ(events.ops[2], PCVAR_OPERATION_INFLATED);
+    ASSERT_EQ(events.nr_calls, 5);
+
+    size_t sz = 0;
+    ASSERT_TRUE(purc_variant_array_size(arr, &sz));
+    ASSERT_EQ(sz, 3);
+    ASSERT_EQ(purc_variant_array_get(arr, 0), values[1]);
+
+    purc_variant_revoke_listener(arr, listener);
+    purc_variant_unref(arr);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(values); i++)
+        purc_variant_unref(values[i]);
+
+    ASSERT_TRUE(purc_cleanup());
+}
+
+struct removed_events {
+    size_t      nr_events;
+    size_t      nr_removed;
+    bool        descending;
+    uint64_t    last_pos;
+};
+
+static bool
+on_array_removed(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    (void)source;
+    (void)msg_type;
+    (void)nr_args;
+
+    struct removed_events *events = (struct removed_events *)ctxt;
+    uint64_t pos = 0;
+    purc_variant_cast_to_ulongint(argv[0], &pos, false);
+    if (events->nr_removed > 0 && pos >= events->last_pos)
+        events->descending = false;
+    events->last_pos = pos;
+    events->nr_removed++;
+    return true;
+}
+
+static bool
+on_array_shrunk(purc_variant_t source, pcvar_op_t msg_type, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    struct removed_events *events = (struct removed_events *)ctxt;
+    events->nr_events++;
+
+    return purc_variant_unbatch_event(source, msg_type, ctxt, nr_args, argv,
+            on_array_removed);
+}
+
+TEST(variant_array, remove_indexed)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_variant_t values[20];
+    for (size_t i = 0; i < PCA_TABLESIZE(values); i++) {
+        values[i] = purc_variant_make_ulongint(i);
+        ASSERT_NE(values[i], nullptr);
+    }
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, nullptr);
+    ASSERT_TRUE(purc_variant_array_append_many(arr,
+                PCA_TABLESIZE(values), values));
+
+    // enough members in the source to go through the temporary index
+    purc_variant_t src = purc_variant_make_array_0();
+    ASSERT_NE(src, nullptr);
+    for (size_t i = 0; i < PCA_TABLESIZE(values); i += 2) {
+        ASSERT_TRUE(purc_variant_array_append(src, values[i]));
+    }
+
+    struct removed_events events = {};
+    events.descending = true;
+    struct pcvar_listener *listener;
+    listener = purc_variant_register_post_listener(arr,
+            PCVAR_OPERATION_DEFLATED, on_array_shrunk, &events);
+    ASSERT_NE(listener, nullptr);
+
+    ASSERT_TRUE(pcvariant_container_remove(arr, src, true));
+
+    // the removals are reported once, from the last position to the first
+    ASSERT_EQ(events.nr_events, 1);
+    ASSERT_EQ(events.nr_removed, PCA_TABLESIZE(values) / 2);
+    ASSERT_TRUE(events.descending);
+    ASSERT_EQ(events.last_pos, 0);
+
+    size_t sz = 0;
+    ASSERT_TRUE(purc_variant_array_size(arr, &sz));
+    ASSERT_EQ(sz, PCA_TABLESIZE(values) / 2);
+    for (size_t i = 0; i < sz; i++) {
+        ASSERT_EQ(purc_variant_array_get(arr, i), values[i * 2 + 1]);
+    }
+
+    purc_variant_revoke_listener(arr, listener);
+    purc_variant_unref(src);
+    purc_variant_unref(arr);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(values); i++)
+        purc_variant_unref(values[i]);
+
+    ASSERT_TRUE(purc_cleanup());
+}